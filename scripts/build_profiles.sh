@@ -0,0 +1,134 @@
+#!/bin/bash
+
+# Build Profile Comparison Script
+# Builds the benchmark executables once per build profile, runs the
+# benchmark suite (`make benchmarks`) with each and reports the speedup of
+# every profile over a plain Release build.
+#
+#   scripts/build_profiles.sh [work_dir] [profile...]
+#   scripts/build_profiles.sh build-profiles release lto pgo
+#
+# Profiles (default: all of them):
+#   debug    -O0, what a build without any build type used to be
+#   release  -O3 -DNDEBUG, the default build type and the baseline
+#   lto      release + link-time optimization
+#   native   release + -march=native
+#   pgo      release + profile-guided optimization: an instrumented build
+#            is trained on the benchmark suite itself, then rebuilt
+#   all      lto + native + pgo
+#
+# Each profile gets its own build directory under work_dir. Results:
+#   work_dir/<profile>/benchmark_results/   JSON + CSV per suite
+#   work_dir/speedups.csv                   per-benchmark median ratios
+# BENCH_REPETITIONS / BENCH_WARMUP are passed through to the benchmarks.
+
+set -e
+
+SOURCE_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+WORK_DIR="${1:-build-profiles}"
+[ $# -gt 0 ] && shift
+PROFILES="${*:-debug release lto native pgo all}"
+JOBS="$(nproc 2>/dev/null || echo 2)"
+
+mkdir -p "$WORK_DIR"
+WORK_DIR="$(cd "$WORK_DIR" && pwd)"
+
+profile_flags() {
+    case "$1" in
+        debug)   echo "-DCMAKE_BUILD_TYPE=Debug" ;;
+        release) echo "-DCMAKE_BUILD_TYPE=Release" ;;
+        lto)     echo "-DCMAKE_BUILD_TYPE=Release -DBOOTCAMP_LTO=ON" ;;
+        native)  echo "-DCMAKE_BUILD_TYPE=Release -DBOOTCAMP_NATIVE=ON" ;;
+        pgo)     echo "-DCMAKE_BUILD_TYPE=Release" ;;
+        all)     echo "-DCMAKE_BUILD_TYPE=Release -DBOOTCAMP_LTO=ON -DBOOTCAMP_NATIVE=ON" ;;
+        *)       return 1 ;;
+    esac
+}
+
+configure() {
+    local build_dir="$1"
+    shift
+    cmake -S "$SOURCE_DIR" -B "$build_dir" "$@" > "$build_dir.configure.log" 2>&1 || {
+        echo "❌ cmake failed, see $build_dir.configure.log"
+        exit 1
+    }
+}
+
+# Build the benchmark executables and run them (the `benchmarks` target)
+build_and_run() {
+    local build_dir="$1"
+    local log="$2"
+    cmake --build "$build_dir" --target benchmarks -j"$JOBS" > "$log" 2>&1 || {
+        echo "❌ build or benchmark run failed, see $log"
+        exit 1
+    }
+}
+
+echo "=== BUILD PROFILE COMPARISON ==="
+echo "Source: $SOURCE_DIR"
+echo "Work directory: $WORK_DIR"
+echo ""
+
+for profile in $PROFILES; do
+    flags="$(profile_flags "$profile")" || { echo "❌ Unknown profile: $profile"; exit 1; }
+    build_dir="$WORK_DIR/$profile"
+    mkdir -p "$build_dir"
+    echo "🔧 $profile"
+
+    if [ "$profile" = "pgo" ] || [ "$profile" = "all" ]; then
+        # Stale profiles from an older tree would be (partially) ignored
+        # with a warning per file; start clean
+        rm -rf "$build_dir/pgo_profiles"
+        configure "$build_dir" $flags -DBOOTCAMP_PGO=GENERATE
+        echo "   training instrumented build..."
+        build_and_run "$build_dir" "$build_dir/train.log"
+        if ls "$build_dir/pgo_profiles/"*.profraw > /dev/null 2>&1; then
+            llvm-profdata merge -o "$build_dir/pgo_profiles/default.profdata" "$build_dir/pgo_profiles/"*.profraw
+        fi
+        configure "$build_dir" $flags -DBOOTCAMP_PGO=USE
+    else
+        configure "$build_dir" $flags -DBOOTCAMP_PGO=OFF
+    fi
+
+    echo "   building and running benchmarks..."
+    build_and_run "$build_dir" "$build_dir/benchmarks.log"
+done
+
+if [ ! -d "$WORK_DIR/release/benchmark_results" ]; then
+    echo ""
+    echo "(no release results in $WORK_DIR to compare against)"
+    exit 0
+fi
+
+# Join every profile's CSV rows with the release rows on (suite, name).
+# The last nine fields are numbers, so the key is everything before them,
+# whatever quoting the benchmark name needed; median_ns is field NF-7.
+echo ""
+echo "Speedup over release (median time ratio; >1 is faster):"
+printf "  %-10s %8s %8s %8s %6s\n" "profile" "geomean" "min" "max" "n"
+echo "profile,suite_and_name,release_median_ns,median_ns,speedup" > "$WORK_DIR/speedups.csv"
+for profile in $PROFILES; do
+    [ "$profile" = "release" ] && continue
+    [ -d "$WORK_DIR/$profile/benchmark_results" ] || continue
+    awk -v profile="$profile" -v out="$WORK_DIR/speedups.csv" '
+        FNR == 1 { next }
+        {
+            key = $1
+            for (i = 2; i <= NF - 9; i++) key = key "," $i
+            median = $(NF - 7) + 0
+        }
+        FILENAME ~ /\/release\// { base[key] = median; next }
+        (key in base) && base[key] > 0 && median > 0 {
+            ratio = base[key] / median
+            printf "%s,%s,%.1f,%.1f,%.3f\n", profile, key, base[key], median, ratio >> out
+            sum += log(ratio); n++
+            if (n == 1 || ratio < low) low = ratio
+            if (n == 1 || ratio > high) high = ratio
+        }
+        END {
+            if (n > 0) printf "  %-10s %7.2fx %7.2fx %7.2fx %6d\n", profile, exp(sum / n), low, high, n
+        }
+    ' FS=, "$WORK_DIR"/release/benchmark_results/*.csv "$WORK_DIR/$profile"/benchmark_results/*.csv
+done
+echo ""
+echo "Per-benchmark ratios: $WORK_DIR/speedups.csv"
@@ -35,11 +35,15 @@ echo "   # Server will bind to port 2323"
 echo "   # Accepts multiple concurrent connections"
 echo "   # Use Ctrl+C to stop"
 echo ""
+echo "   ./telnet_server --reactor --threads 4"
+echo "   # Event-driven mode: 4 epoll/kqueue loops serve every client"
+echo ""
 
 echo "2. Connect with Custom Client (Terminal 2):"
 echo "   ./telnet_client                    # Connect to localhost:2323"
 echo "   ./telnet_client 192.168.1.100      # Connect to specific IP"
 echo "   ./telnet_client 127.0.0.1 2323     # Specify port"
+echo "   ./telnet_client --bench --sessions 10000 --concurrency 2000   # Headless load test"
 echo ""
 
 echo "3. Connect with Standard Telnet Client:"
@@ -2,6 +2,29 @@
 
 # UDP Server and Client Demo Script
 # This script demonstrates how to use the UDP server and client programs
+#
+# Benchmark mode starts the batched server, drives it with the load generator
+# and stops it again. Extra arguments are passed on to udp_client --bench:
+#   scripts/udp_demo.sh --bench [build_dir] [udp_client bench options...]
+#   scripts/udp_demo.sh --bench build --concurrency 4 --rate 100000 --duration 10
+
+if [ "$1" = "--bench" ]; then
+    BUILD_DIR="${2:-build}"
+    shift; [ $# -gt 0 ] && shift
+    if [ ! -x "$BUILD_DIR/udp_server" ] || [ ! -x "$BUILD_DIR/udp_client" ]; then
+        echo "❌ udp_server/udp_client not found in $BUILD_DIR (build first)"
+        exit 1
+    fi
+
+    echo "=== UDP LOAD TEST ==="
+    "$BUILD_DIR/udp_server" --batch > /dev/null &
+    SERVER_PID=$!
+    trap 'kill $SERVER_PID 2>/dev/null' EXIT
+    sleep 0.5
+
+    "$BUILD_DIR/udp_client" --bench "$@"
+    exit $?
+fi
 
 echo "=== UDP SERVER AND CLIENT DEMO ==="
 echo ""
@@ -17,12 +40,15 @@ echo ""
 
 echo "1. Start UDP Server (in one terminal):"
 echo "   ./udp_server"
+echo "   ./udp_server --batch 64           # High-throughput: recvmmsg/sendmmsg, one worker per core"
 echo ""
 
 echo "2. Send messages from UDP Client (in another terminal):"
 echo "   ./udp_client \"Hello Server!\""
 echo "   ./udp_client \"Custom message\" 192.168.1.100"
 echo "   ./udp_client                    # Interactive mode"
+echo "   ./udp_client --bench --concurrency 4 --window 32   # Load generator"
+echo "   scripts/udp_demo.sh --bench build --rate 100000    # Server + load generator"
 echo ""
 
 echo "3. Run combined test:"
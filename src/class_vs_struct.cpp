@@ -6,6 +6,12 @@
 
 #include <iostream>
 #include <string>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "benchmark.h"
+#include "soa_vector.h"
 
 // ANSI Color codes for better output visualization
 namespace Colors {
@@ -294,6 +300,118 @@ void show_when_to_use_which() {
     std::cout << "  • Need validation or business logic" << std::endl;
 }
 
+// Hot loops over 10M Points / Rectangles, stored as std::vector (array of
+// structures) and as containers::SoaVector (one array per field)
+void demonstrate_layout_performance() {
+    std::cout << Colors::BOLD << Colors::MAGENTA << "\n=== DATA LAYOUT IN HOT LOOPS (measured) ===" << Colors::RESET
+              << std::endl;
+    
+    const size_t COUNT = 10'000'000;
+    bench::Options options = bench::Options::from_environment();
+    options.print = false;  // The table below instead
+    bench::Suite suite("class_vs_struct", options);
+    auto ns_per_element = [&](const std::string& name, auto&& scan) {
+        return suite.run(name, scan, COUNT).ns_per_item();
+    };
+    auto print_row = [](const char* loop, const char* fields, double aos_ns, double soa_ns) {
+        printf("  %-30s %-7s %9.2f %9.2f   %5.1fx\n", loop, fields, aos_ns, soa_ns, aos_ns / soa_ns);
+    };
+    printf("  %-30s %-7s %9s %9s   %s\n", "ns per element", "fields", "AoS", "SoA", "SoA gain");
+    
+    {
+        std::vector<Point> aos;
+        containers::SoaVector<Point, &Point::x, &Point::y> soa;
+        aos.reserve(COUNT);
+        soa.reserve(COUNT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            Point p(static_cast<double>(i % 1000), static_cast<double>(i % 777));
+            aos.push_back(p);
+            soa.push_back(p);
+        }
+        double* xs = soa.data<&Point::x>();
+        const double* ys = soa.data<&Point::y>();
+        
+        print_row("Point: sum of x", "1 of 2",
+                  ns_per_element("point sum x / AoS", [&] {
+                      double sum = 0;
+                      for (const Point& p : aos) sum += p.x;
+                      bench::do_not_optimize(sum);
+                  }),
+                  ns_per_element("point sum x / SoA", [&] {
+                      double sum = 0;
+                      for (size_t i = 0; i < COUNT; ++i) sum += xs[i];
+                      bench::do_not_optimize(sum);
+                  }));
+        print_row("Point: x += 1", "1 of 2",
+                  ns_per_element("point shift x / AoS", [&] {
+                      for (Point& p : aos) p.x += 1.0;
+                      bench::clobber_memory();
+                  }),
+                  ns_per_element("point shift x / SoA", [&] {
+                      for (size_t i = 0; i < COUNT; ++i) xs[i] += 1.0;
+                      bench::clobber_memory();
+                  }));
+        print_row("Point: sum of distances", "2 of 2",
+                  ns_per_element("point distance / AoS", [&] {
+                      double sum = 0;
+                      for (const Point& p : aos) sum += p.distance_from_origin();
+                      bench::do_not_optimize(sum);
+                  }),
+                  ns_per_element("point distance / SoA", [&] {
+                      double sum = 0;
+                      for (size_t i = 0; i < COUNT; ++i) sum += sqrt(xs[i] * xs[i] + ys[i] * ys[i]);
+                      bench::do_not_optimize(sum);
+                  }));
+    }
+    
+    {
+        std::vector<Rectangle> aos;
+        containers::SoaVector<Rectangle, &Rectangle::width, &Rectangle::height> soa;
+        aos.reserve(COUNT);
+        soa.reserve(COUNT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            Rectangle r(static_cast<double>(i % 10), static_cast<double>(i % 7));
+            aos.push_back(r);
+            soa.push_back(r);
+        }
+        const double* widths = soa.data<&Rectangle::width>();
+        const double* heights = soa.data<&Rectangle::height>();
+        
+        print_row("Rectangle: count width > 5", "1 of 2",
+                  ns_per_element("rectangle wide / AoS", [&] {
+                      size_t wide = 0;
+                      for (const Rectangle& r : aos) wide += r.width > 5.0;
+                      bench::do_not_optimize(wide);
+                  }),
+                  ns_per_element("rectangle wide / SoA", [&] {
+                      size_t wide = 0;
+                      for (size_t i = 0; i < COUNT; ++i) wide += widths[i] > 5.0;
+                      bench::do_not_optimize(wide);
+                  }));
+        // The SoA loop cannot call area(): there is no Rectangle to call it
+        // on, so its validity rule is repeated here
+        print_row("Rectangle: total area", "2 of 2",
+                  ns_per_element("rectangle area / AoS", [&] {
+                      double total = 0;
+                      for (const Rectangle& r : aos) total += r.area();
+                      bench::do_not_optimize(total);
+                  }),
+                  ns_per_element("rectangle area / SoA", [&] {
+                      double total = 0;
+                      for (size_t i = 0; i < COUNT; ++i) {
+                          total += widths[i] > 0 && heights[i] > 0 ? widths[i] * heights[i] : 0.0;
+                      }
+                      bench::do_not_optimize(total);
+                  }));
+    }
+    
+    std::cout << "\n  1 of 2 fields: AoS drags the unused field through the cache, so SoA moves half the bytes." << std::endl;
+    std::cout << "  Loops over a dense column vectorize with plain vector loads; over AoS the compiler needs" << std::endl;
+    std::cout << "  strided loads and shuffles, or gives up (build with -fopt-info-vec to see which)." << std::endl;
+    std::cout << "  Sums of doubles still add in source order without -ffast-math, one add at a time." << std::endl;
+    std::cout << "  2 of 2 fields: both layouts read every byte, and the gain (if any) is vectorization." << std::endl;
+}
+
 // =============================================================================
 // MAIN FUNCTION
 // =============================================================================
@@ -306,6 +424,7 @@ int main() {
     demonstrate_class_usage();
     demonstrate_access_levels();
     show_when_to_use_which();
+    demonstrate_layout_performance();
     
     std::cout << Colors::BOLD << Colors::GREEN << "\n✅ Key Takeaway:" << Colors::RESET << std::endl;
     std::cout << "The ONLY difference is default access level:" << std::endl;
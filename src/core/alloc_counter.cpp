@@ -0,0 +1,74 @@
+/**
+ * @file alloc_counter.cpp
+ * @brief Counting replacements for the global operator new / delete
+ */
+
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+thread_local uint64_t thread_allocations = 0;
+thread_local uint64_t thread_bytes = 0;
+std::atomic<uint64_t> total_allocations{0};
+
+void count_allocation(std::size_t size) {
+    ++thread_allocations;
+    thread_bytes += size;
+    total_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* checked_malloc(std::size_t size) {
+    count_allocation(size);
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* checked_aligned_alloc(std::size_t size, std::align_val_t alignment) {
+    count_allocation(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (align < sizeof(void*)) align = sizeof(void*);
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, align, size == 0 ? 1 : size) != 0) throw std::bad_alloc();
+    return ptr;
+}
+}  // namespace
+
+namespace memory {
+
+uint64_t thread_allocation_count() { return thread_allocations; }
+
+uint64_t thread_allocated_bytes() { return thread_bytes; }
+
+uint64_t total_allocation_count() { return total_allocations.load(std::memory_order_relaxed); }
+
+}  // namespace memory
+
+void* operator new(std::size_t size) { return checked_malloc(size); }
+void* operator new[](std::size_t size) { return checked_malloc(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return checked_aligned_alloc(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return checked_aligned_alloc(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    count_allocation(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    count_allocation(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
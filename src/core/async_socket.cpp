@@ -0,0 +1,113 @@
+/**
+ * @file async_socket.cpp
+ * @brief Readiness bookkeeping and system calls for net::AsyncSocket
+ */
+
+#include "async_socket.h"
+
+#include <utility>
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0  // macOS: ignore SIGPIPE process-wide instead
+#endif
+
+namespace net {
+
+bool AsyncSocket::wait(Operation& operation, uint32_t direction) {
+    if (direction == EVENT_READ) {
+        reader_ = &operation;
+    } else {
+        writer_ = &operation;
+    }
+    if ((interest_ & direction) != 0) return true;  // Still armed from last time
+    if (update_interest(interest_ | direction)) return true;
+    (direction == EVENT_READ ? reader_ : writer_) = nullptr;
+    return false;
+}
+
+void AsyncSocket::remove() {
+    if (!registered_) return;
+    loop_.remove(fd_);
+    registered_ = false;
+    interest_ = 0;
+}
+
+void AsyncSocket::handle_event(uint32_t events) {
+    // Retry the parked operations, and collect the ones that completed
+    // before resuming anything: a resumed coroutine may destroy *this
+    Operation* done[2];
+    int count = 0;
+    bool read_done = false;
+    if (reader_ != nullptr && (events & (EVENT_READ | EVENT_ERROR)) && reader_->attempt()) {
+        done[count++] = std::exchange(reader_, nullptr);
+        read_done = true;
+    }
+    if (writer_ != nullptr && (events & (EVENT_WRITE | EVENT_ERROR)) && writer_->attempt()) {
+        done[count++] = std::exchange(writer_, nullptr);
+    }
+
+    if (reader_ == nullptr && writer_ == nullptr && count == 0 && (events & EVENT_ERROR)) {
+        // A hang-up is reported whatever the interest: leave the loop until
+        // the next operation instead of hearing about it on every iteration
+        remove();
+    } else {
+        // Readiness nobody waits for would be reported again and again, so
+        // drop it. Read interest survives a completed recv() (the next one
+        // is probably coming); write interest does not, since a socket is
+        // nearly always writable.
+        uint32_t wanted = interest_;
+        if (reader_ == nullptr && !read_done) wanted &= ~EVENT_READ;
+        if (writer_ == nullptr) wanted &= ~EVENT_WRITE;
+        update_interest(wanted);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        done[i]->waiter.resume();
+    }
+}
+
+bool AsyncSocket::update_interest(uint32_t wanted) {
+    if (wanted == interest_ && registered_) return true;
+    bool ok = registered_ ? loop_.modify(fd_, wanted, this) : loop_.add(fd_, wanted, this);
+    if (!ok) return false;
+    registered_ = true;
+    interest_ = wanted;
+    return true;
+}
+
+bool RecvAwaiter::attempt() {
+    while (true) {
+        ssize_t received = ::recv(socket_.fd(), buffer_, length_, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0 && would_block()) return false;
+        return complete(received);
+    }
+}
+
+bool SendAwaiter::attempt() {
+    while (sent_ < length_) {
+        ssize_t sent = ::send(socket_.fd(), data_ + sent_, length_ - sent_, MSG_NOSIGNAL);
+        if (sent > 0) {
+            sent_ += static_cast<size_t>(sent);
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        } else if (sent < 0 && would_block()) {
+            return false;  // Keep what went out, wait for room for the rest
+        } else {
+            return complete(-1);
+        }
+    }
+    return complete(static_cast<ssize_t>(sent_));
+}
+
+bool AcceptAwaiter::attempt() {
+    while (true) {
+        if (address_length_ != nullptr) *address_length_ = initial_length_;
+        int client = ::accept(socket_.fd(), address_, address_length_);
+        if (client < 0 && (errno == EINTR || errno == ECONNABORTED)) continue;
+        if (client < 0 && would_block()) return false;
+        return complete(client);
+    }
+}
+
+}  // namespace net
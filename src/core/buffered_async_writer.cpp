@@ -0,0 +1,281 @@
+/**
+ * @file buffered_async_writer.cpp
+ * @brief Buffer switching, background flushing and durability for io::BufferedAsyncWriter
+ */
+
+#include "buffered_async_writer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace io {
+
+namespace {
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+// fdatasync where it exists (macOS only has fsync)
+int data_sync(int fd) {
+#if defined(__APPLE__)
+    return fsync(fd);
+#else
+    return fdatasync(fd);
+#endif
+}
+
+}  // namespace
+
+BufferedAsyncWriter::BufferedAsyncWriter() = default;
+
+BufferedAsyncWriter::~BufferedAsyncWriter() { close(); }
+
+bool BufferedAsyncWriter::open(const std::string& path, const Options& options) {
+    if (fd_ >= 0) {
+        errno = EBUSY;
+        return false;
+    }
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    options_ = options;
+    for (Buffer& buffer : buffers_) {
+        buffer.data.reset(new char[options_.buffer_bytes]);
+        buffer.reserved.store(SEALED, std::memory_order_relaxed);
+        buffer.committed.store(0, std::memory_order_relaxed);
+        buffer.end.store(NO_END, std::memory_order_relaxed);
+        buffer.base = 0;
+    }
+    buffers_[0].reserved.store(0, std::memory_order_relaxed);
+    active_.store(0, std::memory_order_relaxed);
+    stopping_.store(false, std::memory_order_relaxed);
+    failed_.store(false, std::memory_order_relaxed);
+    flush_requested_.store(false, std::memory_order_relaxed);
+    swaps_.store(0, std::memory_order_relaxed);
+    written_ = durable_ = 0;
+
+    fd_ = fd;
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+bool BufferedAsyncWriter::close() {
+    if (fd_ < 0) return true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_.store(true, std::memory_order_release);
+    }
+    work_cv_.notify_one();
+    thread_.join();
+    bool ok = !failed_.load(std::memory_order_acquire);
+    if (::close(fd_) != 0) ok = false;
+    fd_ = -1;
+    return ok;
+}
+
+uint64_t BufferedAsyncWriter::append(const void* data, size_t length) {
+    if (fd_ < 0 || length == 0 || length > options_.buffer_bytes) return 0;
+    uint64_t start = options_.record_append_latency ? now_ns() : 0;
+    const uint64_t capacity = options_.buffer_bytes;
+
+    while (!failed_.load(std::memory_order_relaxed)) {
+        uint64_t epoch = swaps_.load(std::memory_order_acquire);
+        Buffer& buffer = buffers_[active_.load(std::memory_order_acquire)];
+        uint64_t offset = buffer.reserved.fetch_add(length, std::memory_order_acq_rel);
+
+        if ((offset & SEALED) == 0 && offset + length <= capacity) {
+            // Read base before committing: once the last commit lands the
+            // flusher may write the buffer out and reuse it
+            uint64_t ticket = buffer.base + offset + length;
+            std::memcpy(buffer.data.get() + offset, data, length);
+            buffer.committed.fetch_add(length, std::memory_order_release);
+            appends_.fetch_add(1, std::memory_order_relaxed);
+            if (options_.record_append_latency) record_append_latency(now_ns() - start);
+            return ticket;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if ((offset & SEALED) == 0 && offset <= capacity) {
+            // The one reservation that straddles the end marks where the
+            // buffer's data stops, and asks for a flush
+            buffer.end.store(offset, std::memory_order_release);
+            work_cv_.notify_one();
+        }
+        full_waits_.fetch_add(1, std::memory_order_relaxed);
+        space_cv_.wait(lock, [&] {
+            return swaps_.load(std::memory_order_acquire) != epoch || failed_.load(std::memory_order_relaxed);
+        });
+    }
+    return 0;
+}
+
+bool BufferedAsyncWriter::wait_durable(uint64_t ticket) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (durable_ < ticket) {
+        // Don't wait out the linger time: a batch that is already being
+        // written keeps collecting records, so this still groups commits
+        flush_requested_.store(true, std::memory_order_relaxed);
+        work_cv_.notify_one();
+    }
+    durable_cv_.wait(lock, [&] { return durable_ >= ticket || failed_.load(std::memory_order_relaxed); });
+    return durable_ >= ticket;
+}
+
+void BufferedAsyncWriter::flush() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_requested_.store(true, std::memory_order_relaxed);
+    }
+    work_cv_.notify_one();
+}
+
+BufferedAsyncWriter::Stats BufferedAsyncWriter::stats() const {
+    Stats stats;
+    stats.appends = appends_.load(std::memory_order_relaxed);
+    stats.full_waits = full_waits_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.bytes = written_;
+        stats.batches = batches_;
+        stats.syncs = syncs_;
+        stats.flush = flush_latency_;
+    }
+    for (auto& stripe : append_latency_) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        stats.append.merge(stripe->histogram);
+    }
+    return stats;
+}
+
+void BufferedAsyncWriter::record_append_latency(uint64_t nanos) {
+    static std::atomic<unsigned> next_stripe{0};
+    thread_local unsigned stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % LATENCY_STRIPES;
+    // Never block an append for a statistic: skip the sample if contended
+    LatencyStripe& target = *append_latency_[stripe];
+    if (target.mutex.try_lock()) {
+        target.histogram.record(nanos);
+        target.mutex.unlock();
+    }
+}
+
+bool BufferedAsyncWriter::write_all(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::write(fd_, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Seal the active buffer, switch appenders to the other one, and write the
+// sealed one out. Returns false if there is nothing to write.
+bool BufferedAsyncWriter::write_sealed(Buffer& buffer, uint64_t& batch_bytes) {
+    const uint64_t capacity = options_.buffer_bytes;
+    int index = active_.load(std::memory_order_relaxed);
+    Buffer& next = buffers_[1 - index];
+    if ((buffer.reserved.load(std::memory_order_acquire) & ~SEALED) == 0) return false;
+
+    uint64_t reserved = buffer.reserved.fetch_or(SEALED, std::memory_order_acq_rel);
+    uint64_t end = reserved;
+    if (reserved > capacity) {
+        // Overflowed: the straddling append publishes the real end
+        while ((end = buffer.end.load(std::memory_order_acquire)) == NO_END) std::this_thread::yield();
+    }
+
+    // The other buffer was written out by the previous round; reopen it
+    next.committed.store(0, std::memory_order_relaxed);
+    next.end.store(NO_END, std::memory_order_relaxed);
+    next.base = buffer.base + end;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next.reserved.store(0, std::memory_order_release);
+        active_.store(1 - index, std::memory_order_release);
+        swaps_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    space_cv_.notify_all();
+
+    // Wait for appenders that reserved space but are still copying
+    while (buffer.committed.load(std::memory_order_acquire) != end) std::this_thread::yield();
+
+    if (!failed_.load(std::memory_order_relaxed) && !write_all(buffer.data.get(), end)) {
+        failed_.store(true, std::memory_order_release);
+    }
+    batch_bytes = end;
+    return true;
+}
+
+void BufferedAsyncWriter::run() {
+    const bool durable = options_.durability != Durability::NONE;
+    auto next_sync = std::chrono::steady_clock::now() + options_.sync_interval;
+    uint64_t unsynced = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait_for(lock, options_.max_linger, [&] {
+                const Buffer& active = buffers_[active_.load(std::memory_order_relaxed)];
+                return stopping_.load(std::memory_order_relaxed) ||
+                       flush_requested_.load(std::memory_order_relaxed) ||
+                       active.end.load(std::memory_order_relaxed) != NO_END;
+            });
+            flush_requested_.store(false, std::memory_order_relaxed);
+        }
+        bool stopping = stopping_.load(std::memory_order_acquire);
+
+        uint64_t start = now_ns();
+        uint64_t batch_bytes = 0;
+        bool wrote = write_sealed(buffers_[active_.load(std::memory_order_relaxed)], batch_bytes);
+        if (durable) unsynced += batch_bytes;
+
+        bool sync_now = false;
+        if (unsynced > 0 && durable) {
+            sync_now = options_.durability == Durability::BATCH || stopping ||
+                       std::chrono::steady_clock::now() >= next_sync;
+        }
+        if (sync_now) {
+            if (!failed_.load(std::memory_order_relaxed) && data_sync(fd_) != 0) {
+                failed_.store(true, std::memory_order_release);
+            }
+            next_sync = std::chrono::steady_clock::now() + options_.sync_interval;
+        }
+
+        if (wrote || sync_now) {
+            uint64_t elapsed = now_ns() - start;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                written_ += batch_bytes;
+                if (wrote) {
+                    ++batches_;
+                    flush_latency_.record(elapsed);
+                }
+                if (sync_now) ++syncs_;
+                if (!durable) {
+                    durable_ = written_;
+                } else if (sync_now) {
+                    durable_ = written_;
+                    unsynced = 0;
+                }
+            }
+            durable_cv_.notify_all();
+        }
+        if (failed_.load(std::memory_order_relaxed)) {
+            space_cv_.notify_all();
+            durable_cv_.notify_all();
+        }
+
+        // Appends have finished by the time close() stops us, so an idle
+        // round means everything is out
+        if (stopping && !wrote && unsynced == 0) break;
+    }
+}
+
+}  // namespace io
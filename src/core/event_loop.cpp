@@ -0,0 +1,250 @@
+/**
+ * @file event_loop.cpp
+ * @brief epoll / kqueue backends for net::EventLoop
+ */
+
+#include "event_loop.h"
+
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define NET_USE_EPOLL 1
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#include <sys/event.h>
+#include <sys/time.h>
+#define NET_USE_KQUEUE 1
+#else
+#error "net::EventLoop needs epoll or kqueue"
+#endif
+
+namespace net {
+
+namespace {
+const int MAX_EVENTS_PER_WAIT = 256;
+
+// Sentinel handler pointer for the wake-up pipe
+EventHandler* const WAKEUP_TAG = nullptr;
+}  // namespace
+
+bool set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return false;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+uint64_t raise_fd_limit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return 0;
+    if (limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return static_cast<uint64_t>(limit.rlim_cur);
+}
+
+EventLoop::EventLoop() {
+#if NET_USE_EPOLL
+    poll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+#else
+    poll_fd_ = kqueue();
+#endif
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) == 0) {
+        wake_read_fd_ = pipe_fds[0];
+        wake_write_fd_ = pipe_fds[1];
+        set_nonblocking(wake_read_fd_);
+        set_nonblocking(wake_write_fd_);
+        add(wake_read_fd_, EVENT_READ, WAKEUP_TAG);
+    }
+}
+
+EventLoop::~EventLoop() {
+    if (wake_read_fd_ != -1) close(wake_read_fd_);
+    if (wake_write_fd_ != -1) close(wake_write_fd_);
+    if (poll_fd_ != -1) close(poll_fd_);
+}
+
+#if NET_USE_EPOLL
+
+static uint32_t to_epoll(uint32_t events) {
+    uint32_t result = 0;
+    if (events & EVENT_READ) result |= EPOLLIN | EPOLLRDHUP;
+    if (events & EVENT_WRITE) result |= EPOLLOUT;
+    return result;
+}
+
+bool EventLoop::add(int fd, uint32_t events, EventHandler* handler) {
+    struct epoll_event ev {};
+    ev.events = to_epoll(events);
+    ev.data.ptr = handler;
+    return epoll_ctl(poll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+bool EventLoop::modify(int fd, uint32_t events, EventHandler* handler) {
+    struct epoll_event ev {};
+    ev.events = to_epoll(events);
+    ev.data.ptr = handler;
+    return epoll_ctl(poll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void EventLoop::remove(int fd) {
+    epoll_ctl(poll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+int EventLoop::run_once(int timeout_ms) {
+    struct epoll_event events[MAX_EVENTS_PER_WAIT];
+    int ready = epoll_wait(poll_fd_, events, MAX_EVENTS_PER_WAIT, timeout_ms);
+    if (ready < 0) {
+        return 0;  // EINTR: let the caller re-check its state
+    }
+
+    int handled = 0;
+    for (int i = 0; i < ready; ++i) {
+        auto* handler = static_cast<EventHandler*>(events[i].data.ptr);
+        if (handler == WAKEUP_TAG) {
+            drain_wakeup();
+            continue;
+        }
+        uint32_t flags = 0;
+        if (events[i].events & EPOLLIN) flags |= EVENT_READ;
+        if (events[i].events & EPOLLOUT) flags |= EVENT_WRITE;
+        if (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) flags |= EVENT_ERROR;
+        handler->handle_event(flags);
+        ++handled;
+    }
+
+    run_pending();
+    timers_.advance(now_ms());
+    return handled;
+}
+
+#else  // NET_USE_KQUEUE
+
+// kqueue tracks read and write interest as two independent filters, so
+// add/modify boil down to enabling or deleting each filter explicitly.
+static bool apply_kqueue(int kq, int fd, uint32_t events, EventHandler* handler) {
+    struct kevent changes[2];
+    EV_SET(&changes[0], fd, EVFILT_READ, (events & EVENT_READ) ? EV_ADD | EV_ENABLE : EV_DELETE, 0, 0, handler);
+    EV_SET(&changes[1], fd, EVFILT_WRITE, (events & EVENT_WRITE) ? EV_ADD | EV_ENABLE : EV_DELETE, 0, 0, handler);
+    // EV_DELETE of a filter that was never added reports ENOENT; that is fine
+    for (auto& change : changes) {
+        if (kevent(kq, &change, 1, nullptr, 0, nullptr) < 0 && errno != ENOENT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EventLoop::add(int fd, uint32_t events, EventHandler* handler) {
+    return apply_kqueue(poll_fd_, fd, events, handler);
+}
+
+bool EventLoop::modify(int fd, uint32_t events, EventHandler* handler) {
+    return apply_kqueue(poll_fd_, fd, events, handler);
+}
+
+void EventLoop::remove(int fd) {
+    apply_kqueue(poll_fd_, fd, 0, nullptr);
+}
+
+int EventLoop::run_once(int timeout_ms) {
+    struct kevent events[MAX_EVENTS_PER_WAIT];
+    struct timespec timeout;
+    struct timespec* timeout_ptr = nullptr;
+    if (timeout_ms >= 0) {
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+        timeout_ptr = &timeout;
+    }
+
+    int ready = kevent(poll_fd_, nullptr, 0, events, MAX_EVENTS_PER_WAIT, timeout_ptr);
+    if (ready < 0) {
+        return 0;
+    }
+
+    int handled = 0;
+    for (int i = 0; i < ready; ++i) {
+        auto* handler = static_cast<EventHandler*>(events[i].udata);
+        if (handler == WAKEUP_TAG) {
+            drain_wakeup();
+            continue;
+        }
+        uint32_t flags = 0;
+        if (events[i].filter == EVFILT_READ) flags |= EVENT_READ;
+        if (events[i].filter == EVFILT_WRITE) flags |= EVENT_WRITE;
+        if (events[i].flags & (EV_EOF | EV_ERROR)) flags |= EVENT_ERROR;
+        handler->handle_event(flags);
+        ++handled;
+    }
+
+    run_pending();
+    timers_.advance(now_ms());
+    return handled;
+}
+
+#endif
+
+void EventLoop::run() {
+    running_.store(true, std::memory_order_release);
+    while (!stop_requested_.load(std::memory_order_acquire)) {
+        run_once(timer_timeout_ms());
+    }
+    run_pending();
+    running_.store(false, std::memory_order_release);
+}
+
+int EventLoop::timer_timeout_ms() const {
+    int64_t ticks = timers_.ticks_until_next();
+    if (ticks < 0) return -1;
+    // The wheel's clock only moves in advance(); count the time since then
+    int64_t behind = static_cast<int64_t>(now_ms() - timers_.now());
+    int64_t wait = ticks - behind;
+    if (wait <= 0) return 0;
+    return wait > INT_MAX ? INT_MAX : static_cast<int>(wait);
+}
+
+void EventLoop::stop() {
+    stop_requested_.store(true, std::memory_order_release);
+    wakeup();
+}
+
+void EventLoop::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_.push_back(std::move(task));
+    }
+    wakeup();
+}
+
+void EventLoop::wakeup() {
+    // write() is async-signal-safe, so stop() may be called from a handler
+    char byte = 1;
+    ssize_t ignored = write(wake_write_fd_, &byte, 1);
+    (void)ignored;
+}
+
+void EventLoop::drain_wakeup() {
+    char scratch[64];
+    while (read(wake_read_fd_, scratch, sizeof(scratch)) > 0) {
+    }
+}
+
+void EventLoop::run_pending() {
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        tasks.swap(pending_);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+}  // namespace net
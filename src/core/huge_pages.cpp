@@ -0,0 +1,190 @@
+/**
+ * @file huge_pages.cpp
+ * @brief The hugetlb -> THP -> 4KB fallback chain and the arena over it
+ */
+
+#include "huge_pages.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <utility>
+#include <sys/mman.h>
+
+namespace memory {
+
+namespace {
+
+const size_t SMALL_PAGE = 4096;
+const size_t HUGE_PAGE = 2 << 20;
+
+size_t round_up(size_t bytes, size_t page) { return (std::max<size_t>(bytes, 1) + page - 1) / page * page; }
+
+// MAP_HUGETLB with an explicit page size, or nullptr
+char* map_hugetlb(size_t size, PageSize kind) {
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    int log2_size = kind == PageSize::HUGETLB_1GB ? 30 : 21;
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2_size << MAP_HUGE_SHIFT), -1, 0);
+    return memory == MAP_FAILED ? nullptr : static_cast<char*>(memory);
+#else
+    (void)size;
+    (void)kind;
+    return nullptr;
+#endif
+}
+
+// A 2MB-aligned mapping (over-map, then trim both ends), or nullptr
+char* map_aligned(size_t size, size_t alignment) {
+    void* memory = mmap(nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return nullptr;
+    char* base = static_cast<char*>(memory);
+    char* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(base) + alignment - 1) & ~(alignment - 1));
+    if (aligned > base) munmap(base, static_cast<size_t>(aligned - base));
+    size_t tail = static_cast<size_t>(base + size + alignment - (aligned + size));
+    if (tail > 0) munmap(aligned + size, tail);
+    return aligned;
+}
+
+}  // namespace
+
+const char* page_size_name(PageSize size) {
+    switch (size) {
+        case PageSize::HUGETLB_1GB:
+            return "hugetlb 1GB";
+        case PageSize::HUGETLB_2MB:
+            return "hugetlb 2MB";
+        case PageSize::TRANSPARENT_2MB:
+            return "THP 2MB";
+        case PageSize::SMALL_4KB:
+            return "4KB";
+    }
+    return "unknown";
+}
+
+size_t page_bytes(PageSize size) {
+    switch (size) {
+        case PageSize::HUGETLB_1GB:
+            return size_t{1} << 30;
+        case PageSize::HUGETLB_2MB:
+        case PageSize::TRANSPARENT_2MB:
+            return HUGE_PAGE;
+        case PageSize::SMALL_4KB:
+            break;
+    }
+    return SMALL_PAGE;
+}
+
+HugePageRegion::HugePageRegion(size_t bytes, PageSize largest) {
+    const PageSize ORDER[] = {PageSize::HUGETLB_1GB, PageSize::HUGETLB_2MB, PageSize::TRANSPARENT_2MB,
+                              PageSize::SMALL_4KB};
+    for (PageSize kind : ORDER) {
+        if (kind < largest) continue;  // Larger than the caller allows
+        size_t page = page_bytes(kind);
+        if (kind != PageSize::SMALL_4KB && bytes < page) continue;
+        size_t size = round_up(bytes, page);
+        char* memory = nullptr;
+        if (kind == PageSize::HUGETLB_1GB || kind == PageSize::HUGETLB_2MB) {
+            memory = map_hugetlb(size, kind);
+        } else if (kind == PageSize::TRANSPARENT_2MB) {
+#if defined(MADV_HUGEPAGE)
+            memory = map_aligned(size, HUGE_PAGE);
+            if (memory != nullptr && madvise(memory, size, MADV_HUGEPAGE) != 0) {
+                munmap(memory, size);  // THP not built in or disabled
+                memory = nullptr;
+            }
+#endif
+        } else {
+            void* small = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (small == MAP_FAILED) throw std::bad_alloc();
+            memory = static_cast<char*>(small);
+#if defined(MADV_NOHUGEPAGE)
+            madvise(memory, size, MADV_NOHUGEPAGE);
+#endif
+        }
+        if (memory != nullptr) {
+            data_ = memory;
+            size_ = size;
+            page_size_ = kind;
+            return;
+        }
+    }
+}
+
+HugePageRegion::~HugePageRegion() {
+    if (data_ != nullptr) munmap(data_, size_);
+}
+
+HugePageRegion::HugePageRegion(HugePageRegion&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      page_size_(other.page_size_) {}
+
+HugePageRegion& HugePageRegion::operator=(HugePageRegion&& other) noexcept {
+    if (this != &other) {
+        if (data_ != nullptr) munmap(data_, size_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        page_size_ = other.page_size_;
+    }
+    return *this;
+}
+
+size_t HugePageRegion::huge_bytes() const {
+    switch (page_size_) {
+        case PageSize::HUGETLB_1GB:
+        case PageSize::HUGETLB_2MB:
+            return size_;
+        case PageSize::TRANSPARENT_2MB:
+            return data_ != nullptr ? transparent_huge_bytes(data_) : 0;
+        case PageSize::SMALL_4KB:
+            break;
+    }
+    return 0;
+}
+
+PageSize HugePageArena::page_size() const {
+    PageSize smallest = regions_.empty() ? PageSize::SMALL_4KB : PageSize::HUGETLB_1GB;
+    for (const HugePageRegion& region : regions_) smallest = std::max(smallest, region.page_size());
+    return smallest;
+}
+
+void* HugePageArena::do_allocate(size_t bytes, size_t alignment) {
+    while (current_ < regions_.size()) {
+        const HugePageRegion& region = regions_[current_];
+        size_t start = (offset_ + alignment - 1) & ~(alignment - 1);
+        if (start + bytes <= region.size()) {
+            offset_ = start + bytes;
+            return region.data() + start;
+        }
+        // Full (for this request): move on to the next kept region, if any
+        ++current_;
+        offset_ = 0;
+    }
+    regions_.emplace_back(std::max(region_bytes_, bytes + alignment), largest_);
+    current_ = regions_.size() - 1;
+    offset_ = 0;
+    return do_allocate(bytes, alignment);
+}
+
+size_t transparent_huge_bytes(const void* address) {
+    std::ifstream smaps("/proc/self/smaps");
+    uintptr_t target = reinterpret_cast<uintptr_t>(address);
+    std::string line;
+    bool inside = false;
+    while (std::getline(smaps, line)) {
+        unsigned long long begin, end;
+        if (sscanf(line.c_str(), "%llx-%llx ", &begin, &end) == 2) {
+            inside = target >= begin && target < end;
+        } else if (inside && line.compare(0, 14, "AnonHugePages:") == 0) {
+            return std::strtoull(line.c_str() + 14, nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+}
+
+}  // namespace memory
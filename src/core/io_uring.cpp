@@ -0,0 +1,179 @@
+/**
+ * @file io_uring.cpp
+ * @brief Ring setup, SQE preparation and CQE reaping for io::IoUring
+ */
+
+#include "io_uring.h"
+
+#include <cerrno>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define IO_URING_SUPPORTED 1
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace io {
+
+#if defined(IO_URING_SUPPORTED)
+
+namespace {
+
+template <typename T>
+T* at_offset(void* base, unsigned offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+}  // namespace
+
+IoUring::~IoUring() { release(); }
+
+void IoUring::release() {
+    if (sqes_ != nullptr) munmap(sqes_, sqes_bytes_);
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_bytes_);
+    if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_bytes_);
+    if (ring_fd_ >= 0) close(ring_fd_);
+    ring_fd_ = -1;
+    sq_entries_ = 0;
+    to_submit_ = 0;
+    sq_ring_ = cq_ring_ = sqes_ = cqes_ = nullptr;
+    sq_ring_bytes_ = cq_ring_bytes_ = sqes_bytes_ = 0;
+    sq_head_ = sq_tail_ = sq_mask_ = sq_array_ = nullptr;
+    cq_head_ = cq_tail_ = cq_mask_ = nullptr;
+}
+
+bool IoUring::init(unsigned entries) {
+    if (ring_fd_ >= 0) {
+        errno = EBUSY;
+        return false;
+    }
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) return false;
+    ring_fd_ = fd;
+    // Any later failure undoes everything so far, keeping errno
+    auto fail = [this] {
+        int error = errno;
+        release();
+        errno = error;
+        return false;
+    };
+
+    sq_ring_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && cq_ring_bytes_ > sq_ring_bytes_) sq_ring_bytes_ = cq_ring_bytes_;
+
+    sq_ring_ = mmap(nullptr, sq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                    IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        return fail();
+    }
+    if (single_mmap) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = mmap(nullptr, cq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                        IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            return fail();
+        }
+    }
+    sqes_bytes_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) {
+        sqes_ = nullptr;
+        return fail();
+    }
+
+    sq_head_ = at_offset<unsigned>(sq_ring_, params.sq_off.head);
+    sq_tail_ = at_offset<unsigned>(sq_ring_, params.sq_off.tail);
+    sq_mask_ = at_offset<unsigned>(sq_ring_, params.sq_off.ring_mask);
+    sq_array_ = at_offset<unsigned>(sq_ring_, params.sq_off.array);
+    cq_head_ = at_offset<unsigned>(cq_ring_, params.cq_off.head);
+    cq_tail_ = at_offset<unsigned>(cq_ring_, params.cq_off.tail);
+    cq_mask_ = at_offset<unsigned>(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = at_offset<void>(cq_ring_, params.cq_off.cqes);
+    sq_entries_ = params.sq_entries;
+    return true;
+}
+
+void* IoUring::prep(int opcode, int fd, uint64_t address, uint32_t length, uint64_t offset, uint64_t user_data) {
+    unsigned tail = *sq_tail_;
+    // The kernel advances head as it consumes entries
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (tail - head >= sq_entries_) return nullptr;
+
+    unsigned index = tail & *sq_mask_;
+    auto* sqe = static_cast<struct io_uring_sqe*>(sqes_) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = static_cast<uint8_t>(opcode);
+    sqe->fd = fd;
+    sqe->addr = address;
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    // Publish the entry before the new tail
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++to_submit_;
+    return sqe;
+}
+
+bool IoUring::prep_read(int fd, void* buffer, uint32_t length, uint64_t offset, uint64_t user_data) {
+    return prep(IORING_OP_READ, fd, reinterpret_cast<uint64_t>(buffer), length, offset, user_data) != nullptr;
+}
+
+bool IoUring::prep_write(int fd, const void* buffer, uint32_t length, uint64_t offset, uint64_t user_data) {
+    return prep(IORING_OP_WRITE, fd, reinterpret_cast<uint64_t>(buffer), length, offset, user_data) != nullptr;
+}
+
+int IoUring::submit(unsigned wait_for) {
+    unsigned flags = wait_for > 0 ? IORING_ENTER_GETEVENTS : 0;
+    while (true) {
+        int submitted =
+            static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit_, wait_for, flags, nullptr, 0));
+        if (submitted >= 0) {
+            to_submit_ -= static_cast<unsigned>(submitted);
+            return submitted;
+        }
+        if (errno != EINTR) return -errno;
+    }
+}
+
+bool IoUring::pop(Completion& completion) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) return false;
+    const auto* cqe = static_cast<const struct io_uring_cqe*>(cqes_) + (head & *cq_mask_);
+    completion.user_data = cqe->user_data;
+    completion.result = cqe->res;
+    // Hand the slot back to the kernel
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#else  // !IO_URING_SUPPORTED
+
+IoUring::~IoUring() = default;
+
+bool IoUring::init(unsigned) {
+    errno = ENOSYS;
+    return false;
+}
+
+bool IoUring::prep_read(int, void*, uint32_t, uint64_t, uint64_t) { return false; }
+
+bool IoUring::prep_write(int, const void*, uint32_t, uint64_t, uint64_t) { return false; }
+
+int IoUring::submit(unsigned) { return -ENOSYS; }
+
+bool IoUring::pop(Completion&) { return false; }
+
+#endif
+
+}  // namespace io
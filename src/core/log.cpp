@@ -0,0 +1,85 @@
+/**
+ * @file log.cpp
+ * @brief Formatting and the single write() behind logging::Line
+ */
+
+#include "log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace logging {
+
+const char* level_name(Level level) {
+    switch (level) {
+        case Level::ERROR:
+            return "error";
+        case Level::WARNING:
+            return "warning";
+        case Level::INFO:
+            return "info";
+        case Level::DEBUG:
+            return "debug";
+    }
+    return "?";
+}
+
+bool parse_level(std::string_view name, Level& level) {
+    for (Level candidate : {Level::ERROR, Level::WARNING, Level::INFO, Level::DEBUG}) {
+        if (name == level_name(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+Line::Line(Level level) : level_(level) {
+    *this << "[" << level_name(level) << "] ";
+}
+
+// Errors go to stderr, everything else to stdout, like the std::cerr /
+// std::cout lines these replace
+Line::~Line() {
+    if (length_ == MAX_LINE) length_ = MAX_LINE - 1;  // Room for the newline
+    buffer_[length_++] = '\n';
+    int fd = level_ == Level::ERROR ? STDERR_FILENO : STDOUT_FILENO;
+    size_t written = 0;
+    while (written < length_) {
+        ssize_t n = write(fd, buffer_ + written, length_ - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+    }
+}
+
+Line& Line::operator<<(std::string_view text) {
+    size_t count = std::min(text.size(), MAX_LINE - length_);
+    std::memcpy(buffer_ + length_, text.data(), count);
+    length_ += count;
+    return *this;
+}
+
+Line& Line::operator<<(double value) {
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%g", value);
+    return *this << std::string_view(digits, static_cast<size_t>(std::max(length, 0)));
+}
+
+Line& Line::append_signed(long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    return *this << std::string_view(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+Line& Line::append_unsigned(unsigned long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    return *this << std::string_view(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+}  // namespace logging
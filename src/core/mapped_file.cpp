@@ -0,0 +1,75 @@
+/**
+ * @file mapped_file.cpp
+ * @brief open/fstat/mmap plumbing for memory::MappedFile
+ */
+
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace memory {
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      open_(std::exchange(other.open_, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        open_ = std::exchange(other.open_, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int saved = errno;
+        ::close(fd);
+        errno = saved;
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            int saved = errno;
+            ::close(fd);
+            errno = saved;
+            return false;
+        }
+        data_ = static_cast<const char*>(mapping);
+    }
+    // The mapping holds its own reference to the file
+    ::close(fd);
+    size_ = size;
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+bool MappedFile::advise(int advice) const {
+    if (data_ == nullptr) return true;
+    return madvise(const_cast<char*>(data_), size_, advice) == 0;
+}
+
+}  // namespace memory
@@ -0,0 +1,452 @@
+/**
+ * @file memory_probe.cpp
+ * @brief Pointer-chase, STREAM and TLB probes behind memory::probe_memory()
+ */
+
+#include "memory_probe.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+#include "benchmark.h"
+#include "huge_pages.h"
+#include "spin_locks.h"
+
+namespace memory {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t LINE = 64;
+const size_t PAGE = 4096;
+const size_t HUGE_PAGE = 2 << 20;
+const size_t MIN_STREAM_BYTES = 64 << 20;
+const int STREAM_RUNS = 5;
+const double FLAT = 1.15;         // Points within this factor of each other are level
+const size_t SETTLE_POINTS = 2;   // Level points in a row that end a transition
+const double REPORTED_MATCH = 2;  // A detected size this close to a sysconf() size is that level
+
+double elapsed_ns(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+size_t physical_memory() {
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page = sysconf(_SC_PAGESIZE);
+    return pages > 0 && page > 0 ? static_cast<size_t>(pages) * static_cast<size_t>(page) : size_t{1} << 30;
+}
+
+size_t reported_cache(int level) {
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    const int names[] = {_SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE, _SC_LEVEL3_CACHE_SIZE, _SC_LEVEL4_CACHE_SIZE};
+    if (level < 1 || level > 4) return 0;
+    long bytes = sysconf(names[level - 1]);
+    return bytes > 0 ? static_cast<size_t>(bytes) : 0;
+#else
+    (void)level;
+    return 0;
+#endif
+}
+
+// The sysconf() level whose size is nearest to `bytes`, within a factor
+// of REPORTED_MATCH; 0 if none is
+int nearest_reported_level(size_t bytes) {
+    int nearest = 0;
+    double best = REPORTED_MATCH;
+    for (int level = 1; level <= 4; ++level) {
+        size_t reported = reported_cache(level);
+        if (reported == 0) continue;
+        double factor = bytes > reported ? static_cast<double>(bytes) / reported : static_cast<double>(reported) / bytes;
+        if (factor <= best) {
+            best = factor;
+            nearest = level;
+        }
+    }
+    return nearest;
+}
+
+size_t largest_reported_cache() {
+    size_t largest = 0;
+    for (int level = 1; level <= 4; ++level) largest = std::max(largest, reported_cache(level));
+    return largest;
+}
+
+// Huge pages where the system has them (hugetlb, else THP), or plain
+// 4KB pages that really are 4KB pages. Huge regions are at least 2MB, so
+// even small working sets sit on one huge page.
+HugePageRegion region(size_t bytes, bool huge) {
+    return huge ? HugePageRegion(std::max(bytes, HUGE_PAGE), PageSize::HUGETLB_2MB)
+                : HugePageRegion(bytes, PageSize::SMALL_4KB);
+}
+
+// Link `count` slots, `stride` bytes apart (plus `skew(i)` bytes into
+// slot i), into one random cycle (Sattolo's shuffle); returns its start
+template <typename Skew>
+void* link_random_cycle(char* base, size_t count, size_t stride, Skew skew) {
+    std::vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(i);
+    std::mt19937_64 random(count);
+    for (size_t i = count - 1; i > 0; --i) {
+        std::uniform_int_distribution<size_t> pick(0, i - 1);
+        std::swap(order[i], order[pick(random)]);
+    }
+    auto slot = [&](size_t i) { return base + order[i] * stride + skew(order[i]); };
+    for (size_t i = 0; i < count; ++i) {
+        *reinterpret_cast<void**>(slot(i)) = slot((i + 1) % count);
+    }
+    return slot(0);
+}
+
+// Each load's address is the previous load's value, so no two overlap
+__attribute__((noinline)) void* chase(void* p, size_t loads) {
+    for (size_t i = 0; i < loads; i += 8) {
+        p = *static_cast<void**>(p);
+        p = *static_cast<void**>(p);
+        p = *static_cast<void**>(p);
+        p = *static_cast<void**>(p);
+        p = *static_cast<void**>(p);
+        p = *static_cast<void**>(p);
+        p = *static_cast<void**>(p);
+        p = *static_cast<void**>(p);
+    }
+    return p;
+}
+
+// Best ns per load of `runs` timed chases, after one lap to warm up
+double time_chase(void* start, size_t count, size_t loads, int runs) {
+    void* p = chase(start, std::min(count, loads));
+    double best = 0;
+    for (int run = 0; run < runs; ++run) {
+        auto begin = Clock::now();
+        p = chase(p, loads);
+        double ns = elapsed_ns(begin) / static_cast<double>(loads);
+        if (run == 0 || ns < best) best = ns;
+    }
+    bench::do_not_optimize(p);
+    return best;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return bench::percentile(values, 50);
+}
+
+// Start `threads` threads on [begin, end) slices of n, release them
+// together and time until the last one finishes
+template <typename Kernel>
+double run_parallel(unsigned threads, size_t n, Kernel kernel) {
+    std::atomic<unsigned> ready{0}, done{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            size_t begin = n * t / threads, end = n * (t + 1) / threads;
+            ready.fetch_add(1);
+            concurrency::SpinWait spin;
+            while (!go.load(std::memory_order_acquire)) spin.wait();
+            kernel(begin, end);
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    concurrency::SpinWait spin;
+    while (done.load(std::memory_order_acquire) < threads) spin.wait();
+    double ns = elapsed_ns(start);
+    for (std::thread& worker : workers) worker.join();
+    return ns;
+}
+
+struct Step {
+    size_t plateau;  // First point of the plateau before the step
+    size_t knee;     // First point above it
+};
+
+bool level_with(double a, double b) { return a <= b * FLAT && b <= a * FLAT; }
+
+// First index at or after `from` that the next SETTLE_POINTS points all
+// stay level with, ns.size() if there is none. A single noisy point - a
+// spike, or a dip back down - does not end a transition, so one real step
+// is not split into two.
+size_t settle(const std::vector<double>& ns, size_t from) {
+    for (size_t i = from; i + SETTLE_POINTS < ns.size(); ++i) {
+        bool settled = true;
+        for (size_t k = 1; k <= SETTLE_POINTS && settled; ++k) settled = level_with(ns[i], ns[i + k]);
+        if (settled) return i;
+    }
+    return ns.size();
+}
+
+// Hysteresis: entering a step takes `ratio` over the plateau median (held
+// at the next point too, so the last point cannot be one); leaving it takes
+// SETTLE_POINTS points within FLAT. Everything in between is transition
+// and belongs to neither plateau.
+std::vector<Step> find_steps(const std::vector<double>& ns, double ratio) {
+    std::vector<Step> steps;
+    size_t plateau = 0;
+    for (size_t i = 1; i + 1 < ns.size(); ++i) {
+        double level = median(std::vector<double>(ns.begin() + plateau, ns.begin() + i));
+        if (ns[i] < level * ratio || ns[i + 1] < level * ratio) continue;
+        steps.push_back({plateau, i});
+        plateau = settle(ns, i);
+        i = plateau;
+    }
+    return steps;
+}
+
+}  // namespace
+
+double chase_latency_ns(size_t bytes, size_t loads) {
+    size_t count = std::max<size_t>(bytes / LINE, 2);
+    // Huge pages keep TLB misses out of the curve (with 4KB pages they
+    // would already show up at a few hundred KB)
+    HugePageRegion memory = region(count * LINE, true);
+    void* start = link_random_cycle(memory.data(), count, LINE, [](size_t) { return 0; });
+    return time_chase(start, count, loads, bytes <= (64 << 20) ? 3 : 1);
+}
+
+double chase_latency_ns(void* memory, size_t bytes, size_t loads) {
+    size_t count = std::max<size_t>(bytes / LINE, 2);
+    void* start = link_random_cycle(static_cast<char*>(memory), count, LINE, [](size_t) { return 0; });
+    return time_chase(start, count, loads, 3);
+}
+
+std::vector<LatencyPoint> probe_latency(const ProbeOptions& options) {
+    size_t largest = std::min(options.max_working_set, physical_memory() / 4);
+    std::vector<LatencyPoint> points;
+    // Powers of two and the midpoints between them
+    for (size_t bytes = options.min_working_set; bytes <= largest; bytes *= 2) {
+        points.push_back({bytes, chase_latency_ns(bytes, options.loads_per_point)});
+        size_t between = bytes + bytes / 2;
+        if (between <= largest) points.push_back({between, chase_latency_ns(between, options.loads_per_point)});
+    }
+    return points;
+}
+
+std::vector<size_t> find_knees(const std::vector<double>& ns, double ratio) {
+    std::vector<size_t> knees;
+    for (const Step& step : find_steps(ns, ratio)) knees.push_back(step.knee);
+    return knees;
+}
+
+std::vector<CacheLevel> find_cache_levels(const std::vector<LatencyPoint>& latency) {
+    std::vector<double> ns;
+    for (const LatencyPoint& point : latency) ns.push_back(point.ns_per_load);
+    std::vector<CacheLevel> levels;
+    for (const Step& step : find_steps(ns, 1.4)) {
+        size_t bytes = latency[step.knee - 1].bytes;
+        int reported = nearest_reported_level(bytes);
+        int previous = levels.empty() ? 0 : levels.back().level;
+        if (reported != 0 && reported == previous) {
+            // Two steps inside one reported cache: the first was noise or an
+            // inclusive-cache edge effect. Keep its latency, take the new size.
+            levels.back().bytes = bytes;
+            continue;
+        }
+        // Numbered by the sysconf() size it matches, else after the last one
+        int level = reported > previous ? reported : previous + 1;
+        std::vector<double> flat(ns.begin() + step.plateau, ns.begin() + step.knee);
+        levels.push_back({level, bytes, median(flat), reported_cache(level)});
+    }
+    return levels;
+}
+
+std::vector<BandwidthPoint> probe_bandwidth(size_t array_bytes, unsigned max_threads) {
+    const size_t n = array_bytes / sizeof(double);
+    HugePageRegion regions[3] = {region(n * sizeof(double), true), region(n * sizeof(double), true),
+                                 region(n * sizeof(double), true)};
+    double* a = reinterpret_cast<double*>(regions[0].data());
+    double* b = reinterpret_cast<double*>(regions[1].data());
+    double* c = reinterpret_cast<double*>(regions[2].data());
+    const double q = 3.0;
+
+    // First touch by the widest thread split, so each slice starts out on
+    // the NUMA node of a thread that uses it
+    run_parallel(max_threads, n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            a[i] = 1.0;
+            b[i] = 2.0;
+            c[i] = 0.0;
+        }
+    });
+
+    struct Kernel {
+        const char* name;
+        size_t bytes_per_element;  // Read + written
+        void (*run)(double* a, double* b, double* c, double q, size_t begin, size_t end);
+    };
+    const Kernel kernels[] = {
+        {"copy", 2 * sizeof(double),
+         [](double* a, double*, double* c, double, size_t begin, size_t end) {
+             for (size_t i = begin; i < end; ++i) c[i] = a[i];
+         }},
+        {"scale", 2 * sizeof(double),
+         [](double*, double* b, double* c, double q, size_t begin, size_t end) {
+             for (size_t i = begin; i < end; ++i) b[i] = q * c[i];
+         }},
+        {"add", 3 * sizeof(double),
+         [](double* a, double* b, double* c, double, size_t begin, size_t end) {
+             for (size_t i = begin; i < end; ++i) c[i] = a[i] + b[i];
+         }},
+        {"triad", 3 * sizeof(double),
+         [](double* a, double* b, double* c, double q, size_t begin, size_t end) {
+             for (size_t i = begin; i < end; ++i) a[i] = b[i] + q * c[i];
+         }},
+    };
+
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    std::vector<BandwidthPoint> points;
+    for (unsigned threads : thread_counts) {
+        for (const Kernel& kernel : kernels) {
+            double best = 0;
+            for (int run = 0; run < STREAM_RUNS; ++run) {
+                double ns = run_parallel(threads, n, [&](size_t begin, size_t end) {
+                    kernel.run(a, b, c, q, begin, end);
+                });
+                if (run == 0 || ns < best) best = ns;
+            }
+            bench::do_not_optimize(a[n / 2]);
+            points.push_back({kernel.name, threads, kernel.bytes_per_element * n * 1e9 / best});
+        }
+    }
+    return points;
+}
+
+void probe_tlb(MemoryProfile& profile, size_t max_pages) {
+    const size_t loads = 1 << 20;
+    // One line per page, at a pseudo-random offset in each. The same offset
+    // everywhere would put all lines in a few cache sets; a pattern like
+    // page % 64 still does on huge pages, where the physical address bits
+    // above 4KB follow the virtual ones.
+    auto skew = [](size_t page) {
+        return static_cast<size_t>((page * 0x9E3779B97F4A7C15ull) >> 58) * LINE;
+    };
+    profile.tlb.clear();
+    for (size_t pages = 8; pages <= max_pages; pages *= 2) {
+        TlbPoint point{pages, 0, 0};
+        {
+            HugePageRegion small = region(pages * PAGE, false);
+            point.ns_small_pages = time_chase(link_random_cycle(small.data(), pages, PAGE, skew), pages, loads, 3);
+        }
+        HugePageRegion huge = region(pages * PAGE, true);
+        void* start = link_random_cycle(huge.data(), pages, PAGE, skew);
+        size_t granted = huge.page_size() == PageSize::SMALL_4KB ? 0 : huge.huge_bytes();
+        if (granted > 0) point.ns_huge_pages = time_chase(start, pages, loads, 3);
+        profile.huge_page_bytes_granted = std::max(profile.huge_page_bytes_granted, granted);
+        profile.tlb.push_back(point);
+    }
+
+    // Against huge pages when there are some, else against the curve's own start
+    profile.tlb_reach_pages = 0;
+    if (profile.huge_page_bytes_granted > 0) {
+        for (size_t i = 0; i < profile.tlb.size(); ++i) {
+            const TlbPoint& point = profile.tlb[i];
+            if (point.ns_huge_pages > 0 && point.ns_small_pages > point.ns_huge_pages * 1.3) {
+                profile.tlb_reach_pages = i > 0 ? profile.tlb[i - 1].pages : point.pages;
+                break;
+            }
+        }
+    } else {
+        std::vector<double> ns;
+        for (const TlbPoint& point : profile.tlb) ns.push_back(point.ns_small_pages);
+        std::vector<size_t> knees = find_knees(ns, 1.3);
+        if (!knees.empty()) profile.tlb_reach_pages = profile.tlb[knees.front() - 1].pages;
+    }
+}
+
+MemoryProfile probe_memory(const ProbeOptions& options) {
+    MemoryProfile profile;
+#if defined(_SC_LEVEL1_DCACHE_LINESIZE)
+    long line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (line > 0) profile.line_bytes = static_cast<size_t>(line);
+#endif
+    profile.page_bytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    profile.latency = probe_latency(options);
+    profile.caches = find_cache_levels(profile.latency);
+    if (!profile.latency.empty()) profile.memory_ns_per_load = profile.latency.back().ns_per_load;
+
+    size_t last_level = largest_reported_cache();
+    for (const CacheLevel& cache : profile.caches) last_level = std::max(last_level, cache.bytes);
+    size_t array_bytes = options.stream_array_bytes;
+    if (array_bytes == 0) array_bytes = std::max(4 * last_level, MIN_STREAM_BYTES);
+    array_bytes = std::min(array_bytes, physical_memory() / 16);
+    unsigned threads = options.max_threads;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    profile.bandwidth = probe_bandwidth(array_bytes, threads);
+
+    probe_tlb(profile, options.max_tlb_pages);
+    return profile;
+}
+
+size_t MemoryProfile::cache_bytes(int level) const {
+    for (const CacheLevel& cache : caches) {
+        if (cache.level == level) return cache.bytes;
+    }
+    return 0;
+}
+
+double MemoryProfile::peak_bytes_per_second() const {
+    double peak = 0;
+    for (const BandwidthPoint& point : bandwidth) peak = std::max(peak, point.bytes_per_second);
+    return peak;
+}
+
+std::string MemoryProfile::to_json() const {
+    std::ostringstream out;
+    char text[256];
+    out << "{\n  \"line_bytes\": " << line_bytes << ",\n  \"page_bytes\": " << page_bytes << ",\n";
+
+    out << "  \"caches\": [";
+    for (size_t i = 0; i < caches.size(); ++i) {
+        const CacheLevel& cache = caches[i];
+        snprintf(text, sizeof(text), "%s\n    {\"level\": %d, \"bytes\": %zu, \"ns_per_load\": %.2f, \"reported_bytes\": %zu}",
+                 i > 0 ? "," : "", cache.level, cache.bytes, cache.ns_per_load, cache.reported_bytes);
+        out << text;
+    }
+    snprintf(text, sizeof(text), "\n  ],\n  \"memory_ns_per_load\": %.2f,\n", memory_ns_per_load);
+    out << text;
+
+    out << "  \"latency\": [";
+    for (size_t i = 0; i < latency.size(); ++i) {
+        snprintf(text, sizeof(text), "%s\n    {\"bytes\": %zu, \"ns_per_load\": %.2f}", i > 0 ? "," : "",
+                 latency[i].bytes, latency[i].ns_per_load);
+        out << text;
+    }
+    out << "\n  ],\n";
+
+    snprintf(text, sizeof(text), "  \"peak_bytes_per_second\": %.0f,\n", peak_bytes_per_second());
+    out << text << "  \"bandwidth\": [";
+    for (size_t i = 0; i < bandwidth.size(); ++i) {
+        snprintf(text, sizeof(text), "%s\n    {\"kernel\": \"%s\", \"threads\": %u, \"bytes_per_second\": %.0f}",
+                 i > 0 ? "," : "", bandwidth[i].kernel.c_str(), bandwidth[i].threads, bandwidth[i].bytes_per_second);
+        out << text;
+    }
+    out << "\n  ],\n";
+
+    out << "  \"huge_page_bytes_granted\": " << huge_page_bytes_granted << ",\n";
+    out << "  \"tlb_reach_pages\": " << tlb_reach_pages << ",\n";
+    out << "  \"tlb\": [";
+    for (size_t i = 0; i < tlb.size(); ++i) {
+        snprintf(text, sizeof(text), "%s\n    {\"pages\": %zu, \"ns_small_pages\": %.2f, \"ns_huge_pages\": %.2f}",
+                 i > 0 ? "," : "", tlb[i].pages, tlb[i].ns_small_pages, tlb[i].ns_huge_pages);
+        out << text;
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
+
+}  // namespace memory
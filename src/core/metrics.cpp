@@ -0,0 +1,369 @@
+/**
+ * @file metrics.cpp
+ * @brief Metric registry, per-thread blocks, trace collection and exporters
+ */
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "log.h"
+
+namespace metrics {
+
+namespace {
+
+struct Description {
+    const char* name;
+    const char* help;
+};
+
+// Names are written once at registration, before `count` is published
+template <size_t Capacity>
+struct NameTable {
+    std::mutex mutex;
+    Description entries[Capacity];
+    std::atomic<uint32_t> count{0};
+
+    uint32_t add(const char* name, const char* help, const char* kind) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint32_t id = count.load(std::memory_order_relaxed);
+        if (id >= Capacity) throw std::length_error(std::string("too many metrics ") + kind + ": " + name);
+        entries[id] = {name, help};
+        count.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    uint32_t size() const { return count.load(std::memory_order_acquire); }
+};
+
+// Function-local statics: metrics are registered from other files' static
+// initializers, whose order relative to this file's is unspecified
+NameTable<MAX_COUNTERS>& counter_names() {
+    static NameTable<MAX_COUNTERS> table;
+    return table;
+}
+
+NameTable<MAX_HISTOGRAMS>& histogram_names() {
+    static NameTable<MAX_HISTOGRAMS> table;
+    return table;
+}
+
+NameTable<MAX_EVENTS>& event_names() {
+    static NameTable<MAX_EVENTS> table;
+    return table;
+}
+
+std::atomic<detail::ThreadMetrics*> blocks{nullptr};
+std::atomic<uint32_t> next_thread{0};
+
+// Hands the thread's block back when the thread exits
+struct BlockRelease {
+    detail::ThreadMetrics* block = nullptr;
+    ~BlockRelease() {
+        if (block != nullptr) {
+            detail::current = nullptr;
+            block->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+template <typename Visit>
+void for_each_block(Visit&& visit) {
+    for (detail::ThreadMetrics* block = blocks.load(std::memory_order_acquire); block != nullptr;
+         block = block->next) {
+        visit(*block);
+    }
+}
+
+uint64_t counter_total(uint32_t id) {
+    uint64_t total = 0;
+    for_each_block([&](detail::ThreadMetrics& block) { total += block.counters[id].load(std::memory_order_relaxed); });
+    return total;
+}
+
+LatencyHistogram merged_histogram(uint32_t id) {
+    LatencyHistogram merged;
+    for_each_block([&](detail::ThreadMetrics& block) {
+        const detail::AtomicHistogram* histogram = block.histograms[id].load(std::memory_order_acquire);
+        if (histogram == nullptr) return;
+        for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+            merged.record(LatencyHistogram::bucket_upper_bound(i), histogram->counts[i].load(std::memory_order_relaxed));
+        }
+    });
+    return merged;
+}
+
+uint64_t histogram_sum(uint32_t id) {
+    uint64_t total = 0;
+    for_each_block([&](detail::ThreadMetrics& block) {
+        const detail::AtomicHistogram* histogram = block.histograms[id].load(std::memory_order_acquire);
+        if (histogram != nullptr) total += histogram->sum.load(std::memory_order_relaxed);
+    });
+    return total;
+}
+
+void append_line(std::string& out, const char* line_end, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+void append_line(std::string& out, const char* line_end, const char* format, ...) {
+    char line[512];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = std::vsnprintf(line, sizeof(line), format, arguments);
+    va_end(arguments);
+    out.append(line, static_cast<size_t>(std::clamp(length, 0, static_cast<int>(sizeof(line)) - 1)));
+    out += line_end;
+}
+
+}  // namespace
+
+namespace detail {
+
+ThreadMetrics* register_thread() {
+    static thread_local BlockRelease release;
+
+    for (ThreadMetrics* block = blocks.load(std::memory_order_acquire); block != nullptr; block = block->next) {
+        bool expected = false;
+        if (!block->in_use.load(std::memory_order_relaxed) &&
+            block->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            release.block = current = block;
+            return block;
+        }
+    }
+
+    ThreadMetrics* block = new ThreadMetrics;
+    block->thread = next_thread.fetch_add(1, std::memory_order_relaxed);
+    block->in_use.store(true, std::memory_order_relaxed);
+    ThreadMetrics* head = blocks.load(std::memory_order_relaxed);
+    do {
+        block->next = head;
+    } while (!blocks.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+    release.block = current = block;
+    return block;
+}
+
+// Published with release so a reader that sees the pointer sees zeroed counts
+AtomicHistogram* allocate_histogram(ThreadMetrics& block, uint32_t id) {
+    AtomicHistogram* histogram = new AtomicHistogram;
+    block.histograms[id].store(histogram, std::memory_order_release);
+    return histogram;
+}
+
+TraceRing* allocate_trace(ThreadMetrics& block) {
+    TraceRing* ring = new TraceRing;
+    block.trace.store(ring, std::memory_order_release);
+    return ring;
+}
+
+}  // namespace detail
+
+Counter::Counter(const char* name, const char* help) : id_(counter_names().add(name, help, "counters")) {}
+
+uint64_t Counter::value() const { return counter_total(id_); }
+
+Histogram::Histogram(const char* name, const char* help) : id_(histogram_names().add(name, help, "histograms")) {}
+
+LatencyHistogram Histogram::snapshot() const { return merged_histogram(id_); }
+
+uint64_t Histogram::sum() const { return histogram_sum(id_); }
+
+TraceEvent::TraceEvent(const char* name) : id_(event_names().add(name, "", "trace events")) {}
+
+const char* event_name(uint16_t event) {
+    NameTable<MAX_EVENTS>& names = event_names();
+    return event < names.size() ? names.entries[event].name : "?";
+}
+
+std::vector<TraceEntry> collect_trace() {
+    std::vector<TraceEntry> entries;
+    for_each_block([&](detail::ThreadMetrics& block) {
+        const detail::TraceRing* ring = block.trace.load(std::memory_order_acquire);
+        if (ring == nullptr) return;
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = head > TRACE_CAPACITY ? head - TRACE_CAPACITY : 0;
+        for (uint64_t position = first; position < head; ++position) {
+            const detail::TraceSlot& slot = ring->slots[position & (TRACE_CAPACITY - 1)];
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before != 2 * position + 2) continue;  // Already overwritten (or being)
+            TraceEntry entry;
+            entry.timestamp_ns = slot.timestamp.load(std::memory_order_relaxed);
+            entry.event = static_cast<uint16_t>(slot.event.load(std::memory_order_relaxed));
+            entry.argument = slot.argument.load(std::memory_order_relaxed);
+            entry.thread = block.thread;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) entries.push_back(entry);
+        }
+    });
+    std::sort(entries.begin(), entries.end(),
+              [](const TraceEntry& a, const TraceEntry& b) { return a.timestamp_ns < b.timestamp_ns; });
+    return entries;
+}
+
+std::string format_trace(size_t last, const char* line_end) {
+    std::vector<TraceEntry> entries = collect_trace();
+    size_t first = entries.size() > last ? entries.size() - last : 0;
+    std::string out;
+    if (entries.empty()) {
+        out = "(no trace events)";
+        out += line_end;
+        return out;
+    }
+    uint64_t newest = entries.back().timestamp_ns;
+    for (size_t i = first; i < entries.size(); ++i) {
+        const TraceEntry& entry = entries[i];
+        append_line(out, line_end, "%12.3fms  thread %-3u %-12s %llu", -static_cast<double>(newest - entry.timestamp_ns) / 1e6,
+                    entry.thread, event_name(entry.event), static_cast<unsigned long long>(entry.argument));
+    }
+    return out;
+}
+
+bool dump_trace(const char* path) {
+    std::vector<TraceEntry> entries = collect_trace();
+    FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) return false;
+
+    bool ok = std::fwrite("BTRACE01", 1, 8, file) == 8;
+    NameTable<MAX_EVENTS>& names = event_names();
+    uint32_t event_count = names.size();
+    ok = ok && std::fwrite(&event_count, sizeof(event_count), 1, file) == 1;
+    for (uint32_t id = 0; id < event_count && ok; ++id) {
+        uint16_t header[2] = {static_cast<uint16_t>(id), static_cast<uint16_t>(std::strlen(names.entries[id].name))};
+        ok = std::fwrite(header, sizeof(header), 1, file) == 1 &&
+             std::fwrite(names.entries[id].name, 1, header[1], file) == header[1];
+    }
+    uint64_t entry_count = entries.size();
+    ok = ok && std::fwrite(&entry_count, sizeof(entry_count), 1, file) == 1;
+    for (const TraceEntry& entry : entries) {
+        if (!ok) break;
+        uint16_t event[2] = {entry.event, 0};
+        ok = std::fwrite(&entry.timestamp_ns, sizeof(uint64_t), 1, file) == 1 &&
+             std::fwrite(&entry.thread, sizeof(uint32_t), 1, file) == 1 &&
+             std::fwrite(event, sizeof(event), 1, file) == 1 &&
+             std::fwrite(&entry.argument, sizeof(uint64_t), 1, file) == 1;
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+std::string render_text(const char* line_end) {
+    std::string out;
+    NameTable<MAX_COUNTERS>& counters = counter_names();
+    for (uint32_t id = 0; id < counters.size(); ++id) {
+        append_line(out, line_end, "%-36s %llu", counters.entries[id].name,
+                    static_cast<unsigned long long>(counter_total(id)));
+    }
+    NameTable<MAX_HISTOGRAMS>& histograms = histogram_names();
+    for (uint32_t id = 0; id < histograms.size(); ++id) {
+        append_line(out, line_end, "%-36s %s", histograms.entries[id].name, merged_histogram(id).summary().c_str());
+    }
+    return out;
+}
+
+std::string render_prometheus() {
+    std::string out;
+    NameTable<MAX_COUNTERS>& counters = counter_names();
+    for (uint32_t id = 0; id < counters.size(); ++id) {
+        const Description& description = counters.entries[id];
+        append_line(out, "\n", "# HELP %s %s", description.name, description.help);
+        append_line(out, "\n", "# TYPE %s counter", description.name);
+        append_line(out, "\n", "%s %llu", description.name, static_cast<unsigned long long>(counter_total(id)));
+    }
+    NameTable<MAX_HISTOGRAMS>& histograms = histogram_names();
+    for (uint32_t id = 0; id < histograms.size(); ++id) {
+        const Description& description = histograms.entries[id];
+        LatencyHistogram snapshot = merged_histogram(id);
+        append_line(out, "\n", "# HELP %s %s", description.name, description.help);
+        append_line(out, "\n", "# TYPE %s summary", description.name);
+        for (double quantile : {0.5, 0.9, 0.99, 0.999}) {
+            append_line(out, "\n", "%s{quantile=\"%g\"} %.9g", description.name, quantile,
+                        static_cast<double>(snapshot.percentile(quantile * 100)) / 1e9);
+        }
+        append_line(out, "\n", "%s_sum %.9g", description.name, static_cast<double>(histogram_sum(id)) / 1e9);
+        append_line(out, "\n", "%s_count %llu", description.name, static_cast<unsigned long long>(snapshot.count()));
+    }
+    return out;
+}
+
+bool serve_prometheus(int port, const char* address) {
+    struct sockaddr_in bind_address;
+    std::memset(&bind_address, 0, sizeof(bind_address));
+    bind_address.sin_family = AF_INET;
+    bind_address.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address, &bind_address.sin_addr) != 1) return false;
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listener, reinterpret_cast<struct sockaddr*>(&bind_address), sizeof(bind_address)) < 0 ||
+        listen(listener, 16) < 0) {
+        close(listener);
+        return false;
+    }
+
+    // Scrapes are rare and small: one blocking thread, one request at a
+    // time. The timeouts keep a client that connects and then stalls from
+    // holding up every later scrape for more than a moment.
+    std::thread([listener] {
+        const struct timeval timeout = {SCRAPE_TIMEOUT_SECONDS, 0};
+        int backoff_ms = 0;
+        uint64_t next_log_ns = 0;
+        while (true) {
+            int client = accept(listener, nullptr, nullptr);
+            if (client < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                // Out of descriptors or memory: the pending connection stays
+                // queued, so retrying at once would spin. Wait, and retry.
+                backoff_ms = std::min(std::max(2 * backoff_ms, 10), 1000);
+                if (now_ns() >= next_log_ns) {
+                    LOG_ERROR << "Metrics endpoint: accept failed: " << std::strerror(errno) << " (retrying in "
+                              << backoff_ms << " ms)";
+                    next_log_ns = now_ns() + 1000000000ull;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+                continue;
+            }
+            backoff_ms = 0;
+            setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+            char request[1024];
+            if (recv(client, request, sizeof(request), 0) <= 0) {  // Any path, any method
+                close(client);  // Timed out or hung up before asking
+                continue;
+            }
+            std::string body = render_prometheus();
+            char header[160];
+            int length = std::snprintf(header, sizeof(header),
+                                       "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                       "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                                       body.size());
+            std::string response(header, static_cast<size_t>(length));
+            response += body;
+            size_t sent = 0;
+            while (sent < response.size()) {
+                ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;  // Includes the send timeout
+                sent += static_cast<size_t>(n);
+            }
+            close(client);
+        }
+    }).detach();
+    return true;
+}
+
+}  // namespace metrics
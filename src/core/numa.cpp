@@ -0,0 +1,274 @@
+/**
+ * @file numa.cpp
+ * @brief sysfs topology discovery, mbind-based allocation and the NUMA probe
+ */
+
+#include "numa.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#include "benchmark.h"
+#include "memory_probe.h"
+
+namespace memory {
+
+namespace {
+
+const size_t PAGE = 4096;
+const int MAX_NODES = 1024;  // Bits in the nodemask passed to the kernel
+
+size_t round_to_pages(size_t bytes) { return (std::max<size_t>(bytes, 1) + PAGE - 1) / PAGE * PAGE; }
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+// "Node 0 MemTotal:  6148948 kB" -> bytes
+size_t meminfo_bytes(const std::string& meminfo, const char* field) {
+    size_t at = meminfo.find(field);
+    if (at == std::string::npos) return 0;
+    return std::strtoull(meminfo.c_str() + at + std::strlen(field), nullptr, 10) * 1024;
+}
+
+}  // namespace
+
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        if (range.find_first_not_of(" \t\n") == std::string::npos) continue;
+        int first = 0, last = 0;
+        int fields = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+        if (fields < 1) continue;
+        if (fields == 1) last = first;
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+NumaTopology NumaTopology::discover(const std::string& root) {
+    NumaTopology topology;
+    for (int id : parse_cpu_list(read_file(root + "/online"))) {
+        std::string directory = root + "/node" + std::to_string(id);
+        NumaNode node;
+        node.id = id;
+        node.cpus = parse_cpu_list(read_file(directory + "/cpulist"));
+        std::string meminfo = read_file(directory + "/meminfo");
+        node.total_bytes = meminfo_bytes(meminfo, "MemTotal:");
+        node.free_bytes = meminfo_bytes(meminfo, "MemFree:");
+        std::istringstream distances(read_file(directory + "/distance"));
+        for (int distance; distances >> distance;) node.distances.push_back(distance);
+        topology.nodes_.push_back(std::move(node));
+    }
+    topology.from_sysfs_ = !topology.nodes_.empty();
+    if (!topology.from_sysfs_) {
+        NumaNode node;
+        node.id = 0;
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+            node.cpus.push_back(static_cast<int>(cpu));
+        }
+        node.distances = {10};
+        topology.nodes_.push_back(std::move(node));
+    }
+    return topology;
+}
+
+const NumaTopology& NumaTopology::system() {
+    static const NumaTopology topology = discover();
+    return topology;
+}
+
+int NumaTopology::node_of_cpu(int cpu) const {
+    for (const NumaNode& node : nodes_) {
+        if (std::find(node.cpus.begin(), node.cpus.end(), cpu) != node.cpus.end()) return node.id;
+    }
+    return -1;
+}
+
+const NumaNode* NumaTopology::node(int id) const {
+    for (const NumaNode& node : nodes_) {
+        if (node.id == id) return &node;
+    }
+    return nullptr;
+}
+
+int NumaTopology::distance(int from, int to) const {
+    const NumaNode* source = node(from);
+    if (source == nullptr) return 0;
+    for (size_t i = 0; i < nodes_.size() && i < source->distances.size(); ++i) {
+        if (nodes_[i].id == to) return source->distances[i];
+    }
+    return 0;
+}
+
+int current_node() {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return static_cast<int>(node);
+#endif
+    return 0;
+}
+
+bool bind_thread_to_cpus(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (error != 0) {
+        errno = error;
+        return false;
+    }
+    return true;
+#else
+    (void)cpus;
+    return true;
+#endif
+}
+
+bool bind_thread_to_node(int node) {
+    const NumaNode* target = NumaTopology::system().node(node);
+    if (target == nullptr || target->cpus.empty()) {
+        errno = EINVAL;
+        return false;
+    }
+    return bind_thread_to_cpus(target->cpus);
+}
+
+void* allocate_on_node(size_t bytes, int node) {
+    if (node < 0 || node >= MAX_NODES) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    size_t length = round_to_pages(bytes);
+    void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return nullptr;
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long mask[MAX_NODES / (8 * sizeof(unsigned long))] = {};
+    mask[node / (8 * sizeof(unsigned long))] = 1ul << (node % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_mbind, memory, length, MPOL_BIND, mask, MAX_NODES, 0) != 0) {
+        int error = errno;
+        // A kernel without NUMA support has one node; plain memory is node 0
+        if (!(error == ENOSYS && node == 0)) {
+            munmap(memory, length);
+            errno = error;
+            return nullptr;
+        }
+    }
+#else
+    if (node != 0) {
+        munmap(memory, length);
+        errno = EINVAL;
+        return nullptr;
+    }
+#endif
+    return memory;
+}
+
+void free_on_node(void* memory, size_t bytes) {
+    if (memory != nullptr) munmap(memory, round_to_pages(bytes));
+}
+
+int node_of_address(const void* address) {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, address, MPOL_F_NODE | MPOL_F_ADDR) == 0) return node;
+#else
+    (void)address;
+#endif
+    return -1;
+}
+
+void* NodeLocalResource::do_allocate(size_t bytes, size_t alignment) {
+    if (alignment > PAGE) throw std::bad_alloc();  // mmap only promises page alignment
+    void* memory = allocate_on_node(bytes, node_);
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+void NodeLocalResource::do_deallocate(void* p, size_t bytes, size_t) { free_on_node(p, bytes); }
+
+bool NodeLocalResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    auto* local = dynamic_cast<const NodeLocalResource*>(&other);
+    return local != nullptr && local->node_ == node_;
+}
+
+concurrency::WorkerPlacement numa_placement(const NumaTopology& topology, size_t workers) {
+    std::vector<const NumaNode*> nodes;
+    for (const NumaNode& node : topology.nodes()) {
+        if (!node.cpus.empty()) nodes.push_back(&node);  // Not memory-only nodes
+    }
+    concurrency::WorkerPlacement placement;
+    for (size_t i = 0; i < workers; ++i) {
+        placement.cpus.push_back(nodes.empty() ? std::vector<int>() : nodes[i % nodes.size()]->cpus);
+        placement.groups.push_back(nodes.empty() ? 0 : nodes[i % nodes.size()]->id);
+    }
+    return placement;
+}
+
+std::vector<NumaPoint> probe_numa(const NumaTopology& topology, size_t bytes) {
+    std::vector<NumaPoint> points;
+    for (const NumaNode& cpu_node : topology.nodes()) {
+        if (cpu_node.cpus.empty()) continue;  // Memory-only node (e.g. CXL, HBM)
+        for (const NumaNode& memory_node : topology.nodes()) {
+            if (memory_node.total_bytes > 0 && memory_node.free_bytes < 2 * bytes) continue;
+            NumaPoint point{cpu_node.id, memory_node.id, 0, 0};
+            // A fresh thread, so that the caller's affinity is left alone
+            std::thread probe([&] {
+                if (!bind_thread_to_cpus(cpu_node.cpus)) return;
+                char* memory = static_cast<char*>(allocate_on_node(bytes, memory_node.id));
+                if (memory == nullptr) return;
+#if defined(MADV_HUGEPAGE)
+                madvise(memory, bytes, MADV_HUGEPAGE);  // Keep TLB misses out of the latency
+#endif
+                std::memset(memory, 1, bytes);  // Fault every page in, on memory_node
+                point.ns_per_load = chase_latency_ns(memory, bytes, size_t{1} << 22);
+
+                // Sequential reads, 8 bytes at a time, best of three
+                std::memset(memory, 1, bytes);
+                const uint64_t* words = reinterpret_cast<const uint64_t*>(memory);
+                const size_t count = bytes / sizeof(uint64_t);
+                double best_ns = 0;
+                for (int run = 0; run < 3; ++run) {
+                    double ns = bench::time_ns([&] {
+                        uint64_t sum = 0;
+                        for (size_t i = 0; i < count; ++i) sum += words[i];
+                        bench::do_not_optimize(sum);
+                    });
+                    if (run == 0 || ns < best_ns) best_ns = ns;
+                }
+                point.bytes_per_second = bytes * 1e9 / best_ns;
+                free_on_node(memory, bytes);
+            });
+            probe.join();
+            if (point.ns_per_load > 0) points.push_back(point);
+        }
+    }
+    return points;
+}
+
+}  // namespace memory
@@ -0,0 +1,113 @@
+/**
+ * @file perf_counters.cpp
+ * @brief TSC calibration and the perf_event_open counter group
+ */
+
+#include "perf_counters.h"
+
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace bench {
+
+uint64_t read_tsc_fallback() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+double tsc_ticks_per_ns() {
+    static const double ratio = [] {
+        using Clock = std::chrono::steady_clock;
+        auto start = Clock::now();
+        uint64_t ticks = read_tsc();
+        while (Clock::now() - start < std::chrono::milliseconds(20)) {
+        }
+        uint64_t elapsed_ticks = read_tsc() - ticks;
+        double elapsed_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        return elapsed_ticks / elapsed_ns;
+    }();
+    return ratio;
+}
+
+#if defined(__linux__)
+
+namespace {
+
+int open_counter(uint64_t config, int group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group < 0;  // The leader starts the whole group
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+    const uint64_t configs[EVENT_COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                           PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int& fd : fds_) fd = -1;
+    for (int i = 0; i < EVENT_COUNT; ++i) {
+        fds_[i] = open_counter(configs[i], i == 0 ? -1 : fds_[CYCLES]);
+        if (fds_[i] < 0) {
+            // All or nothing: a partial group would report misleading ratios
+            for (int& fd : fds_) {
+                if (fd >= 0) close(fd);
+                fd = -1;
+            }
+            return;
+        }
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+void PerfCounters::start() {
+    if (!available()) return;
+    ioctl(fds_[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::stop() {
+    if (!available()) return;
+    ioctl(fds_[CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // PERF_FORMAT_GROUP: the number of events, then one value per event
+    uint64_t group[1 + EVENT_COUNT];
+    if (read(fds_[CYCLES], group, sizeof(group)) != static_cast<ssize_t>(sizeof(group))) return;
+    for (int i = 0; i < EVENT_COUNT; ++i) values_[i] = group[1 + i];
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    for (int& fd : fds_) fd = -1;
+}
+
+PerfCounters::~PerfCounters() {}
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+
+#endif
+
+double PerfCounters::instructions_per_cycle() const {
+    return values_[CYCLES] > 0 ? static_cast<double>(values_[INSTRUCTIONS]) / values_[CYCLES] : 0;
+}
+
+}  // namespace bench
@@ -0,0 +1,77 @@
+/**
+ * @file rcu.cpp
+ * @brief Reader thread registry and grace-period wait for rcu.h
+ */
+
+#include "rcu.h"
+
+#include <cassert>
+
+#include "spin_locks.h"
+
+namespace concurrency {
+
+namespace {
+
+// Hands the thread's record back to the registry when the thread exits,
+// so threads that come and go reuse a bounded set of records
+struct RecordRelease {
+    RcuDomain::ThreadRecord* record = nullptr;
+    ~RecordRelease() {
+        if (record != nullptr) record->in_use.store(false, std::memory_order_release);
+    }
+};
+
+}  // namespace
+
+RcuDomain::ThreadRecord* RcuDomain::register_thread() {
+    static thread_local RecordRelease release;
+
+    // Reuse a record left behind by a finished thread...
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        bool expected = false;
+        if (!record->in_use.load(std::memory_order_relaxed) &&
+            record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            release.record = current_ = record;
+            return record;
+        }
+    }
+
+    // ...or push a new one (lock-free; the list only ever grows)
+    ThreadRecord* record = new ThreadRecord;
+    record->in_use.store(true, std::memory_order_relaxed);
+    ThreadRecord* head = records_.load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!records_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+    release.record = current_ = record;
+    return record;
+}
+
+void RcuDomain::synchronize() {
+    assert((current_ == nullptr || current_->nesting == 0) && "synchronize() inside a read-side section");
+
+    // Readers that copied an older epoch may hold the old pointer; readers
+    // that see `target` (or later) loaded the pointer after the swap
+    uint64_t target = epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        SpinWait spin;
+        while (true) {
+            uint64_t epoch = record->epoch.load(std::memory_order_acquire);
+            if (epoch == 0 || epoch >= target) break;
+            spin.wait();
+        }
+    }
+}
+
+size_t RcuDomain::registered_threads() {
+    size_t count = 0;
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        if (record->in_use.load(std::memory_order_relaxed)) ++count;
+    }
+    return count;
+}
+
+}  // namespace concurrency
@@ -0,0 +1,56 @@
+/**
+ * @file remap_vector.cpp
+ * @brief mmap / mremap plumbing for containers::RemapVector
+ */
+
+#include "remap_vector.h"
+
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace containers {
+namespace remap_detail {
+
+size_t page_size() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t round_to_pages(size_t bytes) {
+    size_t page = page_size();
+    return (std::max<size_t>(bytes, 1) + page - 1) / page * page;
+}
+
+void* map(size_t bytes) {
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) throw std::bad_alloc();
+    return memory;
+}
+
+void* remap(void* memory, size_t old_bytes, size_t new_bytes) {
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+    void* moved = mremap(memory, old_bytes, new_bytes, MREMAP_MAYMOVE);
+    if (moved == MAP_FAILED) throw std::bad_alloc();
+    return moved;
+#else
+    void* moved = map(new_bytes);
+    std::memcpy(moved, memory, std::min(old_bytes, new_bytes));
+    unmap(memory, old_bytes);
+    return moved;
+#endif
+}
+
+void unmap(void* memory, size_t bytes) { munmap(memory, bytes); }
+
+bool remaps_in_kernel() {
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace remap_detail
+}  // namespace containers
@@ -0,0 +1,303 @@
+/**
+ * @file shm_ring.cpp
+ * @brief Segment setup, framing and futex wake-ups for ipc::ShmRing
+ */
+
+#include "shm_ring.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "cache_line.h"
+#include "spin_locks.h"
+
+namespace ipc {
+
+namespace {
+
+const uint64_t MAGIC = 0x31474E4952534D48ull;  // "HMSRING1"
+const size_t MIN_CAPACITY = 4096;
+const int SPIN_POLLS = 256;  // Polls before a waiter goes to sleep
+const size_t FRAMES_OFFSET = 4096;  // Frames start on the page after the header
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ShmRing needs lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "ShmRing needs lock-free 32-bit atomics");
+
+size_t round_up_pow2(size_t n) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < n) capacity <<= 1;
+    return capacity;
+}
+
+// Spinning only helps if the other side is running on another CPU
+int spin_polls() {
+    static const int polls = std::thread::hardware_concurrency() > 1 ? SPIN_POLLS : 0;
+    return polls;
+}
+
+size_t align8(size_t n) { return (n + 7) & ~size_t{7}; }
+
+// Sleep while *word == expected (or until woken); may return spuriously
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+#else
+    (void)expected;
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+}
+
+void futex_wake(std::atomic<uint32_t>& word, int waiters) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, waiters, nullptr, nullptr, 0);
+#else
+    (void)word;
+    (void)waiters;
+#endif
+}
+
+}  // namespace
+
+// Lives at the start of the shared segment, frames follow. Every field
+// the two sides write often has a cache line of its own.
+struct ShmRing::Header {
+    std::atomic<uint64_t> magic{0};  // Set last: open() waits for it
+    uint64_t capacity = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> reserved{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> committed{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> consumed{0};
+
+    // Bumped by producers to wake a sleeping consumer, and the reverse
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> data_signal{0};
+    std::atomic<uint32_t> consumer_sleeping{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> space_signal{0};
+    std::atomic<uint32_t> producers_sleeping{0};
+    std::atomic<uint32_t> shut_down{0};
+};
+
+bool ShmRing::create(const std::string& name, size_t capacity) {
+    static_assert(sizeof(Header) <= FRAMES_OFFSET, "header overlaps the frames");
+    close();
+    capacity = round_up_pow2(capacity);
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+    size_t size = FRAMES_OFFSET + capacity;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0 || !map(fd, size)) {
+        int saved = errno;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        errno = saved;
+        return false;
+    }
+    ::close(fd);
+
+    Header* header = new (header_) Header();
+    header->capacity = capacity;
+    mask_ = capacity - 1;
+    header->magic.store(MAGIC, std::memory_order_release);
+    unlink_name_ = name;
+    return true;
+}
+
+bool ShmRing::open(const std::string& name) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) <= FRAMES_OFFSET ||
+        !map(fd, static_cast<size_t>(info.st_size))) {
+        int saved = errno;
+        ::close(fd);
+        errno = saved == 0 ? EINVAL : saved;
+        return false;
+    }
+    ::close(fd);
+
+    if (header_->magic.load(std::memory_order_acquire) != MAGIC ||
+        header_->capacity + FRAMES_OFFSET != mapped_size_) {
+        close();
+        errno = EINVAL;  // Not (yet) a ring
+        return false;
+    }
+    mask_ = header_->capacity - 1;
+    read_position_ = header_->consumed.load(std::memory_order_acquire);
+    committed_cache_ = read_position_;
+    return true;
+}
+
+bool ShmRing::map(int fd, size_t size) {
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) return false;
+    header_ = static_cast<Header*>(memory);
+    frames_ = static_cast<char*>(memory) + FRAMES_OFFSET;
+    mapped_size_ = size;
+    read_position_ = 0;
+    committed_cache_ = 0;
+    pending_frame_ = 0;
+    return true;
+}
+
+void ShmRing::close() {
+    if (header_ == nullptr) return;
+    munmap(header_, mapped_size_);
+    header_ = nullptr;
+    frames_ = nullptr;
+    if (!unlink_name_.empty()) {
+        shm_unlink(unlink_name_.c_str());
+        unlink_name_.clear();
+    }
+}
+
+bool ShmRing::try_send(const void* data, size_t length) {
+    if (length > max_message()) {
+        errno = EMSGSIZE;
+        return false;
+    }
+    if (header_->shut_down.load(std::memory_order_acquire)) {
+        errno = EPIPE;
+        return false;
+    }
+
+    // Claim the frame, plus padding to the end if it would wrap
+    const size_t frame = align8(FRAME_HEADER + length);
+    const size_t capacity = mask_ + 1;
+    uint64_t start = header_->reserved.load(std::memory_order_relaxed);
+    size_t offset, needed;
+    do {
+        offset = start & mask_;
+        size_t contiguous = capacity - offset;
+        needed = frame <= contiguous ? frame : contiguous + frame;
+        if (start + needed - header_->consumed.load(std::memory_order_acquire) > capacity) {
+            errno = EAGAIN;
+            return false;
+        }
+    } while (!header_->reserved.compare_exchange_weak(start, start + needed, std::memory_order_relaxed));
+
+    char* at = frames_ + offset;
+    if (needed != frame) {
+        uint32_t padding[2] = {static_cast<uint32_t>(capacity - offset - FRAME_HEADER), PADDING};
+        std::memcpy(at, padding, sizeof(padding));
+        at = frames_;
+    }
+    uint32_t frame_header[2] = {static_cast<uint32_t>(length), 0};
+    std::memcpy(at, frame_header, sizeof(frame_header));
+    std::memcpy(at + FRAME_HEADER, data, length);
+
+    // Publish after every earlier claim has been published
+    concurrency::SpinWait spin;
+    while (header_->committed.load(std::memory_order_acquire) != start) {
+        spin.wait();
+    }
+    header_->committed.store(start + needed, std::memory_order_seq_cst);
+    if (header_->consumer_sleeping.load(std::memory_order_seq_cst)) {
+        header_->data_signal.fetch_add(1, std::memory_order_release);
+        futex_wake(header_->data_signal, 1);
+    }
+    return true;
+}
+
+bool ShmRing::send(const void* data, size_t length) {
+    while (!try_send(data, length)) {
+        if (errno != EAGAIN) return false;
+        if (!wait_for_space(align8(FRAME_HEADER + length) * 2)) {
+            errno = EPIPE;
+            return false;
+        }
+    }
+    return true;
+}
+
+void ShmRing::shutdown() {
+    header_->shut_down.store(1, std::memory_order_seq_cst);
+    header_->data_signal.fetch_add(1, std::memory_order_release);
+    futex_wake(header_->data_signal, 1);
+    header_->space_signal.fetch_add(1, std::memory_order_release);
+    futex_wake(header_->space_signal, INT32_MAX);
+}
+
+bool ShmRing::peek(const char*& data, size_t& length) {
+    while (true) {
+        if (read_position_ == committed_cache_) {
+            committed_cache_ = header_->committed.load(std::memory_order_acquire);
+            if (read_position_ == committed_cache_) return false;
+        }
+        uint32_t frame_header[2];
+        const char* at = frames_ + (read_position_ & mask_);
+        std::memcpy(frame_header, at, sizeof(frame_header));
+        size_t frame = align8(FRAME_HEADER + frame_header[0]);
+        if (frame_header[1] & PADDING) {
+            read_position_ += frame;  // Freed together with the next message
+            continue;
+        }
+        data = at + FRAME_HEADER;
+        length = frame_header[0];
+        pending_frame_ = frame;
+        return true;
+    }
+}
+
+void ShmRing::release() {
+    read_position_ += pending_frame_;
+    pending_frame_ = 0;
+    header_->consumed.store(read_position_, std::memory_order_seq_cst);
+    if (header_->producers_sleeping.load(std::memory_order_seq_cst) != 0) {
+        header_->space_signal.fetch_add(1, std::memory_order_release);
+        futex_wake(header_->space_signal, INT32_MAX);
+    }
+}
+
+// Both waits announce themselves, re-check, then sleep on the signal value
+// read before the re-check; the other side stores its progress before
+// loading the announcement, so at least one of the two sees the other.
+bool ShmRing::wait_for_data() {
+    for (int i = 0, polls = spin_polls(); i < polls; ++i) {
+        if (header_->committed.load(std::memory_order_acquire) != read_position_) return true;
+        concurrency::cpu_relax();
+    }
+    while (true) {
+        header_->consumer_sleeping.store(1, std::memory_order_seq_cst);
+        uint32_t signal = header_->data_signal.load(std::memory_order_acquire);
+        bool ready = header_->committed.load(std::memory_order_seq_cst) != read_position_;
+        bool done = header_->shut_down.load(std::memory_order_seq_cst) != 0;
+        if (!ready && !done) futex_wait(header_->data_signal, signal);
+        header_->consumer_sleeping.store(0, std::memory_order_relaxed);
+        if (ready || header_->committed.load(std::memory_order_acquire) != read_position_) return true;
+        if (done || header_->shut_down.load(std::memory_order_acquire)) return false;
+    }
+}
+
+bool ShmRing::wait_for_space(uint64_t needed) {
+    const uint64_t capacity = mask_ + 1;
+    auto has_room = [&] {
+        return header_->reserved.load(std::memory_order_relaxed) + needed -
+                   header_->consumed.load(std::memory_order_seq_cst) <= capacity;
+    };
+    for (int i = 0, polls = spin_polls(); i < polls; ++i) {
+        if (has_room()) return true;
+        concurrency::cpu_relax();
+    }
+    while (true) {
+        header_->producers_sleeping.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t signal = header_->space_signal.load(std::memory_order_acquire);
+        bool room = has_room();
+        bool done = header_->shut_down.load(std::memory_order_seq_cst) != 0;
+        if (!room && !done) futex_wait(header_->space_signal, signal);
+        header_->producers_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        if (room || has_room()) return true;
+        if (done || header_->shut_down.load(std::memory_order_acquire)) return false;
+    }
+}
+
+}  // namespace ipc
@@ -0,0 +1,794 @@
+/**
+ * @file simd_kernels.cpp
+ * @brief Per-ISA variants of the simd:: kernels and the dispatch that picks one
+ *
+ * Each vector variant handles whole vectors in its main loop and finishes
+ * the last partial vector either with the scalar code, with an overlapping
+ * final vector (min / max, where re-reading elements is harmless), or
+ * with masked loads and stores (AVX-512).
+ */
+
+#include "simd_kernels.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#define TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx2,popcnt")))
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#define SIMD_NEON 1
+#endif
+
+// find_in_string() reads whole aligned vectors, which may extend past the
+// terminator (never past its page); AddressSanitizer would flag that
+#if defined(__clang__) || defined(__GNUC__)
+#define NO_ASAN __attribute__((no_sanitize_address))
+#else
+#define NO_ASAN
+#endif
+
+namespace simd {
+
+namespace {
+
+// ----------------------------------------------------------------------
+// Scalar: the reference, and the tail of the vector variants
+
+int64_t sum_scalar(const int32_t* data, size_t n) {
+    int64_t total = 0;
+    for (size_t i = 0; i < n; ++i) total += data[i];
+    return total;
+}
+
+int32_t min_scalar(const int32_t* data, size_t n) {
+    int32_t best = data[0];
+    for (size_t i = 1; i < n; ++i) best = data[i] < best ? data[i] : best;
+    return best;
+}
+
+int32_t max_scalar(const int32_t* data, size_t n) {
+    int32_t best = data[0];
+    for (size_t i = 1; i < n; ++i) best = data[i] > best ? data[i] : best;
+    return best;
+}
+
+const char* find_byte_scalar(const char* data, size_t n, char byte) {
+    for (size_t i = 0; i < n; ++i) {
+        if (data[i] == byte) return data + i;
+    }
+    return nullptr;
+}
+
+const char* find_in_string_scalar(const char* text, char byte) {
+    for (;; ++text) {
+        if (*text == byte) return text;
+        if (*text == '\0') return nullptr;
+    }
+}
+
+size_t count_byte_scalar(const char* data, size_t n, char byte) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) count += data[i] == byte;
+    return count;
+}
+
+// One bit per byte value, so the cost does not grow with the set
+const char* find_first_of_scalar(const char* data, size_t n, const char* set, size_t set_size) {
+    uint64_t members[4] = {};
+    for (size_t k = 0; k < set_size; ++k) {
+        unsigned char c = static_cast<unsigned char>(set[k]);
+        members[c >> 6] |= uint64_t{1} << (c & 63);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if ((members[c >> 6] >> (c & 63)) & 1) return data + i;
+    }
+    return nullptr;
+}
+
+// Set membership by table lookup on both nibbles of a byte, one bit per
+// distinct high nibble in the set: x is in the set exactly when
+// low[x & 15] & high[x >> 4] is non-zero. Two byte shuffles classify a
+// whole vector whatever the set size. Needs at most 8 distinct high
+// nibbles, which every ASCII set has.
+struct NibbleTables {
+    alignas(16) uint8_t low[16];
+    alignas(16) uint8_t high[16];
+};
+
+bool build_nibble_tables(const char* set, size_t set_size, NibbleTables& tables) {
+    std::memset(&tables, 0, sizeof(tables));
+    unsigned used = 0;
+    for (size_t k = 0; k < set_size; ++k) {
+        unsigned char c = static_cast<unsigned char>(set[k]);
+        if (tables.high[c >> 4] == 0) {
+            if (used == 8) return false;
+            tables.high[c >> 4] = static_cast<uint8_t>(1u << used++);
+        }
+        tables.low[c & 15] |= tables.high[c >> 4];
+    }
+    return true;
+}
+
+// Lowercase letters for FIRST = 'a' (to upper), uppercase for 'A'; the
+// two cases differ only in bit 0x20
+template <char FIRST>
+void flip_case_scalar(char* data, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (static_cast<unsigned char>(data[i] - FIRST) < 26) data[i] ^= 0x20;
+    }
+}
+
+void reverse_scalar(char* data, size_t n) {
+    if (n < 2) return;
+    for (char *left = data, *right = data + n - 1; left < right; ++left, --right) std::swap(*left, *right);
+}
+
+const Kernels SCALAR_KERNELS = {Isa::SCALAR,          sum_scalar,           min_scalar,
+                                max_scalar,           find_byte_scalar,     find_in_string_scalar,
+                                find_first_of_scalar, count_byte_scalar,    flip_case_scalar<'a'>,
+                                flip_case_scalar<'A'>, reverse_scalar};
+
+#if defined(SIMD_X86)
+
+// ----------------------------------------------------------------------
+// SSE4.2: 16 bytes at a time
+
+TARGET_SSE42 inline __m128i load16(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+
+TARGET_SSE42 int64_t sum_sse42(const int32_t* data, size_t n) {
+    __m128i low = _mm_setzero_si128(), high = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = load16(data + i);
+        low = _mm_add_epi64(low, _mm_cvtepi32_epi64(v));
+        high = _mm_add_epi64(high, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+    }
+    __m128i total = _mm_add_epi64(low, high);
+    return _mm_cvtsi128_si64(total) + _mm_extract_epi64(total, 1) + sum_scalar(data + i, n - i);
+}
+
+template <bool MAX>
+TARGET_SSE42 inline __m128i pick_sse42(__m128i a, __m128i b) {
+    return MAX ? _mm_max_epi32(a, b) : _mm_min_epi32(a, b);
+}
+
+template <bool MAX>
+TARGET_SSE42 int32_t extreme_sse42(const int32_t* data, size_t n) {
+    if (n < 4) return MAX ? max_scalar(data, n) : min_scalar(data, n);
+    __m128i best = load16(data);
+    for (size_t i = 4; i + 4 <= n; i += 4) best = pick_sse42<MAX>(best, load16(data + i));
+    best = pick_sse42<MAX>(best, load16(data + n - 4));
+    best = pick_sse42<MAX>(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(1, 0, 3, 2)));
+    best = pick_sse42<MAX>(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(best);
+}
+
+TARGET_SSE42 const char* find_byte_sse42(const char* data, size_t n, char byte) {
+    const __m128i needle = _mm_set1_epi8(byte);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m128i a = _mm_cmpeq_epi8(load16(data + i), needle);
+        __m128i b = _mm_cmpeq_epi8(load16(data + i + 16), needle);
+        __m128i c = _mm_cmpeq_epi8(load16(data + i + 32), needle);
+        __m128i d = _mm_cmpeq_epi8(load16(data + i + 48), needle);
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) == 0) continue;
+        uint64_t mask = static_cast<uint64_t>(_mm_movemask_epi8(a)) |
+                        static_cast<uint64_t>(_mm_movemask_epi8(b)) << 16 |
+                        static_cast<uint64_t>(_mm_movemask_epi8(c)) << 32 |
+                        static_cast<uint64_t>(_mm_movemask_epi8(d)) << 48;
+        return data + i + __builtin_ctzll(mask);
+    }
+    for (; i + 16 <= n; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(load16(data + i), needle));
+        if (mask != 0) return data + i + __builtin_ctz(mask);
+    }
+    return find_byte_scalar(data + i, n - i, byte);
+}
+
+NO_ASAN TARGET_SSE42 const char* find_in_string_sse42(const char* text, char byte) {
+    const __m128i needle = _mm_set1_epi8(byte), zero = _mm_setzero_si128();
+    size_t offset = reinterpret_cast<uintptr_t>(text) & 15;
+    const char* block = text - offset;
+    unsigned skip = ~0u << offset;  // Bytes before `text` do not count
+    while (true) {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+        unsigned hits = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle))) & skip;
+        unsigned ends = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero))) & skip;
+        if ((hits | ends) != 0) {
+            if (hits == 0) return nullptr;
+            // Searching for '\0' finds the terminator, as strchr() does
+            return ends == 0 || __builtin_ctz(hits) <= __builtin_ctz(ends) ? block + __builtin_ctz(hits) : nullptr;
+        }
+        block += 16;
+        skip = ~0u;
+    }
+}
+
+TARGET_SSE42 size_t count_byte_sse42(const char* data, size_t n, char byte) {
+    const __m128i needle = _mm_set1_epi8(byte);
+    size_t count = 0, i = 0;
+    for (; i + 16 <= n; i += 16) {
+        count += static_cast<size_t>(__builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(load16(data + i), needle))));
+    }
+    return count + count_byte_scalar(data + i, n - i, byte);
+}
+
+// PCMPESTRI, the SSE4.2 string instruction, compares 16 bytes against a
+// set of up to 16; larger sets fall back to the bitmap
+TARGET_SSE42 const char* find_first_of_sse42(const char* data, size_t n, const char* set, size_t set_size) {
+    if (set_size == 1) return find_byte_sse42(data, n, set[0]);
+    if (set_size == 0 || set_size > 16) return find_first_of_scalar(data, n, set, set_size);
+    const int MODE = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT;
+    char members[16] = {};
+    std::memcpy(members, set, set_size);
+    const __m128i needles = load16(members);
+    const int set_length = static_cast<int>(set_size);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int index = _mm_cmpestri(needles, set_length, load16(data + i), 16, MODE);
+        if (index < 16) return data + i + index;
+    }
+    if (i == n) return nullptr;
+    char tail[16] = {};
+    std::memcpy(tail, data + i, n - i);
+    int index = _mm_cmpestri(needles, set_length, load16(tail), static_cast<int>(n - i), MODE);
+    return index < static_cast<int>(n - i) ? data + i + index : nullptr;
+}
+
+// Adding 128 - FIRST moves the letter range to the bottom of the signed
+// byte range, so one signed compare finds it
+template <char FIRST>
+TARGET_SSE42 void flip_case_sse42(char* data, size_t n) {
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(128 - FIRST));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(-128 + 26));
+    const __m128i flip = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = load16(data + i);
+        __m128i letters = _mm_cmplt_epi8(_mm_add_epi8(v, bias), limit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(v, _mm_and_si128(letters, flip)));
+    }
+    flip_case_scalar<FIRST>(data + i, n - i);
+}
+
+// Swap 16-byte blocks from both ends, reversing each
+TARGET_SSE42 void reverse_sse42(char* data, size_t n) {
+    const __m128i backwards = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    char* left = data;
+    char* right = data + n;
+    while (right - left >= 32) {
+        right -= 16;
+        __m128i head = load16(left), tail = load16(right);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(left), _mm_shuffle_epi8(tail, backwards));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(right), _mm_shuffle_epi8(head, backwards));
+        left += 16;
+    }
+    reverse_scalar(left, static_cast<size_t>(right - left));
+}
+
+const Kernels SSE42_KERNELS = {Isa::SSE42,          sum_sse42,            extreme_sse42<false>,
+                               extreme_sse42<true>, find_byte_sse42,      find_in_string_sse42,
+                               find_first_of_sse42, count_byte_sse42,     flip_case_sse42<'a'>,
+                               flip_case_sse42<'A'>, reverse_sse42};
+
+// ----------------------------------------------------------------------
+// AVX2: 32 bytes at a time
+
+TARGET_AVX2 inline __m256i load32(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+
+TARGET_AVX2 inline int64_t add_lanes_avx2(__m256i v) {
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1);
+}
+
+TARGET_AVX2 int64_t sum_avx2(const int32_t* data, size_t n) {
+    __m256i low = _mm256_setzero_si256(), high = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        low = _mm256_add_epi64(low, _mm256_cvtepi32_epi64(load16(data + i)));
+        high = _mm256_add_epi64(high, _mm256_cvtepi32_epi64(load16(data + i + 4)));
+    }
+    return add_lanes_avx2(_mm256_add_epi64(low, high)) + sum_scalar(data + i, n - i);
+}
+
+template <bool MAX>
+TARGET_AVX2 inline __m256i pick_avx2(__m256i a, __m256i b) {
+    return MAX ? _mm256_max_epi32(a, b) : _mm256_min_epi32(a, b);
+}
+
+template <bool MAX>
+TARGET_AVX2 inline int32_t reduce_avx2(__m256i best) {
+    best = pick_avx2<MAX>(best, _mm256_permute2x128_si256(best, best, 1));
+    best = pick_avx2<MAX>(best, _mm256_shuffle_epi32(best, _MM_SHUFFLE(1, 0, 3, 2)));
+    best = pick_avx2<MAX>(best, _mm256_shuffle_epi32(best, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm256_cvtsi256_si32(best);
+}
+
+template <bool MAX>
+TARGET_AVX2 int32_t extreme_avx2(const int32_t* data, size_t n) {
+    if (n < 8) return extreme_sse42<MAX>(data, n);
+    __m256i best = load32(data);
+    for (size_t i = 8; i + 8 <= n; i += 8) best = pick_avx2<MAX>(best, load32(data + i));
+    return reduce_avx2<MAX>(pick_avx2<MAX>(best, load32(data + n - 8)));
+}
+
+TARGET_AVX2 const char* find_byte_avx2(const char* data, size_t n, char byte) {
+    const __m256i needle = _mm256_set1_epi8(byte);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m256i a = _mm256_cmpeq_epi8(load32(data + i), needle);
+        __m256i b = _mm256_cmpeq_epi8(load32(data + i + 32), needle);
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) continue;
+        uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(a)) |
+                        static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(b))) << 32;
+        return data + i + __builtin_ctzll(mask);
+    }
+    return find_byte_sse42(data + i, n - i, byte);
+}
+
+NO_ASAN TARGET_AVX2 const char* find_in_string_avx2(const char* text, char byte) {
+    const __m256i needle = _mm256_set1_epi8(byte), zero = _mm256_setzero_si256();
+    size_t offset = reinterpret_cast<uintptr_t>(text) & 31;
+    const char* block = text - offset;
+    uint32_t skip = ~0u << offset;
+    while (true) {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+        uint32_t hits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle))) & skip;
+        uint32_t ends = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero))) & skip;
+        if ((hits | ends) != 0) {
+            if (hits == 0) return nullptr;
+            return ends == 0 || __builtin_ctz(hits) <= __builtin_ctz(ends) ? block + __builtin_ctz(hits) : nullptr;
+        }
+        block += 32;
+        skip = ~0u;
+    }
+}
+
+TARGET_AVX2 size_t count_byte_avx2(const char* data, size_t n, char byte) {
+    const __m256i needle = _mm256_set1_epi8(byte);
+    size_t count = 0, i = 0;
+    for (; i + 32 <= n; i += 32) {
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load32(data + i), needle)));
+        count += static_cast<size_t>(__builtin_popcount(mask));
+    }
+    return count + count_byte_sse42(data + i, n - i, byte);
+}
+
+TARGET_AVX2 const char* find_first_of_avx2(const char* data, size_t n, const char* set, size_t set_size) {
+    NibbleTables tables;
+    if (set_size < 2 || !build_nibble_tables(set, set_size, tables)) {
+        return find_first_of_sse42(data, n, set, set_size);
+    }
+    const __m256i low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.low)));
+    const __m256i high = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.high)));
+    const __m256i nibble = _mm256_set1_epi8(0x0f), zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = load32(data + i);
+        __m256i classes = _mm256_and_si256(_mm256_shuffle_epi8(low, _mm256_and_si256(v, nibble)),
+                                           _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+        uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(classes, zero)));
+        if (mask != 0) return data + i + __builtin_ctz(mask);
+    }
+    return find_first_of_sse42(data + i, n - i, set, set_size);
+}
+
+template <char FIRST>
+TARGET_AVX2 void flip_case_avx2(char* data, size_t n) {
+    const __m256i bias = _mm256_set1_epi8(static_cast<char>(128 - FIRST));
+    const __m256i limit = _mm256_set1_epi8(static_cast<char>(-128 + 26));
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = load32(data + i);
+        __m256i letters = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(v, bias));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_xor_si256(v, _mm256_and_si256(letters, flip)));
+    }
+    flip_case_sse42<FIRST>(data + i, n - i);
+}
+
+// pshufb only shuffles within 128-bit lanes, so reverse each lane and
+// then swap the lanes
+TARGET_AVX2 inline __m256i reverse32(__m256i v) {
+    const __m256i backwards = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                               15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, backwards), _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+TARGET_AVX2 void reverse_avx2(char* data, size_t n) {
+    char* left = data;
+    char* right = data + n;
+    while (right - left >= 64) {
+        right -= 32;
+        __m256i head = load32(left), tail = load32(right);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(left), reverse32(tail));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(right), reverse32(head));
+        left += 32;
+    }
+    reverse_sse42(left, static_cast<size_t>(right - left));
+}
+
+const Kernels AVX2_KERNELS = {Isa::AVX2,          sum_avx2,            extreme_avx2<false>,
+                              extreme_avx2<true>, find_byte_avx2,      find_in_string_avx2,
+                              find_first_of_avx2, count_byte_avx2,     flip_case_avx2<'a'>,
+                              flip_case_avx2<'A'>, reverse_avx2};
+
+// ----------------------------------------------------------------------
+// AVX-512 (F + BW): 64 bytes at a time, tails through masked loads
+
+// GCC 12's intrinsic headers self-initialize their "undefined" vectors,
+// which its own -Wuninitialized then reports at every inlined call
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+TARGET_AVX512 inline __m512i load64(const void* p) { return _mm512_loadu_si512(p); }
+
+// The first `n` (< 64) bytes
+TARGET_AVX512 inline __mmask64 first_bytes(size_t n) { return n >= 64 ? ~0ull : (1ull << n) - 1; }
+
+TARGET_AVX512 int64_t sum_avx512(const int32_t* data, size_t n) {
+    __m512i low = _mm512_setzero_si512(), high = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        low = _mm512_add_epi64(low, _mm512_cvtepi32_epi64(load32(data + i)));
+        high = _mm512_add_epi64(high, _mm512_cvtepi32_epi64(load32(data + i + 8)));
+    }
+    __m512i total = _mm512_add_epi64(low, high);
+    return add_lanes_avx2(_mm256_add_epi64(_mm512_castsi512_si256(total), _mm512_extracti64x4_epi64(total, 1))) +
+           sum_scalar(data + i, n - i);
+}
+
+template <bool MAX>
+TARGET_AVX512 inline __m512i pick_avx512(__m512i a, __m512i b) {
+    return MAX ? _mm512_max_epi32(a, b) : _mm512_min_epi32(a, b);
+}
+
+template <bool MAX>
+TARGET_AVX512 int32_t extreme_avx512(const int32_t* data, size_t n) {
+    if (n < 16) return extreme_avx2<MAX>(data, n);
+    __m512i best = load64(data);
+    for (size_t i = 16; i + 16 <= n; i += 16) best = pick_avx512<MAX>(best, load64(data + i));
+    best = pick_avx512<MAX>(best, load64(data + n - 16));
+    return reduce_avx2<MAX>(pick_avx2<MAX>(_mm512_castsi512_si256(best), _mm512_extracti64x4_epi64(best, 1)));
+}
+
+TARGET_AVX512 const char* find_byte_avx512(const char* data, size_t n, char byte) {
+    const __m512i needle = _mm512_set1_epi8(byte);
+    for (size_t i = 0; i < n; i += 64) {
+        __mmask64 valid = first_bytes(n - i);
+        __mmask64 hits = _mm512_mask_cmpeq_epi8_mask(valid, _mm512_maskz_loadu_epi8(valid, data + i), needle);
+        if (hits != 0) return data + i + __builtin_ctzll(hits);
+    }
+    return nullptr;
+}
+
+NO_ASAN TARGET_AVX512 const char* find_in_string_avx512(const char* text, char byte) {
+    const __m512i needle = _mm512_set1_epi8(byte);
+    size_t offset = reinterpret_cast<uintptr_t>(text) & 63;
+    const char* block = text - offset;
+    uint64_t skip = ~0ull << offset;
+    while (true) {
+        __m512i v = _mm512_load_si512(block);
+        uint64_t hits = _mm512_cmpeq_epi8_mask(v, needle) & skip;
+        uint64_t ends = _mm512_testn_epi8_mask(v, v) & skip;
+        if ((hits | ends) != 0) {
+            if (hits == 0) return nullptr;
+            return ends == 0 || __builtin_ctzll(hits) <= __builtin_ctzll(ends) ? block + __builtin_ctzll(hits) : nullptr;
+        }
+        block += 64;
+        skip = ~0ull;
+    }
+}
+
+TARGET_AVX512 size_t count_byte_avx512(const char* data, size_t n, char byte) {
+    const __m512i needle = _mm512_set1_epi8(byte);
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += 64) {
+        __mmask64 valid = first_bytes(n - i);
+        count += static_cast<size_t>(
+            __builtin_popcountll(_mm512_mask_cmpeq_epi8_mask(valid, _mm512_maskz_loadu_epi8(valid, data + i), needle)));
+    }
+    return count;
+}
+
+TARGET_AVX512 const char* find_first_of_avx512(const char* data, size_t n, const char* set, size_t set_size) {
+    NibbleTables tables;
+    if (set_size < 2 || !build_nibble_tables(set, set_size, tables)) {
+        return find_first_of_sse42(data, n, set, set_size);
+    }
+    const __m512i low = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.low)));
+    const __m512i high = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.high)));
+    const __m512i nibble = _mm512_set1_epi8(0x0f);
+    for (size_t i = 0; i < n; i += 64) {
+        __mmask64 valid = first_bytes(n - i);
+        __m512i v = _mm512_maskz_loadu_epi8(valid, data + i);
+        __m512i low_classes = _mm512_shuffle_epi8(low, _mm512_and_si512(v, nibble));
+        __m512i high_classes = _mm512_shuffle_epi8(high, _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble));
+        __mmask64 hits = _mm512_mask_test_epi8_mask(valid, low_classes, high_classes);
+        if (hits != 0) return data + i + __builtin_ctzll(hits);
+    }
+    return nullptr;
+}
+
+template <char FIRST>
+TARGET_AVX512 void flip_case_avx512(char* data, size_t n) {
+    const __m512i first = _mm512_set1_epi8(FIRST);
+    const __m512i letters_in_alphabet = _mm512_set1_epi8(26);
+    const __m512i flip = _mm512_set1_epi8(0x20);
+    for (size_t i = 0; i < n; i += 64) {
+        __mmask64 valid = first_bytes(n - i);
+        __m512i v = _mm512_maskz_loadu_epi8(valid, data + i);
+        __mmask64 letters = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(v, first), letters_in_alphabet);
+        _mm512_mask_storeu_epi8(data + i, valid, _mm512_xor_si512(v, _mm512_maskz_mov_epi8(letters, flip)));
+    }
+}
+
+// Reverse the bytes of each 128-bit lane, then the order of the lanes
+TARGET_AVX512 inline __m512i reverse64(__m512i v) {
+    const __m512i backwards = _mm512_broadcast_i32x4(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    __m512i lanes_reversed = _mm512_shuffle_epi8(v, backwards);
+    return _mm512_shuffle_i64x2(lanes_reversed, lanes_reversed, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+TARGET_AVX512 void reverse_avx512(char* data, size_t n) {
+    char* left = data;
+    char* right = data + n;
+    while (right - left >= 128) {
+        right -= 64;
+        __m512i head = load64(left), tail = load64(right);
+        _mm512_storeu_si512(left, reverse64(tail));
+        _mm512_storeu_si512(right, reverse64(head));
+        left += 64;
+    }
+    reverse_avx2(left, static_cast<size_t>(right - left));
+}
+
+const Kernels AVX512_KERNELS = {Isa::AVX512,          sum_avx512,            extreme_avx512<false>,
+                                extreme_avx512<true>, find_byte_avx512,      find_in_string_avx512,
+                                find_first_of_avx512, count_byte_avx512,     flip_case_avx512<'a'>,
+                                flip_case_avx512<'A'>, reverse_avx512};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif  // SIMD_X86
+
+#if defined(SIMD_NEON)
+
+// ----------------------------------------------------------------------
+// NEON: 16 bytes at a time. There is no movemask; narrowing each 16-bit
+// pair of compare bytes by 4 bits gives a 64-bit mask with 4 bits per byte.
+
+inline uint64_t nibble_mask(uint8x16_t compare) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(compare), 4)), 0);
+}
+
+int64_t sum_neon(const int32_t* data, size_t n) {
+    int64x2_t total = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) total = vpadalq_s32(total, vld1q_s32(data + i));
+    return vaddvq_s64(total) + sum_scalar(data + i, n - i);
+}
+
+template <bool MAX>
+inline int32x4_t pick_neon(int32x4_t a, int32x4_t b) {
+    return MAX ? vmaxq_s32(a, b) : vminq_s32(a, b);
+}
+
+template <bool MAX>
+int32_t extreme_neon(const int32_t* data, size_t n) {
+    if (n < 4) return MAX ? max_scalar(data, n) : min_scalar(data, n);
+    int32x4_t best = vld1q_s32(data);
+    for (size_t i = 4; i + 4 <= n; i += 4) best = pick_neon<MAX>(best, vld1q_s32(data + i));
+    best = pick_neon<MAX>(best, vld1q_s32(data + n - 4));
+    return MAX ? vmaxvq_s32(best) : vminvq_s32(best);
+}
+
+const char* find_byte_neon(const char* data, size_t n, char byte) {
+    const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(byte));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint64_t mask = nibble_mask(vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + i)), needle));
+        if (mask != 0) return data + i + (__builtin_ctzll(mask) >> 2);
+    }
+    return find_byte_scalar(data + i, n - i, byte);
+}
+
+NO_ASAN const char* find_in_string_neon(const char* text, char byte) {
+    const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(byte));
+    size_t offset = reinterpret_cast<uintptr_t>(text) & 15;
+    const char* block = text - offset;
+    uint64_t skip = ~0ull << (offset * 4);
+    while (true) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(block));
+        uint64_t hits = nibble_mask(vceqq_u8(v, needle)) & skip;
+        uint64_t ends = nibble_mask(vceqzq_u8(v)) & skip;
+        if ((hits | ends) != 0) {
+            if (hits == 0) return nullptr;
+            return ends == 0 || __builtin_ctzll(hits) <= __builtin_ctzll(ends) ? block + (__builtin_ctzll(hits) >> 2)
+                                                                              : nullptr;
+        }
+        block += 16;
+        skip = ~0ull;
+    }
+}
+
+size_t count_byte_neon(const char* data, size_t n, char byte) {
+    const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(byte));
+    const uint8x16_t one = vdupq_n_u8(1);
+    size_t count = 0, i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t hits = vandq_u8(vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + i)), needle), one);
+        count += vaddvq_u8(hits);
+    }
+    return count + count_byte_scalar(data + i, n - i, byte);
+}
+
+const char* find_first_of_neon(const char* data, size_t n, const char* set, size_t set_size) {
+    NibbleTables tables;
+    if (set_size == 1) return find_byte_neon(data, n, set[0]);
+    if (set_size == 0 || !build_nibble_tables(set, set_size, tables)) {
+        return find_first_of_scalar(data, n, set, set_size);
+    }
+    const uint8x16_t low = vld1q_u8(tables.low), high = vld1q_u8(tables.high);
+    const uint8x16_t nibble = vdupq_n_u8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        uint8x16_t classes = vandq_u8(vqtbl1q_u8(low, vandq_u8(v, nibble)), vqtbl1q_u8(high, vshrq_n_u8(v, 4)));
+        uint64_t mask = nibble_mask(vtstq_u8(classes, classes));
+        if (mask != 0) return data + i + (__builtin_ctzll(mask) >> 2);
+    }
+    return find_first_of_scalar(data + i, n - i, set, set_size);
+}
+
+template <char FIRST>
+void flip_case_neon(char* data, size_t n) {
+    const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(FIRST));
+    const uint8x16_t letters_in_alphabet = vdupq_n_u8(26);
+    const uint8x16_t flip = vdupq_n_u8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8_t* p = reinterpret_cast<uint8_t*>(data + i);
+        uint8x16_t v = vld1q_u8(p);
+        uint8x16_t letters = vcltq_u8(vsubq_u8(v, first), letters_in_alphabet);
+        vst1q_u8(p, veorq_u8(v, vandq_u8(letters, flip)));
+    }
+    flip_case_scalar<FIRST>(data + i, n - i);
+}
+
+// vrev64 reverses each half; swapping the halves finishes the job
+inline uint8x16_t reverse16(uint8x16_t v) {
+    uint8x16_t halves = vrev64q_u8(v);
+    return vextq_u8(halves, halves, 8);
+}
+
+void reverse_neon(char* data, size_t n) {
+    uint8_t* left = reinterpret_cast<uint8_t*>(data);
+    uint8_t* right = left + n;
+    while (right - left >= 32) {
+        right -= 16;
+        uint8x16_t head = vld1q_u8(left), tail = vld1q_u8(right);
+        vst1q_u8(left, reverse16(tail));
+        vst1q_u8(right, reverse16(head));
+        left += 16;
+    }
+    reverse_scalar(reinterpret_cast<char*>(left), static_cast<size_t>(right - left));
+}
+
+const Kernels NEON_KERNELS = {Isa::NEON,          sum_neon,            extreme_neon<false>,
+                              extreme_neon<true>, find_byte_neon,      find_in_string_neon,
+                              find_first_of_neon, count_byte_neon,     flip_case_neon<'a'>,
+                              flip_case_neon<'A'>, reverse_neon};
+
+#endif  // SIMD_NEON
+
+const Kernels* table(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR:
+            return &SCALAR_KERNELS;
+#if defined(SIMD_X86)
+        case Isa::SSE42:
+            return &SSE42_KERNELS;
+        case Isa::AVX2:
+            return &AVX2_KERNELS;
+        case Isa::AVX512:
+            return &AVX512_KERNELS;
+#endif
+#if defined(SIMD_NEON)
+        case Isa::NEON:
+            return &NEON_KERNELS;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+const Kernels& choose() {
+    const Isa ALL[] = {Isa::SCALAR, Isa::SSE42, Isa::AVX2, Isa::AVX512, Isa::NEON};
+    if (const char* forced = std::getenv("SIMD_ISA")) {
+        for (Isa isa : ALL) {
+            if (std::strcmp(forced, isa_name(isa)) == 0) {
+                const Kernels* kernels = kernels_for(isa);
+                return kernels != nullptr ? *kernels : SCALAR_KERNELS;
+            }
+        }
+    }
+    const Isa BEST_FIRST[] = {Isa::AVX512, Isa::AVX2, Isa::SSE42, Isa::NEON};
+    for (Isa isa : BEST_FIRST) {
+        if (const Kernels* kernels = kernels_for(isa)) return *kernels;
+    }
+    return SCALAR_KERNELS;
+}
+
+}  // namespace
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR:
+            return "scalar";
+        case Isa::SSE42:
+            return "sse4.2";
+        case Isa::AVX2:
+            return "avx2";
+        case Isa::AVX512:
+            return "avx512";
+        case Isa::NEON:
+            return "neon";
+    }
+    return "unknown";
+}
+
+bool isa_supported(Isa isa) {
+#if defined(SIMD_X86)
+    __builtin_cpu_init();  // Safe to call early, e.g. from static initializers
+#endif
+    switch (isa) {
+        case Isa::SCALAR:
+            return true;
+#if defined(SIMD_X86)
+        case Isa::SSE42:
+            return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+        case Isa::AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+#if defined(SIMD_NEON)
+        case Isa::NEON:
+#if defined(__linux__)
+            return (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#else
+            return true;  // Part of the AArch64 baseline
+#endif
+#endif
+        default:
+            return false;
+    }
+}
+
+const Kernels* kernels_for(Isa isa) { return isa_supported(isa) ? table(isa) : nullptr; }
+
+const Kernels& kernels() {
+    static const Kernels& chosen = choose();
+    return chosen;
+}
+
+}  // namespace simd
@@ -0,0 +1,177 @@
+/**
+ * @file timer_wheel.cpp
+ * @brief Slot hashing, cascading and expiry for net::TimerWheel
+ */
+
+#include "timer_wheel.h"
+
+namespace net {
+
+Timer::~Timer() { cancel(); }
+
+void Timer::cancel() {
+    if (wheel_ != nullptr) wheel_->cancel(*this);
+}
+
+TimerWheel::TimerWheel(uint64_t start_tick) : now_(start_tick), next_(start_tick) {}
+
+TimerWheel::~TimerWheel() {
+    // Orphan whatever is still scheduled so that its destructor is a no-op
+    auto orphan = [](TimerLink& head) {
+        while (head.next != &head) {
+            auto* timer = static_cast<Timer*>(head.next);
+            unlink_node(*timer);
+            timer->wheel_ = nullptr;
+        }
+    };
+    for (auto& slot : level0_) orphan(slot);
+    for (auto& level : levels_) {
+        for (auto& slot : level) orphan(slot);
+    }
+}
+
+void TimerWheel::schedule_at(Timer& timer, uint64_t deadline) {
+    if (timer.wheel_ != nullptr) timer.wheel_->cancel(timer);
+    timer.deadline_ = deadline < next_ ? next_ : deadline;
+    timer.wheel_ = this;
+    link(timer);
+    ++size_;
+}
+
+void TimerWheel::cancel(Timer& timer) {
+    if (timer.wheel_ != this) return;
+    unlink(timer);
+    timer.wheel_ = nullptr;
+    --size_;
+}
+
+TimerLink& TimerWheel::slot_for(uint64_t deadline, int& level) {
+    uint64_t delta = deadline - next_;
+    if (delta < LEVEL0_SLOTS) {
+        level = 0;
+        return level0_[deadline & (LEVEL0_SLOTS - 1)];
+    }
+    for (level = 1; level < LEVELS - 1; ++level) {
+        if (delta < (uint64_t(1) << (LEVEL0_BITS + level * LEVEL_BITS))) break;
+    }
+    int shift = LEVEL0_BITS + level * LEVEL_BITS;
+    // Beyond the top level's range: park in its furthest slot and get
+    // re-hashed (with the real deadline) when that slot cascades
+    if (delta >= (uint64_t(1) << shift)) deadline = next_ + (uint64_t(1) << shift) - 1;
+    return levels_[level - 1][(deadline >> (shift - LEVEL_BITS)) & (LEVEL_SLOTS - 1)];
+}
+
+void TimerWheel::link(Timer& timer) {
+    TimerLink& head = slot_for(timer.deadline_, timer.level_);
+    timer.prev = head.prev;
+    timer.next = &head;
+    head.prev->next = &timer;
+    head.prev = &timer;
+    ++level_size_[timer.level_];
+}
+
+void TimerWheel::unlink(Timer& timer) {
+    unlink_node(timer);
+    --level_size_[timer.level_];
+}
+
+void TimerWheel::unlink_node(TimerLink& node) {
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = node.next = &node;
+}
+
+// Move a whole slot list onto the (empty) sentinel `to`
+void TimerWheel::take_list(TimerLink& from, TimerLink& to) {
+    if (from.next == &from) return;
+    to.next = from.next;
+    to.prev = from.prev;
+    to.next->prev = &to;
+    to.prev->next = &to;
+    from.prev = from.next = &from;
+}
+
+// Re-hash every timer in levels_[level - 1][index] relative to next_; each
+// lands in a lower level (or level 0) because its deadline is now closer
+void TimerWheel::cascade(int level, size_t index) {
+    TimerLink pending;
+    take_list(levels_[level - 1][index], pending);
+    while (pending.next != &pending) {
+        auto* timer = static_cast<Timer*>(pending.next);
+        unlink(*timer);
+        link(*timer);
+    }
+}
+
+size_t TimerWheel::advance(uint64_t tick) {
+    if (tick < next_) return 0;  // Already processed
+    now_ = tick;
+
+    size_t fired = 0;
+    while (next_ <= tick) {
+        if (size_ == 0) {
+            next_ = tick + 1;  // Nothing left: skip the empty ticks
+            break;
+        }
+        if (level_size_[0] == 0) {
+            // Nothing can fire before the next cascade of a non-empty
+            // level, so jump straight to that boundary
+            int shift = LEVEL0_BITS;
+            for (int level = 1; level < LEVELS - 1 && level_size_[level] == 0; ++level) shift += LEVEL_BITS;
+            uint64_t step = uint64_t(1) << shift;
+            if ((next_ & (step - 1)) != 0) {
+                uint64_t boundary = (next_ | (step - 1)) + 1;
+                if (boundary > tick) {
+                    next_ = tick + 1;
+                    break;
+                }
+                next_ = boundary;
+            }
+        }
+
+        size_t index = next_ & (LEVEL0_SLOTS - 1);
+        if (index == 0) {
+            // Crossing a level-0 revolution: pull the next slots down
+            for (int level = 1; level < LEVELS; ++level) {
+                int slot_shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+                size_t slot = (next_ >> slot_shift) & (LEVEL_SLOTS - 1);
+                cascade(level, slot);
+                if (slot != 0) break;
+            }
+        }
+
+        // Detach the due list first: callbacks may schedule into this very
+        // slot (deadlines that are not in the future move to the next
+        // tick), or cancel timers that are still waiting in it
+        TimerLink due;
+        take_list(level0_[index], due);
+        ++next_;
+
+        while (due.next != &due) {
+            auto* timer = static_cast<Timer*>(due.next);
+            unlink(*timer);
+            timer->wheel_ = nullptr;
+            --size_;
+            ++fired;
+            if (timer->callback_) timer->callback_();  // May destroy the timer
+        }
+    }
+    return fired;
+}
+
+int64_t TimerWheel::ticks_until_next() const {
+    if (size_ == 0) return -1;
+    size_t start = next_ & (LEVEL0_SLOTS - 1);
+    size_t until_cascade = LEVEL0_SLOTS - start;
+    size_t i = level_size_[0] == 0 ? until_cascade : 0;
+    while (i < until_cascade) {
+        const TimerLink& slot = level0_[start + i];
+        if (slot.next != &slot) break;
+        ++i;
+    }
+    // Slot start + i comes due at tick next_ + i
+    uint64_t due = next_ + i;
+    return due > now_ ? static_cast<int64_t>(due - now_) : 0;
+}
+
+}  // namespace net
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <cstring>
 #include <iomanip>
 
 // ANSI Color codes for console output
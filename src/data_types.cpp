@@ -20,6 +20,10 @@
 #include <vector>     // For std::vector
 #include <cmath>      // For sqrt function
 #include <cstddef>    // For offsetof
+#include <cstdio>     // For printf
+
+#include "benchmark.h"
+#include "soa_vector.h"
 
 void demonstrate_primitive_types() {
   std::cout << "=== PRIMITIVE/FUNDAMENTAL TYPES ===" << std::endl;
@@ -455,6 +459,72 @@ void demonstrate_memory_layout() {
   
   std::cout << "PackedStruct size: " << sizeof(PackedStruct) << " bytes" << std::endl;
   
+  // What the layouts cost in a loop over one field of 10M elements:
+  // padded wastes 10 of every 24 bytes, packed wastes none but reads
+  // misaligned values, structure-of-arrays reads only the field scanned
+  std::cout << "\n--- Padding in a Hot Loop (measured) ---" << std::endl;
+  const size_t COUNT = 10'000'000;
+  std::vector<PaddedStruct> padded(COUNT);
+  std::vector<PackedStruct> packed(COUNT);
+  containers::SoaVector<PaddedStruct, &PaddedStruct::c, &PaddedStruct::i, &PaddedStruct::c2, &PaddedStruct::d> columns;
+  columns.reserve(COUNT);
+  for (size_t n = 0; n < COUNT; ++n) {
+    PaddedStruct element{static_cast<char>(n), static_cast<int>(n % 1000), 'x', static_cast<double>(n % 77)};
+    padded[n] = element;
+    packed[n].c = element.c;
+    packed[n].i = element.i;
+    packed[n].c2 = element.c2;
+    packed[n].d = element.d;
+    columns.push_back(element);
+  }
+  
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;  // The table below instead
+  bench::Suite suite("data_types", options);
+  auto ns_per_element = [&](const std::string& name, auto&& scan) {
+    return suite.run(name, scan, COUNT).ns_per_item();
+  };
+  const int* is = columns.data<&PaddedStruct::i>();
+  const double* ds = columns.data<&PaddedStruct::d>();
+  
+  printf("  %-16s %10s %10s %10s\n", "ns per element", "padded", "packed", "SoA");
+  printf("  %-16s %10.2f %10.2f %10.2f\n", "sum of int i",
+         ns_per_element("sum i / padded", [&] {
+           long long sum = 0;
+           for (const PaddedStruct& e : padded) sum += e.i;
+           bench::do_not_optimize(sum);
+         }),
+         ns_per_element("sum i / packed", [&] {
+           long long sum = 0;
+           for (const PackedStruct& e : packed) sum += e.i;
+           bench::do_not_optimize(sum);
+         }),
+         ns_per_element("sum i / SoA", [&] {
+           long long sum = 0;
+           for (size_t n = 0; n < COUNT; ++n) sum += is[n];
+           bench::do_not_optimize(sum);
+         }));
+  printf("  %-16s %10.2f %10.2f %10.2f\n", "sum of double d",
+         ns_per_element("sum d / padded", [&] {
+           double sum = 0;
+           for (const PaddedStruct& e : padded) sum += e.d;
+           bench::do_not_optimize(sum);
+         }),
+         ns_per_element("sum d / packed", [&] {
+           double sum = 0;
+           for (const PackedStruct& e : packed) sum += e.d;
+           bench::do_not_optimize(sum);
+         }),
+         ns_per_element("sum d / SoA", [&] {
+           double sum = 0;
+           for (size_t n = 0; n < COUNT; ++n) sum += ds[n];
+           bench::do_not_optimize(sum);
+         }));
+  std::cout << "Bytes per element read: padded " << sizeof(PaddedStruct) << ", packed " << sizeof(PackedStruct)
+            << ", SoA " << sizeof(int) << " / " << sizeof(double) << std::endl;
+  std::cout << "The loops are memory bound: vectorized or not (see -fopt-info-vec), time follows" << std::endl;
+  std::cout << "the bytes each layout makes the loop pull through the cache." << std::endl;
+  
   std::cout << std::endl;
 }
 
@@ -15,6 +15,16 @@
 #include <chrono>
 #include <random>
 #include <functional>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "bounded_queue.h"
+#include "cache_line.h"
+#include "sharded_counter.h"
+#include "work_stealing_pool.h"
 
 // ANSI Color codes for better output
 namespace Colors {
@@ -92,6 +102,7 @@ namespace Exercise1 {
 namespace Exercise2 {
     int shared_counter = 0;
     std::mutex counter_mutex;
+    concurrency::ShardedCounter sharded_counter;
     
     void print_header() {
         std::cout << Colors::BOLD << Colors::BLUE << "\n🔒 EXERCISE 2: Mutex and Race Conditions" << Colors::RESET << std::endl;
@@ -123,6 +134,15 @@ namespace Exercise2 {
         std::cout << Colors::GREEN << "Thread " << thread_id << " (safe) finished" << Colors::RESET << std::endl;
     }
     
+    // Also safe, without a shared hot spot: each thread increments its own
+    // cache-line-sized slot and value() adds the slots up
+    void sharded_increment(int thread_id, int iterations) {
+        for (int i = 0; i < iterations; ++i) {
+            sharded_counter.add();
+        }
+        std::cout << Colors::GREEN << "Thread " << thread_id << " (sharded) finished" << Colors::RESET << std::endl;
+    }
+    
     void run_exercise() {
         print_header();
         
@@ -157,6 +177,22 @@ namespace Exercise2 {
         
         std::cout << Colors::GREEN << "Safe result: " << shared_counter 
                   << " (expected: 500)" << Colors::RESET << std::endl;
+        
+        // Part C: Sharded counter, no lock and no shared cache line
+        std::cout << Colors::CYAN << "\nPart C: Sharded counter (per-thread slots)" << Colors::RESET << std::endl;
+        sharded_counter.reset();
+        
+        std::vector<std::thread> sharded_threads;
+        for (int i = 0; i < 5; ++i) {
+            sharded_threads.emplace_back(sharded_increment, i, 100);
+        }
+        
+        for (auto& t : sharded_threads) {
+            t.join();
+        }
+        
+        std::cout << Colors::GREEN << "Sharded result: " << sharded_counter.value()
+                  << " (expected: 500)" << Colors::RESET << std::endl;
         std::cout << Colors::GREEN << "✅ Exercise 2 completed!" << Colors::RESET << std::endl;
     }
 }
@@ -170,58 +206,108 @@ namespace Exercise3 {
     std::mutex queue_mutex;
     std::condition_variable condition;
     bool finished = false;
+
+    // The same exercise on a bounded lock-free ring (spin, then park)
+    enum class QueueKind { MUTEX, LOCK_FREE };
+    QueueKind queue_kind = QueueKind::MUTEX;
+    concurrency::BlockingQueue<concurrency::MpmcQueue<int>> lock_free_queue(1024);
     
     void print_header() {
         std::cout << Colors::BOLD << Colors::BLUE << "\n📦 EXERCISE 3: Producer-Consumer Pattern" << Colors::RESET << std::endl;
         std::cout << Colors::YELLOW << "Task: Implement producer-consumer using condition variables" << Colors::RESET << std::endl;
         std::cout << std::string(60, '-') << std::endl;
     }
+
+    void push_item(int item) {
+        if (queue_kind == QueueKind::LOCK_FREE) {
+            lock_free_queue.push(item);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            data_queue.push(item);
+        }
+        condition.notify_one();
+    }
+
+    // Blocks for the next item; false once production is finished and drained
+    bool pop_item(int& item) {
+        if (queue_kind == QueueKind::LOCK_FREE) {
+            return lock_free_queue.pop(item);
+        }
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        
+        // Wait for items or until finished
+        condition.wait(lock, [] { return !data_queue.empty() || finished; });
+        
+        if (data_queue.empty()) {
+            return false; // No more items to process
+        }
+        item = data_queue.front();
+        data_queue.pop();
+        return true;
+    }
+
+    void finish_production() {
+        if (queue_kind == QueueKind::LOCK_FREE) {
+            lock_free_queue.close();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            finished = true;
+        }
+        condition.notify_all();
+    }
+
+    void reset_queues() {
+        while (!data_queue.empty()) data_queue.pop();
+        finished = false;
+        int discarded;
+        while (lock_free_queue.try_pop(discarded)) {
+        }
+        lock_free_queue.reset();
+    }
     
     // TODO: Implement producer function
-    void producer(int producer_id, int items_to_produce) {
+    // (verbose = false drops the simulated work and logging, for benchmarks)
+    void producer(int producer_id, int items_to_produce, bool verbose = true) {
         // YOUR CODE HERE:
         // 1. Produce items and add them to the queue
         // 2. Use proper locking when accessing the queue
         // 3. Notify consumers when items are available
         
         for (int i = 0; i < items_to_produce; ++i) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Simulate work
-            
-            {
+            int item = producer_id * 1000 + i;
+            if (verbose) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Simulate work
+            }
+            push_item(item);
+            if (verbose) {
                 std::lock_guard<std::mutex> lock(queue_mutex);
-                int item = producer_id * 1000 + i;
-                data_queue.push(item);
                 std::cout << Colors::GREEN << "Producer " << producer_id 
                           << " produced item: " << item << Colors::RESET << std::endl;
             }
-            condition.notify_one();
         }
         
-        std::cout << Colors::CYAN << "Producer " << producer_id << " finished!" << Colors::RESET << std::endl;
+        if (verbose) {
+            std::cout << Colors::CYAN << "Producer " << producer_id << " finished!" << Colors::RESET << std::endl;
+        }
     }
     
     // TODO: Implement consumer function
-    void consumer(int consumer_id) {
+    // Returns the number of items consumed
+    long consumer(int consumer_id, bool verbose = true) {
         // YOUR CODE HERE:
         // 1. Wait for items in the queue using condition variable
         // 2. Process items when available
         // 3. Handle the case when production is finished
         
-        while (true) {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            
-            // Wait for items or until finished
-            condition.wait(lock, [] { return !data_queue.empty() || finished; });
-            
-            if (data_queue.empty() && finished) {
-                break; // No more items to process
-            }
-            
-            if (!data_queue.empty()) {
-                int item = data_queue.front();
-                data_queue.pop();
-                lock.unlock(); // Release lock while processing
-                
+        long consumed = 0;
+        int item;
+        while (pop_item(item)) {
+            ++consumed;
+            if (verbose) {
                 std::cout << Colors::MAGENTA << "Consumer " << consumer_id 
                           << " consumed item: " << item << Colors::RESET << std::endl;
                 
@@ -229,37 +315,38 @@ namespace Exercise3 {
             }
         }
         
-        std::cout << Colors::YELLOW << "Consumer " << consumer_id << " finished!" << Colors::RESET << std::endl;
+        if (verbose) {
+            std::cout << Colors::YELLOW << "Consumer " << consumer_id << " finished!" << Colors::RESET << std::endl;
+        }
+        return consumed;
     }
     
     void run_exercise() {
         print_header();
         
         // Reset state
-        while (!data_queue.empty()) data_queue.pop();
-        finished = false;
+        reset_queues();
+        std::cout << Colors::YELLOW << "Queue: "
+                  << (queue_kind == QueueKind::MUTEX ? "std::queue + mutex" : "lock-free MPMC ring")
+                  << Colors::RESET << std::endl;
         
         // Create producers and consumers
         std::vector<std::thread> threads;
         
         // Start consumers first
-        threads.emplace_back(consumer, 1);
-        threads.emplace_back(consumer, 2);
+        threads.emplace_back(consumer, 1, true);
+        threads.emplace_back(consumer, 2, true);
         
         // Start producers
-        threads.emplace_back(producer, 1, 5);
-        threads.emplace_back(producer, 2, 3);
+        threads.emplace_back(producer, 1, 5, true);
+        threads.emplace_back(producer, 2, 3, true);
         
         // Wait for producers to finish
         threads[2].join();
         threads[3].join();
         
         // Signal that production is finished
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex);
-            finished = true;
-        }
-        condition.notify_all();
+        finish_production();
         
         // Wait for consumers to finish
         threads[0].join();
@@ -267,6 +354,67 @@ namespace Exercise3 {
         
         std::cout << Colors::GREEN << "✅ Exercise 3 completed!" << Colors::RESET << std::endl;
     }
+
+    // ===== BENCHMARK: mutex queue vs lock-free ring =====
+
+    // Items/second through producer() / consumer() with `pairs` of each
+    double measure_queue(QueueKind kind, int pairs, int items_per_producer) {
+        queue_kind = kind;
+        reset_queues();
+
+        std::vector<std::thread> consumers;
+        std::vector<std::thread> producers;
+        auto start = std::chrono::steady_clock::now();
+        for (int c = 0; c < pairs; ++c) {
+            consumers.emplace_back([c] { consumer(c, false); });
+        }
+        for (int p = 0; p < pairs; ++p) {
+            producers.emplace_back(producer, p, items_per_producer, false);
+        }
+        for (auto& t : producers) t.join();
+        finish_production();
+        for (auto& t : consumers) t.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        queue_kind = QueueKind::MUTEX;
+        return seconds > 0 ? (static_cast<double>(pairs) * items_per_producer) / seconds : 0.0;
+    }
+
+    // The 1P1C case can use the single-producer ring directly
+    double measure_spsc(int items) {
+        concurrency::BlockingQueue<concurrency::SpscQueue<int>> queue(1024);
+        auto start = std::chrono::steady_clock::now();
+        std::thread consumer_thread([&queue] {
+            int item;
+            while (queue.pop(item)) {
+            }
+        });
+        for (int i = 0; i < items; ++i) queue.push(i);
+        queue.close();
+        consumer_thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return seconds > 0 ? items / seconds : 0.0;
+    }
+
+    void benchmark_queues(int total_items) {
+        std::cout << Colors::BOLD << Colors::BLUE << "\n📊 Producer-consumer benchmark: " << total_items
+                  << " items per run" << Colors::RESET << std::endl;
+        std::cout << std::string(60, '-') << std::endl;
+        std::printf("%8s %16s %16s %16s\n", "config", "mutex items/s", "MPMC items/s", "SPSC items/s");
+
+        for (int pairs : {1, 4, 16}) {
+            int per_producer = std::max(1, total_items / pairs);
+            double mutex_rate = measure_queue(QueueKind::MUTEX, pairs, per_producer);
+            double mpmc_rate = measure_queue(QueueKind::LOCK_FREE, pairs, per_producer);
+            std::string config = std::to_string(pairs) + "P" + std::to_string(pairs) + "C";
+            if (pairs == 1) {
+                std::printf("%8s %16.0f %16.0f %16.0f\n", config.c_str(), mutex_rate, mpmc_rate,
+                            measure_spsc(per_producer));
+            } else {
+                std::printf("%8s %16.0f %16.0f %16s\n", config.c_str(), mutex_rate, mpmc_rate, "-");
+            }
+        }
+    }
 }
 
 // =============================================================================
@@ -277,6 +425,7 @@ namespace Exercise4 {
     std::atomic<int> atomic_counter(0);
     int regular_counter = 0;
     std::mutex regular_mutex;
+    concurrency::ShardedCounter sharded_counter;
     
     void print_header() {
         std::cout << Colors::BOLD << Colors::BLUE << "\n⚛️  EXERCISE 4: Atomic Operations" << Colors::RESET << std::endl;
@@ -306,6 +455,81 @@ namespace Exercise4 {
         }
     }
     
+    // Per-thread slots: the increments never leave this core's cache
+    void sharded_increment_worker(int iterations) {
+        for (int i = 0; i < iterations; ++i) {
+            sharded_counter.add();
+        }
+    }
+    
+    // Increments/second with `threads` threads each running work(thread, iterations)
+    template <typename Work>
+    double measure_rate(int threads, int iterations, Work work) {
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back(work, t, iterations);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return seconds > 0 ? static_cast<double>(threads) * iterations / seconds : 0.0;
+    }
+    
+    std::vector<int> thread_counts() {
+        int max_threads = std::max(4, static_cast<int>(std::thread::hardware_concurrency()));
+        std::vector<int> counts;
+        for (int n = 1; n < max_threads; n *= 2) counts.push_back(n);
+        counts.push_back(max_threads);
+        return counts;
+    }
+    
+    // One counter, three ways, as the thread count grows
+    void report_scaling(int iterations) {
+        std::cout << Colors::BOLD << Colors::BLUE << "\nScaling (M increments/s, all threads):" << Colors::RESET << std::endl;
+        std::printf("%8s %12s %12s %12s\n", "threads", "mutex", "atomic", "sharded");
+        for (int threads : thread_counts()) {
+            regular_counter = 0;
+            atomic_counter = 0;
+            sharded_counter.reset();
+            double mutex_rate = measure_rate(threads, iterations, [](int, int n) { mutex_increment_worker(n); });
+            double atomic_rate = measure_rate(threads, iterations, [](int, int n) { atomic_increment_worker(n); });
+            double sharded_rate = measure_rate(threads, iterations, [](int, int n) { sharded_increment_worker(n); });
+            std::printf("%8d %12.1f %12.1f %12.1f", threads, mutex_rate / 1e6, atomic_rate / 1e6, sharded_rate / 1e6);
+            uint64_t expected = static_cast<uint64_t>(threads) * iterations;
+            if (static_cast<uint64_t>(regular_counter) != expected || static_cast<uint64_t>(atomic_counter) != expected ||
+                sharded_counter.value() != expected) {
+                std::printf("  COUNT MISMATCH");
+            }
+            std::printf("\n");
+        }
+    }
+    
+    // False sharing: every thread increments only its own slot, yet packed
+    // slots (8 per cache line) still fight over the line
+    void report_false_sharing(int iterations) {
+        std::cout << Colors::BOLD << Colors::BLUE << "\nFalse sharing: one private slot per thread (M increments/s):"
+                  << Colors::RESET << std::endl;
+        std::printf("%8s %12s %12s\n", "threads", "packed", "padded");
+        for (int threads : thread_counts()) {
+            std::vector<std::atomic<uint64_t>> packed(threads);
+            std::vector<CachePadded<std::atomic<uint64_t>>> padded(threads);
+            double packed_rate = measure_rate(threads, iterations, [&packed](int t, int n) {
+                for (int i = 0; i < n; ++i) {
+                    packed[t].fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+            double padded_rate = measure_rate(threads, iterations, [&padded](int t, int n) {
+                for (int i = 0; i < n; ++i) {
+                    padded[t]->fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+            std::printf("%8d %12.1f %12.1f\n", threads, packed_rate / 1e6, padded_rate / 1e6);
+        }
+        std::cout << "Padded slots are alignas(" << CACHE_LINE_SIZE << "), see cache_line.h" << std::endl;
+    }
+    
     void run_exercise() {
         print_header();
         
@@ -358,6 +582,9 @@ namespace Exercise4 {
         std::cout << Colors::YELLOW << "Mutex time: " << mutex_ms << "ms" << Colors::RESET << std::endl;
         std::cout << Colors::MAGENTA << "Performance ratio: " << (double)mutex_ms / atomic_ms << "x" << Colors::RESET << std::endl;
         
+        report_scaling(iterations_per_thread * 10);
+        report_false_sharing(iterations_per_thread * 10);
+        
         std::cout << Colors::GREEN << "✅ Exercise 4 completed!" << Colors::RESET << std::endl;
     }
 }
@@ -555,8 +782,113 @@ namespace Exercise6 {
         // Wait a bit to see tasks being executed
         std::this_thread::sleep_for(std::chrono::seconds(5));
         
+        // The promoted pool: per-worker deques, and submit() hands back a future
+        concurrency::WorkStealingPool ws_pool(3);
+        std::vector<std::future<long long>> partial_sums;
+        for (int chunk = 0; chunk < 4; ++chunk) {
+            partial_sums.push_back(ws_pool.submit([chunk] {
+                long long sum = 0;
+                for (int i = chunk * 250000; i < (chunk + 1) * 250000; ++i) sum += i;
+                return sum;
+            }));
+        }
+        long long total = 0;
+        for (auto& f : partial_sums) total += f.get();
+        std::cout << Colors::CYAN << "WorkStealingPool futures: sum(0..999999) = " << total << Colors::RESET << std::endl;
+
+        std::vector<int> squares(16);
+        ws_pool.parallel_for(0, squares.size(), [&squares](size_t i) { squares[i] = static_cast<int>(i * i); });
+        std::cout << Colors::CYAN << "parallel_for: squares[15] = " << squares[15] << Colors::RESET << std::endl;
+        
         std::cout << Colors::GREEN << "✅ Exercise 6 completed!" << Colors::RESET << std::endl;
     }
+
+    // ===== BENCHMARK: mutex queue vs work stealing =====
+
+    // A few hundred nanoseconds of work, so queueing cost dominates
+    inline uint64_t short_task_work(uint64_t seed) {
+        uint64_t x = seed | 1;
+        for (int i = 0; i < 64; ++i) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+        }
+        return x;
+    }
+
+    double tasks_per_second(size_t tasks, std::chrono::steady_clock::duration elapsed) {
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        return seconds > 0 ? tasks / seconds : 0.0;
+    }
+
+    void wait_for(const std::atomic<size_t>& done, size_t target) {
+        while (done.load(std::memory_order_acquire) < target) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Tasks/second for `tasks` short tasks, at 1, 2, 4, ... max_threads workers:
+    // - ThreadPool:            the single-lock pool above, enqueue from main
+    // - WS submit:             WorkStealingPool::post() from main (inboxes)
+    // - WS spawn:              tasks spawned by a pool task (deque push + steal)
+    void benchmark_pools(size_t max_threads, size_t tasks) {
+        std::cout << Colors::BOLD << Colors::BLUE << "\n📊 Thread pool benchmark: " << tasks
+                  << " short tasks per run" << Colors::RESET << std::endl;
+        std::cout << std::string(60, '-') << std::endl;
+        std::printf("%8s %16s %16s %16s\n", "threads", "ThreadPool/s", "WS submit/s", "WS spawn/s");
+
+        std::vector<size_t> thread_counts;
+        for (size_t n = 1; n < max_threads; n *= 2) thread_counts.push_back(n);
+        thread_counts.push_back(max_threads);
+
+        std::atomic<uint64_t> sink(0);
+        for (size_t threads : thread_counts) {
+            double mutex_rate, submit_rate, spawn_rate;
+            {
+                std::atomic<size_t> done(0);
+                ThreadPool pool(threads);
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < tasks; ++i) {
+                    pool.enqueue([i, &done, &sink] {
+                        sink.fetch_add(short_task_work(i) & 1, std::memory_order_relaxed);
+                        done.fetch_add(1, std::memory_order_release);
+                    });
+                }
+                wait_for(done, tasks);
+                mutex_rate = tasks_per_second(tasks, std::chrono::steady_clock::now() - start);
+            }
+            {
+                std::atomic<size_t> done(0);
+                concurrency::WorkStealingPool pool(threads);
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < tasks; ++i) {
+                    pool.post([i, &done, &sink] {
+                        sink.fetch_add(short_task_work(i) & 1, std::memory_order_relaxed);
+                        done.fetch_add(1, std::memory_order_release);
+                    });
+                }
+                wait_for(done, tasks);
+                submit_rate = tasks_per_second(tasks, std::chrono::steady_clock::now() - start);
+            }
+            {
+                std::atomic<size_t> done(0);
+                concurrency::WorkStealingPool pool(threads);
+                auto start = std::chrono::steady_clock::now();
+                pool.post([&pool, tasks, &done, &sink] {
+                    for (size_t i = 0; i < tasks; ++i) {
+                        pool.post([i, &done, &sink] {
+                            sink.fetch_add(short_task_work(i) & 1, std::memory_order_relaxed);
+                            done.fetch_add(1, std::memory_order_release);
+                        });
+                    }
+                });
+                wait_for(done, tasks);
+                spawn_rate = tasks_per_second(tasks, std::chrono::steady_clock::now() - start);
+            }
+            std::printf("%8zu %16.0f %16.0f %16.0f\n", threads, mutex_rate, submit_rate, spawn_rate);
+        }
+        std::cout << "(checksum " << sink.load() << ")" << std::endl;
+    }
 }
 
 // =============================================================================
@@ -573,6 +905,8 @@ void print_main_menu() {
     std::cout << Colors::GREEN << "5. Futures and Promises" << Colors::RESET << std::endl;
     std::cout << Colors::GREEN << "6. Thread Pool Implementation" << Colors::RESET << std::endl;
     std::cout << Colors::GREEN << "7. Run All Exercises" << Colors::RESET << std::endl;
+    std::cout << Colors::GREEN << "8. Thread Pool Benchmark (mutex queue vs work stealing)" << Colors::RESET << std::endl;
+    std::cout << Colors::GREEN << "9. Producer-Consumer Benchmark (mutex queue vs lock-free ring)" << Colors::RESET << std::endl;
     std::cout << Colors::GREEN << "0. Exit" << Colors::RESET << std::endl;
     std::cout << std::string(60, '=') << std::endl;
 }
@@ -590,13 +924,58 @@ void run_all_exercises() {
     std::cout << Colors::BOLD << Colors::GREEN << "\n🎉 All exercises completed successfully!" << Colors::RESET << std::endl;
 }
 
-int main() {
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [--bench pools|queues|counters [--threads N] [--tasks N]]" << std::endl;
+}
+
+// Non-interactive entry point for the benchmarks
+int run_benchmark_from_args(int argc, char* argv[]) {
+    std::string which = argc > 2 ? argv[2] : "";
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t tasks = 200000;
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--tasks") == 0 && i + 1 < argc) {
+            tasks = std::max(1, std::atoi(argv[++i]));
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (which == "pools") {
+        Exercise6::benchmark_pools(threads, tasks);
+        return 0;
+    }
+    if (which == "queues") {
+        Exercise3::benchmark_queues(static_cast<int>(tasks));
+        return 0;
+    }
+    if (which == "counters") {
+        Exercise4::report_scaling(static_cast<int>(tasks) * 5);
+        Exercise4::report_false_sharing(static_cast<int>(tasks) * 5);
+        return 0;
+    }
+    print_usage(argv[0]);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        if (std::strcmp(argv[1], "--bench") == 0) {
+            return run_benchmark_from_args(argc, argv);
+        }
+        print_usage(argv[0]);
+        return 1;
+    }
+
     std::cout << Colors::BOLD << Colors::CYAN << "Welcome to C++ Multithreading Practice!" << Colors::RESET << std::endl;
     
     while (true) {
         print_main_menu();
         
-        std::cout << Colors::YELLOW << "Enter your choice (0-7): " << Colors::RESET;
+        std::cout << Colors::YELLOW << "Enter your choice (0-9): " << Colors::RESET;
         int choice;
         std::cin >> choice;
         
@@ -622,6 +1001,12 @@ int main() {
             case 7:
                 run_all_exercises();
                 break;
+            case 8:
+                Exercise6::benchmark_pools(std::max(1u, std::thread::hardware_concurrency()), 200000);
+                break;
+            case 9:
+                Exercise3::benchmark_queues(200000);
+                break;
             case 0:
                 std::cout << Colors::GREEN << "👋 Happy coding!" << Colors::RESET << std::endl;
                 return 0;
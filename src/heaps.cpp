@@ -16,6 +16,16 @@
 #include <random>
 #include <chrono>
 #include <set>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+
+// d-ary heap, indexed heap with decrease_key, and (parallel) top-k
+#include "dary_heap.h"
+#include "benchmark.h"
+#include "top_k.h"
+#include "timer_wheel.h"
 
 void demonstrate_priority_queue_basics() {
   std::cout << "=== PRIORITY QUEUE BASICS ===" << std::endl;
@@ -367,6 +377,260 @@ void demonstrate_heap_applications() {
   std::cout << std::endl;
 }
 
+void demonstrate_dary_and_indexed_heaps() {
+  std::cout << "=== D-ARY AND INDEXED HEAPS ===" << std::endl;
+
+  // A d-ary heap gives every node D children instead of 2. The tree gets
+  // shallower (cheaper push) and the children sit next to each other in
+  // memory. Same conventions as priority_queue: largest on top.
+  containers::DaryHeap<int, 4> four_ary;
+  for (int val : {30, 10, 50, 20, 40, 60, 5}) {
+    four_ary.push(val);
+  }
+  std::cout << "4-ary max heap pops: ";
+  while (!four_ary.empty()) {
+    std::cout << four_ary.top() << " ";
+    four_ary.pop();
+  }
+  std::cout << std::endl;
+
+  // An indexed heap knows where every id sits, so it can lower an id's
+  // priority in place. Dijkstra's algorithm needs exactly that: each time
+  // a shorter path to a node is found, its distance is decreased.
+  std::vector<std::string> names = {"A", "B", "C", "D", "E"};
+  std::vector<std::vector<std::pair<size_t, int>>> edges = {
+    {{1, 4}, {2, 1}},  // A -> B (4), A -> C (1)
+    {{3, 1}},          // B -> D (1)
+    {{1, 2}, {3, 5}},  // C -> B (2), C -> D (5)
+    {{4, 3}},          // D -> E (3)
+    {}
+  };
+  const int unreached = std::numeric_limits<int>::max();
+  std::vector<int> dist(names.size(), unreached);
+  containers::IndexedHeap<int> frontier(names.size());
+  dist[0] = 0;
+  frontier.push(0, 0);
+  while (!frontier.empty()) {
+    size_t node = frontier.top();
+    frontier.pop();
+    for (auto [next, weight] : edges[node]) {
+      if (dist[node] + weight < dist[next]) {
+        dist[next] = dist[node] + weight;
+        frontier.push_or_decrease(next, dist[next]);
+      }
+    }
+  }
+  std::cout << "Dijkstra shortest distances from A: ";
+  for (size_t i = 0; i < names.size(); ++i) {
+    std::cout << names[i] << "=" << dist[i] << " ";
+  }
+  std::cout << std::endl;
+
+  // top_k keeps a heap of the k best elements seen so far, worst on top,
+  // and rejects most elements with one comparison.
+  std::vector<int> scores = {88, 42, 97, 15, 73, 64, 99, 23, 81};
+  std::cout << "Top 3 scores: ";
+  for (int score : containers::top_k(scores.begin(), scores.end(), 3)) {
+    std::cout << score << " ";
+  }
+  std::cout << std::endl << std::endl;
+}
+
+// Push every element, then pop them all
+template <typename Heap>
+void push_pop(const std::vector<int>& data) {
+  Heap heap;
+  for (int val : data) {
+    heap.push(val);
+  }
+  while (!heap.empty()) {
+    heap.pop();
+  }
+}
+
+// Scheduler-style workload: ids enter with a priority, then get
+// rescheduled earlier many times before they are all drained.
+void indexed_heap_reschedule(const std::vector<int>& data, const std::vector<size_t>& order) {
+  containers::IndexedHeap<int> heap(data.size());
+  std::vector<int> prio(data.begin(), data.end());
+  for (size_t id = 0; id < data.size(); ++id) {
+    heap.push(id, prio[id]);
+  }
+  for (size_t id : order) {
+    prio[id] -= 1 + prio[id] / 2;
+    heap.decrease_key(id, prio[id]);
+  }
+  while (!heap.empty()) {
+    heap.pop();
+  }
+}
+
+// The same workload on priority_queue, which cannot change a priority:
+// push a duplicate and skip stale entries when they surface ("lazy deletion")
+void lazy_priority_queue_reschedule(const std::vector<int>& data, const std::vector<size_t>& order) {
+  using Entry = std::pair<int, size_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+  std::vector<int> prio(data.begin(), data.end());
+  for (size_t id = 0; id < data.size(); ++id) {
+    heap.push({prio[id], id});
+  }
+  for (size_t id : order) {
+    prio[id] -= 1 + prio[id] / 2;
+    heap.push({prio[id], id});
+  }
+  std::vector<bool> done(data.size(), false);
+  while (!heap.empty()) {
+    Entry top = heap.top();
+    heap.pop();
+    if (done[top.second] || top.first != prio[top.second]) {
+      continue;  // Stale duplicate
+    }
+    done[top.second] = true;
+  }
+}
+
+// Timer workload: schedule n timers with random delays, reschedule each
+// one once (an idle timeout pushed back by activity), then run the clock
+// until all have fired. Returns the nanoseconds of each phase.
+struct TimerTimes {
+  double schedule, reschedule, drain;
+};
+
+TimerTimes time_timer_wheel(const std::vector<uint32_t>& delays, const std::vector<uint32_t>& redelays) {
+  const size_t n = delays.size();
+  net::TimerWheel wheel;
+  std::vector<net::Timer> timers(n);
+  size_t fired = 0;
+  for (net::Timer& timer : timers) {
+    timer.set_callback([&fired] { ++fired; });
+  }
+  TimerTimes times;
+  times.schedule = bench::time_ns([&] {
+    for (size_t i = 0; i < n; ++i) {
+      wheel.schedule(timers[i], delays[i]);
+    }
+  });
+  times.reschedule = bench::time_ns([&] {
+    for (size_t i = 0; i < n; ++i) {
+      wheel.schedule(timers[i], redelays[i]);  // Cancel + insert, O(1)
+    }
+  });
+  times.drain = bench::time_ns([&] {
+    for (uint64_t tick = 1; !wheel.empty(); ++tick) {
+      wheel.advance(tick);
+    }
+  });
+  if (fired != n) {
+    std::cout << "    (timer wheel fired " << fired << " of " << n << ")" << std::endl;
+  }
+  return times;
+}
+
+// The same on priority_queue, which cannot cancel: every reschedule pushes
+// a new entry and bumps the timer's generation so the old one is skipped
+TimerTimes time_timer_priority_queue(const std::vector<uint32_t>& delays, const std::vector<uint32_t>& redelays) {
+  struct Entry {
+    uint64_t deadline;
+    uint32_t id;
+    uint32_t generation;
+    bool operator>(const Entry& other) const { return deadline > other.deadline; }
+  };
+  const size_t n = delays.size();
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  std::vector<uint32_t> generation(n, 0);
+  size_t fired = 0;
+  TimerTimes times;
+  times.schedule = bench::time_ns([&] {
+    for (size_t i = 0; i < n; ++i) {
+      queue.push({delays[i], static_cast<uint32_t>(i), 0});
+    }
+  });
+  times.reschedule = bench::time_ns([&] {
+    for (size_t i = 0; i < n; ++i) {
+      queue.push({redelays[i], static_cast<uint32_t>(i), ++generation[i]});
+    }
+  });
+  times.drain = bench::time_ns([&] {
+    for (uint64_t tick = 1; !queue.empty(); ++tick) {
+      while (!queue.empty() && queue.top().deadline <= tick) {
+        Entry top = queue.top();
+        queue.pop();
+        if (top.generation == generation[top.id]) {
+          ++fired;
+        }
+      }
+    }
+  });
+  if (fired != n) {
+    std::cout << "    (priority_queue fired " << fired << " of " << n << ")" << std::endl;
+  }
+  return times;
+}
+
+void demonstrate_timer_wheel() {
+  std::cout << "=== TIMER WHEEL ===" << std::endl;
+
+  // Scheduling by deadline is the classic heap application, but timers are
+  // mostly cancelled or pushed back before they fire (think idle timeouts
+  // re-armed on every read). A hierarchical timer wheel hashes each timer
+  // into a slot by its deadline instead: schedule, cancel and the per-tick
+  // expiry check are all O(1), and a cancel really removes the timer.
+  net::TimerWheel wheel;
+  std::vector<std::string> log;
+  net::Timer flush([&log] { log.push_back("flush@5"); });
+  net::Timer retry([&log] { log.push_back("retry@20"); });
+  net::Timer idle([&log] { log.push_back("idle@40"); });
+  net::Timer lease([&log] { log.push_back("lease@3000"); });
+  wheel.schedule(idle, 10);
+  wheel.schedule(retry, 20);
+  wheel.schedule(flush, 5);
+  wheel.schedule(lease, 3000);  // Lands in a higher level, cascades down later
+  wheel.advance(8);
+  wheel.schedule(idle, 32);     // Activity at tick 8: push the idle timeout back
+  retry.cancel();
+  std::cout << "Outstanding timers at tick 8: " << wheel.size() << std::endl;
+  wheel.advance(5000);
+  std::cout << "Fired in order: ";
+  for (const std::string& entry : log) {
+    std::cout << entry << " ";
+  }
+  std::cout << "(retry was cancelled)" << std::endl;
+
+  // Benchmark against std::priority_queue with lazy cancellation. Delays
+  // are up to a minute of millisecond ticks, as for network timeouts.
+  bench::Suite suite("heaps_timers");
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<uint32_t> delay(1, 60000);
+  for (size_t n : {size_t(100000), size_t(1000000)}) {
+    std::vector<uint32_t> delays(n), redelays(n);
+    for (size_t i = 0; i < n; ++i) {
+      delays[i] = delay(gen);
+      redelays[i] = delay(gen);
+    }
+    // Each repetition runs all three phases; collect one sample per phase
+    auto measure = [&](const std::string& label, TimerTimes (*workload)(const std::vector<uint32_t>&,
+                                                                         const std::vector<uint32_t>&)) {
+      std::vector<double> schedule, reschedule, drain;
+      for (int i = 0; i < suite.options().warmup; ++i) {
+        workload(delays, redelays);
+      }
+      for (int i = 0; i < suite.options().repetitions; ++i) {
+        TimerTimes times = workload(delays, redelays);
+        schedule.push_back(times.schedule);
+        reschedule.push_back(times.reschedule);
+        drain.push_back(times.drain);
+      }
+      suite.add(label + " schedule", schedule, n);
+      suite.add(label + " reschedule", reschedule, n);
+      suite.add(label + " drain", drain, n);
+    };
+    std::cout << "\n" << n << " outstanding timers:" << std::endl;
+    measure(std::to_string(n) + " priority_queue", time_timer_priority_queue);
+    measure(std::to_string(n) + " TimerWheel", time_timer_wheel);
+  }
+  std::cout << std::endl;
+}
+
 void demonstrate_performance_analysis() {
   std::cout << "=== PERFORMANCE ANALYSIS ===" << std::endl;
   
@@ -382,39 +646,32 @@ void demonstrate_performance_analysis() {
     test_data.push_back(dis(gen));
   }
   
-  // Test 1: Heap construction
-  auto start = std::chrono::high_resolution_clock::now();
-  std::priority_queue<int> pq(test_data.begin(), test_data.end());
-  auto end = std::chrono::high_resolution_clock::now();
-  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-  std::cout << "Heap construction (" << data_size << " elements): " << duration.count() << " microseconds" << std::endl;
-  
-  // Test 2: Sequential insertions
-  start = std::chrono::high_resolution_clock::now();
-  std::priority_queue<int> pq2;
-  for (int val : test_data) {
-    pq2.push(val);
-  }
-  end = std::chrono::high_resolution_clock::now();
-  duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-  std::cout << "Sequential insertions: " << duration.count() << " microseconds" << std::endl;
-  
-  // Test 3: Extract all elements
-  start = std::chrono::high_resolution_clock::now();
-  while (!pq.empty()) {
-    pq.pop();
-  }
-  end = std::chrono::high_resolution_clock::now();
-  duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-  std::cout << "Extract all elements: " << duration.count() << " microseconds" << std::endl;
-  
-  // Test 4: Compare with sorted approach
-  std::vector<int> sorted_data = test_data;
-  start = std::chrono::high_resolution_clock::now();
-  std::sort(sorted_data.begin(), sorted_data.end(), std::greater<int>());
-  end = std::chrono::high_resolution_clock::now();
-  duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-  std::cout << "Full sort (for comparison): " << duration.count() << " microseconds" << std::endl;
+  // Tests 1-4, each repeated with warmup (see benchmark.h)
+  bench::Suite suite("heaps");
+  std::cout << data_size << " elements:" << std::endl;
+  suite.run("heap construction", [&] {
+    std::priority_queue<int> pq(test_data.begin(), test_data.end());
+    bench::do_not_optimize(pq.top());
+  }, data_size);
+  suite.run("sequential insertions", [&] {
+    std::priority_queue<int> pq;
+    for (int val : test_data) {
+      pq.push(val);
+    }
+    bench::do_not_optimize(pq.top());
+  }, data_size);
+  std::priority_queue<int> pq;
+  suite.run_with_setup("extract all elements", [&] {
+    pq = std::priority_queue<int>(test_data.begin(), test_data.end());
+  }, [&] {
+    while (!pq.empty()) {
+      pq.pop();
+    }
+  }, data_size);
+  std::vector<int> sorted_data;
+  suite.run_with_setup("full sort (for comparison)", [&] { sorted_data = test_data; }, [&] {
+    std::sort(sorted_data.begin(), sorted_data.end(), std::greater<int>());
+  }, data_size);
   
   std::cout << "\nTime Complexity Summary:" << std::endl;
   std::cout << "  Insertion: O(log n)" << std::endl;
@@ -424,7 +681,71 @@ void demonstrate_performance_analysis() {
   std::cout << "  Heapsort: O(n log n)" << std::endl;
   
   std::cout << "\nSpace Complexity: O(n)" << std::endl;
-  
+
+  // Side by side across data sizes
+  concurrency::WorkStealingPool pool(std::max(2u, std::thread::hardware_concurrency()));
+  const size_t k = 100;
+  for (int size : {10000, 100000, 1000000}) {
+    std::vector<int> data(size);
+    for (int& val : data) {
+      val = dis(gen);
+    }
+    std::vector<size_t> order(size);
+    for (size_t& id : order) {
+      id = gen() % size;
+    }
+    std::string n = std::to_string(size) + " ";
+
+    std::cout << "\n" << size << " elements, push all + pop all:" << std::endl;
+    suite.run(n + "std::priority_queue (binary)", [&] { push_pop<std::priority_queue<int>>(data); }, size);
+    suite.run(n + "DaryHeap<2>", [&] { push_pop<containers::DaryHeap<int, 2>>(data); }, size);
+    suite.run(n + "DaryHeap<4>", [&] { push_pop<containers::DaryHeap<int, 4>>(data); }, size);
+    suite.run(n + "DaryHeap<8>", [&] { push_pop<containers::DaryHeap<int, 8>>(data); }, size);
+
+    std::cout << "push all + " << size << " priority decreases + drain:" << std::endl;
+    suite.run(n + "priority_queue, lazy deletion", [&] { lazy_priority_queue_reschedule(data, order); }, size);
+    suite.run(n + "IndexedHeap::decrease_key", [&] { indexed_heap_reschedule(data, order); }, size);
+
+    std::cout << "top " << k << ":" << std::endl;
+    std::vector<int> best;
+    suite.run(n + "full sort", [&] {
+      std::vector<int> copy = data;
+      std::sort(copy.begin(), copy.end(), std::greater<int>());
+      copy.resize(k);
+      best = copy;
+    }, size);
+    suite.run(n + "std::partial_sort_copy", [&] {
+      std::vector<int> out(k);
+      std::partial_sort_copy(data.begin(), data.end(), out.begin(), out.end(), std::greater<int>());
+      bench::do_not_optimize(out.data());
+    }, size);
+    suite.run(n + "top_k (bounded heap)", [&] {
+      std::vector<int> out = containers::top_k(data.begin(), data.end(), k);
+      bench::do_not_optimize(out.data());
+    }, size);
+    std::vector<int> parallel;
+    suite.run(n + "parallel_top_k (" + std::to_string(pool.size()) + " workers)", [&] {
+      parallel = containers::parallel_top_k(data, k, pool);
+    }, size);
+    if (parallel != best) {
+      std::cout << "  parallel_top_k MISMATCH" << std::endl;
+    }
+  }
+
+  // Inputs small next to the pool, where chunks outnumber the elements
+  concurrency::WorkStealingPool wide_pool(4);
+  for (size_t size = 0; size <= 20; ++size) {
+    std::vector<int> data(size);
+    for (int& val : data) {
+      val = dis(gen);
+    }
+    for (size_t k = 0; k <= 6; ++k) {
+      if (containers::parallel_top_k(data, k, wide_pool) != containers::top_k(data.begin(), data.end(), k)) {
+        std::cout << "  parallel_top_k MISMATCH: " << size << " elements, k=" << k << std::endl;
+      }
+    }
+  }
+
   std::cout << std::endl;
 }
 
@@ -443,41 +764,36 @@ void demonstrate_heap_vs_alternatives() {
   }
   
   // Test finding maximum with different approaches
-  auto start = std::chrono::high_resolution_clock::now();
+  bench::Suite suite("heaps_alternatives");
+  int max_heap = 0, max_sort = 0, max_linear = 0, max_set = 0;
+  std::cout << "Finding maximum in " << n << " elements:" << std::endl;
   
   // Approach 1: Priority Queue (Heap)
-  std::priority_queue<int> pq(test_data.begin(), test_data.end());
-  int max_heap = pq.top();
-  auto end1 = std::chrono::high_resolution_clock::now();
+  suite.run("heap construction + top()", [&] {
+    std::priority_queue<int> pq(test_data.begin(), test_data.end());
+    max_heap = pq.top();
+  }, n);
   
   // Approach 2: Sorting
-  std::vector<int> sorted_data = test_data;
-  std::sort(sorted_data.begin(), sorted_data.end());
-  int max_sort = sorted_data.back();
-  auto end2 = std::chrono::high_resolution_clock::now();
+  suite.run("full sort + back()", [&] {
+    std::vector<int> sorted_data = test_data;
+    std::sort(sorted_data.begin(), sorted_data.end());
+    max_sort = sorted_data.back();
+  }, n);
   
   // Approach 3: Linear search
-  int max_linear = *std::max_element(test_data.begin(), test_data.end());
-  auto end3 = std::chrono::high_resolution_clock::now();
+  suite.run("linear search", [&] {
+    max_linear = *std::max_element(test_data.begin(), test_data.end());
+    bench::do_not_optimize(max_linear);
+  }, n);
   
   // Approach 4: Set (balanced BST)
-  std::set<int> ordered_set(test_data.begin(), test_data.end());
-  int max_set = *ordered_set.rbegin();
-  auto end4 = std::chrono::high_resolution_clock::now();
+  suite.run("set construction + rbegin()", [&] {
+    std::set<int> ordered_set(test_data.begin(), test_data.end());
+    max_set = *ordered_set.rbegin();
+  }, n);
   
-  std::cout << "Finding maximum in " << n << " elements:" << std::endl;
-  std::cout << "  Heap construction + top(): " 
-            << std::chrono::duration_cast<std::chrono::microseconds>(end1 - start).count() 
-            << " µs (result: " << max_heap << ")" << std::endl;
-  std::cout << "  Full sort + back(): " 
-            << std::chrono::duration_cast<std::chrono::microseconds>(end2 - end1).count() 
-            << " µs (result: " << max_sort << ")" << std::endl;
-  std::cout << "  Linear search: " 
-            << std::chrono::duration_cast<std::chrono::microseconds>(end3 - end2).count() 
-            << " µs (result: " << max_linear << ")" << std::endl;
-  std::cout << "  Set construction + rbegin(): " 
-            << std::chrono::duration_cast<std::chrono::microseconds>(end4 - end3).count() 
-            << " µs (result: " << max_set << ")" << std::endl;
+  std::cout << "  Results: " << max_heap << " " << max_sort << " " << max_linear << " " << max_set << std::endl;
   
   std::cout << "\nUse Cases:" << std::endl;
   std::cout << "  Heap: Dynamic insertions/deletions with priority" << std::endl;
@@ -522,6 +838,7 @@ void demonstrate_heap_operations_summary() {
   std::cout << "  K smallest elements: Use max heap of size k" << std::endl;
   std::cout << "  Running median: Use two heaps (max + min)" << std::endl;
   std::cout << "  Priority scheduling: Use max heap with custom comparator" << std::endl;
+  std::cout << "  Many cancellable timeouts: Use a timer wheel (O(1) schedule/cancel)" << std::endl;
   
   std::cout << std::endl;
 }
@@ -536,6 +853,8 @@ int main() {
   demonstrate_custom_comparators();
   demonstrate_heap_algorithms();
   demonstrate_heap_applications();
+  demonstrate_dary_and_indexed_heaps();
+  demonstrate_timer_wheel();
   demonstrate_performance_analysis();
   demonstrate_heap_vs_alternatives();
   demonstrate_heap_operations_summary();
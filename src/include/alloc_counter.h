@@ -0,0 +1,44 @@
+/**
+ * @file alloc_counter.h
+ * @brief Counts heap allocations made through operator new
+ *
+ * Link src/core/alloc_counter.cpp into an executable to replace the global
+ * operator new/delete with thin malloc/free wrappers that count calls, per
+ * thread and process-wide. Executables that do not link it can still
+ * include this header; the functions are simply not defined there.
+ *
+ * Typical use is proving that a hot path does not allocate:
+ *
+ *     memory::AllocationScope scope;
+ *     handle_request();
+ *     assert(scope.allocations() == 0);
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace memory {
+
+// operator new calls made by the calling thread so far
+uint64_t thread_allocation_count();
+
+// Bytes requested from operator new by the calling thread so far
+uint64_t thread_allocated_bytes();
+
+// operator new calls made by all threads so far
+uint64_t total_allocation_count();
+
+// Allocations (and bytes requested) by the current thread since construction
+class AllocationScope {
+public:
+    AllocationScope() : start_(thread_allocation_count()), start_bytes_(thread_allocated_bytes()) {}
+    uint64_t allocations() const { return thread_allocation_count() - start_; }
+    uint64_t bytes() const { return thread_allocated_bytes() - start_bytes_; }
+
+private:
+    uint64_t start_;
+    uint64_t start_bytes_;
+};
+
+}  // namespace memory
@@ -0,0 +1,552 @@
+/**
+ * @file async_future.h
+ * @brief Composable futures: then(), when_all(), when_any() on a WorkStealingPool
+ *
+ * std::future only offers get() and wait(), so the one way to run
+ * something after a future is ready is to block a thread on it. A graph
+ * of a few thousand dependent tasks then needs a few thousand threads.
+ * Future<T> instead takes a continuation: the thread that completes the
+ * future hands the continuation to the pool, and nothing ever waits.
+ *
+ *     Future<int> a = async(pool, [] { return 20; });
+ *     Future<int> b = std::move(a).then([](int x) { return x + 1; });
+ *     Future<std::vector<int>> all = when_all(std::move(futures));
+ *     int answer = std::move(b).get();   // The only blocking call
+ *
+ * Each future owns one heap block, its shared state: the value, the
+ * exception, a reference count and the continuation slot. The state
+ * created by then() or async() also holds the callable, so there is no
+ * second allocation for a std::function or a packaged_task.
+ *
+ * Rules, all cheaper than the alternatives:
+ * - Future and Promise are move-only; then() and get() consume the
+ *   future, so a state has at most one continuation
+ * - An exception skips every then() after it and surfaces in get()
+ * - then() runs on the pool the future came from (async(), Promise(pool),
+ *   or an explicit then(pool, f)); a future with no pool runs it inline on
+ *   the completing thread. when_all()/when_any() themselves always
+ *   complete inline: they only move values around
+ * - The pool must outlive every continuation scheduled on it; do not
+ *   block in get() from inside a pool task, chain with then() instead
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "work_stealing_pool.h"
+
+namespace concurrency {
+
+template <typename T>
+class Future;
+
+template <typename T>
+struct WhenAnyResult {
+    size_t index;  // Which input finished first
+    T value;
+};
+
+template <>
+struct WhenAnyResult<void> {
+    size_t index;
+};
+
+namespace detail {
+
+struct Unit {};
+
+// What a state stores: T, or Unit for Future<void>
+template <typename T>
+using Stored = std::conditional_t<std::is_void<T>::value, Unit, T>;
+
+template <typename F, typename T>
+struct ThenResultOf {
+    using type = std::invoke_result_t<F, T>;
+};
+
+template <typename F>
+struct ThenResultOf<F, void> {
+    using type = std::invoke_result_t<F>;
+};
+
+template <typename F, typename T>
+using ThenResult = typename ThenResultOf<std::decay_t<F>, T>::type;
+
+template <typename T>
+using WhenAllResult = std::conditional_t<std::is_void<T>::value, void, std::vector<T>>;
+
+// Something waiting on a state. on_ready() runs exactly once, on the thread
+// that completed the state (or on the one that attached it, if it was late).
+struct Continuation {
+    virtual void on_ready() noexcept = 0;
+
+protected:
+    ~Continuation() = default;
+};
+
+class StateBase {
+public:
+    explicit StateBase(WorkStealingPool* pool) : pool_(pool) {}
+    virtual ~StateBase() = default;
+
+    StateBase(const StateBase&) = delete;
+    StateBase& operator=(const StateBase&) = delete;
+
+    void add_ref() { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+    void release() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+
+    bool is_ready() const { return ready_.load(std::memory_order_acquire); }
+
+    // Only blocking waiters pay for the mutex: complete() skips it unless
+    // one has announced itself (both sides store, then load the other flag)
+    void wait() {
+        if (is_ready()) return;
+        waiters_.store(true, std::memory_order_seq_cst);
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return ready_.load(std::memory_order_seq_cst); });
+    }
+
+    // At most one per state; runs at once if the state is already complete
+    void set_continuation(Continuation* next) {
+        Continuation* expected = nullptr;
+        if (!continuation_.compare_exchange_strong(expected, next, std::memory_order_acq_rel,
+                                                   std::memory_order_acquire)) {
+            next->on_ready();
+        }
+    }
+
+    WorkStealingPool* pool() const { return pool_; }
+
+protected:
+    // After the value or error is stored. The caller must hold a reference:
+    // the continuation may drop every other one.
+    void complete() {
+        ready_.store(true, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst)) {
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            cv_.notify_all();
+        }
+        Continuation* next = continuation_.exchange(completed(), std::memory_order_acq_rel);
+        if (next != nullptr) next->on_ready();
+    }
+
+    std::exception_ptr error_;
+
+private:
+    // Marks the continuation slot of a completed state
+    static Continuation* completed() {
+        struct Completed final : Continuation {
+            void on_ready() noexcept override {}
+        };
+        static Completed marker;
+        return &marker;
+    }
+
+    std::atomic<uint32_t> refs_{1};
+    std::atomic<bool> ready_{false};
+    std::atomic<bool> waiters_{false};
+    std::atomic<Continuation*> continuation_{nullptr};
+    WorkStealingPool* pool_;  // Where then() schedules by default; may be null
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+template <typename T>
+class State : public StateBase {
+public:
+    using StateBase::StateBase;
+
+    void set_value(Stored<T> value) {
+        value_.emplace(std::move(value));
+        complete();
+    }
+
+    void set_error(std::exception_ptr error) {
+        error_ = std::move(error);
+        complete();
+    }
+
+    // Once, after completion: the value, or the stored exception rethrown
+    Stored<T> take() {
+        if (error_) std::rethrow_exception(error_);
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<Stored<T>> value_;
+};
+
+// Store compute()'s result in `state`, or whatever it threw
+template <typename R, typename Compute>
+void fulfil(State<R>& state, Compute&& compute) {
+    std::optional<Stored<R>> result;
+    try {
+        if constexpr (std::is_void<R>::value) {
+            compute();
+            result.emplace();
+        } else {
+            result.emplace(compute());
+        }
+    } catch (...) {
+        state.set_error(std::current_exception());
+        return;
+    }
+    state.set_value(std::move(*result));
+}
+
+struct Release {
+    void operator()(StateBase* state) const { state->release(); }
+};
+
+template <typename T>
+using StateRef = std::unique_ptr<State<T>, Release>;
+
+// Future's constructor and state are private; the combinators get at them here
+struct Access {
+    template <typename T>
+    static Future<T> make(State<T>* state) {
+        return Future<T>(state);
+    }
+
+    template <typename T>
+    static State<T>* detach(Future<T>& future) {
+        if (!future.valid()) throw std::future_error(std::future_errc::no_state);
+        return future.state_.release();
+    }
+};
+
+// async(): the callable lives next to the result it produces
+template <typename R, typename F>
+class AsyncState final : public State<R> {
+public:
+    template <typename Fn>
+    AsyncState(WorkStealingPool* pool, Fn&& f) : State<R>(pool), f_(std::forward<Fn>(f)) {}
+
+    void run() {
+        fulfil(*this, f_);
+        this->release();  // The reference held by the pool task
+    }
+
+private:
+    F f_;
+};
+
+// then(): waits on `parent`, then runs f(parent's value) on the pool
+template <typename T, typename R, typename F>
+class ThenState final : public State<R>, public Continuation {
+public:
+    template <typename Fn>
+    ThenState(WorkStealingPool* pool, State<T>* parent, Fn&& f)
+        : State<R>(pool), parent_(parent), f_(std::forward<Fn>(f)) {}
+
+    void on_ready() noexcept override {
+        if (WorkStealingPool* pool = this->pool()) {
+            pool->post([this] { run(); });
+        } else {
+            run();
+        }
+    }
+
+private:
+    void run() {
+        fulfil(*this, [this]() -> R {
+            if constexpr (std::is_void<T>::value) {
+                parent_->take();
+                return f_();
+            } else {
+                return f_(parent_->take());
+            }
+        });
+        parent_->release();
+        this->release();  // The reference held while waiting
+    }
+
+    State<T>* parent_;  // Owned: the future then() consumed
+    F f_;
+};
+
+// when_all(): one counter for all inputs; the last to finish collects
+template <typename T>
+class WhenAllState final : public State<WhenAllResult<T>> {
+public:
+    WhenAllState(WorkStealingPool* pool, std::vector<State<T>*> inputs)
+        : State<WhenAllResult<T>>(pool),
+          inputs_(std::move(inputs)),
+          slots_(new Slot[inputs_.size()]),
+          remaining_(inputs_.size()) {}
+
+    ~WhenAllState() override {
+        for (State<T>* input : inputs_) input->release();
+    }
+
+    void start() {
+        this->add_ref();  // Held until the last input arrives
+        if (inputs_.empty()) {
+            finish();
+            return;
+        }
+        for (size_t i = 0; i < inputs_.size(); ++i) {
+            slots_[i].owner = this;
+            inputs_[i]->set_continuation(&slots_[i]);
+        }
+    }
+
+private:
+    struct Slot final : Continuation {
+        WhenAllState* owner = nullptr;
+        void on_ready() noexcept override { owner->arrived(); }
+    };
+
+    void arrived() {
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) finish();
+    }
+
+    // The first failed input, in input order, fails the whole result
+    void finish() {
+        fulfil(*this, [this]() -> WhenAllResult<T> {
+            if constexpr (std::is_void<T>::value) {
+                for (State<T>* input : inputs_) input->take();
+            } else {
+                std::vector<T> values;
+                values.reserve(inputs_.size());
+                for (State<T>* input : inputs_) values.push_back(input->take());
+                return values;
+            }
+        });
+        this->release();
+    }
+
+    std::vector<State<T>*> inputs_;  // Owned
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<size_t> remaining_;
+};
+
+// when_any(): the first input to finish, value or exception, decides
+template <typename T>
+class WhenAnyState final : public State<WhenAnyResult<T>> {
+public:
+    WhenAnyState(WorkStealingPool* pool, std::vector<State<T>*> inputs)
+        : State<WhenAnyResult<T>>(pool), inputs_(std::move(inputs)), slots_(new Slot[inputs_.size()]) {}
+
+    ~WhenAnyState() override {
+        for (State<T>* input : inputs_) input->release();
+    }
+
+    // The slots live in this state, so it stays alive until every input
+    // has finished, not just the winner
+    void start() {
+        for (size_t i = 0; i < inputs_.size(); ++i) {
+            this->add_ref();
+            slots_[i].owner = this;
+            slots_[i].index = i;
+            inputs_[i]->set_continuation(&slots_[i]);
+        }
+    }
+
+private:
+    struct Slot final : Continuation {
+        WhenAnyState* owner = nullptr;
+        size_t index = 0;
+        void on_ready() noexcept override { owner->arrived(index); }
+    };
+
+    void arrived(size_t index) {
+        if (!decided_.exchange(true, std::memory_order_acq_rel)) {
+            fulfil(*this, [this, index]() -> WhenAnyResult<T> {
+                if constexpr (std::is_void<T>::value) {
+                    inputs_[index]->take();
+                    return WhenAnyResult<T>{index};
+                } else {
+                    return WhenAnyResult<T>{index, inputs_[index]->take()};
+                }
+            });
+        }
+        this->release();
+    }
+
+    std::vector<State<T>*> inputs_;  // Owned
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<bool> decided_{false};
+};
+
+}  // namespace detail
+
+template <typename T>
+class Future {
+public:
+    Future() = default;
+
+    bool valid() const { return state_ != nullptr; }
+    bool is_ready() const { return state_ != nullptr && state_->is_ready(); }
+
+    void wait() const {
+        if (!valid()) throw std::future_error(std::future_errc::no_state);
+        state_->wait();
+    }
+
+    // Block until ready and return the value (or throw); consumes the future
+    T get() && {
+        detail::StateRef<T> state(detail::Access::detach(*this));
+        state->wait();
+        if constexpr (std::is_void<T>::value) {
+            state->take();
+        } else {
+            return state->take();
+        }
+    }
+
+    // f(value) (f() for Future<void>) once this future is ready, on the
+    // pool it came from; consumes the future
+    template <typename F>
+    Future<detail::ThenResult<F, T>> then(F&& f) && {
+        return chain(detail::Access::detach(*this), std::forward<F>(f), nullptr);
+    }
+
+    // Same, scheduled on `pool`
+    template <typename F>
+    Future<detail::ThenResult<F, T>> then(WorkStealingPool& pool, F&& f) && {
+        return chain(detail::Access::detach(*this), std::forward<F>(f), &pool);
+    }
+
+private:
+    friend struct detail::Access;
+
+    explicit Future(detail::State<T>* state) : state_(state) {}
+
+    template <typename F>
+    static Future<detail::ThenResult<F, T>> chain(detail::State<T>* parent, F&& f, WorkStealingPool* pool) {
+        using R = detail::ThenResult<F, T>;
+        detail::StateRef<T> owned(parent);
+        auto* child = new detail::ThenState<T, R, std::decay_t<F>>(pool != nullptr ? pool : parent->pool(),
+                                                                  owned.release(), std::forward<F>(f));
+        Future<R> result = detail::Access::make<R>(child);
+        child->add_ref();  // Released by the continuation when it has run
+        parent->set_continuation(child);
+        return result;
+    }
+
+    detail::StateRef<T> state_;
+};
+
+template <typename T>
+class Promise {
+public:
+    // Continuations on the future run inline where set_value() is called
+    Promise() : state_(new detail::State<T>(nullptr)) {}
+
+    // ... or on `pool`
+    explicit Promise(WorkStealingPool& pool) : state_(new detail::State<T>(&pool)) {}
+
+    Promise(Promise&&) noexcept = default;
+    Promise& operator=(Promise&& other) noexcept {
+        if (this != &other) {
+            abandon();
+            state_ = std::move(other.state_);
+            retrieved_ = other.retrieved_;
+            satisfied_ = other.satisfied_;
+        }
+        return *this;
+    }
+
+    ~Promise() { abandon(); }
+
+    Future<T> get_future() {
+        if (!state_) throw std::future_error(std::future_errc::no_state);
+        if (retrieved_) throw std::future_error(std::future_errc::future_already_retrieved);
+        retrieved_ = true;
+        state_->add_ref();
+        return detail::Access::make<T>(state_.get());
+    }
+
+    // set_value(x), or set_value() for Promise<void>
+    template <typename... Args>
+    void set_value(Args&&... args) {
+        static_assert(sizeof...(Args) == (std::is_void<T>::value ? 0 : 1), "set_value() takes exactly one T");
+        satisfy();
+        if constexpr (std::is_void<T>::value) {
+            state_->set_value(detail::Unit{});
+        } else {
+            state_->set_value(detail::Stored<T>(std::forward<Args>(args)...));
+        }
+    }
+
+    void set_exception(std::exception_ptr error) {
+        satisfy();
+        state_->set_error(std::move(error));
+    }
+
+private:
+    void satisfy() {
+        if (!state_) throw std::future_error(std::future_errc::no_state);
+        if (satisfied_) throw std::future_error(std::future_errc::promise_already_satisfied);
+        satisfied_ = true;
+    }
+
+    // Like std::promise: dropped unsatisfied, the future gets broken_promise
+    void abandon() {
+        if (state_ && !satisfied_) {
+            state_->set_error(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+    }
+
+    detail::StateRef<T> state_;
+    bool retrieved_ = false;
+    bool satisfied_ = false;
+};
+
+// Run f() on the pool; one allocation holds both f and its result
+template <typename F>
+Future<std::invoke_result_t<std::decay_t<F>&>> async(WorkStealingPool& pool, F&& f) {
+    using R = std::invoke_result_t<std::decay_t<F>&>;
+    auto* state = new detail::AsyncState<R, std::decay_t<F>>(&pool, std::forward<F>(f));
+    Future<R> result = detail::Access::make<R>(state);
+    state->add_ref();  // Released by the task when it has run
+    pool.post([state] { state->run(); });
+    return result;
+}
+
+// Ready when every input is: their values in input order, or the first
+// failure in input order. Consumes the inputs.
+template <typename T>
+Future<detail::WhenAllResult<T>> when_all(std::vector<Future<T>> futures) {
+    std::vector<detail::State<T>*> inputs;
+    inputs.reserve(futures.size());
+    for (Future<T>& future : futures) inputs.push_back(detail::Access::detach(future));
+    WorkStealingPool* pool = inputs.empty() ? nullptr : inputs.front()->pool();
+    auto* state = new detail::WhenAllState<T>(pool, std::move(inputs));
+    Future<detail::WhenAllResult<T>> result = detail::Access::make<detail::WhenAllResult<T>>(state);
+    state->start();
+    return result;
+}
+
+// Ready when the first input is, with its index. Consumes the inputs.
+template <typename T>
+Future<WhenAnyResult<T>> when_any(std::vector<Future<T>> futures) {
+    if (futures.empty()) throw std::invalid_argument("when_any() needs at least one future");
+    std::vector<detail::State<T>*> inputs;
+    inputs.reserve(futures.size());
+    for (Future<T>& future : futures) inputs.push_back(detail::Access::detach(future));
+    WorkStealingPool* pool = inputs.front()->pool();
+    auto* state = new detail::WhenAnyState<T>(pool, std::move(inputs));
+    Future<WhenAnyResult<T>> result = detail::Access::make<WhenAnyResult<T>>(state);
+    state->start();
+    return result;
+}
+
+}  // namespace concurrency
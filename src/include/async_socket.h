@@ -0,0 +1,230 @@
+/**
+ * @file async_socket.h
+ * @brief co_await-able accept / recv / send on a net::EventLoop (C++20)
+ *
+ * AsyncSocket puts a non-blocking descriptor on an EventLoop on behalf of
+ * the coroutines using it. It does not own the descriptor. Each
+ * awaitable first makes the system call right away. Only if that would
+ * block (EAGAIN) does the coroutine suspend. The socket then asks the
+ * loop for readiness, and when the loop reports it the socket retries
+ * the call on the loop thread. The coroutine resumes once the call
+ * completes:
+ *
+ *     ssize_t n = co_await net::async_recv(socket, buffer, sizeof(buffer));
+ *     int client = co_await net::async_accept(listener, &addr, &addr_len);
+ *     ssize_t sent = co_await net::async_send(socket, reply.data(), reply.size());
+ *     co_await net::async_sleep(loop, 100);   // A timer on the loop's wheel
+ *
+ * Results are those of the system call (-1 with errno set on failure).
+ * async_send() completes only once everything is sent or the connection
+ * fails. At most one coroutine may wait per direction (read / write).
+ *
+ * The registration is level-triggered and kept across operations. After
+ * a recv() completes the read interest stays armed, betting that the next
+ * operation is another recv(); only a readiness report that nobody waits
+ * for drops it. A recv-process-recv session loop therefore costs no
+ * epoll_ctl() calls at all. Write interest is dropped as soon as a send
+ * completes, since a socket is nearly always writable.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "event_loop.h"
+
+namespace net {
+
+class AsyncSocket : public EventHandler {
+public:
+    // A suspended operation. attempt() makes the system call and returns
+    // false if it would block; it is retried each time the socket is ready.
+    class Operation {
+    public:
+        virtual bool attempt() = 0;
+
+        std::coroutine_handle<> waiter;
+
+    protected:
+        ~Operation() = default;
+    };
+
+    // fd must already be non-blocking; it is registered on first use
+    AsyncSocket(EventLoop& loop, int fd) : loop_(loop), fd_(fd) {}
+    ~AsyncSocket() override { remove(); }
+
+    AsyncSocket(const AsyncSocket&) = delete;
+    AsyncSocket& operator=(const AsyncSocket&) = delete;
+
+    int fd() const { return fd_; }
+    EventLoop& loop() { return loop_; }
+
+    // Park `operation` until the socket is ready in `direction` (EVENT_READ
+    // or EVENT_WRITE); false if the loop refused the registration
+    bool wait(Operation& operation, uint32_t direction);
+
+    // Unregister from the loop; call before closing the descriptor
+    void remove();
+
+    void handle_event(uint32_t events) override;
+
+private:
+    bool update_interest(uint32_t wanted);
+
+    EventLoop& loop_;
+    int fd_;
+    Operation* reader_ = nullptr;
+    Operation* writer_ = nullptr;
+    uint32_t interest_ = 0;
+    bool registered_ = false;
+};
+
+// Common part of the awaitables: try at once, suspend only if it would block
+template <uint32_t DIRECTION>
+class SocketAwaiter : public AsyncSocket::Operation {
+public:
+    explicit SocketAwaiter(AsyncSocket& socket) : socket_(socket) {}
+
+    bool await_ready() { return attempt(); }
+
+    // Not suspending after all resumes at once, with the error in result_
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        waiter = awaiting;
+        if (socket_.wait(*this, DIRECTION)) return true;
+        complete(-1);
+        return false;
+    }
+
+    ssize_t await_resume() const {
+        errno = error_;  // The loop may have made other calls since
+        return result_;
+    }
+
+protected:
+    // Record the outcome of the system call just made
+    bool complete(ssize_t result) {
+        result_ = result;
+        error_ = result < 0 ? errno : 0;
+        return true;
+    }
+
+    static bool would_block() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+
+    AsyncSocket& socket_;
+    ssize_t result_ = -1;
+    int error_ = 0;
+};
+
+class RecvAwaiter : public SocketAwaiter<EVENT_READ> {
+public:
+    RecvAwaiter(AsyncSocket& socket, void* buffer, size_t length)
+        : SocketAwaiter(socket), buffer_(buffer), length_(length) {}
+
+    bool attempt() override;
+
+private:
+    void* buffer_;
+    size_t length_;
+};
+
+class SendAwaiter : public SocketAwaiter<EVENT_WRITE> {
+public:
+    SendAwaiter(AsyncSocket& socket, const void* data, size_t length)
+        : SocketAwaiter(socket), data_(static_cast<const char*>(data)), length_(length) {}
+
+    bool attempt() override;
+
+private:
+    const char* data_;
+    size_t length_;
+    size_t sent_ = 0;
+};
+
+class AcceptAwaiter : public SocketAwaiter<EVENT_READ> {
+public:
+    AcceptAwaiter(AsyncSocket& listener, sockaddr* address, socklen_t* address_length)
+        : SocketAwaiter(listener), address_(address), address_length_(address_length) {}
+
+    // The accepted descriptor (or -1)
+    int await_resume() const { return static_cast<int>(SocketAwaiter::await_resume()); }
+
+    bool attempt() override;
+
+private:
+    sockaddr* address_;
+    socklen_t* address_length_;
+    socklen_t initial_length_ = address_length_ != nullptr ? *address_length_ : 0;
+};
+
+// Until the socket is readable / writable (for callers that make the system
+// call themselves, e.g. a gather write of an OutputBuffer)
+template <uint32_t DIRECTION>
+class ReadinessAwaiter : public SocketAwaiter<DIRECTION> {
+public:
+    using SocketAwaiter<DIRECTION>::SocketAwaiter;
+
+    // Not ready when first asked, ready when the loop says so
+    bool attempt() override {
+        if (!asked_) {
+            asked_ = true;
+            return false;
+        }
+        return this->complete(0);
+    }
+
+private:
+    bool asked_ = false;
+};
+
+// Resumes the coroutine on the loop thread delay_ms from now
+class SleepAwaiter {
+public:
+    SleepAwaiter(EventLoop& loop, uint64_t delay_ms) : loop_(loop), delay_ms_(delay_ms) {}
+
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<> awaiting) {
+        timer_.set_callback([awaiting] { awaiting.resume(); });
+        loop_.schedule_after(timer_, delay_ms_);
+    }
+    void await_resume() const {}
+
+private:
+    EventLoop& loop_;
+    uint64_t delay_ms_;
+    Timer timer_;  // In the coroutine frame while suspended
+};
+
+// Bytes received, 0 at end of stream, -1 on error
+inline RecvAwaiter async_recv(AsyncSocket& socket, void* buffer, size_t length) {
+    return RecvAwaiter(socket, buffer, length);
+}
+
+// All `length` bytes, or -1 on error (SIGPIPE suppressed)
+inline SendAwaiter async_send(AsyncSocket& socket, const void* data, size_t length) {
+    return SendAwaiter(socket, data, length);
+}
+
+// The new connection's descriptor (blocking mode, like accept()), or -1
+inline AcceptAwaiter async_accept(AsyncSocket& listener, sockaddr* address = nullptr,
+                                  socklen_t* address_length = nullptr) {
+    return AcceptAwaiter(listener, address, address_length);
+}
+
+inline SleepAwaiter async_sleep(EventLoop& loop, uint64_t delay_ms) {
+    return SleepAwaiter(loop, delay_ms);
+}
+
+inline ReadinessAwaiter<EVENT_READ> async_readable(AsyncSocket& socket) {
+    return ReadinessAwaiter<EVENT_READ>(socket);
+}
+
+inline ReadinessAwaiter<EVENT_WRITE> async_writable(AsyncSocket& socket) {
+    return ReadinessAwaiter<EVENT_WRITE>(socket);
+}
+
+}  // namespace net
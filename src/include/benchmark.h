@@ -0,0 +1,295 @@
+/**
+ * @file benchmark.h
+ * @brief Micro-benchmark harness: warmup, repeated runs, robust statistics
+ *
+ * Timing a block once with two clock reads measures whatever else the
+ * machine was doing at that moment as much as the code. Suite::run()
+ * instead runs the body a few times untimed (cold caches, page faults,
+ * lazy binding), then times it `repetitions` times and reports the median
+ * and the median absolute deviation (MAD), which a single outlier cannot
+ * move, plus percentiles:
+ *
+ *     bench::Suite suite("heaps");
+ *     suite.run("priority_queue push+pop", [&] { ... }, data.size());
+ *
+ * prints one line per benchmark, and when BENCH_DIR is set every Suite
+ * also writes <BENCH_DIR>/<suite>.json and .csv when it is destroyed (the
+ * `benchmarks` CMake target sets it), so results can be compared between
+ * builds.
+ *
+ * do_not_optimize() / clobber_memory() keep the compiler from deleting or
+ * hoisting benchmarked work; prefer them to storing into a volatile, which
+ * also forces a real memory write on every iteration.
+ *
+ * Environment overrides: BENCH_REPETITIONS, BENCH_WARMUP, BENCH_DIR.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// The value must be computed, as if something read it
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// ... and may have been modified, so it cannot be constant-folded either
+template <typename T>
+inline void do_not_optimize(T& value) {
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#else
+    // GCC rejects "+r,m" when it cannot keep the value in a register
+    asm volatile("" : "+m,r"(value) : : "memory");
+#endif
+}
+
+// All pending memory writes must happen before this point
+inline void clobber_memory() { asm volatile("" : : : "memory"); }
+
+// One timed call, for the phases of a larger workload: collect one sample
+// per repetition and hand them to Suite::add()
+template <typename Fn>
+inline double time_ns(Fn&& fn) {
+    clobber_memory();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    clobber_memory();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Options {
+    int warmup = 1;       // Untimed runs first
+    int repetitions = 5;  // Timed runs
+    bool print = true;    // One summary line per result; off for callers with their own report
+
+    // Defaults, overridden by BENCH_WARMUP / BENCH_REPETITIONS
+    static Options from_environment() { return from_environment(Options()); }
+
+    // Same, starting from the caller's own defaults
+    static Options from_environment(Options options) {
+        if (const char* value = std::getenv("BENCH_WARMUP")) options.warmup = std::max(0, std::atoi(value));
+        if (const char* value = std::getenv("BENCH_REPETITIONS")) {
+            options.repetitions = std::max(1, std::atoi(value));
+        }
+        return options;
+    }
+};
+
+struct Result {
+    std::string name;
+    uint64_t items = 1;               // Work items per run, for throughput
+    std::vector<double> samples_ns;  // One per timed run, in run order
+    double median_ns = 0;
+    double mad_ns = 0;  // Median absolute deviation
+    double min_ns = 0;
+    double max_ns = 0;
+    double mean_ns = 0;
+    double p10_ns = 0;
+    double p90_ns = 0;
+
+    double items_per_second() const { return median_ns > 0 ? items * 1e9 / median_ns : 0; }
+    double ns_per_item() const { return items > 0 ? median_ns / static_cast<double>(items) : median_ns; }
+};
+
+// Linear interpolation between closest ranks; sorted must not be empty
+inline double percentile(const std::vector<double>& sorted, double percent) {
+    double rank = percent / 100.0 * static_cast<double>(sorted.size() - 1);
+    size_t low = static_cast<size_t>(rank);
+    size_t high = std::min(low + 1, sorted.size() - 1);
+    return sorted[low] + (sorted[high] - sorted[low]) * (rank - static_cast<double>(low));
+}
+
+inline void summarize(Result& result) {
+    std::vector<double> sorted = result.samples_ns;
+    std::sort(sorted.begin(), sorted.end());
+    result.median_ns = percentile(sorted, 50);
+    result.min_ns = sorted.front();
+    result.max_ns = sorted.back();
+    result.p10_ns = percentile(sorted, 10);
+    result.p90_ns = percentile(sorted, 90);
+    double sum = 0;
+    for (double sample : sorted) sum += sample;
+    result.mean_ns = sum / static_cast<double>(sorted.size());
+    std::vector<double> deviations;
+    for (double sample : sorted) deviations.push_back(std::fabs(sample - result.median_ns));
+    std::sort(deviations.begin(), deviations.end());
+    result.mad_ns = percentile(deviations, 50);
+}
+
+// "812.4ns", "12.31us", "4.20ms", "1.50s"
+inline std::string format_ns(double ns) {
+    char text[32];
+    if (ns < 1e3) {
+        snprintf(text, sizeof(text), "%.1fns", ns);
+    } else if (ns < 1e6) {
+        snprintf(text, sizeof(text), "%.2fus", ns / 1e3);
+    } else if (ns < 1e9) {
+        snprintf(text, sizeof(text), "%.2fms", ns / 1e6);
+    } else {
+        snprintf(text, sizeof(text), "%.2fs", ns / 1e9);
+    }
+    return text;
+}
+
+class Suite {
+public:
+    explicit Suite(std::string name, Options options = Options::from_environment())
+        : name_(std::move(name)), options_(options) {}
+
+    ~Suite() {
+        if (const char* directory = std::getenv("BENCH_DIR")) write(directory);
+    }
+
+    Suite(const Suite&) = delete;
+    Suite& operator=(const Suite&) = delete;
+
+    // Time fn() and print a summary line. `items` is the number of work
+    // items one call processes; it turns the median into a throughput.
+    // The returned reference stays valid for the life of the suite.
+    template <typename Fn>
+    const Result& run(const std::string& name, Fn&& fn, uint64_t items = 1) {
+        return run_with_setup(name, [] {}, std::forward<Fn>(fn), items);
+    }
+
+    // Same, calling setup() untimed before every run (e.g. to refill a
+    // container that fn() drains)
+    template <typename Setup, typename Fn>
+    const Result& run_with_setup(const std::string& name, Setup&& setup, Fn&& fn, uint64_t items = 1) {
+        Result result;
+        result.name = name;
+        result.items = items;
+        for (int i = 0; i < options_.warmup; ++i) {
+            setup();
+            fn();
+        }
+        for (int i = 0; i < options_.repetitions; ++i) {
+            setup();
+            clobber_memory();
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            clobber_memory();
+            auto end = std::chrono::steady_clock::now();
+            result.samples_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        summarize(result);
+        print(result);
+        results_.push_back(std::move(result));
+        return results_.back();
+    }
+
+    // Record a measurement taken some other way (e.g. one sample per
+    // thread); printed and exported like the others
+    const Result& add(const std::string& name, std::vector<double> samples_ns, uint64_t items = 1) {
+        Result result;
+        result.name = name;
+        result.items = items;
+        result.samples_ns = std::move(samples_ns);
+        if (result.samples_ns.empty()) result.samples_ns.push_back(0);
+        summarize(result);
+        print(result);
+        results_.push_back(std::move(result));
+        return results_.back();
+    }
+
+    void print(const Result& result) const {
+        if (!options_.print) return;
+        std::string line = "  " + result.name;
+        if (line.size() < 40) line.resize(40, ' ');
+        line += " median " + format_ns(result.median_ns) + " ± " + format_ns(result.mad_ns) + "  p90 " +
+                format_ns(result.p90_ns);
+        if (result.items > 1) {
+            char rate[64];
+            snprintf(rate, sizeof(rate), "  %s/item  %.3g items/s", format_ns(result.ns_per_item()).c_str(),
+                     result.items_per_second());
+            line += rate;
+        }
+        std::printf("%s\n", line.c_str());
+        std::fflush(stdout);
+    }
+
+    const std::string& name() const { return name_; }
+    const Options& options() const { return options_; }
+    const std::deque<Result>& results() const { return results_; }
+
+    std::string to_json() const {
+        std::string out = "{\n  \"suite\": \"" + escape(name_) + "\",\n  \"repetitions\": " +
+                          std::to_string(options_.repetitions) + ",\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            char fields[512];
+            snprintf(fields, sizeof(fields),
+                     "\"items\": %llu, \"median_ns\": %.1f, \"mad_ns\": %.1f, \"min_ns\": %.1f, "
+                     "\"p10_ns\": %.1f, \"p90_ns\": %.1f, \"max_ns\": %.1f, \"mean_ns\": %.1f, "
+                     "\"items_per_second\": %.1f",
+                     static_cast<unsigned long long>(r.items), r.median_ns, r.mad_ns, r.min_ns, r.p10_ns, r.p90_ns,
+                     r.max_ns, r.mean_ns, r.items_per_second());
+            out += "    {\"name\": \"" + escape(r.name) + "\", " + fields + "}";
+            out += i + 1 < results_.size() ? ",\n" : "\n";
+        }
+        out += "  ]\n}\n";
+        return out;
+    }
+
+    std::string to_csv() const {
+        std::string out = "suite,name,items,median_ns,mad_ns,min_ns,p10_ns,p90_ns,max_ns,mean_ns,items_per_second\n";
+        for (const Result& r : results_) {
+            char fields[256];
+            snprintf(fields, sizeof(fields), ",%llu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+                     static_cast<unsigned long long>(r.items), r.median_ns, r.mad_ns, r.min_ns, r.p10_ns, r.p90_ns,
+                     r.max_ns, r.mean_ns, r.items_per_second());
+            out += csv_field(name_) + "," + csv_field(r.name) + fields;
+        }
+        return out;
+    }
+
+    // Write <directory>/<suite>.json and .csv; false if either fails
+    bool write(const std::string& directory) const {
+        std::string base = directory + "/" + name_;
+        std::ofstream json(base + ".json");
+        json << to_json();
+        std::ofstream csv(base + ".csv");
+        csv << to_csv();
+        return json.good() && csv.good();
+    }
+
+private:
+    static std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) continue;
+            out += c;
+        }
+        return out;
+    }
+
+    static std::string csv_field(const std::string& text) {
+        if (text.find_first_of(",\"\n") == std::string::npos) return text;
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    std::string name_;
+    Options options_;
+    std::deque<Result> results_;  // Stable references for run() / add() callers
+};
+
+}  // namespace bench
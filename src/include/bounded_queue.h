@@ -0,0 +1,305 @@
+/**
+ * @file bounded_queue.h
+ * @brief Bounded lock-free ring buffers (MPMC and SPSC) and a blocking adapter
+ *
+ * MpmcQueue is Dmitry Vyukov's bounded MPMC queue: every cell carries a
+ * sequence number that says whose turn it is (producer of lap n, or
+ * consumer of lap n), so a push or pop is one CAS on the shared position
+ * plus one release store on the cell - no lock, and no futex wake.
+ *
+ * SpscQueue is the single-producer / single-consumer special case. With
+ * only one writer per index no CAS is needed, and each side keeps a cached
+ * copy of the other side's index so it touches the shared line only when
+ * the ring looks full (or empty).
+ *
+ * Both are non-blocking (try_push / try_pop). BlockingQueue<Q> wraps either
+ * one with push() / pop() that spin for a short while and then park on a
+ * condition variable, plus close() to end a producer-consumer run.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "cache_line.h"
+
+namespace concurrency {
+
+// Capacity is rounded up to a power of two (minimum 2)
+inline size_t round_up_pow2(size_t n) {
+    size_t capacity = 2;
+    while (capacity < n) capacity <<= 1;
+    return capacity;
+}
+
+template <typename T>
+class MpmcQueue {
+public:
+    using value_type = T;
+
+    explicit MpmcQueue(size_t capacity)
+        : mask_(round_up_pow2(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcQueue() {
+        T discarded;
+        while (try_pop(discarded)) {
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    template <typename U>
+    bool try_push(U&& value) {
+        size_t pos = enqueue_pos_->load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                // Cell is free for this lap; claim the position
+                if (enqueue_pos_->compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // Full: the consumer of the previous lap is not done
+            } else {
+                pos = enqueue_pos_->load(std::memory_order_relaxed);  // Another producer won
+            }
+        }
+        new (&cell->storage) T(std::forward<U>(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        size_t pos = dequeue_pos_->load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_->compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // Empty
+            } else {
+                pos = dequeue_pos_->load(std::memory_order_relaxed);
+            }
+        }
+        T* item = std::launder(reinterpret_cast<T*>(&cell->storage));
+        out = std::move(*item);
+        item->~T();
+        // Hand the cell to the producer of the next lap
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Approximate while producers and consumers are running
+    size_t size_approx() const {
+        size_t head = dequeue_pos_->load(std::memory_order_relaxed);
+        size_t tail = enqueue_pos_->load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    CachePadded<std::atomic<size_t>> enqueue_pos_{0};
+    CachePadded<std::atomic<size_t>> dequeue_pos_{0};
+};
+
+template <typename T>
+class SpscQueue {
+public:
+    using value_type = T;
+
+    explicit SpscQueue(size_t capacity)
+        : mask_(round_up_pow2(capacity) - 1), slots_(new Slot[mask_ + 1]) {}
+
+    ~SpscQueue() {
+        T discarded;
+        while (try_pop(discarded)) {
+        }
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer thread only
+    template <typename U>
+    bool try_push(U&& value) {
+        size_t tail = tail_->load(std::memory_order_relaxed);
+        if (tail - producer_.cached_head > mask_) {
+            producer_.cached_head = head_->load(std::memory_order_acquire);
+            if (tail - producer_.cached_head > mask_) return false;
+        }
+        new (&slots_[tail & mask_]) T(std::forward<U>(value));
+        tail_->store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool try_pop(T& out) {
+        size_t head = head_->load(std::memory_order_relaxed);
+        if (head == consumer_.cached_tail) {
+            consumer_.cached_tail = tail_->load(std::memory_order_acquire);
+            if (head == consumer_.cached_tail) return false;
+        }
+        T* item = std::launder(reinterpret_cast<T*>(&slots_[head & mask_]));
+        out = std::move(*item);
+        item->~T();
+        head_->store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    using Slot = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    // Each side's private copy of the other side's index
+    struct alignas(CACHE_LINE_SIZE) ProducerCache {
+        size_t cached_head = 0;
+    };
+    struct alignas(CACHE_LINE_SIZE) ConsumerCache {
+        size_t cached_tail = 0;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    CachePadded<std::atomic<size_t>> head_{0};
+    CachePadded<std::atomic<size_t>> tail_{0};
+    ProducerCache producer_;
+    ConsumerCache consumer_;
+};
+
+// Blocking push/pop over any queue with try_push/try_pop. Each side spins
+// (with yields) for SPIN_LIMIT attempts before it sleeps, so a busy pipeline
+// never touches the mutex; only a side that actually parked costs the
+// other side a notify.
+template <typename Queue>
+class BlockingQueue {
+public:
+    using value_type = typename Queue::value_type;
+
+    explicit BlockingQueue(size_t capacity) : queue_(capacity) {}
+
+    template <typename U>
+    void push(U&& value) {
+        // try_push only constructs on success, so forwarding again after a
+        // failed attempt is safe
+        for (int spin = 0; !queue_.try_push(std::forward<U>(value)); ++spin) {
+            if (spin < SPIN_LIMIT) {
+                std::this_thread::yield();
+                continue;
+            }
+            park(*producers_waiting_, producer_cv_, [&] { return queue_.try_push(std::forward<U>(value)); });
+            break;
+        }
+        wake(*consumers_waiting_, consumer_cv_);
+    }
+
+    // Blocks until an item is available; false once closed and drained
+    bool pop(value_type& out) {
+        for (int spin = 0; !queue_.try_pop(out); ++spin) {
+            if (closed_.load(std::memory_order_acquire)) {
+                return queue_.try_pop(out);  // Items pushed before close()
+            }
+            if (spin < SPIN_LIMIT) {
+                std::this_thread::yield();
+                continue;
+            }
+            bool got = false;
+            park(*consumers_waiting_, consumer_cv_, [&] {
+                got = queue_.try_pop(out);
+                return got || closed_.load(std::memory_order_acquire);
+            });
+            if (!got && !(got = queue_.try_pop(out))) return false;
+            break;
+        }
+        wake(*producers_waiting_, producer_cv_);
+        return true;
+    }
+
+    template <typename U>
+    bool try_push(U&& value) {
+        if (!queue_.try_push(std::forward<U>(value))) return false;
+        wake(*consumers_waiting_, consumer_cv_);
+        return true;
+    }
+
+    bool try_pop(value_type& out) {
+        if (!queue_.try_pop(out)) return false;
+        wake(*producers_waiting_, producer_cv_);
+        return true;
+    }
+
+    // Wake every waiter; pop() returns false once the queue is empty.
+    // The producers must have stopped pushing; reset() makes it reusable.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            closed_.store(true, std::memory_order_release);
+        }
+        consumer_cv_.notify_all();
+        producer_cv_.notify_all();
+    }
+
+    void reset() { closed_.store(false, std::memory_order_release); }
+
+    Queue& underlying() { return queue_; }
+
+private:
+    static constexpr int SPIN_LIMIT = 128;
+
+    // The waiter count is raised before the condition is re-checked, and
+    // wake() fences between the queue update and reading the count, so a
+    // sleeper and a waker can never both miss each other.
+    template <typename Ready>
+    void park(std::atomic<int>& waiting, std::condition_variable& cv, Ready ready) {
+        waiting.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(park_mutex_);
+            cv.wait(lock, ready);
+        }
+        waiting.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void wake(std::atomic<int>& waiting, std::condition_variable& cv) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            cv.notify_one();
+        }
+    }
+
+    Queue queue_;
+    std::atomic<bool> closed_{false};
+    CachePadded<std::atomic<int>> producers_waiting_{0};
+    CachePadded<std::atomic<int>> consumers_waiting_{0};
+    std::mutex park_mutex_;
+    std::condition_variable producer_cv_;
+    std::condition_variable consumer_cv_;
+};
+
+}  // namespace concurrency
@@ -0,0 +1,521 @@
+/**
+ * @file btree_set.h
+ * @brief B-tree set with cache-line-aligned nodes (BTreeSet)
+ *
+ * A red-black tree (std::set) stores one element per node, so a lookup in
+ * a million elements visits about 20 nodes, each a likely cache miss. A
+ * B-tree stores many sorted keys per node. Each node is a whole number of
+ * cache lines (NodeBytes, default 4 x 64 bytes), so for a million ints a
+ * lookup visits about four nodes and binary-searches within each one.
+ *
+ * - Leaves hold keys only; internal nodes also hold child pointers
+ * - Every node except the root is at least half full (split on overflow,
+ *   borrow or merge on underflow), so memory stays close to the element
+ *   size
+ * - Nodes come from memory::PoolAllocator, one shared pool per node type
+ *
+ * The API mirrors the parts of std::set used in sets.cpp: insert, emplace,
+ * find, count, erase by key, iterator or range, and bidirectional
+ * iteration. Unlike std::set, insert and erase may move elements between
+ * nodes, so both invalidate all iterators. T must be default-constructible
+ * and movable, because keys are stored in plain arrays.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "cache_line.h"
+#include "fixed_pool.h"
+
+namespace containers {
+
+template <typename T, typename Compare = std::less<T>, size_t NodeBytes = 4 * CACHE_LINE_SIZE>
+class BTreeSet {
+    struct Internal;
+
+    struct Header {
+        Internal* parent;
+        uint16_t position;  // Index of this node in parent->children
+        uint16_t count;
+        bool leaf;
+    };
+
+public:
+    // Keys per node: what fits into NodeBytes next to the header (at least 3)
+    static constexpr size_t NODE_CAPACITY =
+        (NodeBytes - sizeof(Header)) / sizeof(T) >= 3 ? (NodeBytes - sizeof(Header)) / sizeof(T) : 3;
+
+private:
+    static constexpr size_t MIN_KEYS = (NODE_CAPACITY - 1) / 2;
+
+    struct alignas(CACHE_LINE_SIZE) Node : Header {
+        T keys[NODE_CAPACITY];
+    };
+
+    struct Internal : Node {
+        Node* children[NODE_CAPACITY + 1];
+    };
+
+    static Internal* as_internal(Node* node) { return static_cast<Internal*>(node); }
+
+    class Iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        Iterator() = default;
+
+        reference operator*() const { return node_->keys[pos_]; }
+        pointer operator->() const { return &node_->keys[pos_]; }
+
+        Iterator& operator++() {
+            if (!node_->leaf) {
+                // Successor: leftmost key of the right subtree
+                node_ = leftmost(as_internal(node_)->children[pos_ + 1]);
+                pos_ = 0;
+                return *this;
+            }
+            if (++pos_ < node_->count) return *this;
+            // Climb until we arrive from a child that has a key to its right
+            while (node_->parent != nullptr) {
+                pos_ = node_->position;
+                node_ = node_->parent;
+                if (pos_ < node_->count) return *this;
+            }
+            node_ = nullptr;  // Walked off the last key: end()
+            pos_ = 0;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        // Decrementing end() lands on the last key
+        Iterator& operator--() {
+            if (node_ == nullptr) {
+                node_ = rightmost(tree_->root_);
+                pos_ = node_->count - 1;
+                return *this;
+            }
+            if (!node_->leaf) {
+                node_ = rightmost(as_internal(node_)->children[pos_]);
+                pos_ = node_->count - 1;
+                return *this;
+            }
+            if (pos_ > 0) {
+                --pos_;
+                return *this;
+            }
+            while (node_->position == 0) {
+                node_ = node_->parent;
+            }
+            pos_ = node_->position - 1;
+            node_ = node_->parent;
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator temp = *this;
+            --*this;
+            return temp;
+        }
+
+        bool operator==(const Iterator& other) const { return node_ == other.node_ && pos_ == other.pos_; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class BTreeSet;
+
+        Iterator(const BTreeSet* tree, Node* node, size_t pos) : tree_(tree), node_(node), pos_(pos) {}
+
+        const BTreeSet* tree_ = nullptr;
+        Node* node_ = nullptr;
+        size_t pos_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using key_type = T;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+
+    BTreeSet() = default;
+
+    template <typename InputIt>
+    BTreeSet(InputIt first, InputIt last) {
+        insert(first, last);
+    }
+
+    BTreeSet(std::initializer_list<T> init) { insert(init.begin(), init.end()); }
+
+    BTreeSet(const BTreeSet& other) : comp_(other.comp_) { insert(other.begin(), other.end()); }
+
+    BTreeSet(BTreeSet&& other) noexcept : comp_(other.comp_) { steal(other); }
+
+    BTreeSet& operator=(BTreeSet other) noexcept {
+        clear();
+        comp_ = other.comp_;
+        steal(other);
+        return *this;
+    }
+
+    ~BTreeSet() { clear(); }
+
+    iterator begin() const { return root_ == nullptr ? end() : iterator(this, leftmost(root_), 0); }
+    iterator end() const { return iterator(this, nullptr, 0); }
+    iterator cbegin() const { return begin(); }
+    iterator cend() const { return end(); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Bytes held in nodes (node memory is pooled, so this is what the tree
+    // actually occupies, not counting pool slack)
+    size_t memory_bytes() const { return leaves_ * sizeof(Node) + internals_ * sizeof(Internal); }
+
+    // Tree height in levels (0 for an empty tree)
+    size_t height() const {
+        size_t levels = 0;
+        for (Node* node = root_; node != nullptr; node = node->leaf ? nullptr : as_internal(node)->children[0]) {
+            ++levels;
+        }
+        return levels;
+    }
+
+    // ===== LOOKUP =====
+
+    iterator find(const T& key) const {
+        Node* node = root_;
+        while (node != nullptr) {
+            size_t i = lower_index(node, key);
+            if (i < node->count && !comp_(key, node->keys[i])) return iterator(this, node, i);
+            if (node->leaf) break;
+            node = as_internal(node)->children[i];
+        }
+        return end();
+    }
+
+    size_t count(const T& key) const { return find(key) != end() ? 1 : 0; }
+    bool contains(const T& key) const { return find(key) != end(); }
+
+    // First key not less than `key`
+    iterator lower_bound(const T& key) const {
+        iterator candidate = end();
+        Node* node = root_;
+        while (node != nullptr) {
+            size_t i = lower_index(node, key);
+            if (i < node->count) {
+                candidate = iterator(this, node, i);
+                if (!comp_(key, node->keys[i])) break;  // Exact match
+            }
+            if (node->leaf) break;
+            node = as_internal(node)->children[i];
+        }
+        return candidate;
+    }
+
+    // ===== MODIFIERS =====
+
+    std::pair<iterator, bool> insert(const T& value) { return insert_value(T(value)); }
+    std::pair<iterator, bool> insert(T&& value) { return insert_value(std::move(value)); }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        return insert_value(T(std::forward<Args>(args)...));
+    }
+
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) insert(*first);
+    }
+
+    size_t erase(const T& key) {
+        iterator it = find(key);
+        if (it == end()) return 0;
+        erase_at(it.node_, it.pos_);
+        return 1;
+    }
+
+    // Returns an iterator to the key after the erased one
+    iterator erase(iterator pos) {
+        iterator next = std::next(pos);
+        if (next == end()) {
+            erase_at(pos.node_, pos.pos_);
+            return end();
+        }
+        T next_key = *next;  // Nodes may be rebalanced; find it again after
+        erase_at(pos.node_, pos.pos_);
+        return find(next_key);
+    }
+
+    iterator erase(iterator first, iterator last) {
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        for (size_t i = 0; i < n; ++i) first = erase(first);
+        return first;
+    }
+
+    void clear() {
+        if (root_ != nullptr) free_subtree(root_);
+        root_ = nullptr;
+        size_ = 0;
+    }
+
+private:
+    using LeafAllocator = memory::PoolAllocator<Node>;
+    using InternalAllocator = memory::PoolAllocator<Internal>;
+
+    static Node* leftmost(Node* node) {
+        while (!node->leaf) node = as_internal(node)->children[0];
+        return node;
+    }
+
+    static Node* rightmost(Node* node) {
+        while (!node->leaf) node = as_internal(node)->children[node->count];
+        return node;
+    }
+
+    size_t lower_index(const Node* node, const T& key) const {
+        return static_cast<size_t>(std::lower_bound(node->keys, node->keys + node->count, key, comp_) - node->keys);
+    }
+
+    Node* new_leaf() {
+        Node* node = new (LeafAllocator().allocate(1)) Node();
+        node->leaf = true;
+        ++leaves_;
+        return node;
+    }
+
+    Internal* new_internal() {
+        Internal* node = new (InternalAllocator().allocate(1)) Internal();
+        node->leaf = false;
+        ++internals_;
+        return node;
+    }
+
+    void free_node(Node* node) {
+        if (node->leaf) {
+            node->~Node();
+            LeafAllocator().deallocate(node, 1);
+            --leaves_;
+        } else {
+            Internal* internal = as_internal(node);
+            internal->~Internal();
+            InternalAllocator().deallocate(internal, 1);
+            --internals_;
+        }
+    }
+
+    void free_subtree(Node* node) {
+        if (!node->leaf) {
+            Internal* internal = as_internal(node);
+            for (size_t i = 0; i <= internal->count; ++i) free_subtree(internal->children[i]);
+        }
+        free_node(node);
+    }
+
+    void set_child(Internal* parent, size_t i, Node* child) {
+        parent->children[i] = child;
+        child->parent = parent;
+        child->position = static_cast<uint16_t>(i);
+    }
+
+    std::pair<iterator, bool> insert_value(T&& value) {
+        if (root_ == nullptr) {
+            root_ = new_leaf();
+        }
+        Node* node = root_;
+        while (true) {
+            size_t i = lower_index(node, value);
+            if (i < node->count && !comp_(value, node->keys[i])) return {iterator(this, node, i), false};
+            if (node->leaf) {
+                ++size_;
+                return {insert_into(node, i, std::move(value), nullptr), true};
+            }
+            node = as_internal(node)->children[i];
+        }
+    }
+
+    // Insert key at index i of node (and, for internal nodes, right_child just
+    // after it). A full node is split first and its middle key pushed up.
+    iterator insert_into(Node* node, size_t i, T&& key, Node* right_child) {
+        if (node->count == NODE_CAPACITY) {
+            const size_t split_at = NODE_CAPACITY / 2;
+            Node* right = split(node, split_at);
+            if (i > split_at) {
+                node = right;
+                i -= split_at + 1;
+            }
+        }
+
+        std::move_backward(node->keys + i, node->keys + node->count, node->keys + node->count + 1);
+        node->keys[i] = std::move(key);
+        if (!node->leaf) {
+            Internal* internal = as_internal(node);
+            for (size_t c = internal->count + 1; c > i + 1; --c) set_child(internal, c, internal->children[c - 1]);
+            set_child(internal, i + 1, right_child);
+        }
+        ++node->count;
+        return iterator(this, node, i);
+    }
+
+    // Move keys after `at` into a new right sibling and push keys[at] up
+    // into the parent (growing a new root if needed). Returns the sibling.
+    Node* split(Node* node, size_t at) {
+        Node* right = node->leaf ? new_leaf() : new_internal();
+        size_t moved = node->count - at - 1;
+        std::move(node->keys + at + 1, node->keys + node->count, right->keys);
+        right->count = static_cast<uint16_t>(moved);
+        if (!node->leaf) {
+            Internal* from = as_internal(node);
+            Internal* to = as_internal(right);
+            for (size_t c = 0; c <= moved; ++c) set_child(to, c, from->children[at + 1 + c]);
+        }
+        T separator = std::move(node->keys[at]);
+        node->count = static_cast<uint16_t>(at);
+
+        if (node->parent == nullptr) {
+            Internal* root = new_internal();
+            root->keys[0] = std::move(separator);
+            root->count = 1;
+            set_child(root, 0, node);
+            set_child(root, 1, right);
+            root_ = root;
+        } else {
+            insert_into(node->parent, node->position, std::move(separator), right);
+        }
+        return right;
+    }
+
+    void erase_at(Node* node, size_t i) {
+        if (!node->leaf) {
+            // Replace with the predecessor, then delete that from its leaf
+            Node* leaf = rightmost(as_internal(node)->children[i]);
+            node->keys[i] = std::move(leaf->keys[leaf->count - 1]);
+            node = leaf;
+            i = leaf->count - 1;
+        }
+        std::move(node->keys + i + 1, node->keys + node->count, node->keys + i);
+        --node->count;
+        --size_;
+        rebalance(node);
+    }
+
+    void rebalance(Node* node) {
+        if (node == root_) {
+            if (node->count > 0) return;
+            if (node->leaf) {
+                root_ = nullptr;
+            } else {
+                root_ = as_internal(node)->children[0];
+                root_->parent = nullptr;
+                root_->position = 0;
+            }
+            free_node(node);
+            return;
+        }
+        if (node->count >= MIN_KEYS) return;
+
+        Internal* parent = node->parent;
+        size_t p = node->position;
+        Node* left = p > 0 ? parent->children[p - 1] : nullptr;
+        Node* right = p < parent->count ? parent->children[p + 1] : nullptr;
+
+        if (left != nullptr && left->count > MIN_KEYS) {
+            rotate_right(parent, p - 1);
+        } else if (right != nullptr && right->count > MIN_KEYS) {
+            rotate_left(parent, p);
+        } else if (left != nullptr) {
+            merge(parent, p - 1);
+        } else {
+            merge(parent, p);
+        }
+    }
+
+    // Move the last key of children[k] up into keys[k] and the old
+    // keys[k] down to the front of children[k + 1]
+    void rotate_right(Internal* parent, size_t k) {
+        Node* left = parent->children[k];
+        Node* right = parent->children[k + 1];
+        std::move_backward(right->keys, right->keys + right->count, right->keys + right->count + 1);
+        right->keys[0] = std::move(parent->keys[k]);
+        parent->keys[k] = std::move(left->keys[left->count - 1]);
+        if (!right->leaf) {
+            Internal* to = as_internal(right);
+            for (size_t c = to->count + 1; c > 0; --c) set_child(to, c, to->children[c - 1]);
+            set_child(to, 0, as_internal(left)->children[left->count]);
+        }
+        --left->count;
+        ++right->count;
+    }
+
+    // Mirror image of rotate_right
+    void rotate_left(Internal* parent, size_t k) {
+        Node* left = parent->children[k];
+        Node* right = parent->children[k + 1];
+        left->keys[left->count] = std::move(parent->keys[k]);
+        parent->keys[k] = std::move(right->keys[0]);
+        if (!left->leaf) {
+            Internal* from = as_internal(right);
+            set_child(as_internal(left), left->count + 1, from->children[0]);
+            for (size_t c = 0; c < from->count; ++c) set_child(from, c, from->children[c + 1]);
+        }
+        std::move(right->keys + 1, right->keys + right->count, right->keys);
+        ++left->count;
+        --right->count;
+    }
+
+    // Fold keys[k] and children[k + 1] into children[k], then let the
+    // parent rebalance itself
+    void merge(Internal* parent, size_t k) {
+        Node* left = parent->children[k];
+        Node* right = parent->children[k + 1];
+        size_t base = left->count;
+        left->keys[base] = std::move(parent->keys[k]);
+        std::move(right->keys, right->keys + right->count, left->keys + base + 1);
+        if (!left->leaf) {
+            for (size_t c = 0; c <= right->count; ++c) {
+                set_child(as_internal(left), base + 1 + c, as_internal(right)->children[c]);
+            }
+        }
+        left->count = static_cast<uint16_t>(base + 1 + right->count);
+
+        std::move(parent->keys + k + 1, parent->keys + parent->count, parent->keys + k);
+        for (size_t c = k + 1; c < parent->count; ++c) set_child(parent, c, parent->children[c + 1]);
+        --parent->count;
+        free_node(right);
+        rebalance(parent);
+    }
+
+    void steal(BTreeSet& other) {
+        root_ = other.root_;
+        size_ = other.size_;
+        leaves_ = other.leaves_;
+        internals_ = other.internals_;
+        other.root_ = nullptr;
+        other.size_ = other.leaves_ = other.internals_ = 0;
+    }
+
+    Node* root_ = nullptr;
+    size_t size_ = 0;
+    size_t leaves_ = 0;
+    size_t internals_ = 0;
+    Compare comp_;
+};
+
+}  // namespace containers
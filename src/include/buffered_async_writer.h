@@ -0,0 +1,157 @@
+/**
+ * @file buffered_async_writer.h
+ * @brief Multi-producer append-only file writer with background group commit
+ *
+ * Log-heavy code usually pays for a write() (and often an fsync) per
+ * record, on the caller's thread. BufferedAsyncWriter decouples the two:
+ *
+ *   append() ──► [ active buffer ]        (lock-free: fetch_add + memcpy)
+ *                [ flushing buffer ] ──► background thread: write(), then
+ *                                        fdatasync according to Durability
+ *
+ * There are two buffers. Appenders reserve space in the active one with an
+ * atomic fetch_add and copy their record in, so appends from different
+ * threads never take a lock unless the active buffer is full. The
+ * background thread seals the active buffer, switches appenders over to
+ * the other one, and writes the sealed buffer with one large write().
+ * Records from one thread keep their order; records from different
+ * threads interleave at record granularity.
+ *
+ * Durability:
+ * - NONE:     write() only; the page cache decides when data hits the disk
+ * - BATCH:    fdatasync after every batch: group commit, one sync for all
+ *             records that arrived while the previous batch was syncing
+ * - INTERVAL: fdatasync at most every sync_interval
+ *
+ * append() returns a ticket (the stream offset just past the record), and
+ * wait_durable(ticket) blocks until the record is written and, in BATCH /
+ * INTERVAL mode, synced.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "cache_line.h"
+#include "latency_histogram.h"
+
+namespace io {
+
+class BufferedAsyncWriter {
+public:
+    enum class Durability { NONE, BATCH, INTERVAL };
+
+    struct Options {
+        size_t buffer_bytes = 4 << 20;  // Per buffer; also the largest append
+        Durability durability = Durability::NONE;
+        std::chrono::milliseconds sync_interval{100};  // INTERVAL mode
+        std::chrono::microseconds max_linger{1000};    // Longest a record waits for its batch
+        bool record_append_latency = false;            // Two clock reads per append
+    };
+
+    struct Stats {
+        uint64_t appends = 0;
+        uint64_t bytes = 0;
+        uint64_t batches = 0;       // write() batches
+        uint64_t syncs = 0;         // fdatasync calls
+        uint64_t full_waits = 0;    // Appends that had to wait for buffer space
+        LatencyHistogram append;    // ns per append() (if enabled; sampled under contention)
+        LatencyHistogram flush;     // ns per batch: write + sync
+    };
+
+    BufferedAsyncWriter();
+    ~BufferedAsyncWriter();
+
+    BufferedAsyncWriter(const BufferedAsyncWriter&) = delete;
+    BufferedAsyncWriter& operator=(const BufferedAsyncWriter&) = delete;
+
+    // Open (create or truncate) path and start the background thread.
+    // Returns false and leaves errno set on failure.
+    bool open(const std::string& path, const Options& options);
+    bool open(const std::string& path) { return open(path, Options()); }
+
+    // Write out everything (and sync it, unless Durability::NONE), stop the
+    // thread, close the file. Returns false if any write or sync failed.
+    // Appends must have finished.
+    bool close();
+
+    bool is_open() const { return fd_ >= 0; }
+
+    // Thread-safe. Returns the record's ticket, or 0 if the writer is not
+    // open or the record is empty or larger than buffer_bytes.
+    uint64_t append(const void* data, size_t length);
+    uint64_t append(std::string_view data) { return append(data.data(), data.size()); }
+
+    // Block until everything up to ticket is written (and synced, unless
+    // Durability::NONE). Returns false if the writer failed.
+    bool wait_durable(uint64_t ticket);
+
+    // Ask the background thread to write out the active buffer now
+    void flush();
+
+    // Snapshot; safe to call while appends are running
+    Stats stats() const;
+
+private:
+    // reserved_ doubles as the seal flag: once SEALED is set, reservations
+    // fail and appenders retry on the other buffer
+    static constexpr uint64_t SEALED = uint64_t(1) << 63;
+    static constexpr uint64_t NO_END = ~uint64_t(0);
+    static constexpr int LATENCY_STRIPES = 16;
+
+    struct Buffer {
+        std::unique_ptr<char[]> data;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> reserved{SEALED};
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> committed{0};
+        std::atomic<uint64_t> end{NO_END};  // Set by the append that overflowed
+        uint64_t base = 0;                  // Stream offset of data[0]
+    };
+
+    struct LatencyStripe {
+        std::mutex mutex;
+        LatencyHistogram histogram;
+    };
+
+    void run();
+    bool write_sealed(Buffer& buffer, uint64_t& batch_bytes);
+    bool write_all(const char* data, size_t length);
+    void record_append_latency(uint64_t nanos);
+
+    Options options_;
+    int fd_ = -1;
+    std::thread thread_;
+
+    Buffer buffers_[2];
+    alignas(CACHE_LINE_SIZE) std::atomic<int> active_{0};
+    std::atomic<bool> flush_requested_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> failed_{false};
+
+    // Slow paths: waiting for space, for durability, or for work
+    mutable std::mutex mutex_;
+    std::condition_variable space_cv_;
+    std::condition_variable durable_cv_;
+    std::condition_variable work_cv_;
+    std::atomic<uint64_t> swaps_{0};  // Buffer switches; changed under mutex_
+    uint64_t written_ = 0;            // Stream offset written, guarded by mutex_
+    uint64_t durable_ = 0;            // ... and synced (= written_ for NONE)
+
+    // Counters; the histograms are striped so concurrent appenders rarely meet
+    std::atomic<uint64_t> appends_{0};
+    std::atomic<uint64_t> full_waits_{0};
+    uint64_t batches_ = 0;           // Background thread; read under mutex_
+    uint64_t syncs_ = 0;
+    LatencyHistogram flush_latency_;
+    mutable CachePadded<LatencyStripe> append_latency_[LATENCY_STRIPES];
+};
+
+}  // namespace io
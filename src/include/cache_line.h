@@ -0,0 +1,32 @@
+/**
+ * @file cache_line.h
+ * @brief Cache-line size constant and a padding wrapper against false sharing
+ *
+ * std::hardware_destructive_interference_size would be the portable answer,
+ * but compilers disagree on its value (and GCC warns whenever it appears in
+ * a header), so the 64 bytes of every x86-64 and most AArch64 cores is
+ * spelled out here once.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Gives a value a cache line of its own, so that per-thread state updated
+// in a tight loop does not invalidate its neighbours
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) CachePadded {
+    T value;
+
+    CachePadded() = default;
+    template <typename... Args>
+    explicit CachePadded(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    T* operator->() { return &value; }
+    const T* operator->() const { return &value; }
+    T& operator*() { return value; }
+    const T& operator*() const { return value; }
+};
@@ -0,0 +1,257 @@
+/**
+ * @file dary_heap.h
+ * @brief d-ary heap and an indexed heap with decrease_key
+ *
+ * std::priority_queue is a binary heap. A d-ary heap gives every node D
+ * children instead of two:
+ *
+ * - the tree is log2(D) times shallower, so push (sift-up) does fewer
+ *   steps and fewer cache misses
+ * - pop (sift-down) compares D children per level, but the children are
+ *   adjacent in memory (with D = 4 and int keys they share a cache line)
+ *
+ * For the push-heavy pattern of schedulers and timer queues, D = 4 or 8
+ * usually beats D = 2. D is a template parameter, so the index
+ * arithmetic compiles to shifts when D is a power of two.
+ *
+ * DaryHeap follows std::priority_queue conventions: Compare = std::less
+ * keeps the largest element on top.
+ *
+ * IndexedHeap orders a fixed set of ids 0..capacity-1 by priority and
+ * remembers where each id sits in the heap. A priority change is then
+ * one sift (O(log n)) instead of a lazy duplicate push. Its top() is the
+ * id with the *smallest* priority under Compare, which is what Dijkstra
+ * and other shortest-first algorithms want.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace containers {
+
+template <typename T, size_t D = 4, typename Compare = std::less<T>>
+class DaryHeap {
+    static_assert(D >= 2, "a heap node needs at least two children");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    static constexpr size_t ARITY = D;
+
+    DaryHeap() = default;
+    explicit DaryHeap(const Compare& comp) : comp_(comp) {}
+
+    // Heapify in O(n)
+    template <typename InputIt>
+    DaryHeap(InputIt first, InputIt last, const Compare& comp = Compare()) : data_(first, last), comp_(comp) {
+        if (data_.size() > 1) {
+            for (size_t i = (data_.size() - 2) / D + 1; i-- > 0;) sift_down(i);
+        }
+    }
+
+    const T& top() const { return data_.front(); }
+    size_t size() const { return data_.size(); }
+    bool empty() const { return data_.empty(); }
+    void reserve(size_t n) { data_.reserve(n); }
+    void clear() { data_.clear(); }
+
+    void push(const T& value) {
+        data_.push_back(value);
+        sift_up(data_.size() - 1);
+    }
+
+    void push(T&& value) {
+        data_.push_back(std::move(value));
+        sift_up(data_.size() - 1);
+    }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        data_.emplace_back(std::forward<Args>(args)...);
+        sift_up(data_.size() - 1);
+    }
+
+    void pop() {
+        if (data_.size() > 1) {
+            data_.front() = std::move(data_.back());
+            data_.pop_back();
+            sift_down(0);
+        } else {
+            data_.pop_back();
+        }
+    }
+
+    // pop() followed by push(value), with a single sift-down
+    void replace_top(T value) {
+        data_.front() = std::move(value);
+        sift_down(0);
+    }
+
+    // Hands over the elements (in heap order, not sorted) and empties the heap
+    std::vector<T> release() { return std::exchange(data_, {}); }
+
+private:
+    // The element being sifted is held aside and the others are moved
+    // into the hole, so each level costs one move instead of a swap
+    void sift_up(size_t i) {
+        T value = std::move(data_[i]);
+        while (i > 0) {
+            size_t parent = (i - 1) / D;
+            if (!comp_(data_[parent], value)) break;
+            data_[i] = std::move(data_[parent]);
+            i = parent;
+        }
+        data_[i] = std::move(value);
+    }
+
+    void sift_down(size_t i) {
+        const size_t n = data_.size();
+        T value = std::move(data_[i]);
+        while (true) {
+            size_t first = i * D + 1;
+            if (first >= n) break;
+            size_t last = std::min(first + D, n);
+            size_t best = first;
+            for (size_t c = first + 1; c < last; ++c) {
+                if (comp_(data_[best], data_[c])) best = c;
+            }
+            if (!comp_(value, data_[best])) break;
+            data_[i] = std::move(data_[best]);
+            i = best;
+        }
+        data_[i] = std::move(value);
+    }
+
+    std::vector<T> data_;
+    Compare comp_;
+};
+
+template <typename Priority, size_t D = 4, typename Compare = std::less<Priority>>
+class IndexedHeap {
+    static_assert(D >= 2, "a heap node needs at least two children");
+
+public:
+    static constexpr size_t NPOS = std::numeric_limits<size_t>::max();
+
+    // Ids are 0..capacity-1
+    explicit IndexedHeap(size_t capacity, const Compare& comp = Compare()) : position_(capacity, NPOS), comp_(comp) {}
+
+    size_t size() const { return heap_.size(); }
+    bool empty() const { return heap_.empty(); }
+    size_t capacity() const { return position_.size(); }
+    bool contains(size_t id) const { return position_[id] != NPOS; }
+
+    size_t top() const { return heap_.front().id; }
+    const Priority& top_priority() const { return heap_.front().priority; }
+    const Priority& priority(size_t id) const { return heap_[position_[id]].priority; }
+
+    // id must not be in the heap yet
+    void push(size_t id, Priority priority) {
+        position_[id] = heap_.size();
+        heap_.push_back({std::move(priority), id});
+        sift_up(heap_.size() - 1);
+    }
+
+    // Move id towards the top: priority must not come after its current one
+    void decrease_key(size_t id, Priority priority) {
+        size_t i = position_[id];
+        heap_[i].priority = std::move(priority);
+        sift_up(i);
+    }
+
+    // Priority change in either direction
+    void update(size_t id, Priority priority) {
+        size_t i = position_[id];
+        bool earlier = comp_(priority, heap_[i].priority);
+        heap_[i].priority = std::move(priority);
+        if (earlier) {
+            sift_up(i);
+        } else {
+            sift_down(i);
+        }
+    }
+
+    // The Dijkstra "relax" step: insert id, or lower its priority if the
+    // new one is better. Returns true if anything changed.
+    bool push_or_decrease(size_t id, Priority priority) {
+        if (!contains(id)) {
+            push(id, std::move(priority));
+            return true;
+        }
+        if (!comp_(priority, heap_[position_[id]].priority)) return false;
+        decrease_key(id, std::move(priority));
+        return true;
+    }
+
+    void pop() { erase(heap_.front().id); }
+
+    void erase(size_t id) {
+        size_t i = position_[id];
+        position_[id] = NPOS;
+        if (i + 1 == heap_.size()) {
+            heap_.pop_back();
+            return;
+        }
+        heap_[i] = std::move(heap_.back());
+        heap_.pop_back();
+        position_[heap_[i].id] = i;
+        // The element moved in from the back may belong above or below
+        if (i > 0 && comp_(heap_[i].priority, heap_[(i - 1) / D].priority)) {
+            sift_up(i);
+        } else {
+            sift_down(i);
+        }
+    }
+
+private:
+    struct Entry {
+        Priority priority;
+        size_t id;
+    };
+
+    void place(size_t i, Entry&& entry) {
+        position_[entry.id] = i;
+        heap_[i] = std::move(entry);
+    }
+
+    void sift_up(size_t i) {
+        Entry entry = std::move(heap_[i]);
+        while (i > 0) {
+            size_t parent = (i - 1) / D;
+            if (!comp_(entry.priority, heap_[parent].priority)) break;
+            place(i, std::move(heap_[parent]));
+            i = parent;
+        }
+        place(i, std::move(entry));
+    }
+
+    void sift_down(size_t i) {
+        const size_t n = heap_.size();
+        Entry entry = std::move(heap_[i]);
+        while (true) {
+            size_t first = i * D + 1;
+            if (first >= n) break;
+            size_t last = std::min(first + D, n);
+            size_t best = first;
+            for (size_t c = first + 1; c < last; ++c) {
+                if (comp_(heap_[c].priority, heap_[best].priority)) best = c;
+            }
+            if (!comp_(heap_[best].priority, entry.priority)) break;
+            place(i, std::move(heap_[best]));
+            i = best;
+        }
+        place(i, std::move(entry));
+    }
+
+    std::vector<Entry> heap_;
+    std::vector<size_t> position_;  // id -> index in heap_, or NPOS
+    Compare comp_;
+};
+
+}  // namespace containers
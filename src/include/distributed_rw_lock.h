@@ -0,0 +1,118 @@
+/**
+ * @file distributed_rw_lock.h
+ * @brief Reader-writer lock with per-slot reader counts (read-mostly state)
+ *
+ * std::shared_mutex keeps one reader count, so every lock_shared() and
+ * unlock_shared() is a read-modify-write on the same cache line. With
+ * enough cores the line spends more time moving between them than the
+ * readers spend reading, and read throughput falls as readers are added.
+ *
+ * DistributedRwLock gives each reader thread a slot (a cache line of its
+ * own, threads are spread round-robin over SLOTS slots), so readers only
+ * ever write their own line:
+ *
+ *   reader:  ++slot[me]; if (writer) { --slot[me]; wait; retry }
+ *   writer:  writer = true; wait until every slot[i] == 0
+ *
+ * Both sides store first and then load the other side's flag with
+ * sequentially consistent ordering, so at least one of them sees the
+ * other. Writers take a mutex among themselves and have priority: new
+ * readers back off while a writer is waiting. A write costs a scan of all
+ * SLOTS lines, so this suits state that is read far more than written.
+ *
+ * Meets SharedLockable: use it with std::shared_lock / std::unique_lock
+ * exactly like std::shared_mutex. A shared lock must be released by the
+ * thread that took it (the slot is per thread).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include "cache_line.h"
+#include "spin_locks.h"
+
+namespace concurrency {
+
+class DistributedRwLock {
+public:
+    static constexpr size_t SLOTS = 64;
+
+    DistributedRwLock() = default;
+    DistributedRwLock(const DistributedRwLock&) = delete;
+    DistributedRwLock& operator=(const DistributedRwLock&) = delete;
+
+    void lock_shared() {
+        std::atomic<int>& slot = *readers_[thread_slot()];
+        SpinWait spin;
+        while (true) {
+            slot.fetch_add(1, std::memory_order_seq_cst);
+            if (!writer_.load(std::memory_order_seq_cst)) return;
+            // A writer is in (or waiting): step aside until it is done
+            slot.fetch_sub(1, std::memory_order_release);
+            while (writer_.load(std::memory_order_relaxed)) {
+                spin.wait();
+            }
+        }
+    }
+
+    bool try_lock_shared() {
+        std::atomic<int>& slot = *readers_[thread_slot()];
+        slot.fetch_add(1, std::memory_order_seq_cst);
+        if (!writer_.load(std::memory_order_seq_cst)) return true;
+        slot.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    void unlock_shared() { readers_[thread_slot()]->fetch_sub(1, std::memory_order_release); }
+
+    void lock() {
+        writers_.lock();
+        writer_.store(true, std::memory_order_seq_cst);
+        wait_for_readers();
+    }
+
+    bool try_lock() {
+        if (!writers_.try_lock()) return false;
+        writer_.store(true, std::memory_order_seq_cst);
+        for (auto& slot : readers_) {
+            if (slot->load(std::memory_order_seq_cst) != 0) {
+                writer_.store(false, std::memory_order_release);
+                writers_.unlock();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void unlock() {
+        writer_.store(false, std::memory_order_release);
+        writers_.unlock();
+    }
+
+private:
+    // Threads get consecutive slots in the order they first take a shared
+    // lock on any DistributedRwLock
+    static size_t thread_slot() {
+        static std::atomic<size_t> next_slot{0};
+        thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % SLOTS;
+        return slot;
+    }
+
+    void wait_for_readers() {
+        for (auto& slot : readers_) {
+            SpinWait spin;
+            while (slot->load(std::memory_order_seq_cst) != 0) {
+                spin.wait();
+            }
+        }
+    }
+
+    CachePadded<std::atomic<int>> readers_[SLOTS];
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> writer_{false};
+    std::mutex writers_;  // Serializes writers; readers never touch it
+};
+
+}  // namespace concurrency
@@ -0,0 +1,119 @@
+/**
+ * @file event_loop.h
+ * @brief Readiness-based event loop used by the networking examples
+ *
+ * A small reactor on top of the platform's scalable readiness API:
+ * - epoll on Linux
+ * - kqueue on macOS / BSD
+ *
+ * Every file descriptor is registered together with an EventHandler. When
+ * the kernel reports the descriptor as readable/writable the loop calls
+ * EventHandler::handle_event() on the thread that owns the loop. Work from
+ * other threads (for example "adopt this freshly accepted socket") is handed
+ * over with post(), which wakes the loop through an internal pipe.
+ *
+ * Every loop also owns a TimerWheel with one-millisecond ticks. Timers
+ * scheduled with schedule_after() fire on the loop thread, and the loop
+ * sleeps in epoll_wait / kevent no longer than until the next one is due.
+ *
+ * A server typically runs a handful of EventLoops, one per thread, instead
+ * of one blocking thread per connection.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "timer_wheel.h"
+
+namespace net {
+
+// Readiness flags used both for registration and for handle_event()
+enum EventFlags : uint32_t {
+    EVENT_READ = 1u << 0,
+    EVENT_WRITE = 1u << 1,
+    EVENT_ERROR = 1u << 2,  // Error or hang-up (reported only)
+};
+
+// Anything that owns a file descriptor registered with an EventLoop
+class EventHandler {
+public:
+    virtual ~EventHandler() = default;
+    virtual void handle_event(uint32_t events) = 0;
+};
+
+class EventLoop {
+public:
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Register / update / unregister interest in a file descriptor.
+    // The handler must stay alive until remove() has been called.
+    bool add(int fd, uint32_t events, EventHandler* handler);
+    bool modify(int fd, uint32_t events, EventHandler* handler);
+    void remove(int fd);
+
+    // Dispatch events until stop() is called
+    void run();
+
+    // Wait up to timeout_ms (-1 = forever) and dispatch what is ready,
+    // then fire due timers. Returns the number of I/O events handled.
+    int run_once(int timeout_ms);
+
+    // Ask the loop to exit; safe to call from any thread or signal context
+    void stop();
+
+    // Run task on the loop thread during the next iteration
+    void post(std::function<void()> task);
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    // Fire timer delay_ms from now (re-arms it if already scheduled).
+    // Loop thread only, like everything else that touches the timers.
+    void schedule_after(Timer& timer, uint64_t delay_ms) { timers_.schedule_at(timer, now_ms() + delay_ms); }
+
+    // Milliseconds since the loop was created (steady clock)
+    uint64_t now_ms() const {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - epoch_).count());
+    }
+
+    TimerWheel& timers() { return timers_; }
+
+private:
+    // Poll timeout that wakes the loop for the next due timer
+    int timer_timeout_ms() const;
+    void wakeup();
+    void drain_wakeup();
+    void run_pending();
+
+    int poll_fd_ = -1;
+    int wake_read_fd_ = -1;
+    int wake_write_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_requested_{false};
+
+    std::mutex pending_mutex_;
+    std::vector<std::function<void()>> pending_;
+
+    std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+    TimerWheel timers_;
+};
+
+// Put a socket into non-blocking mode; returns false on failure
+bool set_nonblocking(int fd);
+
+// Lift the soft RLIMIT_NOFILE to the hard limit (thousands of sockets per
+// process); returns the limit now in effect
+uint64_t raise_fd_limit();
+
+}  // namespace net
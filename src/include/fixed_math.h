@@ -0,0 +1,399 @@
+/**
+ * @file fixed_math.h
+ * @brief Fixed-size vectors and matrices whose sizes are template arguments
+ *
+ * Geometry code multiplies 3- and 4-element vectors by 3x3 and 4x4
+ * matrices millions of times. With runtime sizes every operation is a
+ * loop with a runtime bound, an index computation and (for a heap-backed
+ * matrix) a pointer chase; with the size in the type the compiler sees
+ * the whole computation:
+ *
+ *     constexpr math::Mat<float, 4, 4> move = math::translation<float>(1, 2, 3);
+ *     math::Vec<float, 4> p{0, 0, 0, 1};
+ *     math::Vec<float, 4> q = move * p;                 // {1, 2, 3, 1}
+ *     static_assert(math::dot(math::Vec<int, 3>{1, 2, 3}, math::Vec<int, 3>{4, 5, 6}) == 32);
+ *
+ * Every loop is unrolled through a fold expression over an index
+ * sequence: no loop counter, no branch, and all of it usable in constant
+ * expressions.
+ *
+ * At run time, float and double operations whose size is a multiple of
+ * the vector width use SIMD intrinsics, chosen by `if constexpr` on the
+ * element type and size. The instruction set is the one the translation
+ * unit is compiled for (SSE2 is always there on x86-64, AVX with
+ * -mavx / -march=native, NEON on AArch64), not a runtime dispatch as in
+ * simd_kernels.h: these operations are a handful of instructions each and
+ * must inline, so an indirect call would cost more than it saves. During
+ * constant evaluation the portable path runs instead.
+ *
+ * Matrices are row-major: Mat<T, R, C> is R rows of Vec<T, C>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define FIXED_MATH_X86 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define FIXED_MATH_NEON 1
+#endif
+
+namespace math {
+
+namespace detail {
+
+// Call f(integral_constant<0>), ..., f(integral_constant<N - 1>)
+template <typename F, size_t... I>
+constexpr void unroll(F&& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<size_t, I>()), ...);
+}
+
+template <size_t N, typename F>
+constexpr void unroll(F&& f) {
+    unroll(f, std::make_index_sequence<N>());
+}
+
+// False during constant evaluation, where intrinsics are not allowed
+constexpr bool run_time() {
+#if defined(__cpp_lib_is_constant_evaluated)
+    return !std::is_constant_evaluated();
+#elif defined(__GNUC__) || defined(__clang__)
+    return !__builtin_is_constant_evaluated();
+#else
+    return false;  // Cannot tell: always take the portable path
+#endif
+}
+
+// One SIMD register of Width T lanes, where the target has one
+template <typename T, size_t Width>
+struct Lanes {
+    static constexpr bool AVAILABLE = false;
+};
+
+#if defined(FIXED_MATH_X86)
+template <>
+struct Lanes<float, 4> {
+    static constexpr bool AVAILABLE = true;
+    using Register = __m128;
+    static Register load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Register r) { _mm_storeu_ps(p, r); }
+    static Register add(Register a, Register b) { return _mm_add_ps(a, b); }
+    static Register sub(Register a, Register b) { return _mm_sub_ps(a, b); }
+    static Register mul(Register a, Register b) { return _mm_mul_ps(a, b); }
+    static float sum(Register r) {
+        __m128 pairs = _mm_add_ps(r, _mm_movehl_ps(r, r));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+    }
+};
+
+template <>
+struct Lanes<double, 2> {
+    static constexpr bool AVAILABLE = true;
+    using Register = __m128d;
+    static Register load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, Register r) { _mm_storeu_pd(p, r); }
+    static Register add(Register a, Register b) { return _mm_add_pd(a, b); }
+    static Register sub(Register a, Register b) { return _mm_sub_pd(a, b); }
+    static Register mul(Register a, Register b) { return _mm_mul_pd(a, b); }
+    static double sum(Register r) { return _mm_cvtsd_f64(_mm_add_sd(r, _mm_unpackhi_pd(r, r))); }
+};
+
+#if defined(__AVX__)
+template <>
+struct Lanes<float, 8> {
+    static constexpr bool AVAILABLE = true;
+    using Register = __m256;
+    static Register load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Register r) { _mm256_storeu_ps(p, r); }
+    static Register add(Register a, Register b) { return _mm256_add_ps(a, b); }
+    static Register sub(Register a, Register b) { return _mm256_sub_ps(a, b); }
+    static Register mul(Register a, Register b) { return _mm256_mul_ps(a, b); }
+    static float sum(Register r) {
+        return Lanes<float, 4>::sum(_mm_add_ps(_mm256_castps256_ps128(r), _mm256_extractf128_ps(r, 1)));
+    }
+};
+
+template <>
+struct Lanes<double, 4> {
+    static constexpr bool AVAILABLE = true;
+    using Register = __m256d;
+    static Register load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, Register r) { _mm256_storeu_pd(p, r); }
+    static Register add(Register a, Register b) { return _mm256_add_pd(a, b); }
+    static Register sub(Register a, Register b) { return _mm256_sub_pd(a, b); }
+    static Register mul(Register a, Register b) { return _mm256_mul_pd(a, b); }
+    static double sum(Register r) {
+        return Lanes<double, 2>::sum(_mm_add_pd(_mm256_castpd256_pd128(r), _mm256_extractf128_pd(r, 1)));
+    }
+};
+#endif
+#elif defined(FIXED_MATH_NEON)
+template <>
+struct Lanes<float, 4> {
+    static constexpr bool AVAILABLE = true;
+    using Register = float32x4_t;
+    static Register load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, Register r) { vst1q_f32(p, r); }
+    static Register add(Register a, Register b) { return vaddq_f32(a, b); }
+    static Register sub(Register a, Register b) { return vsubq_f32(a, b); }
+    static Register mul(Register a, Register b) { return vmulq_f32(a, b); }
+    static float sum(Register r) { return vaddvq_f32(r); }
+};
+
+template <>
+struct Lanes<double, 2> {
+    static constexpr bool AVAILABLE = true;
+    using Register = float64x2_t;
+    static Register load(const double* p) { return vld1q_f64(p); }
+    static void store(double* p, Register r) { vst1q_f64(p, r); }
+    static Register add(Register a, Register b) { return vaddq_f64(a, b); }
+    static Register sub(Register a, Register b) { return vsubq_f64(a, b); }
+    static Register mul(Register a, Register b) { return vmulq_f64(a, b); }
+    static double sum(Register r) { return vaddvq_f64(r); }
+};
+#endif
+
+// The widest register whose lanes divide N exactly; 1 for none (no SIMD)
+template <typename T, size_t N>
+constexpr size_t lane_width() {
+    if constexpr (Lanes<T, 8>::AVAILABLE && N % 8 == 0) {
+        return 8;
+    } else if constexpr (Lanes<T, 4>::AVAILABLE && N % 4 == 0) {
+        return 4;
+    } else if constexpr (Lanes<T, 2>::AVAILABLE && N % 2 == 0) {
+        return 2;
+    } else {
+        return 1;
+    }
+}
+
+template <typename T, size_t N>
+constexpr bool VECTORIZED = lane_width<T, N>() > 1;
+
+template <typename T, size_t N>
+using LanesFor = Lanes<T, lane_width<T, N>()>;
+
+}  // namespace detail
+
+template <typename T, size_t N>
+struct Vec {
+    static_assert(N > 0, "empty vector");
+
+    T v[N];
+
+    static constexpr size_t size() { return N; }
+    constexpr T& operator[](size_t i) { return v[i]; }
+    constexpr const T& operator[](size_t i) const { return v[i]; }
+
+    static constexpr Vec filled(T value) {
+        Vec result{};
+        detail::unroll<N>([&](auto i) { result[i] = value; });
+        return result;
+    }
+};
+
+namespace detail {
+
+struct Add {
+    template <typename T>
+    static constexpr T scalar(T a, T b) { return a + b; }
+    template <typename L, typename Register>
+    static Register lanes(Register a, Register b) { return L::add(a, b); }
+};
+
+struct Subtract {
+    template <typename T>
+    static constexpr T scalar(T a, T b) { return a - b; }
+    template <typename L, typename Register>
+    static Register lanes(Register a, Register b) { return L::sub(a, b); }
+};
+
+struct Multiply {
+    template <typename T>
+    static constexpr T scalar(T a, T b) { return a * b; }
+    template <typename L, typename Register>
+    static Register lanes(Register a, Register b) { return L::mul(a, b); }
+};
+
+// a op b element by element, in whole registers when T and N allow it
+template <typename Op, typename T, size_t N>
+constexpr Vec<T, N> elementwise(const Vec<T, N>& a, const Vec<T, N>& b) {
+    Vec<T, N> result{};
+    if constexpr (VECTORIZED<T, N>) {
+        if (run_time()) {
+            using L = LanesFor<T, N>;
+            constexpr size_t WIDTH = lane_width<T, N>();
+            unroll<N / WIDTH>([&](auto i) {
+                const size_t at = i * WIDTH;
+                L::store(result.v + at, Op::template lanes<L>(L::load(a.v + at), L::load(b.v + at)));
+            });
+            return result;
+        }
+    }
+    unroll<N>([&](auto i) { result[i] = Op::scalar(a[i], b[i]); });
+    return result;
+}
+
+}  // namespace detail
+
+template <typename T, size_t N>
+constexpr Vec<T, N> operator+(const Vec<T, N>& a, const Vec<T, N>& b) {
+    return detail::elementwise<detail::Add>(a, b);
+}
+
+template <typename T, size_t N>
+constexpr Vec<T, N> operator-(const Vec<T, N>& a, const Vec<T, N>& b) {
+    return detail::elementwise<detail::Subtract>(a, b);
+}
+
+// Element-wise (Hadamard) product
+template <typename T, size_t N>
+constexpr Vec<T, N> operator*(const Vec<T, N>& a, const Vec<T, N>& b) {
+    return detail::elementwise<detail::Multiply>(a, b);
+}
+
+template <typename T, size_t N>
+constexpr Vec<T, N> operator*(const Vec<T, N>& a, T scale) {
+    return a * Vec<T, N>::filled(scale);
+}
+
+template <typename T, size_t N>
+constexpr Vec<T, N> operator*(T scale, const Vec<T, N>& a) {
+    return a * Vec<T, N>::filled(scale);
+}
+
+template <typename T, size_t N>
+constexpr bool operator==(const Vec<T, N>& a, const Vec<T, N>& b) {
+    bool equal = true;
+    detail::unroll<N>([&](auto i) { equal = equal && a[i] == b[i]; });
+    return equal;
+}
+
+template <typename T, size_t N>
+constexpr bool operator!=(const Vec<T, N>& a, const Vec<T, N>& b) {
+    return !(a == b);
+}
+
+template <typename T, size_t N>
+constexpr T dot(const Vec<T, N>& a, const Vec<T, N>& b) {
+    if constexpr (detail::VECTORIZED<T, N>) {
+        if (detail::run_time()) {
+            using L = detail::LanesFor<T, N>;
+            constexpr size_t WIDTH = detail::lane_width<T, N>();
+            typename L::Register products = L::mul(L::load(a.v), L::load(b.v));
+            detail::unroll<N / WIDTH - 1>([&](auto i) {
+                const size_t at = (i + 1) * WIDTH;
+                products = L::add(products, L::mul(L::load(a.v + at), L::load(b.v + at)));
+            });
+            return L::sum(products);
+        }
+    }
+    T sum{};
+    detail::unroll<N>([&](auto i) { sum += a[i] * b[i]; });
+    return sum;
+}
+
+template <typename T, size_t N>
+constexpr T length_squared(const Vec<T, N>& a) {
+    return dot(a, a);
+}
+
+template <typename T>
+constexpr Vec<T, 3> cross(const Vec<T, 3>& a, const Vec<T, 3>& b) {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+template <typename T, size_t R, size_t C>
+struct Mat {
+    Vec<T, C> rows[R];
+
+    static constexpr size_t row_count() { return R; }
+    static constexpr size_t column_count() { return C; }
+
+    constexpr Vec<T, C>& operator[](size_t r) { return rows[r]; }
+    constexpr const Vec<T, C>& operator[](size_t r) const { return rows[r]; }
+    constexpr T& operator()(size_t r, size_t c) { return rows[r][c]; }
+    constexpr const T& operator()(size_t r, size_t c) const { return rows[r][c]; }
+
+    static constexpr Mat identity() {
+        static_assert(R == C, "identity of a non-square matrix");
+        Mat result{};
+        detail::unroll<R>([&](auto i) { result(i, i) = T(1); });
+        return result;
+    }
+};
+
+template <typename T, size_t R, size_t C>
+constexpr bool operator==(const Mat<T, R, C>& a, const Mat<T, R, C>& b) {
+    bool equal = true;
+    detail::unroll<R>([&](auto r) { equal = equal && a[r] == b[r]; });
+    return equal;
+}
+
+template <typename T, size_t R, size_t C>
+constexpr bool operator!=(const Mat<T, R, C>& a, const Mat<T, R, C>& b) {
+    return !(a == b);
+}
+
+template <typename T, size_t R, size_t C>
+constexpr Mat<T, C, R> transpose(const Mat<T, R, C>& m) {
+    Mat<T, C, R> result{};
+    detail::unroll<R>([&](auto r) { detail::unroll<C>([&](auto c) { result(c, r) = m(r, c); }); });
+    return result;
+}
+
+// Row r of the product is the sum over k of a(r, k) * row k of b: whole
+// rows of b at a time, which is what the SIMD path vectorizes
+template <typename T, size_t R, size_t K, size_t C>
+constexpr Mat<T, R, C> operator*(const Mat<T, R, K>& a, const Mat<T, K, C>& b) {
+    Mat<T, R, C> result{};
+    detail::unroll<R>([&](auto r) {
+        Vec<T, C> row = b[0] * a(r, 0);
+        detail::unroll<K - 1>([&](auto k) { row = row + b[k + 1] * a(r, k + 1); });
+        result[r] = row;
+    });
+    return result;
+}
+
+// m * v as a sum of columns scaled by v's elements when a column is whole
+// registers (no horizontal adds), as dot products of the rows otherwise
+template <typename T, size_t R, size_t C>
+constexpr Vec<T, R> operator*(const Mat<T, R, C>& m, const Vec<T, C>& v) {
+    Vec<T, R> result{};
+    if constexpr (detail::VECTORIZED<T, R>) {
+        if (detail::run_time()) {
+            const Mat<T, C, R> columns = transpose(m);
+            result = columns[0] * v[0];
+            detail::unroll<C - 1>([&](auto c) { result = result + columns[c + 1] * v[c + 1]; });
+            return result;
+        }
+    }
+    detail::unroll<R>([&](auto r) { result[r] = dot(m[r], v); });
+    return result;
+}
+
+// Homogeneous 3D transforms (column vectors: p' = M * p, with p[3] = 1)
+template <typename T>
+constexpr Mat<T, 4, 4> translation(T x, T y, T z) {
+    Mat<T, 4, 4> m = Mat<T, 4, 4>::identity();
+    m(0, 3) = x;
+    m(1, 3) = y;
+    m(2, 3) = z;
+    return m;
+}
+
+template <typename T>
+constexpr Mat<T, 4, 4> scaling(T x, T y, T z) {
+    Mat<T, 4, 4> m = Mat<T, 4, 4>::identity();
+    m(0, 0) = x;
+    m(1, 1) = y;
+    m(2, 2) = z;
+    return m;
+}
+
+}  // namespace math
@@ -0,0 +1,265 @@
+/**
+ * @file fixed_pool.h
+ * @brief Fixed-size block pools and a pool-backed std allocator
+ *
+ * - FixedBlockPool: blocks of one size carved from chained slabs. Freed
+ *   blocks go on an intrusive free list (the "next" pointer lives inside
+ *   the free block itself), so allocate/deallocate are a pointer pop/push.
+ *   Not thread-safe; one owner.
+ * - FixedPool<T>: typed wrapper with create()/destroy()
+ * - PoolAllocator<T>: drop-in std::allocator replacement for node-based
+ *   containers (std::list, std::map, ...). Single-object allocations come
+ *   from a process-wide pool per (size, alignment), fronted by a
+ *   thread-local cache. A thread only takes the shared pool's lock once
+ *   per BATCH allocations (or frees), in either direction.
+ *
+ * Pool memory is returned to the system only when the owning pool is
+ * destroyed (the shared pools behind PoolAllocator live until exit).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace memory {
+
+class FixedBlockPool {
+public:
+    explicit FixedBlockPool(size_t block_size, size_t block_align = alignof(std::max_align_t),
+                            size_t first_slab_blocks = 64, size_t max_slab_blocks = 16384)
+        : align_(std::max(block_align, alignof(FreeBlock))),
+          block_size_(round_up(std::max(block_size, sizeof(FreeBlock)), align_)),
+          next_slab_blocks_(first_slab_blocks),
+          max_slab_blocks_(std::max(first_slab_blocks, max_slab_blocks)) {}
+
+    ~FixedBlockPool() {
+        while (slabs_ != nullptr) {
+            Slab* next = slabs_->next;
+            ::operator delete(slabs_, std::align_val_t(align_));
+            slabs_ = next;
+        }
+    }
+
+    FixedBlockPool(const FixedBlockPool&) = delete;
+    FixedBlockPool& operator=(const FixedBlockPool&) = delete;
+
+    // Free list first, then the untouched tail of the newest slab
+    void* allocate() {
+        if (free_list_ != nullptr) {
+            FreeBlock* block = free_list_;
+            free_list_ = block->next;
+            return block;
+        }
+        if (bump_ == bump_end_) {
+            add_slab();
+        }
+        void* block = bump_;
+        bump_ += block_size_;
+        return block;
+    }
+
+    void deallocate(void* ptr) {
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = free_list_;
+        free_list_ = block;
+    }
+
+    size_t block_size() const { return block_size_; }
+    size_t slab_count() const { return slab_count_; }
+    size_t reserved_bytes() const { return reserved_bytes_; }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Slab {
+        Slab* next;
+    };
+
+    static size_t round_up(size_t n, size_t align) { return (n + align - 1) / align * align; }
+
+    // Slabs double in size up to max_slab_blocks_, so a pool that grows to
+    // N blocks makes O(log N) trips to the system allocator
+    void add_slab() {
+        size_t header = round_up(sizeof(Slab), align_);
+        size_t bytes = header + next_slab_blocks_ * block_size_;
+        auto* slab = static_cast<Slab*>(::operator new(bytes, std::align_val_t(align_)));
+        slab->next = slabs_;
+        slabs_ = slab;
+
+        bump_ = reinterpret_cast<char*>(slab) + header;
+        bump_end_ = bump_ + next_slab_blocks_ * block_size_;
+        ++slab_count_;
+        reserved_bytes_ += bytes;
+        next_slab_blocks_ = std::min(next_slab_blocks_ * 2, max_slab_blocks_);
+    }
+
+    const size_t align_;
+    const size_t block_size_;
+    size_t next_slab_blocks_;
+    const size_t max_slab_blocks_;
+
+    FreeBlock* free_list_ = nullptr;
+    char* bump_ = nullptr;
+    char* bump_end_ = nullptr;
+    Slab* slabs_ = nullptr;
+    size_t slab_count_ = 0;
+    size_t reserved_bytes_ = 0;
+};
+
+template <typename T>
+class FixedPool {
+public:
+    explicit FixedPool(size_t first_slab_blocks = 64) : blocks_(sizeof(T), alignof(T), first_slab_blocks) {}
+
+    // Raw, uninitialised storage for one T
+    T* allocate() { return static_cast<T*>(blocks_.allocate()); }
+    void deallocate(T* ptr) { blocks_.deallocate(ptr); }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        void* storage = blocks_.allocate();
+        try {
+            return new (storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            blocks_.deallocate(storage);
+            throw;
+        }
+    }
+
+    void destroy(T* ptr) {
+        if (ptr == nullptr) return;
+        ptr->~T();
+        blocks_.deallocate(ptr);
+    }
+
+    size_t slab_count() const { return blocks_.slab_count(); }
+    size_t reserved_bytes() const { return blocks_.reserved_bytes(); }
+
+private:
+    FixedBlockPool blocks_;
+};
+
+// One process-wide pool per block shape, with a per-thread cache in front.
+// Blocks move between the cache and the shared pool in batches of BATCH.
+template <size_t BlockSize, size_t BlockAlign>
+class SharedBlockPool {
+public:
+    static void* allocate() {
+        LocalCache& local = cache();
+        if (local.head == nullptr) {
+            refill(local);
+        }
+        FreeBlock* block = local.head;
+        local.head = block->next;
+        --local.count;
+        return block;
+    }
+
+    static void deallocate(void* ptr) {
+        LocalCache& local = cache();
+        auto* block = static_cast<FreeBlock*>(ptr);
+        block->next = local.head;
+        local.head = block;
+        if (++local.count >= 2 * BATCH) {
+            release(local, BATCH);
+        }
+    }
+
+private:
+    static constexpr size_t BATCH = 256;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Shared {
+        std::mutex mutex;
+        FixedBlockPool pool{BlockSize, BlockAlign, 256};
+    };
+
+    struct LocalCache {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+        ~LocalCache() { release(*this, count); }  // Thread exit: hand everything back
+    };
+
+    // Deliberately leaked so that thread-local caches destroyed during
+    // process exit can still return their blocks
+    static Shared& shared() {
+        static Shared* instance = new Shared;
+        return *instance;
+    }
+
+    static LocalCache& cache() {
+        static thread_local LocalCache local;
+        return local;
+    }
+
+    static void refill(LocalCache& local) {
+        Shared& s = shared();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (size_t i = 0; i < BATCH; ++i) {
+            auto* block = static_cast<FreeBlock*>(s.pool.allocate());
+            block->next = local.head;
+            local.head = block;
+        }
+        local.count += BATCH;
+    }
+
+    static void release(LocalCache& local, size_t n) {
+        if (n == 0) return;
+        Shared& s = shared();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (size_t i = 0; i < n && local.head != nullptr; ++i) {
+            FreeBlock* block = local.head;
+            local.head = block->next;
+            s.pool.deallocate(block);
+            --local.count;
+        }
+    }
+};
+
+// std::allocator replacement. Stateless: every PoolAllocator compares
+// equal, so containers can move and swap nodes between each other freely.
+// Array allocations (n > 1, e.g. a std::vector's buffer) bypass the pool.
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n == 1) {
+            return static_cast<T*>(Pool::allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        if (n == 1) {
+            Pool::deallocate(ptr);
+            return;
+        }
+        ::operator delete(ptr, std::align_val_t(alignof(T)));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+
+private:
+    using Pool = SharedBlockPool<(sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T)),
+                                 (alignof(T) < alignof(void*) ? alignof(void*) : alignof(T))>;
+};
+
+}  // namespace memory
@@ -0,0 +1,555 @@
+/**
+ * @file flat_hash_map.h
+ * @brief Open-addressing hash map with Swiss-table control bytes
+ *
+ * std::unordered_map allocates one node per element and a lookup follows
+ * bucket -> node -> node. FlatHashMap keeps every element inline in one
+ * slot array, plus a parallel array of one-byte "control" entries:
+ *
+ *   ctrl[i] = 0x80        slot i is empty
+ *   ctrl[i] = 0..127      slot i is full; the byte holds 7 bits of the hash
+ *
+ * A lookup starts at the slot picked by the hash and compares a whole group
+ * of control bytes (16 with SSE2, 8 with the portable fallback) against the
+ * 7-bit tag at once. Only slots whose tag matches are compared by key, so
+ * a miss usually touches one control group and no slot at all.
+ *
+ * Groups are probed linearly, which keeps one invariant: between an
+ * element's home slot and the slot it occupies there is no empty slot.
+ * erase() maintains it by shifting later elements of the run back into
+ * the hole (backward-shift deletion), so there are no tombstones. Lookups
+ * never slow down after many erases, and the table never needs a rehash
+ * just to clean up.
+ *
+ * Keys of type std::string get a transparent hash and equality, so
+ * find(), contains() and erase() also accept std::string_view and string
+ * literals without building a temporary std::string.
+ *
+ * Differences from std::unordered_map:
+ * - insert and rehash move elements, so references and iterators are
+ *   invalidated by any insertion that grows the table
+ * - erase() shifts elements, so it invalidates iterators, and
+ *   erase(iterator) returns nothing. Use erase_if() to filter while
+ *   iterating.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace containers {
+
+// Spreads a hash over all 64 bits. Identity hashes (std::hash<int>) would
+// otherwise give every small key the same control-byte tag.
+inline uint64_t hash_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// std::hash, except that string keys get a transparent hash
+template <typename K>
+struct FlatHash : std::hash<K> {};
+
+template <>
+struct FlatHash<std::string> {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+template <typename K>
+using FlatEqual = std::conditional_t<std::is_same_v<K, std::string>, std::equal_to<>, std::equal_to<K>>;
+
+namespace detail {
+
+constexpr int8_t CTRL_EMPTY = static_cast<int8_t>(0x80);
+
+// Bit i*SHIFT..: one candidate per group position
+template <int Shift, typename Word>
+class BitMask {
+public:
+    explicit BitMask(Word bits) : bits_(bits) {}
+    explicit operator bool() const { return bits_ != 0; }
+    size_t lowest() const { return static_cast<size_t>(__builtin_ctzll(bits_)) >> Shift; }
+    void clear_lowest() { bits_ &= bits_ - 1; }
+
+private:
+    Word bits_;
+};
+
+#if defined(__SSE2__)
+
+struct Group {
+    static constexpr size_t WIDTH = 16;
+    using Mask = BitMask<0, uint32_t>;
+
+    explicit Group(const int8_t* ctrl) : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+    Mask match(int8_t tag) const {
+        return Mask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl_))));
+    }
+
+    // Only empty bytes have the top bit set
+    Mask match_empty() const { return Mask(static_cast<uint32_t>(_mm_movemask_epi8(ctrl_))); }
+
+    __m128i ctrl_;
+};
+
+#else
+
+// SWAR fallback: eight control bytes in a uint64_t (little-endian)
+struct Group {
+    static constexpr size_t WIDTH = 8;
+    using Mask = BitMask<3, uint64_t>;
+
+    static constexpr uint64_t LSBS = 0x0101010101010101ULL;
+    static constexpr uint64_t MSBS = 0x8080808080808080ULL;
+
+    explicit Group(const int8_t* ctrl) { std::memcpy(&word_, ctrl, sizeof(word_)); }
+
+    // Classic "has zero byte" trick on word ^ tag. It can report a false
+    // positive next to a real match; the key comparison filters those out.
+    Mask match(int8_t tag) const {
+        uint64_t x = word_ ^ (LSBS * static_cast<uint8_t>(tag));
+        return Mask((x - LSBS) & ~x & MSBS);
+    }
+
+    Mask match_empty() const { return Mask(word_ & MSBS); }
+
+    uint64_t word_;
+};
+
+#endif
+
+}  // namespace detail
+
+template <typename K, typename V, typename Hash = FlatHash<K>, typename Eq = FlatEqual<K>,
+          typename Allocator = std::allocator<std::pair<const K, V>>>
+class FlatHashMap {
+    using Group = detail::Group;
+    static constexpr size_t GROUP_WIDTH = Group::WIDTH;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = Eq;
+    using allocator_type = Allocator;
+
+private:
+    template <typename H, typename = void>
+    struct has_transparent : std::false_type {};
+    template <typename H>
+    struct has_transparent<H, std::void_t<typename H::is_transparent>> : std::true_type {};
+
+    // Heterogeneous lookup is only enabled when both functors opt in
+    template <typename Q>
+    using lookup_key =
+        std::enable_if_t<has_transparent<Hash>::value && has_transparent<Eq>::value && !std::is_same_v<Q, K>>;
+
+    using Slot = std::aligned_storage_t<sizeof(value_type), alignof(value_type)>;
+    using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+    using CtrlAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<int8_t>;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+        Iterator() = default;
+
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        Iterator(const Iterator<false>& other) : map_(other.map_), index_(other.index_) {}
+
+        reference operator*() const { return map_->slot(index_); }
+        pointer operator->() const { return &map_->slot(index_); }
+
+        Iterator& operator++() {
+            index_ = map_->next_full(index_ + 1);
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+
+    private:
+        friend class FlatHashMap;
+        template <bool>
+        friend class Iterator;
+        using MapPtr = std::conditional_t<Const, const FlatHashMap*, FlatHashMap*>;
+
+        Iterator(MapPtr map, size_t index) : map_(map), index_(index) {}
+
+        MapPtr map_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+
+    explicit FlatHashMap(size_t expected, const Allocator& alloc = Allocator()) : alloc_(alloc) {
+        reserve(expected);
+    }
+
+    FlatHashMap(std::initializer_list<value_type> init) {
+        reserve(init.size());
+        for (const value_type& value : init) insert(value);
+    }
+
+    FlatHashMap(const FlatHashMap& other) : hash_(other.hash_), eq_(other.eq_), alloc_(other.alloc_) {
+        reserve(other.size());
+        for (const value_type& value : other) insert(value);
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept : hash_(other.hash_), eq_(other.eq_), alloc_(other.alloc_) {
+        steal(other);
+    }
+
+    FlatHashMap& operator=(FlatHashMap other) noexcept {
+        destroy_table();
+        hash_ = other.hash_;
+        eq_ = other.eq_;
+        steal(other);
+        return *this;
+    }
+
+    ~FlatHashMap() { destroy_table(); }
+
+    iterator begin() { return iterator(this, next_full(0)); }
+    iterator end() { return iterator(this, capacity_); }
+    const_iterator begin() const { return const_iterator(this, next_full(0)); }
+    const_iterator end() const { return const_iterator(this, capacity_); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return capacity_; }
+    float load_factor() const { return capacity_ == 0 ? 0.0f : static_cast<float>(size_) / capacity_; }
+
+    // Bytes owned by the table (slots plus control bytes)
+    size_t memory_bytes() const {
+        return capacity_ == 0 ? 0 : capacity_ * sizeof(Slot) + ctrl_bytes(capacity_);
+    }
+
+    // ===== LOOKUP =====
+
+    iterator find(const K& key) { return iterator(this, find_index(key)); }
+    const_iterator find(const K& key) const { return const_iterator(this, find_index(key)); }
+    bool contains(const K& key) const { return find_index(key) != capacity_; }
+    size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    template <typename Q, typename = lookup_key<Q>>
+    iterator find(const Q& key) {
+        return iterator(this, find_index(key));
+    }
+    template <typename Q, typename = lookup_key<Q>>
+    const_iterator find(const Q& key) const {
+        return const_iterator(this, find_index(key));
+    }
+    template <typename Q, typename = lookup_key<Q>>
+    bool contains(const Q& key) const {
+        return find_index(key) != capacity_;
+    }
+
+    V& at(const K& key) {
+        size_t index = find_index(key);
+        if (index == capacity_) throw std::out_of_range("FlatHashMap::at: key not found");
+        return slot(index).second;
+    }
+
+    // ===== MODIFIERS =====
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        return emplace_key(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return emplace_key(std::move(key), std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return emplace_key(value.first, value.second); }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return emplace_key(std::move(const_cast<K&>(value.first)), std::move(value.second));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const K& key, M&& value) {
+        auto result = emplace_key(key, std::forward<M>(value));
+        if (!result.second) result.first->second = std::forward<M>(value);
+        return result;
+    }
+
+    V& operator[](const K& key) { return emplace_key(key).first->second; }
+    V& operator[](K&& key) { return emplace_key(std::move(key)).first->second; }
+
+    size_t erase(const K& key) { return erase_key(key); }
+
+    template <typename Q, typename = lookup_key<Q>>
+    size_t erase(const Q& key) {
+        return erase_key(key);
+    }
+
+    // Later elements may be shifted into pos, so this returns nothing
+    void erase(const_iterator pos) { erase_at(pos.index_); }
+
+    void clear() {
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (is_full(ctrl_[i])) slot(i).~value_type();
+        }
+        if (ctrl_ != nullptr) std::memset(ctrl_, detail::CTRL_EMPTY, ctrl_bytes(capacity_));
+        size_ = 0;
+    }
+
+    // Make room for n elements without further rehashing
+    void reserve(size_t n) {
+        size_t needed = GROUP_WIDTH;
+        while (needed * MAX_LOAD_NUM / MAX_LOAD_DEN < n) needed <<= 1;
+        if (needed > capacity_) rehash(needed);
+    }
+
+    // Removes every element for which pred(element) is true; returns the
+    // number removed. Safe even though erase() shifts elements backwards:
+    // the slot just erased is re-examined before moving on.
+    template <typename Pred>
+    friend size_t erase_if(FlatHashMap& map, Pred pred) {
+        size_t removed = 0;
+        for (size_t i = 0; i < map.capacity_; ++i) {
+            while (is_full(map.ctrl_[i]) && pred(static_cast<const value_type&>(map.slot(i)))) {
+                map.erase_at(i);
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+private:
+    // Linear probing needs head room: keep the table at most 3/4 full, so
+    // a miss scans about eight slots (one SSE2 group) on average
+    static constexpr size_t MAX_LOAD_NUM = 3;
+    static constexpr size_t MAX_LOAD_DEN = 4;
+
+    static bool is_full(int8_t ctrl) { return ctrl >= 0; }
+
+    // The first GROUP_WIDTH - 1 control bytes are mirrored after the end,
+    // so a group load starting near the end wraps without a branch
+    static size_t ctrl_bytes(size_t capacity) { return capacity + GROUP_WIDTH - 1; }
+
+    value_type& slot(size_t i) { return *std::launder(reinterpret_cast<value_type*>(&slots_[i])); }
+    const value_type& slot(size_t i) const {
+        return *std::launder(reinterpret_cast<const value_type*>(&slots_[i]));
+    }
+
+    template <typename Q>
+    uint64_t hash_of(const Q& key) const {
+        return hash_mix(static_cast<uint64_t>(hash_(key)));
+    }
+
+    // Low bits pick the home slot, the top seven bits become the tag
+    size_t home_of(uint64_t hash) const { return static_cast<size_t>(hash) & (capacity_ - 1); }
+    static int8_t tag_of(uint64_t hash) { return static_cast<int8_t>(hash >> 57); }
+
+    void set_ctrl(size_t i, int8_t value) {
+        ctrl_[i] = value;
+        if (i < GROUP_WIDTH - 1) ctrl_[capacity_ + i] = value;
+    }
+
+    size_t next_full(size_t i) const {
+        while (i < capacity_ && !is_full(ctrl_[i])) ++i;
+        return i;
+    }
+
+    struct ProbeResult {
+        size_t index;  // Matching slot, or the empty slot ending the run
+        bool found;
+    };
+
+    template <typename Q>
+    ProbeResult probe(const Q& key, uint64_t hash) const {
+        const size_t mask = capacity_ - 1;
+        const int8_t tag = tag_of(hash);
+        size_t pos = home_of(hash);
+        while (true) {
+            Group group(ctrl_ + pos);
+            for (auto match = group.match(tag); match; match.clear_lowest()) {
+                size_t index = (pos + match.lowest()) & mask;
+                if (eq_(slot(index).first, key)) return {index, true};
+            }
+            if (auto empty = group.match_empty()) {
+                return {(pos + empty.lowest()) & mask, false};
+            }
+            pos = (pos + GROUP_WIDTH) & mask;
+        }
+    }
+
+    template <typename Q>
+    size_t find_index(const Q& key) const {
+        if (size_ == 0) return capacity_;
+        ProbeResult result = probe(key, hash_of(key));
+        return result.found ? result.index : capacity_;
+    }
+
+    template <typename KeyArg, typename... Args>
+    std::pair<iterator, bool> emplace_key(KeyArg&& key, Args&&... args) {
+        uint64_t hash = hash_of(key);
+        ProbeResult result{0, false};
+        if (capacity_ != 0) {
+            result = probe(key, hash);
+            if (result.found) return {iterator(this, result.index), false};
+        }
+        if (capacity_ == 0 || (size_ + 1) * MAX_LOAD_DEN > capacity_ * MAX_LOAD_NUM) {
+            rehash(capacity_ == 0 ? GROUP_WIDTH : capacity_ * 2);
+            result = probe(key, hash);
+        }
+
+        // No tombstones: the empty slot that ended the probe is the slot
+        new (&slots_[result.index]) value_type(std::piecewise_construct,
+                                               std::forward_as_tuple(std::forward<KeyArg>(key)),
+                                               std::forward_as_tuple(std::forward<Args>(args)...));
+        set_ctrl(result.index, tag_of(hash));
+        ++size_;
+        return {iterator(this, result.index), true};
+    }
+
+    template <typename Q>
+    size_t erase_key(const Q& key) {
+        size_t index = find_index(key);
+        if (index == capacity_) return 0;
+        erase_at(index);
+        return 1;
+    }
+
+    // Backward-shift deletion: walk the run after the hole and move back
+    // every element whose home slot lies at or before the hole, so that no
+    // element is ever separated from its home by an empty slot.
+    void erase_at(size_t hole) {
+        const size_t mask = capacity_ - 1;
+        slot(hole).~value_type();
+        for (size_t j = (hole + 1) & mask; is_full(ctrl_[j]); j = (j + 1) & mask) {
+            size_t home = home_of(hash_of(slot(j).first));
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                relocate(j, hole);
+                set_ctrl(hole, ctrl_[j]);
+                hole = j;
+            }
+        }
+        set_ctrl(hole, detail::CTRL_EMPTY);
+        --size_;
+    }
+
+    // Moves the element in `from` into the (destroyed) slot `to`. The key is
+    // const for users; the table owns it, so moving it out here is fine.
+    void relocate(size_t from, size_t to) {
+        value_type& source = slot(from);
+        new (&slots_[to]) value_type(std::move(const_cast<K&>(source.first)), std::move(source.second));
+        source.~value_type();
+    }
+
+    void rehash(size_t new_capacity) {
+        Slot* old_slots = slots_;
+        int8_t* old_ctrl = ctrl_;
+        size_t old_capacity = capacity_;
+
+        allocate_table(new_capacity);
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (!is_full(old_ctrl[i])) continue;
+            auto* value = std::launder(reinterpret_cast<value_type*>(&old_slots[i]));
+            uint64_t hash = hash_of(value->first);
+            const size_t mask = capacity_ - 1;
+            size_t pos = home_of(hash);
+            // Fresh table, all keys distinct: only empties need finding
+            while (true) {
+                if (auto empty = Group(ctrl_ + pos).match_empty()) {
+                    pos = (pos + empty.lowest()) & mask;
+                    break;
+                }
+                pos = (pos + GROUP_WIDTH) & mask;
+            }
+            new (&slots_[pos]) value_type(std::move(const_cast<K&>(value->first)), std::move(value->second));
+            value->~value_type();
+            set_ctrl(pos, tag_of(hash));
+        }
+        if (old_capacity != 0) deallocate_table(old_slots, old_ctrl, old_capacity);
+    }
+
+    void allocate_table(size_t capacity) {
+        SlotAllocator slot_alloc(alloc_);
+        CtrlAllocator ctrl_alloc(alloc_);
+        slots_ = std::allocator_traits<SlotAllocator>::allocate(slot_alloc, capacity);
+        ctrl_ = std::allocator_traits<CtrlAllocator>::allocate(ctrl_alloc, ctrl_bytes(capacity));
+        std::memset(ctrl_, detail::CTRL_EMPTY, ctrl_bytes(capacity));
+        capacity_ = capacity;
+    }
+
+    void deallocate_table(Slot* slots, int8_t* ctrl, size_t capacity) {
+        SlotAllocator slot_alloc(alloc_);
+        CtrlAllocator ctrl_alloc(alloc_);
+        std::allocator_traits<SlotAllocator>::deallocate(slot_alloc, slots, capacity);
+        std::allocator_traits<CtrlAllocator>::deallocate(ctrl_alloc, ctrl, ctrl_bytes(capacity));
+    }
+
+    void destroy_table() {
+        if (capacity_ == 0) return;
+        clear();
+        deallocate_table(slots_, ctrl_, capacity_);
+        slots_ = nullptr;
+        ctrl_ = nullptr;
+        capacity_ = 0;
+    }
+
+    void steal(FlatHashMap& other) {
+        slots_ = other.slots_;
+        ctrl_ = other.ctrl_;
+        capacity_ = other.capacity_;
+        size_ = other.size_;
+        other.slots_ = nullptr;
+        other.ctrl_ = nullptr;
+        other.capacity_ = other.size_ = 0;
+    }
+
+    Slot* slots_ = nullptr;
+    int8_t* ctrl_ = nullptr;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    Hash hash_;
+    Eq eq_;
+    Allocator alloc_;
+};
+
+}  // namespace containers
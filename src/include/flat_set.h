@@ -0,0 +1,264 @@
+/**
+ * @file flat_set.h
+ * @brief Sorted-vector set and map (FlatSet, FlatMap)
+ *
+ * std::set and std::map allocate one tree node per element: three pointers
+ * and a colour next to every value, and a cache miss per level on lookup.
+ * The flat containers keep their elements sorted in a single std::vector:
+ *
+ * - find / lower_bound are a binary search over contiguous memory
+ * - iteration is a linear scan, as fast as iterating the vector itself
+ * - memory is just the elements (plus unused vector capacity)
+ * - inserting or erasing one element shifts everything after it: O(n)
+ *
+ * That trade-off suits read-mostly data. For build-then-query workloads
+ * use the bulk insert(first, last): it appends the new elements, sorts
+ * only those, and merges them into place once, instead of paying an O(n)
+ * shift per element.
+ *
+ * Iterators are plain vector iterators. Any insertion or erase
+ * invalidates them.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace containers {
+
+namespace detail {
+
+// Shared sorted-vector machinery. KeyOf extracts the key from a stored
+// value: identity for FlatSet, .first for FlatMap.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+class SortedVector {
+public:
+    using key_type = Key;
+    using value_type = Value;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using iterator = typename std::vector<Value>::iterator;
+    using const_iterator = typename std::vector<Value>::const_iterator;
+
+    size_t size() const { return data_.size(); }
+    bool empty() const { return data_.empty(); }
+    size_t capacity() const { return data_.capacity(); }
+    void reserve(size_t n) { data_.reserve(n); }
+    void shrink_to_fit() { data_.shrink_to_fit(); }
+    void clear() { data_.clear(); }
+
+    // Bytes owned by the container, including unused capacity
+    size_t memory_bytes() const { return data_.capacity() * sizeof(Value); }
+
+    const_iterator lower_bound(const Key& key) const {
+        return std::lower_bound(data_.begin(), data_.end(), key, KeyLess{comp_});
+    }
+
+    const_iterator upper_bound(const Key& key) const {
+        return std::upper_bound(data_.begin(), data_.end(), key, KeyGreater{comp_});
+    }
+
+    size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    bool contains(const Key& key) const {
+        auto it = lower_bound(key);
+        return it != data_.end() && !comp_(key, KeyOf()(*it));
+    }
+
+    size_t erase(const Key& key) {
+        auto it = lower_bound(key);
+        if (it == data_.end() || comp_(key, KeyOf()(*it))) return 0;
+        data_.erase(it);
+        return 1;
+    }
+
+    iterator erase(const_iterator pos) { return data_.erase(pos); }
+    iterator erase(const_iterator first, const_iterator last) { return data_.erase(first, last); }
+
+    // Bulk insert: O(m log m + n) for m new elements into n existing ones.
+    // Elements already present win over equivalent new ones, as in std::set.
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last) {
+        size_t old_size = data_.size();
+        data_.insert(data_.end(), first, last);
+        auto middle = data_.begin() + static_cast<std::ptrdiff_t>(old_size);
+        std::stable_sort(middle, data_.end(), ValueLess{comp_});
+        // Stable: for equal keys the existing element comes first
+        std::inplace_merge(data_.begin(), middle, data_.end(), ValueLess{comp_});
+        auto equivalent = [this](const Value& a, const Value& b) { return !comp_(KeyOf()(a), KeyOf()(b)); };
+        data_.erase(std::unique(data_.begin(), data_.end(), equivalent), data_.end());
+    }
+
+protected:
+    struct KeyLess {
+        const Compare& comp;
+        bool operator()(const Value& value, const Key& key) const { return comp(KeyOf()(value), key); }
+    };
+
+    struct KeyGreater {
+        const Compare& comp;
+        bool operator()(const Key& key, const Value& value) const { return comp(key, KeyOf()(value)); }
+    };
+
+    struct ValueLess {
+        const Compare& comp;
+        bool operator()(const Value& a, const Value& b) const { return comp(KeyOf()(a), KeyOf()(b)); }
+    };
+
+    iterator mutable_lower_bound(const Key& key) {
+        return std::lower_bound(data_.begin(), data_.end(), key, KeyLess{comp_});
+    }
+
+    // Insert value (whose key is `key`) unless the key is already present
+    template <typename... Args>
+    std::pair<iterator, bool> insert_unique(const Key& key, Args&&... args) {
+        auto it = mutable_lower_bound(key);
+        if (it != data_.end() && !comp_(key, KeyOf()(*it))) return {it, false};
+        return {data_.emplace(it, std::forward<Args>(args)...), true};
+    }
+
+    std::vector<Value> data_;
+    Compare comp_;
+};
+
+struct Identity {
+    template <typename T>
+    const T& operator()(const T& value) const {
+        return value;
+    }
+};
+
+struct PairFirst {
+    template <typename Pair>
+    const typename Pair::first_type& operator()(const Pair& pair) const {
+        return pair.first;
+    }
+};
+
+}  // namespace detail
+
+template <typename T, typename Compare = std::less<T>>
+class FlatSet : public detail::SortedVector<T, T, detail::Identity, Compare> {
+    using Base = detail::SortedVector<T, T, detail::Identity, Compare>;
+
+public:
+    // Elements are keys: hand out const iterators only
+    using iterator = typename Base::const_iterator;
+    using const_iterator = typename Base::const_iterator;
+    using Base::insert;
+
+    FlatSet() = default;
+
+    template <typename InputIt>
+    FlatSet(InputIt first, InputIt last) {
+        insert(first, last);
+    }
+
+    FlatSet(std::initializer_list<T> init) { insert(init.begin(), init.end()); }
+
+    const_iterator begin() const { return this->data_.begin(); }
+    const_iterator end() const { return this->data_.end(); }
+    const_iterator cbegin() const { return this->data_.begin(); }
+    const_iterator cend() const { return this->data_.end(); }
+
+    std::pair<const_iterator, bool> insert(const T& value) {
+        auto result = this->insert_unique(value, value);
+        return {result.first, result.second};
+    }
+
+    std::pair<const_iterator, bool> insert(T&& value) {
+        auto it = this->mutable_lower_bound(value);
+        if (it != this->data_.end() && !this->comp_(value, *it)) return {it, false};
+        return {this->data_.insert(it, std::move(value)), true};
+    }
+
+    template <typename... Args>
+    std::pair<const_iterator, bool> emplace(Args&&... args) {
+        return insert(T(std::forward<Args>(args)...));
+    }
+
+    const_iterator find(const T& key) const {
+        auto it = this->lower_bound(key);
+        return (it != end() && !this->comp_(key, *it)) ? it : end();
+    }
+
+    // Sorted contents, e.g. for handing to an algorithm
+    const std::vector<T>& sequence() const { return this->data_; }
+};
+
+// Keys live in a plain pair<K, V> so that the vector can move elements.
+// Modifying a key through an iterator breaks the ordering; don't.
+template <typename K, typename V, typename Compare = std::less<K>>
+class FlatMap : public detail::SortedVector<K, std::pair<K, V>, detail::PairFirst, Compare> {
+    using Base = detail::SortedVector<K, std::pair<K, V>, detail::PairFirst, Compare>;
+
+public:
+    using mapped_type = V;
+    using typename Base::const_iterator;
+    using typename Base::iterator;
+    using Base::insert;
+
+    FlatMap() = default;
+
+    template <typename InputIt>
+    FlatMap(InputIt first, InputIt last) {
+        insert(first, last);
+    }
+
+    FlatMap(std::initializer_list<std::pair<K, V>> init) { insert(init.begin(), init.end()); }
+
+    iterator begin() { return this->data_.begin(); }
+    iterator end() { return this->data_.end(); }
+    const_iterator begin() const { return this->data_.begin(); }
+    const_iterator end() const { return this->data_.end(); }
+    const_iterator cbegin() const { return this->data_.begin(); }
+    const_iterator cend() const { return this->data_.end(); }
+
+    std::pair<iterator, bool> insert(const std::pair<K, V>& value) {
+        return this->insert_unique(value.first, value);
+    }
+
+    std::pair<iterator, bool> insert(std::pair<K, V>&& value) {
+        K key = value.first;
+        return this->insert_unique(key, std::move(value));
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        return this->insert_unique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                   std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    V& operator[](const K& key) { return try_emplace(key).first->second; }
+
+    iterator find(const K& key) {
+        auto it = this->mutable_lower_bound(key);
+        return (it != end() && !this->comp_(key, it->first)) ? it : end();
+    }
+
+    const_iterator find(const K& key) const {
+        auto it = this->lower_bound(key);
+        return (it != end() && !this->comp_(key, it->first)) ? it : end();
+    }
+
+    V& at(const K& key) {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("FlatMap::at: key not found");
+        return it->second;
+    }
+
+    const V& at(const K& key) const {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("FlatMap::at: key not found");
+        return it->second;
+    }
+};
+
+}  // namespace containers
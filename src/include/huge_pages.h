@@ -0,0 +1,109 @@
+/**
+ * @file huge_pages.h
+ * @brief Memory on 1GB / 2MB pages when the system has them, 4KB otherwise
+ *
+ * Every 4KB page a program touches needs a TLB entry. The few thousand
+ * the TLB holds cover only a few megabytes, so random access to anything
+ * larger pays a page-table walk on most loads. A 2MB page covers 512
+ * times as much, and a 1GB page covers all of a typical benchmark array.
+ *
+ * HugePageRegion maps one buffer with the largest pages it can get, and
+ * says which it got:
+ *
+ * 1. HUGETLB_1GB / HUGETLB_2MB: mmap(MAP_HUGETLB), from the pool that
+ *    root reserves (vm.nr_hugepages, or hugepages= on the kernel command
+ *    line). Guaranteed huge, but usually unavailable, since the
+ *    reservation defaults to zero.
+ * 2. TRANSPARENT_2MB: a 2MB-aligned mapping with madvise(MADV_HUGEPAGE).
+ *    The kernel backs it with huge pages when it can find free 2MB
+ *    blocks; huge_bytes() tells how much it actually got.
+ * 3. SMALL_4KB: plain pages (explicitly excluded from THP, so that they
+ *    really are 4KB pages).
+ *
+ *     memory::HugePageRegion buffer(512 << 20);
+ *     std::cout << memory::page_size_name(buffer.page_size());   // e.g. "THP 2MB"
+ *
+ *     memory::HugePageArena arena(64 << 20);                      // pmr resource
+ *     std::pmr::vector<uint32_t> table(1 << 24, &arena);
+ *
+ * A page size is only tried for requests of at least one page of that
+ * size, so a 6MB buffer never takes a whole 1GB page.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace memory {
+
+enum class PageSize { HUGETLB_1GB, HUGETLB_2MB, TRANSPARENT_2MB, SMALL_4KB };
+
+const char* page_size_name(PageSize size);
+size_t page_bytes(PageSize size);
+
+class HugePageRegion {
+public:
+    HugePageRegion() = default;
+
+    // At least `bytes`, trying `largest` first and then every smaller
+    // kind. Throws std::bad_alloc if not even 4KB pages can be mapped.
+    explicit HugePageRegion(size_t bytes, PageSize largest = PageSize::HUGETLB_1GB);
+    ~HugePageRegion();
+
+    HugePageRegion(HugePageRegion&& other) noexcept;
+    HugePageRegion& operator=(HugePageRegion&& other) noexcept;
+    HugePageRegion(const HugePageRegion&) = delete;
+    HugePageRegion& operator=(const HugePageRegion&) = delete;
+
+    char* data() const { return data_; }
+    size_t size() const { return size_; }  // Rounded up to whole pages
+    PageSize page_size() const { return page_size_; }
+
+    // Bytes backed by huge pages right now: all of them for hugetlb; for
+    // THP what the kernel has granted so far (pages count once touched)
+    size_t huge_bytes() const;
+
+private:
+    char* data_ = nullptr;
+    size_t size_ = 0;
+    PageSize page_size_ = PageSize::SMALL_4KB;
+};
+
+// Bump-pointer pmr resource over HugePageRegions, one new region (of at
+// least `region_bytes`) whenever the current one is full. Like
+// MonotonicArena, deallocation is a no-op and reset() rewinds everything
+// while keeping the memory mapped.
+class HugePageArena : public std::pmr::memory_resource {
+public:
+    explicit HugePageArena(size_t region_bytes = 64 << 20, PageSize largest = PageSize::HUGETLB_1GB)
+        : region_bytes_(region_bytes), largest_(largest) {}
+
+    void reset() {
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    const std::vector<HugePageRegion>& regions() const { return regions_; }
+
+    // The smallest page size among the regions (what every byte is at
+    // least backed by); SMALL_4KB before the first allocation
+    PageSize page_size() const;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    size_t region_bytes_;
+    PageSize largest_;
+    std::vector<HugePageRegion> regions_;
+    size_t current_ = 0;  // Region being bumped
+    size_t offset_ = 0;
+};
+
+// AnonHugePages of the mapping containing `address`, from /proc/self/smaps
+size_t transparent_huge_bytes(const void* address);
+
+}  // namespace memory
@@ -0,0 +1,233 @@
+/**
+ * @file inline_string.h
+ * @brief String with a configurable inline buffer (small-buffer optimization)
+ *
+ * std::string keeps short strings inside the object, but how short is up
+ * to the library: 15 characters in libstdc++, 22 in libc++. A field that
+ * is usually 20-40 characters long (a name, a key, a path component)
+ * then costs a heap allocation per copy. InlineString<Capacity> stores up
+ * to Capacity characters in the object itself and moves to the heap only
+ * beyond that:
+ *
+ *     containers::InlineString<32> key = "user:1024:session";   // No allocation
+ *     key += ":expires";
+ *     std::string_view view = key;                             // Converts implicitly
+ *
+ * The interface is string_view-first: everything that reads a string
+ * takes std::string_view, whether it came from a std::string, a literal
+ * or another InlineString, and the string converts to std::string_view
+ * wherever one is expected (including the algorithms in
+ * string_algorithms.h). The contents stay NUL-terminated, so c_str() is
+ * free.
+ *
+ * Once on the heap, the string stays there (clear() and shrinking do not
+ * give the buffer back), as std::string does. Moving a heap string steals
+ * its buffer; moving an inline one copies at most Capacity bytes.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace containers {
+
+template <size_t Capacity = 32>
+class InlineString {
+    static_assert(Capacity > 0, "InlineString needs room for at least one character");
+
+public:
+    static constexpr size_t INLINE_CAPACITY = Capacity;
+    static constexpr size_t npos = std::string_view::npos;
+
+    InlineString() noexcept { buffer_[0] = '\0'; }
+    InlineString(std::string_view text) : InlineString() { append(text); }
+    InlineString(const char* text) : InlineString(std::string_view(text)) {}
+    InlineString(size_t count, char c) : InlineString() { resize(count, c); }
+
+    InlineString(const InlineString& other) : InlineString(other.view()) {}
+
+    InlineString(InlineString&& other) noexcept : InlineString() { steal(other); }
+
+    InlineString& operator=(const InlineString& other) {
+        if (this != &other) assign(other.view());
+        return *this;
+    }
+
+    InlineString& operator=(InlineString&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    InlineString& operator=(std::string_view text) { return assign(text); }
+
+    ~InlineString() { release(); }
+
+    // ---- Access ------------------------------------------------------
+
+    char* data() noexcept { return data_; }
+    const char* data() const noexcept { return data_; }
+    const char* c_str() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+    size_t length() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    size_t capacity() const noexcept { return capacity_; }
+
+    // True while the characters live in the object, not on the heap
+    bool is_inline() const noexcept { return data_ == buffer_; }
+
+    std::string_view view() const noexcept { return std::string_view(data_, size_); }
+    operator std::string_view() const noexcept { return view(); }
+    std::string str() const { return std::string(data_, size_); }
+
+    char& operator[](size_t i) noexcept { return data_[i]; }
+    const char& operator[](size_t i) const noexcept { return data_[i]; }
+    char& back() noexcept { return data_[size_ - 1]; }
+    const char& back() const noexcept { return data_[size_ - 1]; }
+
+    char* begin() noexcept { return data_; }
+    char* end() noexcept { return data_ + size_; }
+    const char* begin() const noexcept { return data_; }
+    const char* end() const noexcept { return data_ + size_; }
+
+    // ---- Modification ------------------------------------------------
+
+    InlineString& assign(std::string_view text) {
+        // `text` may point into this string; memmove and no reallocation
+        // before the copy keep that safe
+        if (text.size() > capacity_) {
+            InlineString copy(text);
+            return *this = std::move(copy);
+        }
+        std::memmove(data_, text.data(), text.size());
+        set_size(text.size());
+        return *this;
+    }
+
+    InlineString& append(std::string_view text) {
+        if (size_ + text.size() > capacity_) {
+            if (text.data() >= data_ && text.data() < data_ + size_) {
+                // Appending part of ourselves: copy it out before the buffer moves
+                std::string saved(text);
+                return append(std::string_view(saved));
+            }
+            grow(size_ + text.size());
+        }
+        std::memcpy(data_ + size_, text.data(), text.size());
+        set_size(size_ + text.size());
+        return *this;
+    }
+
+    InlineString& operator+=(std::string_view text) { return append(text); }
+    InlineString& operator+=(char c) {
+        push_back(c);
+        return *this;
+    }
+
+    void push_back(char c) {
+        if (size_ == capacity_) grow(size_ + 1);
+        data_[size_] = c;
+        set_size(size_ + 1);
+    }
+
+    void pop_back() noexcept { set_size(size_ - 1); }
+
+    void resize(size_t count, char c = '\0') {
+        if (count > capacity_) grow(count);
+        if (count > size_) std::memset(data_ + size_, c, count - size_);
+        set_size(count);
+    }
+
+    void reserve(size_t count) {
+        if (count > capacity_) grow(count);
+    }
+
+    void clear() noexcept { set_size(0); }
+
+    // ---- Search ------------------------------------------------------
+
+    size_t find(std::string_view text, size_t pos = 0) const noexcept { return view().find(text, pos); }
+    size_t find(char c, size_t pos = 0) const noexcept { return view().find(c, pos); }
+    std::string_view substr(size_t pos, size_t count = npos) const { return view().substr(pos, count); }
+
+    // ---- Comparison --------------------------------------------------
+
+    // Against anything that converts to std::string_view: another
+    // InlineString, std::string, a literal
+    template <typename Text, typename = std::enable_if_t<std::is_convertible_v<const Text&, std::string_view>>>
+    friend bool operator==(const InlineString& a, const Text& b) noexcept {
+        return a.view() == std::string_view(b);
+    }
+    template <typename Text, typename = std::enable_if_t<std::is_convertible_v<const Text&, std::string_view>>>
+    friend bool operator!=(const InlineString& a, const Text& b) noexcept {
+        return a.view() != std::string_view(b);
+    }
+    template <typename Text, typename = std::enable_if_t<std::is_convertible_v<const Text&, std::string_view>>>
+    friend bool operator<(const InlineString& a, const Text& b) noexcept {
+        return a.view() < std::string_view(b);
+    }
+    template <typename Text, typename = std::enable_if_t<!std::is_same_v<Text, InlineString> &&
+                                                         std::is_convertible_v<const Text&, std::string_view>>>
+    friend bool operator==(const Text& a, const InlineString& b) noexcept {
+        return std::string_view(a) == b.view();
+    }
+    template <typename Text, typename = std::enable_if_t<!std::is_same_v<Text, InlineString> &&
+                                                         std::is_convertible_v<const Text&, std::string_view>>>
+    friend bool operator!=(const Text& a, const InlineString& b) noexcept {
+        return std::string_view(a) != b.view();
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const InlineString& s) { return out << s.view(); }
+
+private:
+    void set_size(size_t size) noexcept {
+        size_ = size;
+        data_[size_] = '\0';
+    }
+
+    // At least `needed` characters, doubling so that appends stay amortized O(1)
+    void grow(size_t needed) {
+        size_t capacity = std::max(needed, capacity_ * 2);
+        char* heap = new char[capacity + 1];
+        std::memcpy(heap, data_, size_ + 1);
+        release();
+        data_ = heap;
+        capacity_ = capacity;
+    }
+
+    void release() noexcept {
+        if (!is_inline()) delete[] data_;
+        data_ = buffer_;
+        capacity_ = Capacity;
+    }
+
+    // Take other's contents, leaving it empty and inline (expects *this released)
+    void steal(InlineString& other) noexcept {
+        if (other.is_inline()) {
+            std::memcpy(buffer_, other.buffer_, other.size_ + 1);
+        } else {
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            other.data_ = other.buffer_;
+            other.capacity_ = Capacity;
+        }
+        size_ = other.size_;
+        other.set_size(0);
+    }
+
+    char* data_ = buffer_;  // buffer_ or a heap block of capacity_ + 1
+    size_t size_ = 0;
+    size_t capacity_ = Capacity;
+    char buffer_[Capacity + 1];
+};
+
+}  // namespace containers
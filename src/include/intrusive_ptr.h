@@ -0,0 +1,227 @@
+/**
+ * @file intrusive_ptr.h
+ * @brief Reference-counted pointer whose count lives inside the object
+ *
+ * std::shared_ptr keeps its counts in a separate control block: a second
+ * allocation (unless make_shared merges them), 16 bytes of pointer per
+ * shared_ptr, and an atomic increment and decrement for every copy, even
+ * when the object never leaves one thread. IntrusivePtr is one pointer
+ * wide and asks the object to count itself:
+ *
+ *     struct Session : memory::RefCounted<Session, memory::LocalCount> {
+ *         int fd;
+ *     };
+ *     memory::IntrusivePtr<Session> session = memory::make_intrusive<Session>();
+ *     auto copy = session;     // ++session->count, not atomic
+ *
+ * The count policy is a template argument of RefCounted:
+ * - AtomicCount: safe to share between threads, like shared_ptr
+ * - LocalCount: a plain integer, for objects that stay on one thread
+ *   (per-core shards, the event-loop thread); copies are then an ordinary
+ *   increment the compiler can even combine or elide
+ *
+ * The allocation policy decides where make_intrusive() gets the memory
+ * and where the last release returns it: HeapAllocation (new / delete) or
+ * PoolAllocation (one block from memory::PoolAllocator's per-size pool
+ * and thread cache). Either way the object and its count are a single
+ * allocation, like std::allocate_shared, without the control block.
+ *
+ * Any type can be used with IntrusivePtr by providing
+ * intrusive_add_ref(T*) and intrusive_release(T*) (found by ADL);
+ * RefCounted defines them. A class hierarchy counted at its base needs a
+ * virtual destructor there (HeapAllocation deletes through the base), and
+ * PoolAllocation only works for the exact type named in RefCounted.
+ * There are no weak references.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "fixed_pool.h"
+
+namespace memory {
+
+class AtomicCount {
+public:
+    void increment() { count_.fetch_add(1, std::memory_order_relaxed); }
+    // True when the count reached zero: the object must be destroyed.
+    // acq_rel orders every other owner's use of the object before that.
+    bool decrement() { return count_.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+    uint32_t load() const { return count_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> count_{0};
+};
+
+class LocalCount {
+public:
+    void increment() { ++count_; }
+    bool decrement() { return --count_ == 0; }
+    uint32_t load() const { return count_; }
+
+private:
+    uint32_t count_ = 0;
+};
+
+struct HeapAllocation {
+    static constexpr bool EXACT_TYPE_ONLY = false;
+
+    template <typename T, typename... Args>
+    static T* create(Args&&... args) {
+        return new T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    static void destroy(T* object) {
+        delete object;
+    }
+};
+
+struct PoolAllocation {
+    static constexpr bool EXACT_TYPE_ONLY = true;  // The pool is chosen by sizeof(T)
+
+    template <typename T, typename... Args>
+    static T* create(Args&&... args) {
+        PoolAllocator<T> pool;
+        T* storage = pool.allocate(1);
+        try {
+            return new (storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            pool.deallocate(storage, 1);
+            throw;
+        }
+    }
+
+    template <typename T>
+    static void destroy(T* object) {
+        object->~T();
+        PoolAllocator<T>().deallocate(object, 1);
+    }
+};
+
+// Base class holding the count. Copying a RefCounted object makes a new
+// object, so the copy's count starts from zero rather than being copied.
+template <typename Derived, typename Count = AtomicCount, typename Allocation = HeapAllocation>
+class RefCounted {
+public:
+    using counted_type = Derived;
+    using allocation_policy = Allocation;
+
+    uint32_t use_count() const { return count_.load(); }
+
+protected:
+    RefCounted() = default;
+    RefCounted(const RefCounted&) {}
+    RefCounted& operator=(const RefCounted&) { return *this; }
+    ~RefCounted() = default;
+
+private:
+    friend void intrusive_add_ref(const RefCounted* object) { object->count_.increment(); }
+
+    friend void intrusive_release(const RefCounted* object) {
+        if (object->count_.decrement()) {
+            Allocation::destroy(static_cast<Derived*>(const_cast<RefCounted*>(object)));
+        }
+    }
+
+    mutable Count count_;
+};
+
+template <typename T>
+class IntrusivePtr {
+public:
+    using element_type = T;
+
+    IntrusivePtr() noexcept = default;
+    IntrusivePtr(std::nullptr_t) noexcept {}
+
+    // Takes a reference to `object` (boost's add_ref = false adopts one
+    // the caller already holds)
+    explicit IntrusivePtr(T* object, bool add_ref = true) : object_(object) {
+        if (object_ != nullptr && add_ref) intrusive_add_ref(object_);
+    }
+
+    IntrusivePtr(const IntrusivePtr& other) : object_(other.object_) {
+        if (object_ != nullptr) intrusive_add_ref(object_);
+    }
+
+    IntrusivePtr(IntrusivePtr&& other) noexcept : object_(std::exchange(other.object_, nullptr)) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    IntrusivePtr(const IntrusivePtr<U>& other) : IntrusivePtr(other.get()) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    IntrusivePtr(IntrusivePtr<U>&& other) noexcept : object_(other.detach()) {}
+
+    ~IntrusivePtr() {
+        if (object_ != nullptr) intrusive_release(object_);
+    }
+
+    // Copy-and-swap: correct for self-assignment and for releasing the
+    // old object last (its destructor may drop a reference to this one)
+    IntrusivePtr& operator=(const IntrusivePtr& other) {
+        IntrusivePtr(other).swap(*this);
+        return *this;
+    }
+
+    IntrusivePtr& operator=(IntrusivePtr&& other) noexcept {
+        IntrusivePtr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void reset() { IntrusivePtr().swap(*this); }
+    void reset(T* object) { IntrusivePtr(object).swap(*this); }
+
+    // Give up ownership without releasing: the caller now holds the reference
+    T* detach() noexcept { return std::exchange(object_, nullptr); }
+
+    void swap(IntrusivePtr& other) noexcept { std::swap(object_, other.object_); }
+
+    T* get() const noexcept { return object_; }
+    T& operator*() const noexcept { return *object_; }
+    T* operator->() const noexcept { return object_; }
+    explicit operator bool() const noexcept { return object_ != nullptr; }
+
+    uint32_t use_count() const { return object_ != nullptr ? object_->use_count() : 0; }
+
+private:
+    T* object_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const IntrusivePtr<T>& a, const IntrusivePtr<U>& b) {
+    return a.get() == b.get();
+}
+
+template <typename T, typename U>
+bool operator!=(const IntrusivePtr<T>& a, const IntrusivePtr<U>& b) {
+    return a.get() != b.get();
+}
+
+template <typename T>
+bool operator==(const IntrusivePtr<T>& a, std::nullptr_t) {
+    return a.get() == nullptr;
+}
+
+template <typename T>
+bool operator!=(const IntrusivePtr<T>& a, std::nullptr_t) {
+    return a.get() != nullptr;
+}
+
+// One allocation holding the object and its count, from T's allocation
+// policy (the counterpart of std::make_shared / std::allocate_shared)
+template <typename T, typename... Args>
+IntrusivePtr<T> make_intrusive(Args&&... args) {
+    using Allocation = typename T::allocation_policy;
+    static_assert(!Allocation::EXACT_TYPE_ONLY || std::is_same_v<T, typename T::counted_type>,
+                  "a pool-allocated type must be the Derived of its own RefCounted base");
+    return IntrusivePtr<T>(Allocation::template create<T>(std::forward<Args>(args)...));
+}
+
+}  // namespace memory
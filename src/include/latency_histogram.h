@@ -0,0 +1,121 @@
+/**
+ * @file latency_histogram.h
+ * @brief Fixed-size HDR-style latency histogram (log-linear buckets)
+ *
+ * Values (typically nanoseconds) are bucketed by their power of two and then
+ * split into SUB_BUCKETS linear sub-buckets, the same layout HdrHistogram
+ * uses. With 32 sub-buckets every recorded value is reproduced within ~3%,
+ * across the whole range from 1ns to hours, in a flat 16KB array:
+ *
+ * - record() is a handful of integer ops, no allocation, no locking
+ * - percentile() walks the buckets once
+ * - merge() adds per-thread histograms together after a run
+ *
+ * A histogram is not thread-safe; give each thread its own and merge.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int EXPONENTS = 64 - SUB_BUCKET_BITS + 1;
+    static const int BUCKET_COUNT = EXPONENTS * SUB_BUCKETS;
+
+    void record(uint64_t value) {
+        counts_[bucket_index(value)]++;
+        total_++;
+        sum_ += value;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    // `count` samples of the same value at once
+    void record(uint64_t value, uint64_t count) {
+        if (count == 0) return;
+        counts_[bucket_index(value)] += count;
+        total_ += count;
+        sum_ += value * count;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    void reset() { *this = LatencyHistogram(); }
+
+    uint64_t count() const { return total_; }
+    uint64_t min() const { return total_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ ? static_cast<double>(sum_) / static_cast<double>(total_) : 0.0; }
+
+    // Value at or below which `percent` (0..100) of the samples fall
+    uint64_t percentile(double percent) const {
+        if (total_ == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(total_) + 0.5);
+        target = std::max<uint64_t>(1, std::min(target, total_));
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            seen += counts_[i];
+            if (seen >= target) {
+                return std::min(bucket_upper_bound(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    // "p50=... p99=... p99.9=... max=..." with values divided by `scale`
+    std::string summary(double scale = 1000.0, const char* unit = "us") const {
+        char line[256];
+        snprintf(line, sizeof(line), "min=%.2f%s p50=%.2f%s p99=%.2f%s p99.9=%.2f%s max=%.2f%s (n=%llu)",
+                 static_cast<double>(min()) / scale, unit, static_cast<double>(percentile(50)) / scale, unit,
+                 static_cast<double>(percentile(99)) / scale, unit, static_cast<double>(percentile(99.9)) / scale,
+                 unit, static_cast<double>(max()) / scale, unit, static_cast<unsigned long long>(total_));
+        return line;
+    }
+
+    // Values below SUB_BUCKETS map 1:1; above that the exponent picks the
+    // bucket group and the next SUB_BUCKET_BITS bits pick the sub-bucket.
+    // Public for histograms that keep the same buckets in another form
+    // (per-thread atomic counts in metrics.h).
+    static int bucket_index(uint64_t value) {
+        if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+            return static_cast<int>(value);
+        }
+        int exponent = 63 - __builtin_clzll(value);  // >= SUB_BUCKET_BITS
+        int shift = exponent - SUB_BUCKET_BITS;
+        int sub = static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+        return (shift + 1) * SUB_BUCKETS + sub;
+    }
+
+    static uint64_t bucket_upper_bound(int index) {
+        int group = index / SUB_BUCKETS;
+        uint64_t sub = static_cast<uint64_t>(index % SUB_BUCKETS);
+        if (group == 0) return sub;
+        int shift = group - 1;
+        uint64_t low = (static_cast<uint64_t>(SUB_BUCKETS) | sub) << shift;
+        return low + ((uint64_t{1} << shift) - 1);
+    }
+
+private:
+    uint64_t counts_[BUCKET_COUNT] = {};
+    uint64_t total_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ = 0;
+};
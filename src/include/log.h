@@ -0,0 +1,116 @@
+/**
+ * @file log.h
+ * @brief Leveled log lines that cost nothing when their level is off
+ *
+ * `std::cout << ... << std::endl` on every packet takes the stream's lock
+ * and flushes, i.e. makes a write() system call, on the hot path. These
+ * macros format a line into a buffer on the stack and hand it to the
+ * kernel with one write(), without a lock and without a flush:
+ *
+ *     LOG_INFO << "Client connected: " << ip << ":" << port;
+ *     LOG_DEBUG << "Command from " << ip << ": " << command;
+ *
+ * Two filters apply:
+ * - BOOTCAMP_LOG_MAX_LEVEL, at compile time. Messages above it expand to
+ *   `if (false)`, so their arguments are never even evaluated and the
+ *   optimizer deletes them. Release builds (NDEBUG) default to INFO, so
+ *   per-packet and per-command DEBUG lines do not exist there at all;
+ *   other builds default to DEBUG.
+ * - set_level(), at run time (the servers' --log-level flag), default INFO.
+ *
+ * Lines longer than MAX_LINE are truncated. A line of up to PIPE_BUF bytes
+ * written with one write() is not interleaved with other threads' lines
+ * on a pipe; on a terminal or file it is in practice.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if !defined(BOOTCAMP_LOG_MAX_LEVEL)
+#if defined(NDEBUG)
+#define BOOTCAMP_LOG_MAX_LEVEL 2  // INFO
+#else
+#define BOOTCAMP_LOG_MAX_LEVEL 3  // DEBUG
+#endif
+#endif
+
+namespace logging {
+
+enum class Level : int { ERROR = 0, WARNING = 1, INFO = 2, DEBUG = 3 };
+
+constexpr Level COMPILED_LEVEL = static_cast<Level>(BOOTCAMP_LOG_MAX_LEVEL);
+
+namespace detail {
+inline std::atomic<int> runtime_level{static_cast<int>(Level::INFO)};
+}  // namespace detail
+
+inline void set_level(Level level) { detail::runtime_level.store(static_cast<int>(level), std::memory_order_relaxed); }
+
+inline Level level() { return static_cast<Level>(detail::runtime_level.load(std::memory_order_relaxed)); }
+
+// Constant false, and the whole statement dead code, for levels above
+// COMPILED_LEVEL
+inline bool enabled(Level level) {
+    return level <= COMPILED_LEVEL &&
+           static_cast<int>(level) <= detail::runtime_level.load(std::memory_order_relaxed);
+}
+
+const char* level_name(Level level);
+
+// "error", "warning", "info" or "debug"; false for anything else
+bool parse_level(std::string_view name, Level& level);
+
+// One log line, written when the statement ends
+class Line {
+public:
+    static constexpr size_t MAX_LINE = 512;
+
+    explicit Line(Level level);
+    ~Line();
+
+    Line(const Line&) = delete;
+    Line& operator=(const Line&) = delete;
+
+    Line& operator<<(std::string_view text);
+    Line& operator<<(const char* text) { return *this << std::string_view(text); }
+    Line& operator<<(const std::string& text) { return *this << std::string_view(text); }
+    Line& operator<<(char c) { return *this << std::string_view(&c, 1); }
+    Line& operator<<(bool value) { return *this << (value ? "true" : "false"); }
+    Line& operator<<(double value);
+
+    template <typename Integer, typename = std::enable_if_t<std::is_integral_v<Integer>>>
+    Line& operator<<(Integer value) {
+        if constexpr (std::is_signed_v<Integer>) {
+            return append_signed(static_cast<long long>(value));
+        } else {
+            return append_unsigned(static_cast<unsigned long long>(value));
+        }
+    }
+
+private:
+    Line& append_signed(long long value);
+    Line& append_unsigned(unsigned long long value);
+
+    Level level_;
+    char buffer_[MAX_LINE];
+    size_t length_ = 0;
+};
+
+}  // namespace logging
+
+// `if (!enabled) {} else`: safe inside an unbraced if/else, and the stream
+// expression after it is only evaluated for an enabled level
+#define BOOTCAMP_LOG(level) \
+    if (!::logging::enabled(level)) { \
+    } else \
+        ::logging::Line(level)
+
+#define LOG_ERROR BOOTCAMP_LOG(::logging::Level::ERROR)
+#define LOG_WARNING BOOTCAMP_LOG(::logging::Level::WARNING)
+#define LOG_INFO BOOTCAMP_LOG(::logging::Level::INFO)
+#define LOG_DEBUG BOOTCAMP_LOG(::logging::Level::DEBUG)
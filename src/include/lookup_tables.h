@@ -0,0 +1,93 @@
+/**
+ * @file lookup_tables.h
+ * @brief CRC-32 and popcount lookup tables computed by the compiler
+ *
+ * A table-driven algorithm needs its table before the first call: built
+ * at startup it costs time and a static-initialization order to get
+ * right; typed in by hand it is a block of magic numbers nobody can
+ * review. A constexpr generator does neither: the compiler runs it, the
+ * table lands in .rodata as if it had been typed in, and the code that
+ * builds it is the specification.
+ *
+ *     uint32_t checksum = tables::crc32(buffer.data(), buffer.size());
+ *     static_assert(tables::crc32("123456789") == 0xCBF43926);  // At compile time
+ *     int bits = tables::popcount(mask);
+ *
+ * crc32() (the IEEE 802.3 / zlib polynomial, reflected) uses
+ * slicing-by-8: eight 256-entry tables, so the loop takes eight bytes per
+ * step instead of one and has a much shorter dependency chain. popcount()
+ * is the portable byte-table version; with a hardware POPCNT,
+ * __builtin_popcountll (or C++20 std::popcount) is faster.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace tables {
+
+using Crc32Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+// tables[0] is the classic byte-at-a-time table; tables[k][b] is the CRC
+// of byte b followed by k zero bytes, for slicing-by-8
+constexpr Crc32Tables make_crc32_tables(uint32_t polynomial = 0xEDB88320u) {
+    Crc32Tables tables{};
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+        uint32_t crc = byte;
+        for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (crc & 1 ? polynomial : 0);
+        tables[0][byte] = crc;
+    }
+    for (size_t k = 1; k < 8; ++k) {
+        for (size_t byte = 0; byte < 256; ++byte) {
+            uint32_t previous = tables[k - 1][byte];
+            tables[k][byte] = (previous >> 8) ^ tables[0][previous & 0xFF];
+        }
+    }
+    return tables;
+}
+
+inline constexpr Crc32Tables CRC32_TABLES = make_crc32_tables();
+
+// Continue a running CRC with `previous` (0 to start), so data can be
+// checksummed in pieces
+constexpr uint32_t crc32(const char* data, size_t size, uint32_t previous = 0) {
+    const auto& t = CRC32_TABLES;
+    uint32_t crc = ~previous;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        // Byte by byte rather than a 64-bit load: valid in constant
+        // expressions and independent of endianness (compilers merge it)
+        uint32_t low = crc ^ (static_cast<uint32_t>(static_cast<uint8_t>(data[i])) |
+                              static_cast<uint32_t>(static_cast<uint8_t>(data[i + 1])) << 8 |
+                              static_cast<uint32_t>(static_cast<uint8_t>(data[i + 2])) << 16 |
+                              static_cast<uint32_t>(static_cast<uint8_t>(data[i + 3])) << 24);
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][static_cast<uint8_t>(data[i + 4])] ^ t[2][static_cast<uint8_t>(data[i + 5])] ^
+              t[1][static_cast<uint8_t>(data[i + 6])] ^ t[0][static_cast<uint8_t>(data[i + 7])];
+    }
+    for (; i < size; ++i) crc = (crc >> 8) ^ t[0][(crc ^ static_cast<uint8_t>(data[i])) & 0xFF];
+    return ~crc;
+}
+
+constexpr uint32_t crc32(std::string_view text, uint32_t previous = 0) {
+    return crc32(text.data(), text.size(), previous);
+}
+
+constexpr std::array<uint8_t, 256> make_popcount_table() {
+    std::array<uint8_t, 256> table{};
+    for (size_t byte = 1; byte < 256; ++byte) table[byte] = static_cast<uint8_t>((byte & 1) + table[byte / 2]);
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> POPCOUNT_TABLE = make_popcount_table();
+
+constexpr int popcount(uint64_t x) {
+    int count = 0;
+    for (int byte = 0; byte < 8; ++byte, x >>= 8) count += POPCOUNT_TABLE[x & 0xFF];
+    return count;
+}
+
+}  // namespace tables
@@ -0,0 +1,57 @@
+/**
+ * @file mapped_file.h
+ * @brief Read-only memory-mapped file
+ *
+ * Reading a file through mmap() skips the copy from the page cache into a
+ * user buffer: the file's pages are mapped straight into the address space
+ * and faulted in on first touch. Parsers can then hand out string_views
+ * into the file instead of copying every field.
+ *
+ *     memory::MappedFile file;
+ *     if (!file.open("records.txt")) { perror("open"); return; }
+ *     std::string_view text = file.view();
+ *
+ * The mapping is private and read-only, so views into it stay valid until
+ * the MappedFile is closed or destroyed, even if the file changes size
+ * (reads past a truncated end fault, as with any mmap).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace memory {
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Map the whole file read-only. Returns false (and leaves errno set) on
+    // failure. An empty file opens successfully with an empty view.
+    bool open(const std::string& path);
+    void close();
+
+    // Kernel readahead hint for the whole mapping, e.g. MADV_SEQUENTIAL
+    // before a front-to-back scan; returns false if madvise() fails
+    bool advise(int advice) const;
+
+    bool is_open() const { return open_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+};
+
+}  // namespace memory
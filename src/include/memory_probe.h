@@ -0,0 +1,119 @@
+/**
+ * @file memory_probe.h
+ * @brief Measure this host's cache sizes, memory latency, bandwidth and TLB reach
+ *
+ * Spec sheets and sysconf() say how big the caches are; they do not say
+ * where a working set actually starts to hurt, what a miss costs, or how
+ * many threads it takes to saturate memory bandwidth. probe_memory()
+ * measures all of it:
+ *
+ * - latency: a pointer chase (each load's address comes from the previous
+ *   load, in random order) over working sets from 4KB up to 1GB. The
+ *   time per load steps up wherever the set outgrows a cache level, and
+ *   find_knees() turns those steps into detected L1/L2/L3 sizes and the
+ *   DRAM latency.
+ * - bandwidth: STREAM's copy / scale / add / triad kernels over arrays
+ *   well beyond the last-level cache, with 1, 2, 4 ... threads.
+ * - TLB reach: one load per 4KB page, again chased, over a growing
+ *   number of pages, once on ordinary pages and once on a region madvised
+ *   for transparent huge pages. Both runs miss the caches alike, so where
+ *   the small-page curve climbs above the huge-page curve is the cost of
+ *   TLB misses.
+ *
+ *     memory::MemoryProfile profile = memory::probe_memory();
+ *     size_t chunk = profile.cache_bytes(2) / 2;   // Half of the detected L2
+ *     std::cout << profile.to_json();
+ *
+ * The JSON is meant for scripts that size buffers and pools per host.
+ * A full probe takes tens of seconds; ProbeOptions shrinks it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace memory {
+
+struct ProbeOptions {
+    size_t min_working_set = 4 << 10;
+    size_t max_working_set = size_t{1} << 30;  // Also capped at a quarter of RAM
+    size_t loads_per_point = 1 << 21;          // Chased loads per working set
+    size_t stream_array_bytes = 0;             // 0: 4x the last-level cache, at least 64MB
+    unsigned max_threads = 0;                  // 0: hardware_concurrency()
+    size_t max_tlb_pages = 1 << 16;            // 256MB at 4KB per page
+};
+
+struct LatencyPoint {
+    size_t bytes;
+    double ns_per_load;
+};
+
+// A plateau of the latency curve: everything up to `bytes` fits
+struct CacheLevel {
+    int level;              // 1 = L1
+    size_t bytes;           // Largest working set still on the plateau
+    double ns_per_load;     // Median latency on the plateau
+    size_t reported_bytes;  // What sysconf() says, 0 if unknown
+};
+
+struct BandwidthPoint {
+    std::string kernel;  // "copy", "scale", "add", "triad"
+    unsigned threads;
+    double bytes_per_second;  // Best of several runs, counting reads and writes
+};
+
+struct TlbPoint {
+    size_t pages;
+    double ns_small_pages;
+    double ns_huge_pages;  // 0 if no huge pages were granted
+};
+
+struct MemoryProfile {
+    size_t line_bytes = 64;
+    size_t page_bytes = 4096;
+    std::vector<LatencyPoint> latency;
+    std::vector<CacheLevel> caches;
+    double memory_ns_per_load = 0;  // Largest working set probed
+    std::vector<BandwidthPoint> bandwidth;
+    std::vector<TlbPoint> tlb;
+    size_t huge_page_bytes_granted = 0;
+    size_t tlb_reach_pages = 0;  // Pages before the small-page curve climbs, 0 if it never did
+
+    // Detected size of cache `level` (1-based), 0 if not detected
+    size_t cache_bytes(int level) const;
+    // Highest bandwidth of any kernel and thread count
+    double peak_bytes_per_second() const;
+
+    std::string to_json() const;
+};
+
+// Nanoseconds per load chasing a random cycle through `bytes` of memory
+double chase_latency_ns(size_t bytes, size_t loads);
+
+// Same, through `bytes` of the caller's memory (e.g. bound to a NUMA node)
+double chase_latency_ns(void* memory, size_t bytes, size_t loads);
+
+std::vector<LatencyPoint> probe_latency(const ProbeOptions& options = ProbeOptions());
+
+// Indices into `ns` where the curve steps up by at least `ratio` over the
+// median of the plateau before it, and stays up at the next point; each
+// plateau ends at the index before its knee. The next plateau starts only
+// once the curve has been level (within 15%) for two points in a row, so a
+// noisy point inside a transition does not count as a step of its own.
+std::vector<size_t> find_knees(const std::vector<double>& ns, double ratio = 1.4);
+
+// One level per knee, numbered by the sysconf() size it lies within 2x
+// of; two knees that match the same reported cache become one level
+std::vector<CacheLevel> find_cache_levels(const std::vector<LatencyPoint>& latency);
+
+// `array_bytes` per array, three arrays
+std::vector<BandwidthPoint> probe_bandwidth(size_t array_bytes, unsigned max_threads);
+
+// Fills profile.tlb, huge_page_bytes_granted and tlb_reach_pages
+void probe_tlb(MemoryProfile& profile, size_t max_pages);
+
+MemoryProfile probe_memory(const ProbeOptions& options = ProbeOptions());
+
+}  // namespace memory
@@ -0,0 +1,230 @@
+/**
+ * @file metrics.h
+ * @brief Per-thread counters, latency histograms and trace ring for the servers
+ *
+ * Instrumentation on a hot path must not itself become a shared resource.
+ * Everything here is recorded into the calling thread's own block of
+ * memory, with plain relaxed loads and stores (each thread is the only
+ * writer of its block, so no read-modify-write is needed), and only the
+ * rare reader - a `stats` command, a Prometheus scrape, a trace dump -
+ * walks all threads and adds them up:
+ *
+ *     const metrics::Counter commands("telnet_commands_total", "Commands executed");
+ *     const metrics::Histogram command_latency("telnet_command_seconds", "execute_command() time");
+ *     const metrics::TraceEvent trace_command("command");
+ *
+ *     {
+ *         metrics::ScopedTimer timer(command_latency);   // Records on scope exit
+ *         run(command);
+ *     }
+ *     commands.add();
+ *     trace_command(command.size());                    // Into this thread's ring
+ *
+ * Metrics are declared once at namespace scope (registration is not meant
+ * for the hot path) and identified by index, up to MAX_COUNTERS /
+ * MAX_HISTOGRAMS / MAX_EVENTS of each. Names follow Prometheus
+ * conventions: counters end in _total, histograms record nanoseconds and
+ * are exported in seconds.
+ *
+ * Histograms use LatencyHistogram's log-linear buckets (~3% precision),
+ * with atomic bucket counts so they can be read while being written. A
+ * thread's copy of a histogram (15KB) is allocated on its first record().
+ *
+ * The trace ring is a flight recorder: every thread keeps its last
+ * TRACE_CAPACITY events as fixed 32-byte binary records (timestamp, event,
+ * argument), overwriting the oldest. Nothing is formatted until somebody
+ * asks; dump_trace() writes all threads' records, oldest first, as:
+ *
+ *     "BTRACE01"  u32 event_count  { u16 id  u16 length  name[length] } * event_count
+ *     u64 entry_count  { u64 timestamp_ns  u32 thread  u16 event  u16 0  u64 argument } * entry_count
+ *
+ * (host byte order; timestamps are steady_clock nanoseconds).
+ *
+ * Threads that exit leave their block behind for the next new thread, so
+ * totals never go backwards and a thread-per-client server does not grow
+ * without bound.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cache_line.h"
+#include "latency_histogram.h"
+
+namespace metrics {
+
+constexpr size_t MAX_COUNTERS = 64;
+constexpr size_t MAX_HISTOGRAMS = 16;
+constexpr size_t MAX_EVENTS = 64;
+constexpr size_t TRACE_CAPACITY = 4096;  // Per thread; a power of two
+constexpr int SCRAPE_TIMEOUT_SECONDS = 2;  // serve_prometheus() per-client recv/send timeout
+
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+namespace detail {
+
+// Single-writer increment: no lock prefix, readers still see whole values
+inline void bump(std::atomic<uint64_t>& slot, uint64_t n) {
+    slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct AtomicHistogram {
+    std::atomic<uint64_t> counts[LatencyHistogram::BUCKET_COUNT] = {};
+    std::atomic<uint64_t> sum{0};
+};
+
+struct TraceSlot {
+    std::atomic<uint64_t> sequence{0};  // 2 * position + 2 once complete, odd while written
+    std::atomic<uint64_t> timestamp{0};
+    std::atomic<uint64_t> event{0};
+    std::atomic<uint64_t> argument{0};
+};
+
+struct TraceRing {
+    std::atomic<uint64_t> head{0};  // Events ever written
+    TraceSlot slots[TRACE_CAPACITY];
+};
+
+struct alignas(CACHE_LINE_SIZE) ThreadMetrics {
+    std::atomic<uint64_t> counters[MAX_COUNTERS] = {};
+    std::atomic<AtomicHistogram*> histograms[MAX_HISTOGRAMS] = {};  // Each on first use
+    std::atomic<TraceRing*> trace{nullptr};                         // On first use
+    uint32_t thread = 0;            // Small id, stable for the block
+    std::atomic<bool> in_use{false};
+    ThreadMetrics* next = nullptr;  // Registry list; never freed
+};
+
+ThreadMetrics* register_thread();
+AtomicHistogram* allocate_histogram(ThreadMetrics& block, uint32_t id);
+TraceRing* allocate_trace(ThreadMetrics& block);
+
+inline thread_local ThreadMetrics* current = nullptr;
+
+inline ThreadMetrics& this_thread() {
+    ThreadMetrics* block = current;
+    return block != nullptr ? *block : *register_thread();
+}
+
+}  // namespace detail
+
+class Counter {
+public:
+    Counter(const char* name, const char* help);
+
+    void add(uint64_t n = 1) const { detail::bump(detail::this_thread().counters[id_], n); }
+
+    // Sum over every thread that ever added to it
+    uint64_t value() const;
+
+    uint32_t id() const { return id_; }
+
+private:
+    uint32_t id_;
+};
+
+class Histogram {
+public:
+    Histogram(const char* name, const char* help);
+
+    void record(uint64_t nanoseconds) const {
+        detail::ThreadMetrics& block = detail::this_thread();
+        detail::AtomicHistogram* histogram = block.histograms[id_].load(std::memory_order_relaxed);
+        if (histogram == nullptr) histogram = detail::allocate_histogram(block, id_);
+        detail::bump(histogram->counts[LatencyHistogram::bucket_index(nanoseconds)], 1);
+        detail::bump(histogram->sum, nanoseconds);
+    }
+
+    // All threads merged; values are the upper bounds of their buckets
+    LatencyHistogram snapshot() const;
+
+    // Exact sum of everything recorded, in nanoseconds
+    uint64_t sum() const;
+
+    uint32_t id() const { return id_; }
+
+private:
+    uint32_t id_;
+};
+
+// Records the time between construction and destruction
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const Histogram& histogram) : histogram_(histogram), start_(now_ns()) {}
+    ~ScopedTimer() { histogram_.record(now_ns() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const Histogram& histogram_;
+    uint64_t start_;
+};
+
+class TraceEvent {
+public:
+    explicit TraceEvent(const char* name);
+
+    // Append (now, this event, argument) to the calling thread's ring
+    void operator()(uint64_t argument = 0) const {
+        detail::ThreadMetrics& block = detail::this_thread();
+        detail::TraceRing* ring = block.trace.load(std::memory_order_relaxed);
+        if (ring == nullptr) ring = detail::allocate_trace(block);
+        uint64_t position = ring->head.load(std::memory_order_relaxed);
+        detail::TraceSlot& slot = ring->slots[position & (TRACE_CAPACITY - 1)];
+        // A per-slot seqlock (see seqlock.h): readers retry or skip a slot
+        // that is being overwritten
+        slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.timestamp.store(now_ns(), std::memory_order_relaxed);
+        slot.event.store(id_, std::memory_order_relaxed);
+        slot.argument.store(argument, std::memory_order_relaxed);
+        slot.sequence.store(2 * position + 2, std::memory_order_release);
+        ring->head.store(position + 1, std::memory_order_release);
+    }
+
+    uint32_t id() const { return id_; }
+
+private:
+    uint32_t id_;
+};
+
+struct TraceEntry {
+    uint64_t timestamp_ns;
+    uint32_t thread;
+    uint16_t event;
+    uint64_t argument;
+};
+
+// Every thread's retained events, oldest first
+std::vector<TraceEntry> collect_trace();
+
+const char* event_name(uint16_t event);
+
+// The newest `last` events as text lines, times relative to the newest
+std::string format_trace(size_t last, const char* line_end = "\n");
+
+// Binary dump (format above); false if the file cannot be written
+bool dump_trace(const char* path);
+
+// Every counter and histogram, one per line, for humans
+std::string render_text(const char* line_end = "\n");
+
+// Prometheus text exposition format (counters, histograms as summaries)
+std::string render_prometheus();
+
+// Answer every HTTP request on `port` with render_prometheus(), from a
+// background thread. Loopback only unless `address` (IPv4, e.g. "0.0.0.0")
+// says otherwise. False if the address is invalid or cannot be bound.
+bool serve_prometheus(int port, const char* address = "127.0.0.1");
+
+}  // namespace metrics
@@ -0,0 +1,131 @@
+/**
+ * @file monotonic_arena.h
+ * @brief Bump-pointer arena over chained blocks, exposed as a pmr resource
+ *
+ * Per-request scratch memory: every allocation is a pointer bump, nothing
+ * is freed individually, and reset() rewinds the whole arena at once when
+ * the request is done.
+ *
+ * Unlike std::pmr::monotonic_buffer_resource, reset() keeps the memory.
+ * If a request outgrew the first block, reset() swaps the chain for one
+ * block of the combined size. After the first few requests the arena
+ * therefore stops calling its upstream allocator at all.
+ *
+ * Use it through std::pmr containers:
+ *
+ *     memory::MonotonicArena arena(8192);
+ *     std::pmr::string reply(&arena);
+ *     std::pmr::vector<Token> tokens(&arena);
+ *     ...
+ *     arena.reset();   // Everything above is gone; do not touch it again
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace memory {
+
+class MonotonicArena : public std::pmr::memory_resource {
+public:
+    explicit MonotonicArena(size_t initial_size = 4096,
+                            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream), next_block_size_(initial_size < MIN_BLOCK ? MIN_BLOCK : initial_size) {
+        add_block(next_block_size_);
+    }
+
+    ~MonotonicArena() override { release_blocks(); }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    // Forget every allocation. Memory is kept (coalesced into one block if
+    // the last request needed more than one).
+    void reset() {
+        if (head_ != nullptr && head_->next != nullptr) {
+            size_t total = capacity_;
+            release_blocks();
+            add_block(total);
+        } else if (head_ != nullptr) {
+            cursor_ = head_->data();
+        }
+        used_ = 0;
+    }
+
+    // Bytes handed out since the last reset()
+    size_t bytes_used() const { return used_; }
+
+    // Bytes owned, including block headers
+    size_t capacity() const { return capacity_; }
+
+    // Calls to the upstream resource over the arena's lifetime
+    uint64_t upstream_allocations() const { return upstream_allocations_; }
+
+private:
+    static constexpr size_t MIN_BLOCK = 256;
+
+    struct Block {
+        Block* next;
+        size_t size;  // Including this header
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+        char* end() { return reinterpret_cast<char*>(this) + size; }
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        char* aligned = align_up(cursor_, alignment);
+        if (aligned + bytes > end_) {
+            // Grow geometrically, and always leave room for this request
+            size_t needed = bytes + alignment + sizeof(Block);
+            next_block_size_ *= 2;
+            add_block(needed > next_block_size_ ? needed : next_block_size_);
+            aligned = align_up(cursor_, alignment);
+        }
+        cursor_ = aligned + bytes;
+        used_ += bytes;
+        return aligned;
+    }
+
+    // Monotonic: individual frees are no-ops; reset() reclaims everything
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    static char* align_up(char* ptr, size_t alignment) {
+        auto value = reinterpret_cast<uintptr_t>(ptr);
+        return reinterpret_cast<char*>((value + alignment - 1) & ~(uintptr_t(alignment) - 1));
+    }
+
+    void add_block(size_t size) {
+        auto* block = static_cast<Block*>(upstream_->allocate(size, alignof(std::max_align_t)));
+        block->next = head_;
+        block->size = size;
+        head_ = block;
+        cursor_ = block->data();
+        end_ = block->end();
+        capacity_ += size;
+        ++upstream_allocations_;
+    }
+
+    void release_blocks() {
+        while (head_ != nullptr) {
+            Block* next = head_->next;
+            upstream_->deallocate(head_, head_->size, alignof(std::max_align_t));
+            head_ = next;
+        }
+        cursor_ = end_ = nullptr;
+        capacity_ = 0;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    size_t next_block_size_;
+    Block* head_ = nullptr;
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    uint64_t upstream_allocations_ = 0;
+};
+
+}  // namespace memory
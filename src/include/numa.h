@@ -0,0 +1,130 @@
+/**
+ * @file numa.h
+ * @brief NUMA topology, node-local memory and node-aware thread placement
+ *
+ * On a multi-socket host every socket has its own memory controller; a
+ * load from another socket's memory crosses the interconnect and costs
+ * noticeably more latency and bandwidth. Linux allocates a page on the
+ * node of the thread that first touches it, so memory that one thread
+ * initializes and others use, or threads the scheduler migrates, quietly
+ * end up remote. This header makes placement explicit:
+ *
+ *     const memory::NumaTopology& topology = memory::NumaTopology::system();
+ *     memory::NodeLocalResource node1(1);                  // Pages bound to node 1
+ *     memory::MonotonicArena arena(1 << 20, &node1);       // Small objects on top
+ *     concurrency::WorkStealingPool pool(memory::numa_placement(topology, 16));
+ *
+ * Topology comes from /sys/devices/system/node (nodeN/cpulist, meminfo,
+ * distance), so there is no libnuma dependency; memory binding and the
+ * node queries use the mbind / get_mempolicy / getcpu system calls
+ * directly. Without sysfs (or off Linux) the topology is one node holding
+ * every CPU, and binding succeeds trivially.
+ *
+ * probe_numa() measures what the distance table only estimates: chase
+ * latency and read bandwidth from the CPUs of each node to the memory of
+ * every node.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "work_stealing_pool.h"
+
+namespace memory {
+
+struct NumaNode {
+    int id;
+    std::vector<int> cpus;
+    size_t total_bytes = 0;      // 0 if unknown
+    size_t free_bytes = 0;
+    std::vector<int> distances;  // To every node, in topology order; 10 = local
+};
+
+class NumaTopology {
+public:
+    // The host's nodes, discovered once
+    static const NumaTopology& system();
+
+    // Read a sysfs node directory (another root is useful for recorded
+    // trees); one node with every CPU if there is none
+    static NumaTopology discover(const std::string& root = "/sys/devices/system/node");
+
+    const std::vector<NumaNode>& nodes() const { return nodes_; }
+    size_t node_count() const { return nodes_.size(); }
+
+    // False when the topology is the single-node fallback
+    bool from_sysfs() const { return from_sysfs_; }
+
+    // Node holding `cpu`, or -1
+    int node_of_cpu(int cpu) const;
+
+    // Null if there is no node `id`
+    const NumaNode* node(int id) const;
+
+    // ACPI SLIT distance between two node ids (10 = local), 0 if unknown
+    int distance(int from, int to) const;
+
+private:
+    std::vector<NumaNode> nodes_;
+    bool from_sysfs_ = false;
+};
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+std::vector<int> parse_cpu_list(const std::string& list);
+
+// Node of the CPU the calling thread runs on at this moment, 0 if unknown
+int current_node();
+
+// Restrict the calling thread to `cpus` / to the CPUs of `node`; false
+// with errno set
+bool bind_thread_to_cpus(const std::vector<int>& cpus);
+bool bind_thread_to_node(int node);
+
+// Page-granular memory whose pages may only come from `node`
+// (MPOL_BIND): nullptr with errno set on failure. The pages are faulted
+// in on first touch, as usual, but always on that node.
+void* allocate_on_node(size_t bytes, int node);
+void free_on_node(void* memory, size_t bytes);
+
+// Node backing the (already touched) page at `address`, or -1
+int node_of_address(const void* address);
+
+// A pmr resource handing out node-bound pages. Every allocation is at
+// least one page, so use it as the upstream of an arena or pool resource
+// rather than for individual small objects.
+class NodeLocalResource : public std::pmr::memory_resource {
+public:
+    explicit NodeLocalResource(int node) : node_(node) {}
+
+    int node() const { return node_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    int node_;
+};
+
+// One worker per CPU slot, spread round-robin over the nodes (worker 0 on
+// node 0, worker 1 on node 1, ...) and allowed anywhere on its node, so
+// that the scheduler can still balance within the node. Workers on the
+// same node steal from each other first.
+concurrency::WorkerPlacement numa_placement(const NumaTopology& topology, size_t workers);
+
+struct NumaPoint {
+    int cpu_node;
+    int memory_node;
+    double ns_per_load;       // Pointer chase, random order
+    double bytes_per_second;  // One thread reading sequentially
+};
+
+// Every (CPU node, memory node) pair, `bytes` per buffer (well beyond
+// the last-level cache to measure memory rather than cache)
+std::vector<NumaPoint> probe_numa(const NumaTopology& topology, size_t bytes = size_t{256} << 20);
+
+}  // namespace memory
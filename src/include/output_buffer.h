@@ -0,0 +1,130 @@
+/**
+ * @file output_buffer.h
+ * @brief Segmented output queue for coalesced writev()/sendmsg() flushing
+ *
+ * Connection handlers append everything they want to say (echoed keys,
+ * protocol replies, command output, prompts) to an OutputBuffer and flush it
+ * once per batch of input instead of issuing one send() per fragment.
+ *
+ * - Appended bytes are copied into 4KB blocks; drained blocks are kept for
+ *   reuse, so a steady request/response workload does not allocate
+ * - Large std::string rvalues (command responses) are moved in as their
+ *   own segment instead of being copied
+ * - gather() exposes the queued segments as an iovec array, so a flush is
+ *   a single gather write no matter how many fragments were appended
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+
+namespace net {
+
+class OutputBuffer {
+public:
+    static const size_t BLOCK_SIZE = 4096;
+    static const size_t ADOPT_THRESHOLD = 256;  // Rvalue strings this big are moved, not copied
+    static const size_t MAX_SPARE_BLOCKS = 4;
+
+    // Copy into the tail block, spilling into further blocks as needed
+    void append(const char* data, size_t length) {
+        size_ += length;
+        while (length > 0) {
+            if (head_ == segments_.size() || tail_room() == 0) {
+                segments_.push_back(take_block());
+            }
+            size_t chunk = length < tail_room() ? length : tail_room();
+            segments_.back().append(data, chunk);
+            data += chunk;
+            length -= chunk;
+        }
+    }
+
+    void append(std::string&& data) {
+        if (data.size() < ADOPT_THRESHOLD) {
+            append(data.data(), data.size());
+            return;
+        }
+        size_ += data.size();
+        segments_.push_back(std::move(data));
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    // Fill iov with up to max_iov queued segments; returns the count used
+    int gather(struct iovec* iov, int max_iov) const {
+        int count = 0;
+        for (size_t i = head_; i < segments_.size() && count < max_iov; ++i) {
+            const std::string& segment = segments_[i];
+            size_t skip = (i == head_) ? front_offset_ : 0;
+            iov[count].iov_base = const_cast<char*>(segment.data() + skip);
+            iov[count].iov_len = segment.size() - skip;
+            ++count;
+        }
+        return count;
+    }
+
+    // Drop bytes that the kernel accepted
+    void consume(size_t bytes) {
+        size_ -= bytes;
+        while (bytes > 0) {
+            size_t available = segments_[head_].size() - front_offset_;
+            if (bytes < available) {
+                front_offset_ += bytes;
+                return;
+            }
+            bytes -= available;
+            recycle(std::move(segments_[head_]));
+            ++head_;
+            front_offset_ = 0;
+        }
+        // Fully drained: rewind the segment vector (capacity is kept). A
+        // client that never catches up gets the drained prefix compacted.
+        if (head_ == segments_.size()) {
+            segments_.clear();
+            head_ = 0;
+        } else if (head_ >= 64 && head_ * 2 >= segments_.size()) {
+            segments_.erase(segments_.begin(), segments_.begin() + static_cast<std::ptrdiff_t>(head_));
+            head_ = 0;
+        }
+    }
+
+private:
+    // Appending within capacity never reallocates, so any segment works
+    size_t tail_room() const {
+        const std::string& tail = segments_.back();
+        return tail.capacity() - tail.size();
+    }
+
+    std::string take_block() {
+        std::string block;
+        if (!spare_.empty()) {
+            block = std::move(spare_.back());
+            spare_.pop_back();
+            block.clear();
+        } else {
+            block.reserve(BLOCK_SIZE);
+        }
+        return block;
+    }
+
+    void recycle(std::string&& segment) {
+        if (segment.capacity() >= BLOCK_SIZE && segment.capacity() <= 2 * BLOCK_SIZE &&
+            spare_.size() < MAX_SPARE_BLOCKS) {
+            if (spare_.capacity() == 0) spare_.reserve(MAX_SPARE_BLOCKS);
+            spare_.push_back(std::move(segment));
+        }
+    }
+
+    std::vector<std::string> segments_;  // [head_, size()) are queued
+    size_t head_ = 0;
+    size_t front_offset_ = 0;
+    size_t size_ = 0;
+    std::vector<std::string> spare_;
+};
+
+}  // namespace net
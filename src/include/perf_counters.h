@@ -0,0 +1,78 @@
+/**
+ * @file perf_counters.h
+ * @brief Cycle counts (rdtsc) and hardware event counters (perf_event_open)
+ *
+ * A nanosecond figure hides why a loop is slow. Cycles per element, and
+ * the branch mispredictions and instructions per cycle behind them, do
+ * not:
+ *
+ *     bench::PerfCounters counters;         // available() false without perf
+ *     uint64_t start = bench::read_tsc();
+ *     counters.start();
+ *     kernel();
+ *     counters.stop();
+ *     uint64_t ticks = bench::read_tsc() - start;
+ *     double misses = counters.count(bench::PerfCounters::BRANCH_MISSES);
+ *
+ * read_tsc() counts at the constant TSC rate, not the core clock, so it
+ * is a cycle count only while the core runs at its nominal frequency
+ * (turbo and power saving skew it); tsc_ticks_per_ns() converts it to
+ * time. PerfCounters measures real core cycles, instructions, branches
+ * and branch misses of the calling thread in user mode. It needs
+ * perf_event_paranoid <= 2 and a PMU, which many VMs and containers do
+ * not expose; check available() before trusting count().
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+// Timestamp counter; the fence keeps earlier instructions from being
+// counted after it. Falls back to steady_clock nanoseconds elsewhere.
+uint64_t read_tsc_fallback();
+
+inline uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    return __rdtsc();
+#else
+    return read_tsc_fallback();
+#endif
+}
+
+// Calibrated against steady_clock once, on first use (~20ms)
+double tsc_ticks_per_ns();
+
+class PerfCounters {
+public:
+    enum Event { CYCLES, INSTRUCTIONS, BRANCHES, BRANCH_MISSES, EVENT_COUNT };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // False if the kernel refused the counters (or this is not Linux)
+    bool available() const { return fds_[CYCLES] >= 0; }
+
+    // Reset and count until stop(); no-ops when unavailable
+    void start();
+    void stop();
+
+    // Events between the last start() / stop(), 0 if not counted
+    uint64_t count(Event event) const { return values_[event]; }
+    double instructions_per_cycle() const;
+
+private:
+    int fds_[EVENT_COUNT];
+    uint64_t values_[EVENT_COUNT] = {};
+};
+
+}  // namespace bench
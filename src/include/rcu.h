@@ -0,0 +1,183 @@
+/**
+ * @file rcu.h
+ * @brief Read-copy-update: lock-free readers of immutable published snapshots
+ *
+ * Even the best reader-writer lock makes a reader write something shared
+ * (a count, a slot) so that a writer knows to wait. RCU turns that
+ * around: the data is an immutable object behind an atomic pointer, a
+ * writer copies it, edits the copy and swaps the pointer, and readers just
+ * load the pointer. The only question is when the old object may be
+ * freed, and the answer is "once every reader that could have loaded the
+ * old pointer has finished" — a grace period.
+ *
+ *     concurrency::RcuCell<Settings> settings;
+ *
+ *     // Reader (any thread, never blocks):
+ *     auto snapshot = settings.read();
+ *     use(snapshot->timeout, snapshot->banner);
+ *
+ *     // Writer:
+ *     settings.update([](Settings& copy) { copy.timeout = 30; });
+ *
+ * Grace periods are tracked with epochs. Every thread that reads has a
+ * record on a cache line of its own; entering a read-side section copies
+ * the global epoch into it, leaving stores 0:
+ *
+ *   reader:  mine = epoch; fence; p = pointer; ... use *p ...; mine = 0
+ *   writer:  old = swap(pointer, new); ++epoch; wait until every record
+ *            is 0 or >= the new epoch; delete old
+ *
+ * A reader writes only its own line, takes no lock and never waits, no
+ * matter what writers do; the price is one full fence per read-side
+ * section. Writers are serialized per cell and wait out one grace period
+ * per update, so RCU suits data that is read constantly and changed
+ * rarely (configuration, routing tables, registries). Compared with
+ * SeqLock (seqlock.h), the snapshot can be of any size and type and a
+ * reader never retries; compared with std::atomic<std::shared_ptr>, a
+ * reader never touches a reference count.
+ *
+ * Rules: a snapshot must not be used after its RcuCell::Snapshot (the
+ * read-side section) ends, and must not be handed to another thread.
+ * Read-side sections nest. A thread must not update an RcuCell from inside
+ * a read-side section: it would wait for itself.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "cache_line.h"
+
+namespace concurrency {
+
+// The process-wide epoch and the registry of reader threads. All RcuCells
+// share it: a grace period waits for every reader, not just the cell's.
+class RcuDomain {
+public:
+    struct alignas(CACHE_LINE_SIZE) ThreadRecord {
+        std::atomic<uint64_t> epoch{0};  // 0 = not inside a read-side section
+        std::atomic<bool> in_use{false};
+        ThreadRecord* next = nullptr;    // Registry list; records are never freed
+        uint32_t nesting = 0;            // Owner thread only
+    };
+
+    static void read_lock() {
+        ThreadRecord* record = thread_record();
+        if (record->nesting++ == 0) {
+            // Acquire: a reader that sees an advanced epoch also sees the
+            // pointer swapped before it
+            record->epoch.store(epoch_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            // The epoch store must be visible before the pointer is loaded;
+            // the writer does the mirror image, so one of them sees the other
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    static void read_unlock() {
+        ThreadRecord* record = thread_record();
+        if (--record->nesting == 0) {
+            record->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    // Wait until every read-side section that started before the call has
+    // ended. Sections starting meanwhile do not delay it.
+    static void synchronize();
+
+    // Number of threads currently holding a record (for diagnostics)
+    static size_t registered_threads();
+
+private:
+    static ThreadRecord* thread_record() {
+        ThreadRecord* record = current_;
+        return record != nullptr ? record : register_thread();
+    }
+
+    static ThreadRecord* register_thread();
+
+    static inline thread_local ThreadRecord* current_ = nullptr;
+    static inline std::atomic<uint64_t> epoch_{1};
+    static inline std::atomic<ThreadRecord*> records_{nullptr};
+};
+
+// RAII read-side section
+class RcuReadLock {
+public:
+    RcuReadLock() { RcuDomain::read_lock(); }
+    ~RcuReadLock() { RcuDomain::read_unlock(); }
+    RcuReadLock(const RcuReadLock&) = delete;
+    RcuReadLock& operator=(const RcuReadLock&) = delete;
+};
+
+// One RCU-protected value. Readers see a const T that never changes under
+// them; writers replace it whole.
+template <typename T>
+class RcuCell {
+public:
+    // A read-side section holding one snapshot
+    class Snapshot {
+    public:
+        explicit Snapshot(const std::atomic<const T*>& source) : value_(source.load(std::memory_order_acquire)) {}
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        const T& operator*() const { return *value_; }
+        const T* operator->() const { return value_; }
+        const T* get() const { return value_; }
+
+    private:
+        RcuReadLock lock_;  // Declared first: the section starts before the load
+        const T* value_;
+    };
+
+    RcuCell() : RcuCell(std::make_unique<const T>()) {}
+    explicit RcuCell(T initial) : RcuCell(std::make_unique<const T>(std::move(initial))) {}
+    explicit RcuCell(std::unique_ptr<const T> initial) : current_(initial.release()) {}
+
+    // No reader may still be inside a section on this cell
+    ~RcuCell() { delete current_.load(std::memory_order_relaxed); }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    Snapshot read() const { return Snapshot(current_); }
+
+    // Copy of the current value, taken inside a read-side section
+    T load() const { return *read(); }
+
+    // Replace the value; returns after the old one has been freed (one
+    // grace period)
+    void store(T value) { publish(std::make_unique<const T>(std::move(value))); }
+
+    void publish(std::unique_ptr<const T> next) {
+        std::lock_guard<std::mutex> lock(writer_);
+        retire(current_.exchange(next.release(), std::memory_order_seq_cst));
+    }
+
+    // Read-copy-update: edit(copy) changes a private copy of the current
+    // value, which is then published. Concurrent updates are serialized,
+    // so none of them is lost.
+    template <typename Edit>
+    void update(Edit&& edit) {
+        std::lock_guard<std::mutex> lock(writer_);
+        auto next = std::make_unique<T>(*current_.load(std::memory_order_relaxed));
+        edit(*next);
+        retire(current_.exchange(next.release(), std::memory_order_seq_cst));
+    }
+
+private:
+    static void retire(const T* old) {
+        RcuDomain::synchronize();
+        delete old;
+    }
+
+    std::atomic<const T*> current_;
+    std::mutex writer_;  // Serializes writers; readers never touch it
+};
+
+}  // namespace concurrency
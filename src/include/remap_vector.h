@@ -0,0 +1,180 @@
+/**
+ * @file remap_vector.h
+ * @brief Vector of trivially copyable elements that grows by remapping pages
+ *
+ * std::vector grows by allocating a buffer twice as large, copying every
+ * element into it and freeing the old one. For a vector of gigabytes that
+ * means the last growth copies gigabytes, and for that moment both
+ * buffers exist: peak memory is 1.5x the final size (3x the old one).
+ *
+ * RemapVector keeps its elements in an anonymous mmap() and grows it with
+ * mremap(MREMAP_MAYMOVE). The kernel either extends the mapping in place
+ * or moves its page-table entries to a larger hole in the address space;
+ * no byte of the data is copied, and the old and new pages are the same
+ * physical memory, so peak memory is what the elements actually touch.
+ * New pages are only backed when first written, just like a reserve()d
+ * std::vector that has not been filled yet.
+ *
+ *     containers::RemapVector<uint64_t> ids;
+ *     for (uint64_t i = 0; i < (1u << 30); ++i) ids.push_back(i);  // 8GB, never copied
+ *
+ * Elements are moved by moving their bytes, so T must be trivially
+ * copyable (the closest thing C++ has to "trivially relocatable"). The
+ * buffer is a whole number of pages: a vector of 10 ints still takes 4KB,
+ * so this is for the few big vectors of a program, not for every one.
+ * Without mremap (macOS, BSD) growth falls back to mmap + memcpy, which
+ * still avoids the allocator but not the copy. As with std::vector,
+ * growth invalidates pointers and references to the elements.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace containers {
+
+namespace remap_detail {
+
+size_t page_size();
+
+// Smallest page multiple holding `bytes`
+size_t round_to_pages(size_t bytes);
+
+// Zero-filled anonymous mapping of `bytes` (a page multiple); throws std::bad_alloc
+void* map(size_t bytes);
+
+// Resize a mapping from map(), possibly moving it; the contents up to
+// min(old, new) bytes are preserved. Throws std::bad_alloc, leaving the
+// old mapping untouched.
+void* remap(void* memory, size_t old_bytes, size_t new_bytes);
+
+void unmap(void* memory, size_t bytes);
+
+// True where remap() moves page-table entries rather than copying
+bool remaps_in_kernel();
+
+}  // namespace remap_detail
+
+template <typename T>
+class RemapVector {
+    static_assert(std::is_trivially_copyable_v<T>, "RemapVector<T> relocates elements by moving their pages");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    RemapVector() = default;
+
+    explicit RemapVector(size_t count, const T& value = T()) {
+        reserve(count);
+        std::uninitialized_fill_n(data_, count, value);
+        size_ = count;
+    }
+
+    RemapVector(const RemapVector& other) {
+        reserve(other.size_);
+        if (other.size_ > 0) std::memcpy(data_, other.data_, other.size_ * sizeof(T));
+        size_ = other.size_;
+    }
+
+    RemapVector(RemapVector&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+
+    RemapVector& operator=(RemapVector other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~RemapVector() {
+        if (data_ != nullptr) remap_detail::unmap(data_, mapped_bytes());
+    }
+
+    void swap(RemapVector& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    // `value` may be one of our own elements (v.push_back(v[0])), and
+    // growing may unmap it, so growth takes a copy first
+    void push_back(const T& value) {
+        if (size_ == capacity_) {
+            T copy = value;
+            grow(size_ + 1);
+            data_[size_++] = copy;
+            return;
+        }
+        data_[size_++] = value;
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            T element(std::forward<Args>(args)...);  // As above: args may refer into the buffer
+            grow(size_ + 1);
+            return *new (data_ + size_++) T(element);
+        }
+        return *new (data_ + size_++) T(std::forward<Args>(args)...);
+    }
+
+    void pop_back() { --size_; }
+    void clear() { size_ = 0; }
+
+    // Capacity is rounded up to whole pages
+    void reserve(size_t count) {
+        if (count > capacity_) resize_mapping(count);
+    }
+
+    // New elements are value-initialized
+    void resize(size_t count) {
+        reserve(count);
+        if (count > size_) std::uninitialized_value_construct_n(data_ + size_, count - size_);
+        size_ = count;
+    }
+
+private:
+    // Doubling still bounds the number of mremap() calls, and costs only
+    // address space: untouched pages are never backed
+    void grow(size_t minimum) { resize_mapping(std::max(minimum, capacity_ * 2)); }
+
+    void resize_mapping(size_t count) {
+        size_t bytes = remap_detail::round_to_pages(count * sizeof(T));
+        void* memory = data_ == nullptr ? remap_detail::map(bytes)
+                                        : remap_detail::remap(data_, mapped_bytes(), bytes);
+        data_ = static_cast<T*>(memory);
+        capacity_ = bytes / sizeof(T);
+    }
+
+    size_t mapped_bytes() const { return remap_detail::round_to_pages(capacity_ * sizeof(T)); }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+}  // namespace containers
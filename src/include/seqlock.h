@@ -0,0 +1,121 @@
+/**
+ * @file seqlock.h
+ * @brief Sequence lock for small trivially copyable snapshots
+ *
+ * Readers of a SeqLock never write shared memory at all, so any number
+ * of them scale perfectly. The writer bumps a sequence number to odd
+ * before it changes the data and back to even afterwards. A reader
+ * copies the data between two reads of the sequence and retries if the
+ * two differ or were odd, i.e. if a write overlapped the copy:
+ *
+ *   writer:  seq = 1 ─ write a,b,c ─ seq = 2
+ *   reader:  s1 = seq ─ copy a,b,c ─ s2 = seq   (retry unless s1 == s2, even)
+ *
+ * A reader may therefore copy a torn value, but it never returns one.
+ * The payload is stored as relaxed atomic 64-bit words (Boehm, "Can
+ * Seqlocks Get Along With Programming Language Memory Models?"), so there
+ * is no data race even on the copies that get thrown away.
+ *
+ * Writers are serialized among themselves with a spinlock. Readers can
+ * starve under a continuous stream of writes, so use it for data that
+ * changes rarely and is small enough to copy: statistics, configuration,
+ * a (position, velocity) pair.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+#include "cache_line.h"
+#include "spin_locks.h"
+
+namespace concurrency {
+
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock<T> copies T byte-wise");
+
+public:
+    SeqLock() : SeqLock(T{}) {}
+    explicit SeqLock(const T& value) { store_words(value); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    T load() const {
+        SpinWait spin;
+        while (true) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                uint64_t copy[WORDS];
+                for (size_t i = 0; i < WORDS; ++i) {
+                    copy[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                // Keep the data loads above the second sequence read
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence_.load(std::memory_order_relaxed) == before) {
+                    T value;
+                    std::memcpy(&value, copy, sizeof(T));
+                    return value;
+                }
+            }
+            spin.wait();
+        }
+    }
+
+    void store(const T& value) {
+        std::lock_guard<TtasSpinLock> lock(writer_);
+        publish(value);
+    }
+
+    // Read-modify-write under the writer lock: edit(value) changes a copy
+    template <typename Update>
+    void update(Update&& edit) {
+        std::lock_guard<TtasSpinLock> lock(writer_);
+        T value;
+        load_words(value);
+        edit(value);
+        publish(value);
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // Caller holds writer_
+    void publish(const T& value) {
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        // Readers that see any of the new words also see the odd sequence
+        std::atomic_thread_fence(std::memory_order_release);
+        store_words(value);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    void store_words(const T& value) {
+        uint64_t copy[WORDS] = {};
+        std::memcpy(copy, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; ++i) {
+            words_[i].store(copy[i], std::memory_order_relaxed);
+        }
+    }
+
+    // Writer side only: no concurrent stores, so no retry needed
+    void load_words(T& value) const {
+        uint64_t copy[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            copy[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::memcpy(&value, copy, sizeof(T));
+    }
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> words_[WORDS];
+    TtasSpinLock writer_;
+};
+
+}  // namespace concurrency
@@ -0,0 +1,152 @@
+/**
+ * @file session_table.h
+ * @brief Lock-free registry of live connections (slot array + generations)
+ *
+ * Replaces the "std::vector<int> + std::mutex" client list:
+ *
+ * - insert() pops a free slot from a lock-free stack: O(1), no lock
+ * - remove() clears the slot by handle and pushes it back: O(1), no scan
+ * - size() is a single atomic load (wait-free)
+ * - for_each() walks the slot array without blocking inserts or removes,
+ *   so shutdown and broadcast never stall the accept path. It is also safe
+ *   to call from a signal handler, unlike anything that takes a mutex.
+ *
+ * Each slot has a generation counter that is bumped on every insert. A
+ * Handle carries (index, generation), so a stale handle for a reused slot
+ * is rejected instead of removing somebody else's connection.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace net {
+
+class SessionTable {
+public:
+    struct Handle {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+        bool valid() const { return index != UINT32_MAX; }
+    };
+
+    explicit SessionTable(uint32_t capacity) : capacity_(capacity), slots_(new Slot[capacity]) {}
+
+    SessionTable(const SessionTable&) = delete;
+    SessionTable& operator=(const SessionTable&) = delete;
+
+    // Register a socket; returns an invalid handle if the table is full
+    Handle insert(int socket) {
+        uint32_t index;
+        if (!pop_free(index)) {
+            index = next_unused_.fetch_add(1, std::memory_order_relaxed);
+            if (index >= capacity_) {
+                next_unused_.fetch_sub(1, std::memory_order_relaxed);
+                return Handle();
+            }
+        }
+
+        Slot& slot = slots_[index];
+        uint64_t previous = slot.word.load(std::memory_order_relaxed);
+        uint32_t generation = static_cast<uint32_t>(previous >> 32) + 1;
+        slot.word.store(pack(generation, socket), std::memory_order_release);
+
+        // Publish the slot to for_each() only after it holds a value
+        uint32_t high = high_water_.load(std::memory_order_relaxed);
+        while (high < index + 1 && !high_water_.compare_exchange_weak(high, index + 1, std::memory_order_release)) {
+        }
+        count_.fetch_add(1, std::memory_order_relaxed);
+
+        Handle handle;
+        handle.index = index;
+        handle.generation = generation;
+        return handle;
+    }
+
+    // Unregister by handle; false if the handle is stale or already removed
+    bool remove(Handle handle) {
+        if (!handle.valid() || handle.index >= capacity_) return false;
+        Slot& slot = slots_[handle.index];
+
+        uint64_t word = slot.word.load(std::memory_order_acquire);
+        do {
+            if (static_cast<uint32_t>(word >> 32) != handle.generation || (word & 0xffffffffu) == 0) {
+                return false;
+            }
+        } while (!slot.word.compare_exchange_weak(word, uint64_t{handle.generation} << 32,
+                                                  std::memory_order_acq_rel));
+
+        count_.fetch_sub(1, std::memory_order_relaxed);
+        push_free(handle.index);
+        return true;
+    }
+
+    // Number of registered sockets (wait-free)
+    size_t size() const { return count_.load(std::memory_order_relaxed); }
+
+    size_t capacity() const { return capacity_; }
+
+    // Call fn(socket) for every registered socket. Entries inserted or
+    // removed concurrently may or may not be visited.
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        uint32_t high = high_water_.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < high; ++i) {
+            uint64_t word = slots_[i].word.load(std::memory_order_acquire);
+            uint32_t value = static_cast<uint32_t>(word & 0xffffffffu);
+            if (value != 0) {
+                fn(static_cast<int>(value - 1));
+            }
+        }
+    }
+
+private:
+    // word = [generation:32][socket + 1:32]; a zero low half means free
+    struct Slot {
+        std::atomic<uint64_t> word{0};
+        std::atomic<uint32_t> next_free{0};  // Index + 1 of the next free slot
+    };
+
+    static uint64_t pack(uint32_t generation, int socket) {
+        return (uint64_t{generation} << 32) | static_cast<uint32_t>(socket + 1);
+    }
+
+    // Treiber stack of recycled slots. The head packs [tag:32][index + 1:32];
+    // the tag changes on every update, which rules out ABA.
+    bool pop_free(uint32_t& index) {
+        uint64_t head = free_head_.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t top = static_cast<uint32_t>(head & 0xffffffffu);
+            if (top == 0) return false;
+            uint32_t next = slots_[top - 1].next_free.load(std::memory_order_relaxed);
+            uint64_t tag = (head >> 32) + 1;
+            if (free_head_.compare_exchange_weak(head, (tag << 32) | next, std::memory_order_acq_rel)) {
+                index = top - 1;
+                return true;
+            }
+        }
+    }
+
+    void push_free(uint32_t index) {
+        uint64_t head = free_head_.load(std::memory_order_relaxed);
+        while (true) {
+            slots_[index].next_free.store(static_cast<uint32_t>(head & 0xffffffffu), std::memory_order_relaxed);
+            uint64_t tag = (head >> 32) + 1;
+            if (free_head_.compare_exchange_weak(head, (tag << 32) | (index + 1), std::memory_order_acq_rel)) {
+                return;
+            }
+        }
+    }
+
+    const uint32_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> free_head_{0};
+    std::atomic<uint32_t> next_unused_{0};
+    std::atomic<uint32_t> high_water_{0};
+    std::atomic<size_t> count_{0};
+};
+
+}  // namespace net
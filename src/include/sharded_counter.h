@@ -0,0 +1,82 @@
+/**
+ * @file sharded_counter.h
+ * @brief Per-thread-slot counter for hot statistics (write-heavy, read-rarely)
+ *
+ * A single std::atomic counter incremented by N threads is one cache line
+ * that every increment has to own exclusively, so the threads take turns
+ * no matter how many cores there are. ShardedCounter spreads the count over
+ * per-thread slots, each alignas(CACHE_LINE_SIZE) so that neighbouring
+ * slots never share a line (false sharing would make them take turns just
+ * the same):
+ *
+ *   add():    slot[my thread] += n     relaxed, the line stays in my cache
+ *   value():  sum of all slots         relaxed loads, O(shards)
+ *
+ * value() is not a snapshot: increments that race with the sum may or may
+ * not be included, but every increment that happened before the call is.
+ * That is what statistics counters need; for a counter whose exact value
+ * drives control flow, use a plain atomic.
+ *
+ * Threads are assigned slots round-robin on first use, so with more
+ * threads than shards some slots are shared; they stay correct (the add
+ * is atomic) and only lose some of the benefit.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "cache_line.h"
+
+namespace concurrency {
+
+class ShardedCounter {
+public:
+    // Default: one shard per hardware thread (at least 4)
+    ShardedCounter() : ShardedCounter(std::max(4u, std::thread::hardware_concurrency())) {}
+
+    explicit ShardedCounter(size_t shards)
+        : shards_(std::max<size_t>(1, shards)), slots_(new CachePadded<std::atomic<uint64_t>>[shards_]) {
+        reset();
+    }
+
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+    void add(uint64_t n = 1) { slots_[thread_index() % shards_]->fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < shards_; ++i) {
+            sum += slots_[i]->load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    // Not atomic with respect to concurrent add()
+    void reset() {
+        for (size_t i = 0; i < shards_; ++i) {
+            slots_[i]->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t shards() const { return shards_; }
+
+private:
+    // Small dense per-thread number, shared by every ShardedCounter
+    static size_t thread_index() {
+        static std::atomic<size_t> next{0};
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    size_t shards_;
+    std::unique_ptr<CachePadded<std::atomic<uint64_t>>[]> slots_;
+};
+
+}  // namespace concurrency
@@ -0,0 +1,135 @@
+/**
+ * @file shm_ring.h
+ * @brief Shared-memory message ring between processes (MPSC, futex wake-ups)
+ *
+ * A pipe or socket copies every message twice (sender -> kernel ->
+ * receiver), and each side pays a system call per operation. ShmRing
+ * puts a ring buffer in memory that both processes map (shm_open + mmap).
+ * A message is copied once, into the ring, and the receiver reads it in
+ * place. No system call is made while the other side is keeping up.
+ *
+ *     ipc::ShmRing ring;
+ *     ring.create("/orders", 1 << 20);          // process A (consumer)
+ *     ring.open("/orders");                     // process B (producer)
+ *     ring.send(data, length);                  // B
+ *     ring.receive([](const char* p, size_t n) { ... });   // A, zero-copy
+ *
+ * Messages are variable-length frames (8-byte header + payload, 8-byte
+ * aligned) that are always contiguous: a frame that would wrap around the
+ * end is preceded by a padding frame. Any number of producers (threads or
+ * processes) may send, and one consumer receives:
+ *
+ *   reserved   producers claim space with a CAS
+ *   committed  producers publish in reservation order; the consumer reads
+ *              everything below it, so it never sees half-written frames
+ *   consumed   the consumer frees space up to here
+ *
+ * A producer that is descheduled between claiming and publishing holds up
+ * the producers behind it, which is the price of a consumer that never has
+ * to validate a frame. With one producer the ordering wait never happens.
+ *
+ * Blocking send() / receive() spin briefly and then sleep on a futex in
+ * the shared segment (FUTEX_WAIT, not _PRIVATE, so it works across
+ * processes). A side only makes the wake-up call when the other one has
+ * announced that it is sleeping. Off Linux the sleep is a short poll.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ipc {
+
+class ShmRing {
+public:
+    ShmRing() = default;
+    ~ShmRing() { close(); }
+
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    // Create a ring with `capacity` bytes of frame space (rounded up to a
+    // power of two, at least 4KB) under a shm_open name such as "/ring".
+    // Returns false (and leaves errno set) on failure, EEXIST included.
+    bool create(const std::string& name, size_t capacity);
+
+    // Map a ring another process created
+    bool open(const std::string& name);
+
+    // Unmap; the creator also removes the name (mappings stay valid)
+    void close();
+
+    bool is_open() const { return header_ != nullptr; }
+    size_t capacity() const { return mask_ + 1; }
+
+    // Largest payload send() accepts: half the ring, so a frame plus its
+    // padding always fits once the consumer catches up
+    size_t max_message() const { return capacity() / 2 - FRAME_HEADER; }
+
+    // Copy one message into the ring. try_send() returns false with errno
+    // EAGAIN if the ring is full; both fail with EMSGSIZE (too large) or
+    // EPIPE (shut down).
+    bool try_send(const void* data, size_t length);
+    bool send(const void* data, size_t length);
+
+    // Call fn(const char* data, size_t length) on the next message, in
+    // place, then free its space. try_receive() returns false when the
+    // ring is empty; receive() waits, and returns false once the ring has
+    // been shut down and drained. Consumer only.
+    template <typename Fn>
+    bool try_receive(Fn&& fn) {
+        const char* data;
+        size_t length;
+        if (!peek(data, length)) return false;
+        fn(data, length);
+        release();
+        return true;
+    }
+
+    template <typename Fn>
+    bool receive(Fn&& fn) {
+        const char* data;
+        size_t length;
+        while (!peek(data, length)) {
+            if (!wait_for_data()) return false;
+        }
+        fn(data, length);
+        release();
+        return true;
+    }
+
+    // End of stream: the consumer drains what was sent, then receive()
+    // returns false; later sends fail with EPIPE
+    void shutdown();
+
+private:
+    static constexpr size_t FRAME_HEADER = 8;
+    static constexpr uint32_t PADDING = 1;
+
+    struct Header;
+
+    bool map(int fd, size_t size);
+
+    // Consumer side of receive(): the next frame, skipping padding
+    bool peek(const char*& data, size_t& length);
+    void release();
+    bool wait_for_data();  // False once shut down and drained
+
+    bool wait_for_space(uint64_t needed);  // False once shut down
+
+    Header* header_ = nullptr;
+    char* frames_ = nullptr;
+    size_t mask_ = 0;
+    size_t mapped_size_ = 0;
+    std::string unlink_name_;  // Set on the creating side
+
+    // Consumer's private cursor and its copy of `committed`
+    uint64_t read_position_ = 0;
+    uint64_t committed_cache_ = 0;
+    size_t pending_frame_ = 0;  // Size of the frame peek() handed out
+};
+
+}  // namespace ipc
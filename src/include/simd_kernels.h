@@ -0,0 +1,77 @@
+/**
+ * @file simd_kernels.h
+ * @brief Reductions, byte search and ASCII string kernels with runtime ISA dispatch
+ *
+ * One binary has to run on machines with and without AVX2 or AVX-512, so
+ * the vector code cannot simply be compiled for the best instruction set.
+ * Every kernel here exists once per ISA (scalar, SSE4.2, AVX2, AVX-512 on
+ * x86; NEON on AArch64). Each variant is compiled for its own target with
+ * __attribute__((target)), so the rest of the program keeps the baseline
+ * flags. On first use, kernels() picks the best table the CPU supports:
+ * CPUID on x86 (the compiler's __builtin_cpu_supports also checks that the
+ * OS saves the wide registers), getauxval(AT_HWCAP) on AArch64.
+ *
+ *     int64_t total = simd::sum(values.data(), values.size());
+ *     const char* newline = simd::find_byte(p, end - p, '\n');
+ *     simd::to_lower(word.data(), word.size());
+ *
+ * SIMD_ISA=scalar|sse4.2|avx2|avx512|neon in the environment forces a
+ * variant (falling back to scalar if the CPU lacks it), for testing and
+ * for comparing them. kernels_for() hands out any supported variant
+ * directly.
+ *
+ * The string kernels work on ASCII: bytes outside 'a'-'z' / 'A'-'Z' pass
+ * through unchanged, whatever the locale.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace simd {
+
+enum class Isa { SCALAR, SSE42, AVX2, AVX512, NEON };
+
+const char* isa_name(Isa isa);
+bool isa_supported(Isa isa);
+
+struct Kernels {
+    Isa isa;
+    int64_t (*sum_i32)(const int32_t* data, size_t n);
+    int32_t (*min_i32)(const int32_t* data, size_t n);  // n > 0
+    int32_t (*max_i32)(const int32_t* data, size_t n);  // n > 0
+    // memchr(): the first `byte` in [data, data + n), or nullptr
+    const char* (*find_byte)(const char* data, size_t n, char byte);
+    // strchr(): the first `byte` before the terminating NUL, or nullptr
+    const char* (*find_in_string)(const char* text, char byte);
+    // strpbrk() on a sized range: the first byte that is one of `set`
+    const char* (*find_first_of)(const char* data, size_t n, const char* set, size_t set_size);
+    size_t (*count_byte)(const char* data, size_t n, char byte);
+    void (*to_upper)(char* data, size_t n);
+    void (*to_lower)(char* data, size_t n);
+    void (*reverse)(char* data, size_t n);
+};
+
+// The dispatched table, chosen once
+const Kernels& kernels();
+
+// A specific variant, or nullptr if this CPU (or build) does not have it
+const Kernels* kernels_for(Isa isa);
+
+inline int64_t sum(const int32_t* data, size_t n) { return kernels().sum_i32(data, n); }
+inline int32_t min(const int32_t* data, size_t n) { return kernels().min_i32(data, n); }
+inline int32_t max(const int32_t* data, size_t n) { return kernels().max_i32(data, n); }
+
+inline const char* find_byte(const char* data, size_t n, char byte) { return kernels().find_byte(data, n, byte); }
+inline const char* find_in_string(const char* text, char byte) { return kernels().find_in_string(text, byte); }
+inline const char* find_first_of(const char* data, size_t n, const char* set, size_t set_size) {
+    return kernels().find_first_of(data, n, set, set_size);
+}
+inline size_t count_byte(const char* data, size_t n, char byte) { return kernels().count_byte(data, n, byte); }
+
+inline void to_upper(char* data, size_t n) { kernels().to_upper(data, n); }
+inline void to_lower(char* data, size_t n) { kernels().to_lower(data, n); }
+inline void reverse(char* data, size_t n) { kernels().reverse(data, n); }
+
+}  // namespace simd
@@ -0,0 +1,269 @@
+/**
+ * @file soa_vector.h
+ * @brief Structure-of-arrays vector: one contiguous array per struct field
+ *
+ * std::vector<Point> stores x, y, x, y, ... (array of structures, AoS). A
+ * loop that only reads x still pulls every y through the cache, and a
+ * loop over a field cannot use full-width vector loads because the values
+ * it wants are strided. SoaVector stores the same elements as x, x, x,
+ * ... and y, y, y, ...: a scan touches only the fields it names, each one
+ * a dense array the compiler can vectorize.
+ *
+ * The field list is given as pointers to members, so the struct itself
+ * stays an ordinary struct (and its AoS code keeps working):
+ *
+ *     containers::SoaVector<Point, &Point::x, &Point::y> points;
+ *     points.push_back(Point(3, 4));                    // Split into the columns
+ *     points[0].get<&Point::x>() += 1;                  // AoS-like proxy access
+ *     Point p = points[0];                              // Gathered back
+ *
+ *     const double* xs = points.data<&Point::x>();      // The hot loop
+ *     for (size_t i = 0; i < points.size(); ++i) sum += xs[i];
+ *
+ * operator[] and the iterators hand out proxies (like
+ * std::vector<bool>'s), not references to a T: there is no T in memory to
+ * refer to. Converting a proxy to T needs T to be default constructible;
+ * get<Member>() and data<Member>() work for any struct. Fields that are
+ * not listed are not stored.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace containers {
+
+namespace soa_detail {
+
+template <typename MemberPointer>
+struct member_pointer;
+
+template <typename Class, typename Field>
+struct member_pointer<Field Class::*> {
+    using object = Class;
+    using field = Field;
+};
+
+template <auto Member>
+using field_t = typename member_pointer<decltype(Member)>::field;
+
+// Pointers to members of different types cannot even be compared
+template <auto A, auto B>
+constexpr bool same_member() {
+    if constexpr (std::is_same_v<decltype(A), decltype(B)>) {
+        return A == B;
+    } else {
+        return false;
+    }
+}
+
+// Position of `Target` in `Members...` (sizeof...(Members) if absent)
+template <auto Target, auto... Members>
+constexpr size_t index_of() {
+    size_t index = 0;
+    bool found = false;
+    ((found = found || same_member<Target, Members>(), index += found ? 0 : 1), ...);
+    return index;
+}
+
+}  // namespace soa_detail
+
+template <typename T, auto... Members>
+class SoaVector {
+    static_assert(sizeof...(Members) > 0, "SoaVector needs at least one field");
+    static_assert((std::is_same_v<typename soa_detail::member_pointer<decltype(Members)>::object, T> && ...),
+                  "every field must be a data member of T");
+
+    template <auto Member>
+    static constexpr size_t column_index() {
+        constexpr size_t index = soa_detail::index_of<Member, Members...>();
+        static_assert(index < sizeof...(Members), "not one of this SoaVector's fields");
+        return index;
+    }
+
+    using Columns = std::tuple<std::vector<soa_detail::field_t<Members>>...>;
+    using Indices = std::index_sequence_for<decltype(Members)...>;
+
+public:
+    static constexpr size_t FIELD_COUNT = sizeof...(Members);
+
+    // One element, seen through its index: reads and writes go to the columns
+    template <bool Const>
+    class BasicReference {
+        using Owner = std::conditional_t<Const, const SoaVector, SoaVector>;
+
+    public:
+        BasicReference(Owner* owner, size_t index) : owner_(owner), index_(index) {}
+        BasicReference(const BasicReference&) = default;
+
+        template <auto Member>
+        decltype(auto) get() const {
+            return owner_->template data<Member>()[index_];
+        }
+
+        operator T() const { return owner_->get(index_); }
+
+        template <bool C = Const, typename = std::enable_if_t<!C>>
+        const BasicReference& operator=(const T& value) const {
+            owner_->set(index_, value);
+            return *this;
+        }
+
+        // Element-wise copy between two slots, as with real references
+        const BasicReference& operator=(const BasicReference& other) const {
+            owner_->copy_slot(other.index_, index_, Indices());
+            return *this;
+        }
+
+        size_t index() const { return index_; }
+
+    private:
+        Owner* owner_;
+        size_t index_;
+    };
+
+    using Reference = BasicReference<false>;
+    using ConstReference = BasicReference<true>;
+
+    template <bool Const>
+    class BasicIterator {
+        using Owner = std::conditional_t<Const, const SoaVector, SoaVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = BasicReference<Const>;
+        using pointer = void;
+
+        BasicIterator() = default;
+        BasicIterator(Owner* owner, size_t index) : owner_(owner), index_(index) {}
+
+        reference operator*() const { return reference(owner_, index_); }
+        reference operator[](difference_type n) const { return reference(owner_, index_ + n); }
+
+        BasicIterator& operator++() {
+            ++index_;
+            return *this;
+        }
+        BasicIterator operator++(int) {
+            BasicIterator old = *this;
+            ++index_;
+            return old;
+        }
+        BasicIterator& operator--() {
+            --index_;
+            return *this;
+        }
+        BasicIterator operator--(int) {
+            BasicIterator old = *this;
+            --index_;
+            return old;
+        }
+        BasicIterator& operator+=(difference_type n) {
+            index_ += n;
+            return *this;
+        }
+        BasicIterator& operator-=(difference_type n) {
+            index_ -= n;
+            return *this;
+        }
+        BasicIterator operator+(difference_type n) const { return BasicIterator(owner_, index_ + n); }
+        BasicIterator operator-(difference_type n) const { return BasicIterator(owner_, index_ - n); }
+        difference_type operator-(const BasicIterator& other) const {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const BasicIterator& other) const { return index_ == other.index_; }
+        bool operator!=(const BasicIterator& other) const { return index_ != other.index_; }
+        bool operator<(const BasicIterator& other) const { return index_ < other.index_; }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    SoaVector() = default;
+
+    size_t size() const { return std::get<0>(columns_).size(); }
+    bool empty() const { return size() == 0; }
+
+    void reserve(size_t capacity) {
+        std::apply([&](auto&... column) { (column.reserve(capacity), ...); }, columns_);
+    }
+
+    // New elements are value-initialized, field by field
+    void resize(size_t count) {
+        std::apply([&](auto&... column) { (column.resize(count), ...); }, columns_);
+    }
+
+    void clear() {
+        std::apply([](auto&... column) { (column.clear(), ...); }, columns_);
+    }
+
+    void push_back(const T& value) { push_back(value, Indices()); }
+
+    void pop_back() {
+        std::apply([](auto&... column) { (column.pop_back(), ...); }, columns_);
+    }
+
+    Reference operator[](size_t i) { return Reference(this, i); }
+    ConstReference operator[](size_t i) const { return ConstReference(this, i); }
+
+    // Gather element i into a T (default constructed, then the listed
+    // fields assigned) / scatter a T into slot i
+    T get(size_t i) const { return get(i, Indices()); }
+    void set(size_t i, const T& value) { set(i, value, Indices()); }
+
+    // The column of one field: size() contiguous values
+    template <auto Member>
+    soa_detail::field_t<Member>* data() {
+        return std::get<column_index<Member>()>(columns_).data();
+    }
+
+    template <auto Member>
+    const soa_detail::field_t<Member>* data() const {
+        return std::get<column_index<Member>()>(columns_).data();
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+private:
+    template <size_t... I>
+    void push_back(const T& value, std::index_sequence<I...>) {
+        (std::get<I>(columns_).push_back(value.*Members), ...);
+    }
+
+    template <size_t... I>
+    T get(size_t i, std::index_sequence<I...>) const {
+        static_assert(std::is_default_constructible_v<T>, "gathering a T needs a default constructor");
+        T value{};
+        ((value.*Members = std::get<I>(columns_)[i]), ...);
+        return value;
+    }
+
+    template <size_t... I>
+    void set(size_t i, const T& value, std::index_sequence<I...>) {
+        ((std::get<I>(columns_)[i] = value.*Members), ...);
+    }
+
+    template <size_t... I>
+    void copy_slot(size_t from, size_t to, std::index_sequence<I...>) {
+        ((std::get<I>(columns_)[to] = std::get<I>(columns_)[from]), ...);
+    }
+
+    Columns columns_;
+};
+
+}  // namespace containers
@@ -0,0 +1,184 @@
+/**
+ * @file spin_locks.h
+ * @brief Spinning mutual-exclusion locks: TTAS with backoff, ticket, MCS
+ *
+ * All three keep the waiting thread on the CPU instead of parking it in
+ * the kernel, which wins when critical sections are a few dozen
+ * nanoseconds and loses badly once a lock holder can be preempted. They
+ * differ in what the waiters spin on:
+ *
+ * - TtasSpinLock: every waiter reads the same flag and races for it with
+ *   an exchange when it looks free. Cheap, unfair, and the line holding
+ *   the flag bounces between all waiters on every release; exponential
+ *   backoff spreads the retries out.
+ * - TicketLock: take a number, wait until it is served. Strict FIFO, but
+ *   every waiter still polls the one now_serving counter.
+ * - McsLock: waiters form a queue and each spins on its own node, so a
+ *   release touches exactly one other cache line (Mellor-Crummey & Scott).
+ *   Each acquisition needs a queue node that lives until unlock; use
+ *   McsLock::Guard.
+ *
+ * TtasSpinLock and TicketLock are BasicLockable (std::lock_guard works).
+ * Every spin loop falls back to std::this_thread::yield() after
+ * SpinWait::SPIN_LIMIT rounds so an oversubscribed machine still makes
+ * progress.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "cache_line.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace concurrency {
+
+// Tell the core we are spinning (saves power and, on x86, avoids the
+// memory-order mis-speculation flush when the awaited store arrives)
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// Exponential backoff: 1, 2, 4 ... 1 << MAX_SHIFT pauses per round for
+// SPIN_LIMIT rounds, then a yield per round
+class SpinWait {
+public:
+    static constexpr int SPIN_LIMIT = 16;
+    static constexpr int MAX_SHIFT = 10;
+
+    void wait() {
+        if (rounds_ < SPIN_LIMIT) {
+            int pauses = 1 << (rounds_ < MAX_SHIFT ? rounds_ : MAX_SHIFT);
+            for (int i = 0; i < pauses; ++i) cpu_relax();
+            ++rounds_;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    void reset() { rounds_ = 0; }
+
+private:
+    int rounds_ = 0;
+};
+
+class TtasSpinLock {
+public:
+    void lock() {
+        SpinWait spin;
+        while (true) {
+            // Test with plain loads first: they hit the local cache and leave
+            // the line shared until the holder's release invalidates it
+            if (!locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire)) {
+                return;
+            }
+            spin.wait();
+        }
+    }
+
+    bool try_lock() {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() { locked_.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+class TicketLock {
+public:
+    void lock() {
+        uint32_t ticket = next_ticket_->fetch_add(1, std::memory_order_relaxed);
+        SpinWait spin;
+        while (now_serving_->load(std::memory_order_acquire) != ticket) {
+            spin.wait();
+        }
+    }
+
+    bool try_lock() {
+        uint32_t serving = now_serving_->load(std::memory_order_acquire);
+        uint32_t expected = serving;
+        return next_ticket_->compare_exchange_strong(expected, serving + 1, std::memory_order_acquire,
+                                                     std::memory_order_relaxed);
+    }
+
+    // Only the holder writes now_serving, so a plain increment suffices
+    void unlock() {
+        now_serving_->store(now_serving_->load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    // Separate lines: arrivals bump next_ticket without disturbing the
+    // waiters polling now_serving
+    CachePadded<std::atomic<uint32_t>> next_ticket_{0};
+    CachePadded<std::atomic<uint32_t>> now_serving_{0};
+};
+
+class McsLock {
+public:
+    struct alignas(CACHE_LINE_SIZE) Node {
+        std::atomic<Node*> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    // Scoped acquisition with the queue node on the caller's stack
+    class Guard {
+    public:
+        explicit Guard(McsLock& lock) : lock_(lock) { lock_.lock(node_); }
+        ~Guard() { lock_.unlock(node_); }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        McsLock& lock_;
+        Node node_;
+    };
+
+    void lock(Node& node) {
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.locked.store(true, std::memory_order_relaxed);
+        Node* previous = tail_->exchange(&node, std::memory_order_acq_rel);
+        if (previous == nullptr) return;
+        // Queue behind the previous holder and wait for it to hand over
+        previous->next.store(&node, std::memory_order_release);
+        SpinWait spin;
+        while (node.locked.load(std::memory_order_acquire)) {
+            spin.wait();
+        }
+    }
+
+    void unlock(Node& node) {
+        Node* next = node.next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            Node* expected = &node;
+            if (tail_->compare_exchange_strong(expected, nullptr, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+                return;  // Nobody waiting
+            }
+            // A successor swapped itself in but has not linked up yet
+            SpinWait spin;
+            while ((next = node.next.load(std::memory_order_acquire)) == nullptr) {
+                spin.wait();
+            }
+        }
+        next->locked.store(false, std::memory_order_release);
+    }
+
+private:
+    CachePadded<std::atomic<Node*>> tail_{nullptr};
+};
+
+}  // namespace concurrency
@@ -0,0 +1,229 @@
+/**
+ * @file stable_vector.h
+ * @brief Chunked vector whose elements never move: growth keeps references valid
+ *
+ * StableVector stores its elements in fixed-size chunks and keeps a small
+ * table of chunk pointers. Growing adds one chunk; the elements already
+ * stored stay where they are. So:
+ * - a pointer or reference to an element stays valid until that element is
+ *   popped or the vector is cleared (std::deque gives the same guarantee,
+ *   but with chunks too small for big data: 512 bytes in libstdc++)
+ * - nothing is ever copied on growth, and peak memory is the final size
+ *   plus at most one partly filled chunk, for any element type
+ * - indexing is a shift, a mask and one extra load
+ *
+ *     containers::StableVector<Order> orders;
+ *     Order& first = orders.emplace_back(...);
+ *     for (...) orders.emplace_back(...);    // `first` is still valid
+ *
+ * Chunks hold a power-of-two number of elements, as many as fit into
+ * ChunkBytes (64KB by default, at least one element). Iteration is
+ * contiguous within a chunk, so scans run at nearly vector speed. Unlike a
+ * RemapVector (remap_vector.h), the elements are not one array: data() does
+ * not exist and a C API that wants a pointer and a length cannot take it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace containers {
+
+template <typename T, size_t ChunkBytes = 64 * 1024>
+class StableVector {
+    static constexpr size_t floor_power_of_two(size_t n) {
+        size_t power = 1;
+        while (power * 2 <= n) power *= 2;
+        return power;
+    }
+
+public:
+    static constexpr size_t CHUNK_SIZE = floor_power_of_two(ChunkBytes / sizeof(T) > 0 ? ChunkBytes / sizeof(T) : 1);
+
+private:
+    static constexpr size_t log2(size_t power_of_two) {
+        size_t shift = 0;
+        while ((size_t(1) << shift) < power_of_two) ++shift;
+        return shift;
+    }
+
+    static constexpr size_t CHUNK_SHIFT = log2(CHUNK_SIZE);
+    static constexpr size_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+public:
+    using value_type = T;
+
+    template <bool Const>
+    class BasicIterator {
+        using Owner = std::conditional_t<Const, const StableVector, StableVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const T&, T&>;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+
+        BasicIterator() = default;
+        BasicIterator(Owner* owner, size_t index) : owner_(owner), index_(index) {}
+
+        // iterator -> const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        BasicIterator(const BasicIterator<false>& other) : owner_(other.owner_), index_(other.index_) {}
+
+        reference operator*() const { return (*owner_)[index_]; }
+        pointer operator->() const { return &(*owner_)[index_]; }
+        reference operator[](difference_type n) const { return (*owner_)[index_ + n]; }
+
+        BasicIterator& operator++() {
+            ++index_;
+            return *this;
+        }
+        BasicIterator operator++(int) {
+            BasicIterator old = *this;
+            ++index_;
+            return old;
+        }
+        BasicIterator& operator--() {
+            --index_;
+            return *this;
+        }
+        BasicIterator operator--(int) {
+            BasicIterator old = *this;
+            --index_;
+            return old;
+        }
+        BasicIterator& operator+=(difference_type n) {
+            index_ += n;
+            return *this;
+        }
+        BasicIterator& operator-=(difference_type n) {
+            index_ -= n;
+            return *this;
+        }
+        BasicIterator operator+(difference_type n) const { return BasicIterator(owner_, index_ + n); }
+        BasicIterator operator-(difference_type n) const { return BasicIterator(owner_, index_ - n); }
+        difference_type operator-(const BasicIterator& other) const {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const BasicIterator& other) const { return index_ == other.index_; }
+        bool operator!=(const BasicIterator& other) const { return index_ != other.index_; }
+        bool operator<(const BasicIterator& other) const { return index_ < other.index_; }
+        bool operator>(const BasicIterator& other) const { return index_ > other.index_; }
+        bool operator<=(const BasicIterator& other) const { return index_ <= other.index_; }
+        bool operator>=(const BasicIterator& other) const { return index_ >= other.index_; }
+
+    private:
+        friend class BasicIterator<true>;
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    StableVector() = default;
+
+    StableVector(const StableVector& other) {
+        reserve(other.size_);
+        for (const T& value : other) push_back(value);
+    }
+
+    StableVector(StableVector&& other) noexcept
+        : chunks_(std::move(other.chunks_)), size_(std::exchange(other.size_, 0)) {}
+
+    StableVector& operator=(const StableVector& other) {
+        if (this != &other) StableVector(other).swap(*this);
+        return *this;
+    }
+
+    StableVector& operator=(StableVector&& other) noexcept {
+        StableVector(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~StableVector() {
+        clear();
+        for (T* chunk : chunks_) free_chunk(chunk);
+    }
+
+    void swap(StableVector& other) noexcept {
+        chunks_.swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return chunks_.size() * CHUNK_SIZE; }
+
+    T& operator[](size_t i) { return chunks_[i >> CHUNK_SHIFT][i & CHUNK_MASK]; }
+    const T& operator[](size_t i) const { return chunks_[i >> CHUNK_SHIFT][i & CHUNK_MASK]; }
+    T& back() { return (*this)[size_ - 1]; }
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity()) add_chunk();
+        T* slot = &chunks_[size_ >> CHUNK_SHIFT][size_ & CHUNK_MASK];
+        new (slot) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void pop_back() {
+        --size_;
+        (*this)[size_].~T();
+    }
+
+    // Destroys the elements; the chunks stay allocated for reuse
+    void clear() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < size_; ++i) (*this)[i].~T();
+        }
+        size_ = 0;
+    }
+
+    // Allocates chunks up front (elements already stored stay put)
+    void reserve(size_t count) {
+        size_t chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        if (chunks <= chunks_.size()) return;
+        chunks_.reserve(chunks);
+        while (chunks_.size() < chunks) add_chunk();
+    }
+
+private:
+    void add_chunk() {
+        T* chunk = allocate_chunk();
+        try {
+            chunks_.push_back(chunk);
+        } catch (...) {
+            free_chunk(chunk);
+            throw;
+        }
+    }
+
+    static T* allocate_chunk() {
+        return static_cast<T*>(::operator new(CHUNK_SIZE * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    static void free_chunk(T* chunk) { ::operator delete(chunk, std::align_val_t(alignof(T))); }
+
+    std::vector<T*> chunks_;
+    size_t size_ = 0;
+};
+
+}  // namespace containers
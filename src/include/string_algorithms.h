@@ -0,0 +1,104 @@
+/**
+ * @file string_algorithms.h
+ * @brief Vectorized string algorithms with a string_view-first interface
+ *
+ * Thin, allocation-free front ends to the kernels in simd_kernels.h:
+ *
+ *     strings::to_lower(word);                                 // In place
+ *     size_t cut = strings::find_first_of(line, " \t,;");
+ *     for (std::string_view field : strings::split(csv_line, ',')) { ... }
+ *
+ * Read-only algorithms take std::string_view, so std::string,
+ * containers::InlineString, literals and slices of a mapped file all work
+ * without a copy. The in-place ones take any contiguous string with
+ * data() / size(): std::string, InlineString, std::vector<char>.
+ *
+ * split() and tokenize() return views into the input rather than copies:
+ * a line of twenty fields costs one vector (none, with the overloads that
+ * append to a caller's vector), not twenty strings. The views are only
+ * valid while the input is.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "simd_kernels.h"
+
+namespace strings {
+
+template <typename String>
+void reverse(String& s) {
+    simd::reverse(s.data(), s.size());
+}
+
+// ASCII only: other bytes pass through, whatever the locale
+template <typename String>
+void to_upper(String& s) {
+    simd::to_upper(s.data(), s.size());
+}
+
+template <typename String>
+void to_lower(String& s) {
+    simd::to_lower(s.data(), s.size());
+}
+
+// As std::string_view::find_first_of: position of the first character of
+// `text` (from `pos`) that appears in `set`, or npos
+inline size_t find_first_of(std::string_view text, std::string_view set, size_t pos = 0) {
+    if (pos >= text.size()) return std::string_view::npos;
+    const char* hit = simd::find_first_of(text.data() + pos, text.size() - pos, set.data(), set.size());
+    return hit != nullptr ? static_cast<size_t>(hit - text.data()) : std::string_view::npos;
+}
+
+inline size_t find(std::string_view text, char c, size_t pos = 0) {
+    if (pos >= text.size()) return std::string_view::npos;
+    const char* hit = simd::find_byte(text.data() + pos, text.size() - pos, c);
+    return hit != nullptr ? static_cast<size_t>(hit - text.data()) : std::string_view::npos;
+}
+
+// Every field between delimiters, empty ones included (as std::getline
+// splits): "a,,b" -> {"a", "", "b"}. Appends to `fields`.
+inline void split(std::string_view text, char delimiter, std::vector<std::string_view>& fields) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (true) {
+        const char* cut = simd::find_byte(p, static_cast<size_t>(end - p), delimiter);
+        if (cut == nullptr) {
+            fields.emplace_back(p, static_cast<size_t>(end - p));
+            return;
+        }
+        fields.emplace_back(p, static_cast<size_t>(cut - p));
+        p = cut + 1;
+    }
+}
+
+inline std::vector<std::string_view> split(std::string_view text, char delimiter) {
+    std::vector<std::string_view> fields;
+    split(text, delimiter, fields);
+    return fields;
+}
+
+// The non-empty runs between any of `delimiters` (as strtok() tokenizes,
+// without modifying the input): "  a b\tc " -> {"a", "b", "c"}.
+// Appends to `tokens`.
+inline void tokenize(std::string_view text, std::string_view delimiters, std::vector<std::string_view>& tokens) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        const char* cut = simd::find_first_of(p, static_cast<size_t>(end - p), delimiters.data(), delimiters.size());
+        if (cut == nullptr) cut = end;
+        if (cut > p) tokens.emplace_back(p, static_cast<size_t>(cut - p));
+        p = cut + 1;
+    }
+}
+
+inline std::vector<std::string_view> tokenize(std::string_view text, std::string_view delimiters) {
+    std::vector<std::string_view> tokens;
+    tokenize(text, delimiters, tokens);
+    return tokens;
+}
+
+}  // namespace strings
@@ -0,0 +1,193 @@
+/**
+ * @file task.h
+ * @brief Lazy C++20 coroutine task: Task<T>, co_await-able, with detach()
+ *
+ * A thread blocked in recv() keeps its whole stack (8MB reserved, tens of
+ * KB touched) for as long as the peer is quiet. A coroutine that suspends
+ * in co_await keeps only its frame: the locals that live across the
+ * suspension point, typically a few hundred bytes. Session logic stays the
+ * same straight-line loop:
+ *
+ *     Task<void> session(net::AsyncSocket& socket) {
+ *         char buffer[512];
+ *         while (co_await net::async_recv(socket, buffer, sizeof(buffer)) > 0) {
+ *             ...
+ *         }
+ *     }
+ *
+ * Task<T> is lazy: nothing runs until it is awaited or detached.
+ * - `co_await task` starts it and resumes the awaiting coroutine when it
+ *   finishes (symmetric transfer, so long chains do not grow the stack)
+ *   with its value, or rethrows its exception
+ * - `task.detach()` starts a root coroutine (one per connection, say) that
+ *   frees its own frame when it finishes; an exception escaping a detached
+ *   task calls std::terminate, like one escaping a std::thread
+ *
+ * Tasks are resumed by whoever completes what they wait on, for the
+ * awaitables in async_socket.h that is the EventLoop thread.
+ */
+
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "task.h needs C++20 coroutines; configure with -DBOOTCAMP_CXX20=ON"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace concurrency {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+class TaskPromiseBase {
+public:
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Hand control to the awaiting coroutine, or free a detached frame
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+            TaskPromiseBase& promise = self.promise();
+            if (promise.detached_) {
+                self.destroy();
+                return std::noop_coroutine();
+            }
+            return promise.continuation_ ? promise.continuation_ : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() {
+        if (detached_) std::terminate();  // Nobody left to rethrow it to
+        error_ = std::current_exception();
+    }
+
+    void set_continuation(std::coroutine_handle<> continuation) { continuation_ = continuation; }
+    void set_detached() { detached_ = true; }
+
+protected:
+    void rethrow_if_failed() {
+        if (error_) std::rethrow_exception(error_);
+    }
+
+private:
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr error_;
+    bool detached_ = false;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T take() {
+        rethrow_if_failed();
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T> value_;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void take() { rethrow_if_failed(); }
+};
+
+}  // namespace detail
+
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(Handle handle) : handle_(handle) {}
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    // Destroying a task that has not finished destroys its frame, locals
+    // and all; it must not be suspended on anything at that point
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    bool valid() const { return static_cast<bool>(handle_); }
+
+    // Start running; the frame frees itself at the end
+    void detach() {
+        Handle handle = std::exchange(handle_, {});
+        handle.promise().set_detached();
+        handle.resume();
+    }
+
+    class Awaiter {
+    public:
+        explicit Awaiter(Handle handle) : handle_(handle) {}
+
+        bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+        // Start the task; it resumes us from its final suspend point
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle_.promise().set_continuation(awaiting);
+            return handle_;
+        }
+
+        T await_resume() { return handle_.promise().take(); }
+
+    private:
+        Handle handle_;
+    };
+
+    // The task stays alive (owned by this Task) until the full expression
+    // ends, so the value can be moved out of its promise
+    Awaiter operator co_await() && noexcept { return Awaiter(handle_); }
+
+private:
+    Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+}  // namespace detail
+
+}  // namespace concurrency
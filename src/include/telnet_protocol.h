@@ -0,0 +1,241 @@
+/**
+ * @file telnet_protocol.h
+ * @brief Streaming Telnet (RFC 854) protocol parser shared by server and client
+ *
+ * telnet::Parser is an incremental state machine: bytes can be fed in
+ * arbitrary chunks (one recv() at a time) and IAC sequences that straddle
+ * two chunks are reassembled from the parser's fixed-size state. Nothing is
+ * heap-allocated while parsing.
+ *
+ * Decoded input is reported through a handler object with four callbacks:
+ *
+ *   void on_data(const unsigned char* data, size_t length);   // plain bytes
+ *   void on_command(unsigned char command);                   // IAC NOP, IAC GA, ...
+ *   void on_negotiation(unsigned char command, unsigned char option);  // WILL/WONT/DO/DONT
+ *   void on_subnegotiation(unsigned char option, const unsigned char* data, size_t length);
+ *
+ * Runs of plain data between IACs are located with memchr(), which libc
+ * implements with vector instructions, and are delivered as one span rather
+ * than byte by byte.
+ */
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Telnet protocol constants
+const unsigned char TELNET_IAC = 255;   // Interpret As Command
+const unsigned char TELNET_WILL = 251;  // Will option
+const unsigned char TELNET_WONT = 252;  // Won't option
+const unsigned char TELNET_DO = 253;    // Do option
+const unsigned char TELNET_DONT = 254;  // Don't option
+const unsigned char TELNET_SE = 240;    // Subnegotiation End
+const unsigned char TELNET_SB = 250;    // Subnegotiation Begin
+const unsigned char TELNET_NOP = 241;   // No Operation (used as a keepalive)
+
+// Telnet options
+const unsigned char TELNET_ECHO = 1;           // Echo option
+const unsigned char TELNET_SUPPRESS_GA = 3;    // Suppress Go Ahead
+const unsigned char TELNET_TERMINAL_TYPE = 24; // Terminal Type
+const unsigned char TELNET_WINDOW_SIZE = 31;   // Window Size (NAWS)
+
+// Subnegotiation qualifiers (RFC 1091)
+const unsigned char TELNET_SB_IS = 0;
+const unsigned char TELNET_SB_SEND = 1;
+
+namespace telnet {
+
+// Longest subnegotiation payload we keep; longer ones are truncated
+const size_t MAX_SUBNEGOTIATION = 64;
+
+class Parser {
+public:
+    // Consume the next chunk of the stream
+    template <typename Handler>
+    void feed(const unsigned char* data, size_t length, Handler& handler) {
+        const unsigned char* p = data;
+        const unsigned char* end = data + length;
+
+        while (p < end) {
+            if (state_ == State::DATA) {
+                // Fast path: hand over everything up to the next IAC in one go
+                auto* iac = static_cast<const unsigned char*>(std::memchr(p, TELNET_IAC, end - p));
+                const unsigned char* run_end = iac ? iac : end;
+                if (run_end > p) {
+                    handler.on_data(p, static_cast<size_t>(run_end - p));
+                }
+                if (!iac) return;
+                p = iac + 1;
+                state_ = State::IAC;
+                continue;
+            }
+
+            unsigned char byte = *p++;
+            switch (state_) {
+                case State::IAC:
+                    if (byte == TELNET_IAC) {
+                        // Escaped 255 data byte
+                        handler.on_data(&byte, 1);
+                        state_ = State::DATA;
+                    } else if (byte == TELNET_WILL || byte == TELNET_WONT || byte == TELNET_DO ||
+                               byte == TELNET_DONT) {
+                        command_ = byte;
+                        state_ = State::OPTION;
+                    } else if (byte == TELNET_SB) {
+                        state_ = State::SB_OPTION;
+                    } else {
+                        handler.on_command(byte);
+                        state_ = State::DATA;
+                    }
+                    break;
+
+                case State::OPTION:
+                    handler.on_negotiation(command_, byte);
+                    state_ = State::DATA;
+                    break;
+
+                case State::SB_OPTION:
+                    sb_option_ = byte;
+                    sb_length_ = 0;
+                    state_ = State::SB_DATA;
+                    break;
+
+                case State::SB_DATA:
+                    if (byte == TELNET_IAC) {
+                        state_ = State::SB_IAC;
+                    } else {
+                        append_sb(byte);
+                    }
+                    break;
+
+                case State::SB_IAC:
+                    if (byte == TELNET_SE) {
+                        handler.on_subnegotiation(sb_option_, sb_buffer_, sb_length_);
+                        state_ = State::DATA;
+                    } else {
+                        // IAC IAC inside SB is an escaped 255; anything else is
+                        // malformed, keep the byte and stay in the subnegotiation
+                        append_sb(byte);
+                        state_ = State::SB_DATA;
+                    }
+                    break;
+
+                case State::DATA:
+                    break;
+            }
+        }
+    }
+
+    template <typename Handler>
+    void feed(const char* data, size_t length, Handler& handler) {
+        feed(reinterpret_cast<const unsigned char*>(data), length, handler);
+    }
+
+    // True while a partial IAC sequence is buffered
+    bool in_sequence() const { return state_ != State::DATA; }
+
+    void reset() {
+        state_ = State::DATA;
+        sb_length_ = 0;
+    }
+
+private:
+    enum class State : unsigned char {
+        DATA,       // Ordinary characters
+        IAC,        // Saw IAC, waiting for the command byte
+        OPTION,     // Saw IAC WILL/WONT/DO/DONT, waiting for the option
+        SB_OPTION,  // Saw IAC SB, waiting for the option
+        SB_DATA,    // Inside a subnegotiation payload
+        SB_IAC,     // Saw IAC inside a subnegotiation
+    };
+
+    void append_sb(unsigned char byte) {
+        if (sb_length_ < MAX_SUBNEGOTIATION) {
+            sb_buffer_[sb_length_++] = byte;
+        }
+    }
+
+    State state_ = State::DATA;
+    unsigned char command_ = 0;
+    unsigned char sb_option_ = 0;
+    size_t sb_length_ = 0;
+    unsigned char sb_buffer_[MAX_SUBNEGOTIATION];
+};
+
+// Which options are currently enabled on each side of the connection. RFC 854
+// requires that a request for the mode we are already in is not acknowledged,
+// which is what stops two peers from negotiating in a loop.
+struct OptionTable {
+    std::bitset<256> local;   // Options we perform (we said WILL)
+    std::bitset<256> remote;  // Options the peer performs (we said DO)
+
+    // Record a new state; returns true if it actually changed
+    bool set_local(unsigned char option, bool enabled) {
+        if (local[option] == enabled) return false;
+        local[option] = enabled;
+        return true;
+    }
+
+    bool set_remote(unsigned char option, bool enabled) {
+        if (remote[option] == enabled) return false;
+        remote[option] = enabled;
+        return true;
+    }
+};
+
+// Write IAC <command> <option> into out (3 bytes)
+inline size_t encode_negotiation(unsigned char* out, unsigned char command, unsigned char option) {
+    out[0] = TELNET_IAC;
+    out[1] = command;
+    out[2] = option;
+    return 3;
+}
+
+// Write IAC SB <option> <payload, IAC-escaped> IAC SE into out. out must hold
+// at least 5 + 2 * length bytes. Returns the number of bytes written.
+inline size_t encode_subnegotiation(unsigned char* out, unsigned char option, const unsigned char* payload,
+                                    size_t length) {
+    size_t n = 0;
+    out[n++] = TELNET_IAC;
+    out[n++] = TELNET_SB;
+    out[n++] = option;
+    for (size_t i = 0; i < length; ++i) {
+        out[n++] = payload[i];
+        if (payload[i] == TELNET_IAC) out[n++] = TELNET_IAC;
+    }
+    out[n++] = TELNET_IAC;
+    out[n++] = TELNET_SE;
+    return n;
+}
+
+// Length of the leading run of printable ASCII (32..126) in data. Lets line
+// editors copy and echo pasted text in bulk instead of byte at a time.
+inline size_t scan_printable(const unsigned char* data, size_t length) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Bias by 0x80 so a signed compare tests the unsigned range [32, 126]
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i low = _mm_set1_epi8(static_cast<char>(32 ^ 0x80));
+    const __m128i high = _mm_set1_epi8(static_cast<char>(126 ^ 0x80));
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), bias);
+        __m128i outside = _mm_or_si128(_mm_cmplt_epi8(chunk, low), _mm_cmpgt_epi8(chunk, high));
+        int mask = _mm_movemask_epi8(outside);
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+#endif
+    while (i < length && data[i] >= 32 && data[i] <= 126) {
+        ++i;
+    }
+    return i;
+}
+
+}  // namespace telnet
@@ -0,0 +1,129 @@
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timing wheel: O(1) schedule, cancel and expiry
+ *
+ * A priority queue of deadlines costs O(log n) per timer, and it cannot
+ * cancel at all; the usual workaround is to leave stale entries behind.
+ * Servers with one idle timeout per connection re-arm that timer on every
+ * read, so both costs add up quickly.
+ *
+ * The wheel hashes each timer into a slot by its deadline:
+ *
+ *   level 0: 256 slots of 1 tick           (deadlines < 256 ticks away)
+ *   level 1:  64 slots of 256 ticks        (< 2^14 ticks)
+ *   level 2:  64 slots of 2^14 ticks       (< 2^20 ticks)
+ *   level 3:  64 slots of 2^20 ticks       (< 2^26 ticks)
+ *   level 4:  64 slots of 2^26 ticks       (< 2^32 ticks; later ones wait here)
+ *
+ * Every 256 ticks the next level-1 slot is "cascaded": its timers are
+ * re-hashed into level 0, and likewise upwards. Timers are intrusive
+ * doubly linked list nodes, so schedule() and cancel() are a few pointer
+ * writes, and a timer costs no allocation beyond its owner.
+ *
+ * Not thread-safe: a wheel belongs to one thread (an EventLoop owns one).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace net {
+
+class TimerWheel;
+
+// Intrusive list links; the wheel's slots are sentinel nodes
+struct TimerLink {
+    TimerLink* prev = this;
+    TimerLink* next = this;
+};
+
+// Embed a Timer in the object it times out. It must not move while
+// scheduled; destroying it cancels it.
+class Timer : private TimerLink {
+public:
+    using Callback = std::function<void()>;
+
+    Timer() = default;
+    explicit Timer(Callback callback) : callback_(std::move(callback)) {}
+    ~Timer();
+
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+    void set_callback(Callback callback) { callback_ = std::move(callback); }
+
+    bool scheduled() const { return wheel_ != nullptr; }
+    uint64_t deadline() const { return deadline_; }
+
+    // Convenience for wheel->cancel(*this); no-op when not scheduled
+    void cancel();
+
+private:
+    friend class TimerWheel;
+
+    TimerWheel* wheel_ = nullptr;
+    uint64_t deadline_ = 0;
+    int level_ = 0;
+    Callback callback_;
+};
+
+class TimerWheel {
+public:
+    static constexpr int LEVELS = 5;
+    static constexpr int LEVEL0_BITS = 8;
+    static constexpr int LEVEL_BITS = 6;
+
+    explicit TimerWheel(uint64_t start_tick = 0);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Fire `timer` once `delay` ticks from now (re-arms it if scheduled)
+    void schedule(Timer& timer, uint64_t delay) { schedule_at(timer, now_ + delay); }
+
+    // Fire `timer` at an absolute tick; deadlines that are not in the
+    // future fire on the next advance() that moves time forward
+    void schedule_at(Timer& timer, uint64_t deadline);
+
+    void cancel(Timer& timer);
+
+    // Move time forward to `tick`, running the callbacks of every timer
+    // that is due, in deadline order. Callbacks may schedule or cancel any
+    // timer, including their own. Returns the number of timers fired.
+    size_t advance(uint64_t tick);
+
+    // The tick most recently passed to advance() (or the start tick)
+    uint64_t now() const { return now_; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Ticks until advance() may have work to do, for poll timeouts: exact
+    // when a timer is due within 256 ticks, otherwise the next cascade.
+    // -1 when no timer is scheduled.
+    int64_t ticks_until_next() const;
+
+private:
+    static constexpr size_t LEVEL0_SLOTS = size_t(1) << LEVEL0_BITS;
+    static constexpr size_t LEVEL_SLOTS = size_t(1) << LEVEL_BITS;
+
+    // Slot list (and its level) for a deadline, relative to next_
+    TimerLink& slot_for(uint64_t deadline, int& level);
+    void link(Timer& timer);
+    void unlink(Timer& timer);
+    static void unlink_node(TimerLink& node);
+    static void take_list(TimerLink& from, TimerLink& to);
+    void cascade(int level, size_t index);
+
+    TimerLink level0_[LEVEL0_SLOTS];
+    TimerLink levels_[LEVELS - 1][LEVEL_SLOTS];
+    size_t level_size_[LEVELS] = {};  // Lets advance() skip empty stretches
+    uint64_t now_;
+    uint64_t next_;  // Next tick whose level-0 slot has not been run
+    size_t size_ = 0;
+};
+
+}  // namespace net
@@ -0,0 +1,95 @@
+/**
+ * @file top_k.h
+ * @brief Top-k selection with bounded heaps, sequential and parallel
+ *
+ * To find the k best of n elements, keep a heap of the best k seen so far
+ * with the *worst* of them on top. Every new element is compared with
+ * that worst one and is usually rejected at once, so the cost is
+ * O(n log k) with a small constant and O(k) memory. There is no full
+ * sort and no copy of the input.
+ *
+ * parallel_top_k() splits the input into one contiguous chunk per pool
+ * worker. Each task fills its own bounded heap, and the per-task results
+ * (k elements each) are merged at the end with one more bounded pass.
+ * The tasks share nothing but the read-only input.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <vector>
+
+#include "dary_heap.h"
+#include "work_stealing_pool.h"
+
+namespace containers {
+
+namespace detail {
+
+// Flips a comparator so that the bounded heap keeps its worst element on top
+template <typename Compare>
+struct Reversed {
+    Compare comp;
+    template <typename T>
+    bool operator()(const T& a, const T& b) const {
+        return comp(b, a);
+    }
+};
+
+}  // namespace detail
+
+// The k largest elements of [first, last) under comp, best first
+template <typename It, typename Compare = std::less<typename std::iterator_traits<It>::value_type>>
+std::vector<typename std::iterator_traits<It>::value_type> top_k(It first, It last, size_t k,
+                                                                 Compare comp = Compare()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    if (k == 0) return {};
+
+    DaryHeap<T, 4, detail::Reversed<Compare>> heap(detail::Reversed<Compare>{comp});
+    heap.reserve(k);
+    for (; first != last; ++first) {
+        if (heap.size() < k) {
+            heap.push(*first);
+        } else if (comp(heap.top(), *first)) {
+            heap.replace_top(*first);
+        }
+    }
+    std::vector<T> result = heap.release();
+    std::sort(result.begin(), result.end(), detail::Reversed<Compare>{comp});
+    return result;
+}
+
+// top_k() over data on the pool: one bounded heap per worker, merged at the end
+template <typename T, typename Compare = std::less<T>>
+std::vector<T> parallel_top_k(const std::vector<T>& data, size_t k, concurrency::WorkStealingPool& pool,
+                              Compare comp = Compare()) {
+    size_t chunks = std::min(pool.size(), std::max<size_t>(1, data.size() / std::max<size_t>(k, 1)));
+    if (chunks <= 1) return top_k(data.begin(), data.end(), k, comp);
+
+    std::vector<std::future<std::vector<T>>> partials;
+    size_t chunk_size = (data.size() + chunks - 1) / chunks;
+    // Rounding chunk_size up can leave trailing chunks empty (5 elements in
+    // 4 chunks of 2); starting one past the end would read outside data
+    chunks = (data.size() + chunk_size - 1) / chunk_size;
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t lo = c * chunk_size;
+        size_t hi = std::min(data.size(), lo + chunk_size);
+        partials.push_back(pool.submit([&data, lo, hi, k, comp] {
+            return top_k(data.begin() + lo, data.begin() + hi, k, comp);
+        }));
+    }
+
+    std::vector<T> merged;
+    merged.reserve(chunks * k);
+    for (auto& partial : partials) {
+        std::vector<T> part = partial.get();
+        merged.insert(merged.end(), part.begin(), part.end());
+    }
+    return top_k(merged.begin(), merged.end(), k, comp);
+}
+
+}  // namespace containers
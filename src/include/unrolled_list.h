@@ -0,0 +1,346 @@
+/**
+ * @file unrolled_list.h
+ * @brief Unrolled doubly linked list: several elements per cache-line node
+ *
+ * A classic linked list pays one cache miss per element on traversal,
+ * because every node is a separate heap allocation. An unrolled list keeps
+ * a small array of elements in each node - as many as fit into NodeBytes
+ * (one cache line by default) next to the links - so a traversal misses
+ * at most once per node, and the hardware prefetcher sees short
+ * sequential runs.
+ *
+ * Nodes come from memory::PoolAllocator, with one shared pool per node
+ * type. Nodes are packed densely and can move between lists, so splice()
+ * relinks node chains instead of copying elements.
+ *
+ * Iterator invalidation:
+ * - insert() invalidates iterators into the node it lands in (and into
+ *   the new node if that node had to be split)
+ * - erase() invalidates iterators into the affected node and its successor
+ * - splice() keeps iterators into the moved elements valid, but not into
+ *   the node at the splice position, which may be split
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "cache_line.h"
+#include "fixed_pool.h"
+
+namespace containers {
+
+template <typename T, size_t NodeBytes = CACHE_LINE_SIZE>
+class UnrolledList {
+    struct NodeHeader {
+        NodeHeader* prev;
+        NodeHeader* next;
+        uint32_t count;
+    };
+
+public:
+    // Elements per node: whatever fits next to the header (at least one)
+    static constexpr size_t NODE_CAPACITY =
+        NodeBytes > sizeof(NodeHeader) + sizeof(T) ? (NodeBytes - sizeof(NodeHeader)) / sizeof(T) : 1;
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Node : NodeHeader {
+        alignas(T) unsigned char storage[NODE_CAPACITY * sizeof(T)];
+
+        T* slot(size_t i) { return reinterpret_cast<T*>(storage) + i; }
+        const T* slot(size_t i) const { return reinterpret_cast<const T*>(storage) + i; }
+        Node* next_node() const { return static_cast<Node*>(this->next); }
+        Node* prev_node() const { return static_cast<Node*>(this->prev); }
+    };
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        Iterator() = default;
+
+        // iterator -> const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        Iterator(const Iterator<false>& other) : node_(other.node_), index_(other.index_), list_(other.list_) {}
+
+        reference operator*() const { return *node_->slot(index_); }
+        pointer operator->() const { return node_->slot(index_); }
+
+        Iterator& operator++() {
+            if (++index_ == node_->count) {
+                node_ = node_->next_node();
+                index_ = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        // Decrementing end() lands on the last element
+        Iterator& operator--() {
+            if (node_ == nullptr) {
+                node_ = list_->tail_;
+                index_ = node_->count - 1;
+            } else if (index_ == 0) {
+                node_ = node_->prev_node();
+                index_ = node_->count - 1;
+            } else {
+                --index_;
+            }
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator temp = *this;
+            --*this;
+            return temp;
+        }
+
+        bool operator==(const Iterator& other) const { return node_ == other.node_ && index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class UnrolledList;
+        template <bool>
+        friend class Iterator;
+        using ListPtr = std::conditional_t<Const, const UnrolledList*, UnrolledList*>;
+
+        Iterator(Node* node, size_t index, ListPtr list) : node_(node), index_(index), list_(list) {}
+
+        Node* node_ = nullptr;
+        size_t index_ = 0;
+        ListPtr list_ = nullptr;
+    };
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    UnrolledList() = default;
+
+    UnrolledList(const UnrolledList& other) {
+        for (const T& value : other) push_back(value);
+    }
+
+    UnrolledList(UnrolledList&& other) noexcept { steal(other); }
+
+    UnrolledList& operator=(UnrolledList other) noexcept {
+        clear();
+        steal(other);
+        return *this;
+    }
+
+    ~UnrolledList() { clear(); }
+
+    iterator begin() { return iterator(head_, 0, this); }
+    iterator end() { return iterator(nullptr, 0, this); }
+    const_iterator begin() const { return const_iterator(head_, 0, this); }
+    const_iterator end() const { return const_iterator(nullptr, 0, this); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t node_count() const { return nodes_; }
+
+    T& front() { return *head_->slot(0); }
+    T& back() { return *tail_->slot(tail_->count - 1); }
+
+    void push_back(const T& value) { emplace(end(), value); }
+    void push_back(T&& value) { emplace(end(), std::move(value)); }
+    void push_front(const T& value) { emplace(begin(), value); }
+
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+    // Insert before pos; returns an iterator to the new element
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        Node* node = pos.node_;
+        size_t index = pos.index_;
+
+        if (node == nullptr) {
+            // Appending: use the tail's spare room, or start a new node
+            if (tail_ == nullptr || tail_->count == NODE_CAPACITY) {
+                link_after(tail_, allocate_node());
+            }
+            node = tail_;
+            index = node->count;
+        } else if (node->count == NODE_CAPACITY) {
+            // Full: move the upper half into a new node first
+            Node* upper = split(node, NODE_CAPACITY / 2);
+            if (index > node->count) {
+                index -= node->count;
+                node = upper;
+            }
+        }
+
+        // Shift [index, count) one slot to the right
+        size_t count = node->count;
+        if (index == count) {
+            new (node->slot(index)) T(std::forward<Args>(args)...);
+        } else {
+            T value(std::forward<Args>(args)...);
+            new (node->slot(count)) T(std::move(*node->slot(count - 1)));
+            std::move_backward(node->slot(index), node->slot(count - 1), node->slot(count));
+            *node->slot(index) = std::move(value);
+        }
+        ++node->count;
+        ++size_;
+        return iterator(node, index, this);
+    }
+
+    // Remove the element at pos; returns an iterator to the element after it
+    iterator erase(const_iterator pos) {
+        Node* node = pos.node_;
+        size_t index = pos.index_;
+
+        std::move(node->slot(index + 1), node->slot(node->count), node->slot(index));
+        node->slot(node->count - 1)->~T();
+        --node->count;
+        --size_;
+
+        if (node->count == 0) {
+            Node* next = node->next_node();
+            unlink(node);
+            free_node(node);
+            return iterator(next, 0, this);
+        }
+
+        // Keep nodes at least a quarter full by merging with the successor
+        Node* next = node->next_node();
+        if (next != nullptr && node->count + next->count <= NODE_CAPACITY / 2) {
+            for (size_t i = 0; i < next->count; ++i) {
+                new (node->slot(node->count + i)) T(std::move(*next->slot(i)));
+                next->slot(i)->~T();
+            }
+            node->count += next->count;
+            next->count = 0;
+            unlink(next);
+            free_node(next);
+        }
+
+        if (index == node->count) {
+            return iterator(node->next_node(), 0, this);
+        }
+        return iterator(node, index, this);
+    }
+
+    void pop_front() { erase(begin()); }
+    void pop_back() { erase(std::prev(end())); }
+
+    // Move all of other's elements before pos. O(1) in the number of
+    // elements moved: node chains are relinked, and at most one node of
+    // this list is split to make room.
+    void splice(const_iterator pos, UnrolledList& other) {
+        if (&other == this || other.empty()) return;
+
+        Node* after = pos.node_;
+        if (after != nullptr && pos.index_ > 0) {
+            after = split(after, pos.index_);  // pos now starts a node
+        }
+        Node* before = after != nullptr ? after->prev_node() : tail_;
+
+        Node* first = other.head_;
+        Node* last = other.tail_;
+        first->prev = before;
+        last->next = after;
+        if (before != nullptr) before->next = first; else head_ = first;
+        if (after != nullptr) after->prev = last; else tail_ = last;
+
+        size_ += other.size_;
+        nodes_ += other.nodes_;
+        other.head_ = other.tail_ = nullptr;
+        other.size_ = other.nodes_ = 0;
+    }
+
+    void clear() {
+        Node* node = head_;
+        while (node != nullptr) {
+            Node* next = node->next_node();
+            for (size_t i = 0; i < node->count; ++i) node->slot(i)->~T();
+            free_node(node);
+            node = next;
+        }
+        head_ = tail_ = nullptr;
+        size_ = nodes_ = 0;
+    }
+
+private:
+    using NodeAllocator = memory::PoolAllocator<Node>;
+
+    Node* allocate_node() {
+        Node* node = NodeAllocator().allocate(1);
+        node->prev = node->next = nullptr;
+        node->count = 0;
+        ++nodes_;
+        return node;
+    }
+
+    void free_node(Node* node) {
+        NodeAllocator().deallocate(node, 1);
+        --nodes_;
+    }
+
+    void link_after(Node* before, Node* node) {
+        Node* after = before != nullptr ? before->next_node() : head_;
+        node->prev = before;
+        node->next = after;
+        if (before != nullptr) before->next = node; else head_ = node;
+        if (after != nullptr) after->prev = node; else tail_ = node;
+    }
+
+    void unlink(Node* node) {
+        if (node->prev != nullptr) node->prev_node()->next = node->next; else head_ = node->next_node();
+        if (node->next != nullptr) node->next_node()->prev = node->prev; else tail_ = node->prev_node();
+    }
+
+    // Move elements [at, count) of node into a new node linked right after
+    // it; returns the new node
+    Node* split(Node* node, size_t at) {
+        Node* upper = allocate_node();
+        for (size_t i = at; i < node->count; ++i) {
+            new (upper->slot(i - at)) T(std::move(*node->slot(i)));
+            node->slot(i)->~T();
+        }
+        upper->count = node->count - static_cast<uint32_t>(at);
+        node->count = static_cast<uint32_t>(at);
+        link_after(node, upper);
+        return upper;
+    }
+
+    void steal(UnrolledList& other) {
+        head_ = other.head_;
+        tail_ = other.tail_;
+        size_ = other.size_;
+        nodes_ = other.nodes_;
+        other.head_ = other.tail_ = nullptr;
+        other.size_ = other.nodes_ = 0;
+    }
+
+    Node* head_ = nullptr;
+    Node* tail_ = nullptr;
+    size_t size_ = 0;
+    size_t nodes_ = 0;
+};
+
+}  // namespace containers
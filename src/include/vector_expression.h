@@ -0,0 +1,263 @@
+/**
+ * @file vector_expression.h
+ * @brief Numeric vector whose arithmetic builds expressions, evaluated in one loop
+ *
+ * With ordinary operators on vectors, `a + b * c` computes b * c into a
+ * temporary vector (one allocation, one pass), then adds a into another
+ * (a second allocation and pass), and frees the temporary. Move
+ * semantics can recycle the temporary's buffer, but not the extra pass
+ * over memory.
+ *
+ * Here `b * c` does not compute anything: it returns a small object
+ * holding its operands, and `a + (that)` wraps it once more. Only
+ * assigning the expression to a NumericVector runs the loop, once, with
+ * the whole formula inlined into its body:
+ *
+ *     math::NumericVector<double> a(n, 1.0), b(n, 2.0), c(n, 3.0);
+ *     math::NumericVector<double> r = a + b * c;    // One allocation, one pass
+ *     r = a * 0.5 + r;                              // No allocation, one pass
+ *     double length = std::sqrt(math::dot(r, r));   // No temporary at all
+ *
+ * Expressions hold named vectors by reference and temporaries by value:
+ * an rvalue NumericVector operand is moved into the expression, so
+ * `make_vector() + a` stays valid for as long as the expression does. A
+ * named vector must outlive an expression stored with `auto`.
+ *
+ * Every operation is element-wise, so assigning an expression to one of
+ * its own operands (`a = a + b`) is safe.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace math {
+
+// Base of everything that has a size() and an element operator[]
+template <typename E>
+struct VectorExpression {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+namespace expr_detail {
+
+template <typename E>
+constexpr bool IS_EXPRESSION = std::is_base_of_v<VectorExpression<std::decay_t<E>>, std::decay_t<E>>;
+
+// How a node keeps an operand: lvalues by reference, temporaries (other
+// nodes, moved vectors) by value
+template <typename E>
+using Stored = std::conditional_t<std::is_lvalue_reference_v<E>, const std::decay_t<E>&, std::decay_t<E>>;
+
+// A scalar broadcast over any size, for `v * 2.0`
+template <typename T>
+class Scalar : public VectorExpression<Scalar<T>> {
+public:
+    explicit Scalar(T value) : value_(value) {}
+    static constexpr size_t size() { return std::numeric_limits<size_t>::max(); }
+    T operator[](size_t) const { return value_; }
+
+private:
+    T value_;
+};
+
+template <typename E>
+constexpr bool IS_SCALAR = false;
+template <typename T>
+constexpr bool IS_SCALAR<Scalar<T>> = true;
+
+struct Add {
+    template <typename A, typename B>
+    static auto apply(A a, B b) { return a + b; }
+};
+
+struct Subtract {
+    template <typename A, typename B>
+    static auto apply(A a, B b) { return a - b; }
+};
+
+struct Multiply {
+    template <typename A, typename B>
+    static auto apply(A a, B b) { return a * b; }
+};
+
+struct Divide {
+    template <typename A, typename B>
+    static auto apply(A a, B b) { return a / b; }
+};
+
+template <typename Op, typename L, typename R>
+class Binary : public VectorExpression<Binary<Op, L, R>> {
+public:
+    Binary(L&& left, R&& right) : left_(std::forward<L>(left)), right_(std::forward<R>(right)) {
+        assert(IS_SCALAR<std::decay_t<L>> || IS_SCALAR<std::decay_t<R>> || left_.size() == right_.size());
+    }
+
+    size_t size() const {
+        if constexpr (IS_SCALAR<std::decay_t<L>>) {
+            return right_.size();
+        } else {
+            return left_.size();
+        }
+    }
+
+    auto operator[](size_t i) const { return Op::apply(left_[i], right_[i]); }
+
+private:
+    Stored<L> left_;
+    Stored<R> right_;
+};
+
+template <typename E>
+class Negate : public VectorExpression<Negate<E>> {
+public:
+    explicit Negate(E&& operand) : operand_(std::forward<E>(operand)) {}
+    size_t size() const { return operand_.size(); }
+    auto operator[](size_t i) const { return -operand_[i]; }
+
+private:
+    Stored<E> operand_;
+};
+
+template <typename Op, typename L, typename R>
+Binary<Op, L, R> make_binary(L&& left, R&& right) {
+    return Binary<Op, L, R>(std::forward<L>(left), std::forward<R>(right));
+}
+
+}  // namespace expr_detail
+
+template <typename T>
+class NumericVector : public VectorExpression<NumericVector<T>> {
+public:
+    using value_type = T;
+
+    NumericVector() = default;
+    explicit NumericVector(size_t size, T value = T()) : values_(size, value) {}
+    NumericVector(std::initializer_list<T> values) : values_(values) {}
+
+    // Evaluate: one allocation, one loop over the whole expression
+    template <typename E>
+    NumericVector(const VectorExpression<E>& expression) {
+        const E& e = expression.self();
+        values_.resize(e.size());
+        evaluate(e);
+    }
+
+    // Evaluate into the existing buffer when the size matches (no allocation)
+    template <typename E>
+    NumericVector& operator=(const VectorExpression<E>& expression) {
+        const E& e = expression.self();
+        if (e.size() != values_.size()) {
+            NumericVector result(e);  // e may refer to *this: never resize first
+            values_.swap(result.values_);
+        } else {
+            evaluate(e);
+        }
+        return *this;
+    }
+
+    template <typename E>
+    NumericVector& operator+=(const VectorExpression<E>& expression) {
+        return *this = *this + expression.self();
+    }
+
+    template <typename E>
+    NumericVector& operator-=(const VectorExpression<E>& expression) {
+        return *this = *this - expression.self();
+    }
+
+    NumericVector& operator*=(T scale) { return *this = *this * scale; }
+
+    size_t size() const { return values_.size(); }
+    bool empty() const { return values_.empty(); }
+    T& operator[](size_t i) { return values_[i]; }
+    const T& operator[](size_t i) const { return values_[i]; }
+    T* data() { return values_.data(); }
+    const T* data() const { return values_.data(); }
+    typename std::vector<T>::iterator begin() { return values_.begin(); }
+    typename std::vector<T>::iterator end() { return values_.end(); }
+    typename std::vector<T>::const_iterator begin() const { return values_.begin(); }
+    typename std::vector<T>::const_iterator end() const { return values_.end(); }
+
+private:
+    template <typename E>
+    void evaluate(const E& e) {
+        T* out = values_.data();
+        const size_t n = values_.size();
+        for (size_t i = 0; i < n; ++i) out[i] = e[i];
+    }
+
+    std::vector<T> values_;
+};
+
+// The operators take any mix of vectors and expressions, forwarding them
+// so that temporaries are moved into the node
+template <typename L, typename R,
+          typename = std::enable_if_t<expr_detail::IS_EXPRESSION<L> && expr_detail::IS_EXPRESSION<R>>>
+auto operator+(L&& left, R&& right) {
+    return expr_detail::make_binary<expr_detail::Add>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <typename L, typename R,
+          typename = std::enable_if_t<expr_detail::IS_EXPRESSION<L> && expr_detail::IS_EXPRESSION<R>>>
+auto operator-(L&& left, R&& right) {
+    return expr_detail::make_binary<expr_detail::Subtract>(std::forward<L>(left), std::forward<R>(right));
+}
+
+// Element-wise product and quotient
+template <typename L, typename R,
+          typename = std::enable_if_t<expr_detail::IS_EXPRESSION<L> && expr_detail::IS_EXPRESSION<R>>>
+auto operator*(L&& left, R&& right) {
+    return expr_detail::make_binary<expr_detail::Multiply>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <typename L, typename R,
+          typename = std::enable_if_t<expr_detail::IS_EXPRESSION<L> && expr_detail::IS_EXPRESSION<R>>>
+auto operator/(L&& left, R&& right) {
+    return expr_detail::make_binary<expr_detail::Divide>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <typename E, typename S,
+          typename = std::enable_if_t<expr_detail::IS_EXPRESSION<E> && std::is_arithmetic_v<S>>>
+auto operator*(E&& vector, S scale) {
+    return expr_detail::make_binary<expr_detail::Multiply>(std::forward<E>(vector), expr_detail::Scalar<S>(scale));
+}
+
+template <typename E, typename S,
+          typename = std::enable_if_t<expr_detail::IS_EXPRESSION<E> && std::is_arithmetic_v<S>>>
+auto operator*(S scale, E&& vector) {
+    return expr_detail::make_binary<expr_detail::Multiply>(expr_detail::Scalar<S>(scale), std::forward<E>(vector));
+}
+
+template <typename E, typename S,
+          typename = std::enable_if_t<expr_detail::IS_EXPRESSION<E> && std::is_arithmetic_v<S>>>
+auto operator+(E&& vector, S offset) {
+    return expr_detail::make_binary<expr_detail::Add>(std::forward<E>(vector), expr_detail::Scalar<S>(offset));
+}
+
+template <typename E, typename = std::enable_if_t<expr_detail::IS_EXPRESSION<E>>>
+auto operator-(E&& vector) {
+    return expr_detail::Negate<E>(std::forward<E>(vector));
+}
+
+// Reductions run the expression without storing it anywhere
+template <typename E>
+auto sum(const VectorExpression<E>& expression) {
+    const E& e = expression.self();
+    std::decay_t<decltype(e[0])> total{};
+    for (size_t i = 0; i < e.size(); ++i) total += e[i];
+    return total;
+}
+
+template <typename L, typename R>
+auto dot(const VectorExpression<L>& left, const VectorExpression<R>& right) {
+    return sum(left.self() * right.self());
+}
+
+}  // namespace math
@@ -0,0 +1,477 @@
+/**
+ * @file work_stealing_pool.h
+ * @brief Header-only work-stealing thread pool with futures and parallel_for
+ *
+ * The grown-up version of Exercise6::ThreadPool. Instead of one
+ * std::queue behind one mutex, every worker owns a Chase-Lev deque:
+ *
+ * - A worker pushes and pops its own deque at the bottom (LIFO, no lock,
+ *   hot in cache); tasks spawned by tasks stay on the spawning worker
+ * - An idle worker steals from the top of a randomly chosen victim
+ * - Tasks submitted from outside the pool are spread round-robin over
+ *   small per-worker inboxes, so external producers do not all meet on
+ *   one lock either
+ * - Workers with nothing to do spin briefly, then park on a condition
+ *   variable; submit() only touches the mutex when somebody is parked
+ *
+ * submit() returns a std::future for the callable's result, parallel_for()
+ * splits an index range into chunks and helps run them until all are done.
+ *
+ * A WorkerPlacement (see memory::numa_placement() in numa.h) restricts
+ * each worker to a set of CPUs and groups workers, typically by NUMA
+ * node: a worker then steals within its own group before crossing to
+ * another, so stolen tasks keep using memory from the node they started on.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "cache_line.h"
+
+namespace concurrency {
+
+// Lock-free single-owner / multi-thief deque (Chase & Lev 2005, with the
+// C11 memory orderings from Le, Pop, Cohen & Zappa Nardelli 2013).
+// T must be trivially copyable; the pool stores raw task pointers.
+template <typename T>
+class ChaseLevDeque {
+public:
+    explicit ChaseLevDeque(int64_t initial_capacity = 256) {
+        array_.store(new Array(initial_capacity), std::memory_order_relaxed);
+    }
+
+    ~ChaseLevDeque() {
+        delete array_.load(std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    // Owner only
+    void push(T item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* array = array_.load(std::memory_order_relaxed);
+        if (b - t > array->capacity - 1) {
+            array = grow(array, b, t);
+        }
+        array->put(b, item);
+        // Release store rather than release fence + relaxed store: same
+        // guarantee, and visible to ThreadSanitizer, which ignores fences
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // Owner only
+    bool pop(T& out) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);  // Empty
+            return false;
+        }
+        out = array->get(b);
+        if (t == b) {
+            // Last element: race the thieves for it
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread
+    bool steal(T& out) {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return false;
+
+        Array* array = array_.load(std::memory_order_acquire);
+        T item = array->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;  // Lost to another thief or the owner
+        }
+        out = item;
+        return true;
+    }
+
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Array {
+        explicit Array(int64_t cap) : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+        ~Array() { delete[] slots; }
+
+        T get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T item) { slots[i & mask].store(item, std::memory_order_relaxed); }
+
+        const int64_t capacity;
+        const int64_t mask;
+        std::atomic<T>* slots;
+    };
+
+    // Thieves may still be reading the old array, so it is retired rather
+    // than freed; the deque only ever grows, so this is bounded
+    Array* grow(Array* old, int64_t b, int64_t t) {
+        Array* bigger = new Array(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        retired_.emplace_back(old);
+        array_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> top_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> bottom_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<Array*> array_{nullptr};
+    std::vector<std::unique_ptr<Array>> retired_;
+};
+
+// Where worker threads are allowed to run
+enum class PinPolicy {
+    NONE,     // Let the OS scheduler decide
+    COMPACT,  // Worker i on CPU i (mod CPU count)
+};
+
+// Per worker: the CPUs it may run on (empty: anywhere) and its group
+// (e.g. NUMA node); workers steal inside their group first
+struct WorkerPlacement {
+    std::vector<std::vector<int>> cpus;
+    std::vector<int> groups;
+};
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t num_threads = std::thread::hardware_concurrency(),
+                              PinPolicy pin_policy = PinPolicy::NONE) {
+        num_threads = std::max<size_t>(1, num_threads);
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back(new Worker(static_cast<uint32_t>(i) * 2654435761u + 1));
+        }
+        for (size_t i = 0; i < num_threads; ++i) {
+            threads_.emplace_back([this, i] { worker_loop(i); });
+            if (pin_policy == PinPolicy::COMPACT) {
+                pin_thread(threads_.back(), i);
+            }
+        }
+    }
+
+    // One worker per entry of placement.cpus; each pins itself before it
+    // runs anything, so what it allocates is first touched where it runs
+    explicit WorkStealingPool(const WorkerPlacement& placement) {
+        size_t num_threads = std::max<size_t>(1, placement.cpus.size());
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back(new Worker(static_cast<uint32_t>(i) * 2654435761u + 1));
+            if (i < placement.cpus.size()) workers_.back()->cpus = placement.cpus[i];
+            if (i < placement.groups.size()) workers_.back()->group = placement.groups[i];
+            grouped_ = grouped_ || workers_.back()->group != workers_.front()->group;
+        }
+        for (size_t i = 0; i < num_threads; ++i) {
+            threads_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            stop_.store(true, std::memory_order_seq_cst);
+        }
+        park_cv_.notify_all();
+        for (auto& t : threads_) {
+            t.join();
+        }
+        // Tasks nobody got to are destroyed, which breaks their promises
+        Task* task;
+        for (auto& worker : workers_) {
+            while (worker->deque.pop(task)) delete task;
+            for (Task* pending : worker->inbox) delete pending;
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    // Run f(args...) on the pool; the future yields its result or exception
+    template <typename F, typename... Args>
+    auto submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        using R = std::invoke_result_t<F, Args...>;
+        std::packaged_task<R()> job(
+            [fn = std::forward<F>(f), tup = std::make_tuple(std::forward<Args>(args)...)]() mutable -> R {
+                return std::apply(std::move(fn), std::move(tup));
+            });
+        std::future<R> result = job.get_future();
+        enqueue(new TaskImpl<std::packaged_task<R()>>(std::move(job)));
+        return result;
+    }
+
+    // Fire-and-forget variant of submit() for callers that track completion
+    // themselves (no promise/future shared state)
+    template <typename F>
+    void post(F&& f) {
+        enqueue(new TaskImpl<std::decay_t<F>>(std::forward<F>(f)));
+    }
+
+    // Call fn(i) for every i in [begin, end), split into chunks of `grain`
+    // indices (0 = about 4 chunks per worker). The calling thread runs
+    // chunks too, so this is safe to call from inside a pool task.
+    template <typename Fn>
+    void parallel_for(size_t begin, size_t end, Fn&& fn, size_t grain = 0) {
+        if (begin >= end) return;
+        size_t count = end - begin;
+        if (grain == 0) {
+            grain = std::max<size_t>(1, count / (workers_.size() * 4));
+        }
+        size_t chunks = (count + grain - 1) / grain;
+
+        std::atomic<size_t> remaining(chunks);
+        for (size_t c = 1; c < chunks; ++c) {
+            size_t lo = begin + c * grain;
+            size_t hi = std::min(end, lo + grain);
+            post([&fn, &remaining, lo, hi] {
+                for (size_t i = lo; i < hi; ++i) fn(i);
+                remaining.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        // First chunk inline, then help until the rest are finished
+        for (size_t i = begin; i < std::min(end, begin + grain); ++i) fn(i);
+        remaining.fetch_sub(1, std::memory_order_release);
+        while (remaining.load(std::memory_order_acquire) != 0) {
+            if (!run_one()) std::this_thread::yield();
+        }
+    }
+
+    // Run one queued task on the calling thread if there is one
+    bool run_one() {
+        Task* task = find_task(current_worker());
+        if (task == nullptr) return false;
+        execute(task);
+        return true;
+    }
+
+private:
+    struct Task {
+        virtual ~Task() = default;
+        virtual void run() = 0;
+    };
+
+    template <typename F>
+    struct TaskImpl : Task {
+        explicit TaskImpl(F&& fn) : f(std::move(fn)) {}
+        explicit TaskImpl(const F& fn) : f(fn) {}
+        void run() override { f(); }
+        F f;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Worker {
+        explicit Worker(uint32_t seed) : rng(seed) {}
+
+        ChaseLevDeque<Task*> deque;
+        std::mutex inbox_mutex;
+        std::vector<Task*> inbox;              // Submissions from outside the pool
+        std::atomic<size_t> inbox_size{0};
+        uint32_t rng;                          // xorshift state for victim selection
+        std::vector<int> cpus;                 // Pinned to these, if any
+        int group = 0;
+    };
+
+    static constexpr size_t NOT_A_WORKER = SIZE_MAX;
+    static constexpr int SPIN_ROUNDS = 64;
+
+    // Index of the calling worker in *this* pool, or NOT_A_WORKER
+    size_t current_worker() const {
+        return tls_pool() == this ? tls_index() : NOT_A_WORKER;
+    }
+
+    static const WorkStealingPool*& tls_pool() {
+        static thread_local const WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& tls_index() {
+        static thread_local size_t index = NOT_A_WORKER;
+        return index;
+    }
+
+    void enqueue(Task* task) {
+        size_t self = current_worker();
+        if (self != NOT_A_WORKER) {
+            workers_[self]->deque.push(task);
+        } else {
+            Worker& target = *workers_[next_inbox_.fetch_add(1, std::memory_order_relaxed) % workers_.size()];
+            std::lock_guard<std::mutex> lock(target.inbox_mutex);
+            target.inbox.push_back(task);
+            target.inbox_size.fetch_add(1, std::memory_order_relaxed);
+        }
+        queued_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            park_cv_.notify_one();
+        }
+    }
+
+    // Own deque, then own inbox, then steal from random victims (those in
+    // the same group first, when workers are grouped)
+    Task* find_task(size_t self) {
+        Task* task = nullptr;
+        if (self != NOT_A_WORKER) {
+            Worker& me = *workers_[self];
+            if (me.deque.pop(task)) return claim(task);
+            if ((task = take_inbox(me, true)) != nullptr) return claim(task);
+        }
+
+        size_t n = workers_.size();
+        uint32_t r = self != NOT_A_WORKER ? next_random(*workers_[self]) : static_cast<uint32_t>(n);
+        bool by_group = grouped_ && self != NOT_A_WORKER;
+        int group = self != NOT_A_WORKER ? workers_[self]->group : 0;
+        for (int pass = 0; pass < (by_group ? 2 : 1); ++pass) {
+            for (size_t attempt = 0; attempt < n; ++attempt) {
+                Worker& victim = *workers_[(r + attempt) % n];
+                if (by_group && (victim.group == group) != (pass == 0)) continue;
+                if (victim.deque.steal(task)) return claim(task);
+            }
+        }
+        for (size_t attempt = 0; attempt < n; ++attempt) {
+            Worker& victim = *workers_[(r + attempt) % n];
+            if ((task = take_inbox(victim, false)) != nullptr) return claim(task);
+        }
+        return nullptr;
+    }
+
+    // Take a task from an inbox. The owner moves the rest of the batch into
+    // its deque at the same time, where other workers can steal it.
+    Task* take_inbox(Worker& worker, bool owner) {
+        if (worker.inbox_size.load(std::memory_order_relaxed) == 0) return nullptr;
+        std::lock_guard<std::mutex> lock(worker.inbox_mutex);
+        if (worker.inbox.empty()) return nullptr;
+
+        Task* task = worker.inbox.back();
+        worker.inbox.pop_back();
+        if (owner) {
+            for (Task* rest : worker.inbox) worker.deque.push(rest);
+            worker.inbox.clear();
+        }
+        worker.inbox_size.store(worker.inbox.size(), std::memory_order_relaxed);
+        return task;
+    }
+
+    Task* claim(Task* task) {
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+
+    static void execute(Task* task) {
+        task->run();
+        delete task;
+    }
+
+    static uint32_t next_random(Worker& worker) {
+        uint32_t x = worker.rng;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        worker.rng = x;
+        return x;
+    }
+
+    void worker_loop(size_t index) {
+        tls_pool() = this;
+        tls_index() = index;
+        if (!workers_[index]->cpus.empty()) pin_self(workers_[index]->cpus);
+
+        int idle_rounds = 0;
+        while (true) {
+            Task* task = find_task(index);
+            if (task != nullptr) {
+                execute(task);
+                idle_rounds = 0;
+                continue;
+            }
+            if (stop_.load(std::memory_order_acquire)) {
+                return;
+            }
+            if (++idle_rounds < SPIN_ROUNDS) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Park until something is queued. sleepers_ is raised before
+            // queued_ is re-checked and enqueue() does the reverse, so one of
+            // the two always sees the other (no lost wake-up).
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            {
+                std::unique_lock<std::mutex> lock(park_mutex_);
+                park_cv_.wait(lock, [this] {
+                    return queued_.load(std::memory_order_seq_cst) > 0 || stop_.load(std::memory_order_seq_cst);
+                });
+            }
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+            idle_rounds = 0;
+        }
+    }
+
+    static void pin_thread(std::thread& thread, size_t index) {
+#if defined(__linux__)
+        unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cpus, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)index;  // No portable affinity API (e.g. macOS); run unpinned
+#endif
+    }
+
+    static void pin_self(const std::vector<int>& cpus) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)cpus;
+#endif
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    bool grouped_ = false;  // Workers are in more than one group
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> next_inbox_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> queued_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<int> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+};
+
+}  // namespace concurrency
@@ -12,6 +12,28 @@
 #include <algorithm>
 #include <cctype>
 #include <regex>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory_resource>
+#include <string_view>
+#include <thread>
+#include <sys/mman.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "alloc_counter.h"
+#include "mapped_file.h"
+#include "monotonic_arena.h"
+#include "simd_kernels.h"
+#include "work_stealing_pool.h"
 
 // ANSI Color codes for better output
 namespace Colors {
@@ -25,16 +47,20 @@ namespace Colors {
     const std::string BOLD = "\033[1m";
 }
 
-// Structure to hold parsed input
+// Structure to hold parsed input. The strings live in whatever memory
+// resource the parser was handed: the normal heap by default, or a
+// per-request arena (see demonstrateArenaParsing).
 struct InputData {
-    std::string keyboard;
-    std::string word;
+    std::pmr::string keyboard;
+    std::pmr::string word;
     bool is_valid;
     
-    InputData() : is_valid(false) {}
+    explicit InputData(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : keyboard(resource), word(resource), is_valid(false) {}
     
-    InputData(const std::string& kb, const std::string& w, bool valid) 
-        : keyboard(kb), word(w), is_valid(valid) {}
+    InputData(std::string_view kb, std::string_view w, bool valid,
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource()) 
+        : keyboard(kb, resource), word(w, resource), is_valid(valid) {}
     
     void display() const {
         if (is_valid) {
@@ -53,9 +79,10 @@ struct InputData {
 
 class ManualParser {
 public:
-    static InputData parse(const std::string& input) {
-        InputData result;
-        std::string cleaned = trim(input);
+    static InputData parse(const std::string& input,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        InputData result(resource);
+        std::pmr::string cleaned = trim(input, resource);
         
         // Find keyboard = "..."
         size_t keyboard_pos = cleaned.find("keyboard");
@@ -73,7 +100,7 @@ public:
         size_t quote1_end = cleaned.find("\"", quote1_start + 1);
         if (quote1_end == std::string::npos) return result;
         
-        result.keyboard = cleaned.substr(quote1_start + 1, quote1_end - quote1_start - 1);
+        result.keyboard.assign(cleaned, quote1_start + 1, quote1_end - quote1_start - 1);
         
         // Find word = "..."
         size_t word_pos = cleaned.find("word", quote1_end);
@@ -91,18 +118,19 @@ public:
         size_t quote2_end = cleaned.find("\"", quote2_start + 1);
         if (quote2_end == std::string::npos) return result;
         
-        result.word = cleaned.substr(quote2_start + 1, quote2_end - quote2_start - 1);
+        result.word.assign(cleaned, quote2_start + 1, quote2_end - quote2_start - 1);
         result.is_valid = true;
         
         return result;
     }
     
 private:
-    static std::string trim(const std::string& str) {
+    static std::pmr::string trim(const std::string& str, std::pmr::memory_resource* resource) {
         size_t start = str.find_first_not_of(" \t\n\r");
-        if (start == std::string::npos) return "";
+        if (start == std::string::npos) return std::pmr::string(resource);
         size_t end = str.find_last_not_of(" \t\n\r");
-        return str.substr(start, end - start + 1);
+        // Not substr(): that would allocate the copy from the default resource
+        return std::pmr::string(str.data() + start, end - start + 1, resource);
     }
 };
 
@@ -112,16 +140,18 @@ private:
 
 class RegexParser {
 public:
-    static InputData parse(const std::string& input) {
-        InputData result;
+    static InputData parse(const std::string& input,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        InputData result(resource);
         
         // Regex pattern to match: keyboard = "...", word = "..."
-        std::regex pattern("keyboard\\s*=\\s*\"([^\"]*)\".*word\\s*=\\s*\"([^\"]*)\"");
+        // Compiled once: building a std::regex costs far more than a match
+        static const std::regex pattern("keyboard\\s*=\\s*\"([^\"]*)\".*word\\s*=\\s*\"([^\"]*)\"");
         std::smatch matches;
         
         if (std::regex_search(input, matches, pattern)) {
-            result.keyboard = matches[1].str();
-            result.word = matches[2].str();
+            result.keyboard.assign(matches[1].first, matches[1].second);
+            result.word.assign(matches[2].first, matches[2].second);
             result.is_valid = true;
         }
         
@@ -135,8 +165,9 @@ public:
 
 class StreamParser {
 public:
-    static InputData parse(const std::string& input) {
-        InputData result;
+    static InputData parse(const std::string& input,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        InputData result(resource);
         std::istringstream iss(input);
         std::string token;
         
@@ -175,14 +206,29 @@ public:
         IDENTIFIER, EQUALS, STRING, COMMA, END
     };
     
+    // Allocator-aware, so a std::pmr::vector<Token> hands its memory
+    // resource down to every token's string (uses-allocator construction)
     struct Token {
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+        
         TokenType type;
-        std::string value;
+        std::pmr::string value;
+        
+        Token(TokenType t, std::string_view v, const allocator_type& alloc = {})
+            : type(t), value(v, alloc) {}
+        Token(const Token& other, const allocator_type& alloc = {})
+            : type(other.type), value(other.value, alloc) {}
+        Token(Token&& other) = default;
+        Token(Token&& other, const allocator_type& alloc)
+            : type(other.type), value(std::move(other.value), alloc) {}
+        Token& operator=(const Token&) = default;
+        Token& operator=(Token&&) = default;
     };
     
-    static InputData parse(const std::string& input) {
-        InputData result;
-        std::vector<Token> tokens = tokenize(input);
+    static InputData parse(const std::string& input,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        InputData result(resource);
+        std::pmr::vector<Token> tokens = tokenize(input, resource);
         
         if (parseTokens(tokens, result)) {
             result.is_valid = true;
@@ -192,8 +238,8 @@ public:
     }
     
 private:
-    static std::vector<Token> tokenize(const std::string& input) {
-        std::vector<Token> tokens;
+    static std::pmr::vector<Token> tokenize(const std::string& input, std::pmr::memory_resource* resource) {
+        std::pmr::vector<Token> tokens(resource);
         size_t i = 0;
         
         while (i < input.length()) {
@@ -202,37 +248,37 @@ private:
             if (i >= input.length()) break;
             
             if (input[i] == '=') {
-                tokens.push_back({TokenType::EQUALS, "="});
+                tokens.emplace_back(TokenType::EQUALS, "=");
                 i++;
             } else if (input[i] == ',') {
-                tokens.push_back({TokenType::COMMA, ","});
+                tokens.emplace_back(TokenType::COMMA, ",");
                 i++;
             } else if (input[i] == '"') {
                 // Parse string literal
                 i++; // Skip opening quote
-                std::string str;
+                std::pmr::string str(resource);
                 while (i < input.length() && input[i] != '"') {
                     str += input[i++];
                 }
                 if (i < input.length()) i++; // Skip closing quote
-                tokens.push_back({TokenType::STRING, str});
+                tokens.emplace_back(TokenType::STRING, str);
             } else if (std::isalpha(input[i])) {
                 // Parse identifier
-                std::string identifier;
+                std::pmr::string identifier(resource);
                 while (i < input.length() && std::isalnum(input[i])) {
                     identifier += input[i++];
                 }
-                tokens.push_back({TokenType::IDENTIFIER, identifier});
+                tokens.emplace_back(TokenType::IDENTIFIER, identifier);
             } else {
                 i++; // Skip unknown character
             }
         }
         
-        tokens.push_back({TokenType::END, ""});
+        tokens.emplace_back(TokenType::END, "");
         return tokens;
     }
     
-    static bool parseTokens(const std::vector<Token>& tokens, InputData& result) {
+    static bool parseTokens(const std::pmr::vector<Token>& tokens, InputData& result) {
         size_t i = 0;
         
         // Parse: keyboard = "..."
@@ -253,7 +299,7 @@ private:
         return true;
     }
     
-    static bool expectToken(const std::vector<Token>& tokens, size_t& i, TokenType expected_type, const std::string& expected_value = "") {
+    static bool expectToken(const std::pmr::vector<Token>& tokens, size_t& i, TokenType expected_type, std::string_view expected_value = {}) {
         if (i >= tokens.size() || tokens[i].type != expected_type) return false;
         if (!expected_value.empty() && tokens[i].value != expected_value) return false;
         i++;
@@ -261,13 +307,139 @@ private:
     }
 };
 
+// =============================================================================
+// METHOD 5: Zero-copy Single-pass Parser (Fastest)
+// =============================================================================
+
+// Views into the parsed text: no copies, no allocations. They are only
+// valid while that text is (a std::string, a MappedFile, ...).
+struct InputView {
+    std::string_view keyboard;
+    std::string_view word;
+    bool is_valid = false;
+};
+
+// First position in [p, end) holding a or b, or end. With SSE2 this tests
+// 16 bytes per step: two byte-wise compares, OR, one movemask.
+inline const char* find_either(const char* p, const char* end, char a, char b) {
+#if defined(__SSE2__)
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+    }
+#endif
+    while (p < end && *p != a && *p != b) ++p;
+    return p;
+}
+
+// Walks the input once, left to right: each `key = "value"` field is one
+// SIMD scan to '=' and one to the closing quote. The comma between the
+// fields is optional, as in the Token parser.
+class ViewParser {
+public:
+    static InputView parseView(std::string_view input) {
+        InputView result;
+        const char* p = input.data();
+        const char* end = p + input.size();
+        
+        if (!parseField(p, end, "keyboard", result.keyboard)) return result;
+        p = skipSpace(p, end);
+        if (p < end && *p == ',') ++p;
+        if (!parseField(p, end, "word", result.word)) return result;
+        
+        // Nothing but whitespace may follow
+        result.is_valid = skipSpace(p, end) == end;
+        return result;
+    }
+    
+    // Same interface as the other parsers; only the two values get copied
+    static InputData parse(const std::string& input,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        InputView view = parseView(input);
+        return InputData(view.keyboard, view.word, view.is_valid, resource);
+    }
+    
+    // Call fn(line) for every non-empty line of text (LF or CRLF endings)
+    template <typename Fn>
+    static void forEachLine(std::string_view text, Fn&& fn) {
+        const char* p = text.data();
+        const char* end = p + text.size();
+        while (p < end) {
+            const char* newline = simd::find_byte(p, end - p, '\n');
+            const char* line_end = newline ? newline : end;
+            const char* content_end = (line_end > p && line_end[-1] == '\r') ? line_end - 1 : line_end;
+            if (content_end > p) {
+                fn(std::string_view(p, content_end - p));
+            }
+            p = newline ? newline + 1 : end;
+        }
+    }
+    
+    // Parse every non-empty line of text
+    static void parseLines(std::string_view text, std::vector<InputView>& records) {
+        forEachLine(text, [&](std::string_view line) { records.push_back(parseView(line)); });
+    }
+    
+    // A whole file of records, parsed straight out of a read-only mapping.
+    // The views in `records` point into `file`, so keep the batch alive
+    // while they are in use.
+    struct Batch {
+        memory::MappedFile file;
+        std::vector<InputView> records;
+        size_t invalid = 0;
+    };
+    
+    static bool parseFile(const std::string& path, Batch& batch) {
+        if (!batch.file.open(path)) return false;
+        batch.file.advise(MADV_SEQUENTIAL);  // Front-to-back: read ahead aggressively
+        batch.records.clear();
+        parseLines(batch.file.view(), batch.records);
+        batch.invalid = static_cast<size_t>(std::count_if(batch.records.begin(), batch.records.end(),
+                                                          [](const InputView& r) { return !r.is_valid; }));
+        return true;
+    }
+    
+private:
+    static const char* skipSpace(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        return p;
+    }
+    
+    // <space> key <space> = <space> "value"
+    static bool parseField(const char*& p, const char* end, std::string_view key, std::string_view& value) {
+        const char* equals = find_either(p, end, '=', '"');
+        if (equals == end || *equals != '=') return false;
+        
+        const char* key_begin = skipSpace(p, equals);
+        const char* key_end = equals;
+        while (key_end > key_begin && (key_end[-1] == ' ' || key_end[-1] == '\t')) --key_end;
+        if (std::string_view(key_begin, key_end - key_begin) != key) return false;
+        
+        const char* quote = skipSpace(equals + 1, end);
+        if (quote == end || *quote != '"') return false;
+        // A value never spans lines; stopping at '\n' keeps an unbalanced
+        // quote from swallowing the rest of a batch
+        const char* close = find_either(quote + 1, end, '"', '\n');
+        if (close == end || *close != '"') return false;
+        
+        value = std::string_view(quote + 1, close - quote - 1);
+        p = close + 1;
+        return true;
+    }
+};
+
 // =============================================================================
 // INPUT VALIDATION AND CLEANING
 // =============================================================================
 
 class InputValidator {
 public:
-    static bool validateKeyboard(const std::string& keyboard) {
+    static bool validateKeyboard(std::string_view keyboard) {
         // Check if keyboard contains only unique lowercase letters
         if (keyboard.length() != 26) return false;
         
@@ -280,15 +452,17 @@ public:
         return true;
     }
     
-    static bool validateWord(const std::string& word) {
+    static bool validateWord(std::string_view word) {
         // Check if word contains only lowercase letters
         return std::all_of(word.begin(), word.end(), [](char c) {
             return c >= 'a' && c <= 'z';
         });
     }
     
+    // The cleaned copy is allocated from the same resource as the input
     static InputData validateAndClean(const InputData& input) {
-        InputData result = input;
+        std::pmr::memory_resource* resource = input.keyboard.get_allocator().resource();
+        InputData result(input.keyboard, input.word, input.is_valid, resource);
         
         if (!input.is_valid) {
             result.is_valid = false;
@@ -296,33 +470,371 @@ public:
         }
         
         // Clean and validate keyboard
-        std::string cleaned_keyboard = input.keyboard;
+        std::pmr::string cleaned_keyboard(input.keyboard, resource);
         cleaned_keyboard.erase(std::remove_if(cleaned_keyboard.begin(), cleaned_keyboard.end(), 
                                             [](char c) { return !std::isalpha(c); }), 
                              cleaned_keyboard.end());
-        std::transform(cleaned_keyboard.begin(), cleaned_keyboard.end(), 
-                      cleaned_keyboard.begin(), ::tolower);
+        simd::to_lower(cleaned_keyboard.data(), cleaned_keyboard.size());
         
         // Clean and validate word
-        std::string cleaned_word = input.word;
+        std::pmr::string cleaned_word(input.word, resource);
         cleaned_word.erase(std::remove_if(cleaned_word.begin(), cleaned_word.end(), 
                                         [](char c) { return !std::isalpha(c); }), 
                          cleaned_word.end());
-        std::transform(cleaned_word.begin(), cleaned_word.end(), 
-                      cleaned_word.begin(), ::tolower);
+        simd::to_lower(cleaned_word.data(), cleaned_word.size());
         
-        result.keyboard = cleaned_keyboard;
-        result.word = cleaned_word;
-        result.is_valid = validateKeyboard(cleaned_keyboard) && validateWord(cleaned_word);
+        result.keyboard = std::move(cleaned_keyboard);
+        result.word = std::move(cleaned_word);
+        result.is_valid = validateKeyboard(result.keyboard) && validateWord(result.word);
         
         return result;
     }
+    
+    // validateAndClean() for a zero-copy record: instead of two new strings,
+    // the cleaned record is appended to `out` as a `keyboard = "...", word =
+    // "..."` line. Nothing is appended if the record is invalid.
+    static bool validateAndCleanInto(const InputView& input, std::string& out) {
+        if (!input.is_valid) return false;
+        size_t start = out.size();
+        
+        out += "keyboard = \"";
+        size_t keyboard_start = out.size();
+        appendCleaned(input.keyboard, out);
+        if (!validateKeyboard(std::string_view(out).substr(keyboard_start))) {
+            out.resize(start);
+            return false;
+        }
+        out += "\", word = \"";
+        size_t word_start = out.size();
+        appendCleaned(input.word, out);
+        if (!validateWord(std::string_view(out).substr(word_start))) {
+            out.resize(start);
+            return false;
+        }
+        out += "\"\n";
+        return true;
+    }
+    
+private:
+    // The letters of `text`, lowercased (what validateAndClean() keeps)
+    static void appendCleaned(std::string_view text, std::string& out) {
+        size_t start = out.size();
+        for (char c : text) {
+            if (std::isalpha(static_cast<unsigned char>(c))) out += c;
+        }
+        simd::to_lower(out.data() + start, out.size() - start);
+    }
+};
+
+// =============================================================================
+// BATCH INGESTION: parse and validate a whole file on a thread pool
+// =============================================================================
+
+// The file is cut into chunks of about chunk_bytes that end on a newline,
+// so no record straddles two chunks. Each chunk is one pool task: it parses
+// its lines with ViewParser (views into the mapping, nothing copied) and
+// writes the valid records, cleaned, into its own output buffer. The caller
+// keeps a bounded window of chunks in flight and consumes their buffers
+// strictly in file order, so the output is the same for any thread count
+// while the workers run ahead. Finished buffers are handed to the next
+// chunk, which keeps the steady state free of malloc and page faults.
+class BatchIngestor {
+public:
+    static constexpr size_t DEFAULT_CHUNK_BYTES = 1 << 20;
+    
+    struct Totals {
+        size_t records = 0;    // Non-empty lines
+        size_t malformed = 0;  // Not `keyboard = "...", word = "..."`
+        size_t rejected = 0;   // Parsed, but failed validation
+        size_t bytes_out = 0;
+        size_t chunks = 0;
+        
+        size_t valid() const { return records - malformed - rejected; }
+    };
+    
+    // Feed `text` through the pool; sink(std::string_view) receives the
+    // cleaned output of each chunk, in input order, on the calling thread
+    template <typename Sink>
+    static Totals ingest(std::string_view text, concurrency::WorkStealingPool& pool, Sink&& sink,
+                         size_t chunk_bytes = DEFAULT_CHUNK_BYTES) {
+        Totals totals;
+        std::deque<std::future<ChunkResult>> in_flight;
+        std::vector<std::string> spare_buffers;
+        const size_t window = 4 * pool.size();  // Enough to hide one slow chunk
+        size_t offset = 0;
+        
+        auto submit_next = [&] {
+            size_t end = chunkEnd(text, offset, chunk_bytes);
+            std::string_view chunk = text.substr(offset, end - offset);
+            std::string buffer;
+            if (!spare_buffers.empty()) {
+                buffer = std::move(spare_buffers.back());
+                spare_buffers.pop_back();
+            }
+            in_flight.push_back(pool.submit([chunk, buffer = std::move(buffer)]() mutable {
+                return ingestChunk(chunk, std::move(buffer));
+            }));
+            offset = end;
+        };
+        
+        while (offset < text.size() && in_flight.size() < window) submit_next();
+        while (!in_flight.empty()) {
+            ChunkResult result = in_flight.front().get();
+            in_flight.pop_front();
+            if (offset < text.size()) submit_next();  // Refill before the sink runs
+            
+            totals.records += result.records;
+            totals.malformed += result.malformed;
+            totals.rejected += result.rejected;
+            totals.bytes_out += result.cleaned.size();
+            totals.chunks++;
+            sink(std::string_view(result.cleaned));
+            spare_buffers.push_back(std::move(result.cleaned));
+        }
+        return totals;
+    }
+    
+private:
+    struct ChunkResult {
+        size_t records = 0;
+        size_t malformed = 0;
+        size_t rejected = 0;
+        std::string cleaned;
+    };
+    
+    // One past the first newline at or after offset + chunk_bytes
+    static size_t chunkEnd(std::string_view text, size_t offset, size_t chunk_bytes) {
+        if (text.size() - offset <= chunk_bytes) return text.size();
+        const char* from = text.data() + offset + chunk_bytes;
+        const char* newline = simd::find_byte(from, text.data() + text.size() - from, '\n');
+        return newline ? static_cast<size_t>(newline - text.data()) + 1 : text.size();
+    }
+    
+    static ChunkResult ingestChunk(std::string_view chunk, std::string buffer) {
+        ChunkResult result;
+        result.cleaned = std::move(buffer);
+        result.cleaned.clear();
+        result.cleaned.reserve(chunk.size());  // Cleaning never makes a record longer
+        ViewParser::forEachLine(chunk, [&](std::string_view line) {
+            result.records++;
+            InputView view = ViewParser::parseView(line);
+            if (!view.is_valid) {
+                result.malformed++;
+            } else if (!InputValidator::validateAndCleanInto(view, result.cleaned)) {
+                result.rejected++;
+            }
+        });
+        return result;
+    }
 };
 
 // =============================================================================
 // DEMONSTRATION FUNCTIONS
 // =============================================================================
 
+// Throughput of every parser over the same lines, then the mmap batch API
+// over the same lines written to a file
+void benchmarkParsers(size_t line_count = 100000) {
+    std::cout << Colors::BOLD << Colors::BLUE << "\n⏱️  Parser Throughput (" << line_count << " lines)"
+              << Colors::RESET << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    const char* keyboards[] = {"abcdefghijklmnopqrstuvwxyz", "qwertyuiopasdfghjklzxcvbnm",
+                               "zyxwvutsrqponmlkjihgfedcba"};
+    const char* words[] = {"hello", "world", "parser", "throughput", "cba"};
+    std::vector<std::string> lines;
+    lines.reserve(line_count);
+    size_t total_bytes = 0;
+    for (size_t i = 0; i < line_count; ++i) {
+        std::string line = std::string("keyboard = \"") + keyboards[i % 3] + "\"" + (i % 2 ? ", " : " ") +
+                           "word = \"" + words[i % 5] + "\"";
+        total_bytes += line.size() + 1;  // Plus the newline in the file below
+        lines.push_back(std::move(line));
+    }
+    
+    auto report = [&](const char* label, double seconds, size_t valid) {
+        printf("  %-26s %12.0f lines/s  %8.1f MB/s  (%zu valid)\n", label, line_count / seconds,
+               total_bytes / seconds / 1e6, valid);
+    };
+    auto run = [&](const char* label, auto parse) {
+        size_t valid = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& line : lines) {
+            valid += parse(line).is_valid ? 1 : 0;
+        }
+        report(label, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), valid);
+    };
+    
+    run("Manual parser", [](const std::string& line) { return ManualParser::parse(line); });
+    run("Regex parser", [](const std::string& line) { return RegexParser::parse(line); });
+    run("Stream parser", [](const std::string& line) { return StreamParser::parse(line); });
+    run("Token parser", [](const std::string& line) { return TokenParser::parse(line); });
+    run("View parser", [](const std::string& line) { return ViewParser::parseView(line); });
+    
+    // Batch: the same lines as one file, mapped and parsed in a single pass
+    std::string path = (std::filesystem::temp_directory_path() / "input_parsing_bench.txt").string();
+    {
+        std::ofstream out(path, std::ios::binary);
+        for (const std::string& line : lines) {
+            out << line << '\n';
+        }
+    }
+    ViewParser::Batch batch;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = ViewParser::parseFile(path, batch);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (ok) {
+        report("View parser, mmap batch", seconds, batch.records.size() - batch.invalid);
+    } else {
+        std::cout << Colors::RED << "  Could not map " << path << ": " << std::strerror(errno) << Colors::RESET
+                  << std::endl;
+    }
+    std::remove(path.c_str());
+}
+
+// BatchIngestor over a generated file at 1, 2, 4... threads, against the
+// one-line-at-a-time path (parse, then validateAndClean() into new
+// strings). Every run must produce the same output as the first; a plain
+// newline count over the mapping is the ceiling for what parsing can reach.
+void benchmarkBatchIngestion(size_t line_count = 1000000) {
+    std::cout << Colors::BOLD << Colors::BLUE << "\n🏭 Batch Ingestion (" << line_count << " records)"
+              << Colors::RESET << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    const char* keyboards[] = {"abcdefghijklmnopqrstuvwxyz", "QWERTYUIOPASDFGHJKLZXCVBNM",
+                               "zyxwvutsrqponmlkjihgfedcba", "abc"};
+    const char* words[] = {"hello", "World!", "parser", "through put", "cba"};
+    std::string path = (std::filesystem::temp_directory_path() / "input_parsing_ingest.txt").string();
+    {
+        std::ofstream out(path, std::ios::binary);
+        for (size_t i = 0; i < line_count; ++i) {
+            if (i % 101 == 100) {
+                out << "not a record\n";
+                continue;
+            }
+            out << "keyboard = \"" << keyboards[i % 4] << "\", word = \"" << words[i % 5] << "\"\n";
+        }
+    }
+    memory::MappedFile file;
+    if (!file.open(path)) {
+        std::cout << Colors::RED << "  Could not map " << path << ": " << std::strerror(errno) << Colors::RESET
+                  << std::endl;
+        std::remove(path.c_str());
+        return;
+    }
+    file.advise(MADV_SEQUENTIAL);
+    std::string_view text = file.view();
+    
+    auto elapsed = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto report = [&](const std::string& label, double seconds, size_t records, size_t valid) {
+        printf("  %-28s %12.0f records/s  %8.1f MB/s  (%zu valid)\n", label.c_str(), records / seconds,
+               text.size() / seconds / 1e6, valid);
+    };
+    
+    // Warm the page cache so the first run does not pay for the disk
+    auto start = std::chrono::steady_clock::now();
+    size_t newlines = 0;
+    for (const char* p = text.data(), *end = p + text.size(); p < end; ++newlines) {
+        const char* newline = simd::find_byte(p, end - p, '\n');
+        p = newline ? newline + 1 : end;
+    }
+    start = std::chrono::steady_clock::now();
+    newlines = 0;
+    for (const char* p = text.data(), *end = p + text.size(); p < end; ++newlines) {
+        const char* newline = simd::find_byte(p, end - p, '\n');
+        p = newline ? newline + 1 : end;
+    }
+    double scan_seconds = elapsed(start);
+    printf("  %-28s %12.0f lines/s    %8.1f MB/s\n", "Newline scan, 1 thread", newlines / scan_seconds,
+           text.size() / scan_seconds / 1e6);
+    
+    start = std::chrono::steady_clock::now();
+    size_t valid = 0;
+    size_t records = 0;
+    std::string expected;
+    ViewParser::forEachLine(text, [&](std::string_view line) {
+        records++;
+        InputData cleaned = InputValidator::validateAndClean(ManualParser::parse(std::string(line)));
+        if (cleaned.is_valid) {
+            valid++;
+            expected += "keyboard = \"";
+            expected.append(cleaned.keyboard.data(), cleaned.keyboard.size());
+            expected += "\", word = \"";
+            expected.append(cleaned.word.data(), cleaned.word.size());
+            expected += "\"\n";
+        }
+    });
+    report("Line at a time (InputData)", elapsed(start), records, valid);
+    
+    std::vector<size_t> thread_counts;
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads < hardware; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(hardware);
+    
+    std::string output;
+    output.reserve(expected.size());
+    double one_thread = 0;
+    for (size_t threads : thread_counts) {
+        concurrency::WorkStealingPool pool(threads);
+        output.clear();
+        start = std::chrono::steady_clock::now();
+        BatchIngestor::Totals totals = BatchIngestor::ingest(
+            text, pool, [&](std::string_view cleaned) { output.append(cleaned.data(), cleaned.size()); });
+        double seconds = elapsed(start);
+        if (threads == 1) one_thread = seconds;
+        report("BatchIngestor, " + std::to_string(threads) + (threads == 1 ? " thread" : " threads"), seconds,
+               totals.records, totals.valid());
+        if (threads > 1) printf("  %-28s %11.2fx over 1 thread\n", "", one_thread / seconds);
+        if (output != expected) {
+            std::cout << Colors::RED << "  Output differs from the line-at-a-time path!" << Colors::RESET
+                      << std::endl;
+        }
+    }
+    if (hardware == 1) {
+        std::cout << Colors::YELLOW << "  (one hardware thread here: nothing to scale across)" << Colors::RESET
+                  << std::endl;
+    }
+    std::remove(path.c_str());
+}
+
+// input_parsing --ingest FILE [--threads N] [--output FILE]: validate and
+// clean every record of FILE, writing the valid ones (cleaned) to --output
+int ingestFile(const std::string& path, size_t threads, const std::string& output_path) {
+    memory::MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Could not map " << path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    file.advise(MADV_SEQUENTIAL);
+    FILE* output = nullptr;
+    if (!output_path.empty() && (output = std::fopen(output_path.c_str(), "wb")) == nullptr) {
+        std::cerr << "Could not open " << output_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    
+    concurrency::WorkStealingPool pool(threads);
+    bool write_failed = false;
+    auto start = std::chrono::steady_clock::now();
+    BatchIngestor::Totals totals = BatchIngestor::ingest(file.view(), pool, [&](std::string_view cleaned) {
+        if (output != nullptr && std::fwrite(cleaned.data(), 1, cleaned.size(), output) != cleaned.size()) {
+            write_failed = true;
+        }
+    });
+    if (output != nullptr && std::fclose(output) != 0) write_failed = true;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    printf("%zu records: %zu valid, %zu malformed, %zu rejected; %zu chunks on %zu threads\n", totals.records,
+           totals.valid(), totals.malformed, totals.rejected, totals.chunks, pool.size());
+    printf("%.3f s, %.0f records/s, %.1f MB/s\n", seconds, totals.records / seconds, file.size() / seconds / 1e6);
+    if (write_failed) {
+        std::cerr << "Could not write " << output_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
 void testParsers() {
     std::vector<std::string> test_inputs = {
         "keyboard = \"abcdefghijklmnopqrstuvwxyz\", word = \"cba\"",
@@ -361,8 +873,15 @@ void testParsers() {
         auto token_result = TokenParser::parse(test_inputs[i]);
         token_result.display();
         
+        // Test View Parser
+        std::cout << Colors::CYAN << "View Parser: " << Colors::RESET;
+        auto view_result = ViewParser::parse(test_inputs[i]);
+        view_result.display();
+        
         std::cout << std::string(40, '-') << std::endl;
     }
+    
+    benchmarkParsers();
 }
 
 void demonstrateValidation() {
@@ -389,6 +908,43 @@ void demonstrateValidation() {
     }
 }
 
+// Parse + validate the same line many times, first with every string and
+// token vector on the heap, then in a MonotonicArena that is reset once per
+// line. The allocation counter shows what each strategy costs per line.
+void demonstrateArenaParsing() {
+    std::cout << Colors::BOLD << Colors::BLUE << "\n🧮 Per-Request Scratch Memory (pmr arena)" << Colors::RESET << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    const std::string line = "keyboard = \"qwertyuiopasdfghjklzxcvbnm\", word = \"hello\"";
+    const int iterations = 20000;
+    memory::MonotonicArena arena(4096);
+    
+    auto run = [&](const char* label, auto parse, bool use_arena) {
+        int valid = 0;
+        memory::AllocationScope allocations;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource();
+            if (use_arena) {
+                arena.reset();
+                resource = &arena;
+            }
+            InputData validated = InputValidator::validateAndClean(parse(line, resource));
+            valid += validated.is_valid ? 1 : 0;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printf("  %-22s %6.2f allocs/line  %8.1f ns/line  (%d valid)\n", label,
+               static_cast<double>(allocations.allocations()) / iterations, ms * 1e6 / iterations, valid);
+    };
+    
+    run("Manual parser, heap:", ManualParser::parse, false);
+    run("Manual parser, arena:", ManualParser::parse, true);
+    run("Token parser, heap:", TokenParser::parse, false);
+    run("Token parser, arena:", TokenParser::parse, true);
+    std::cout << "Arena capacity after " << iterations << " resets: " << arena.capacity() << " bytes, "
+              << arena.upstream_allocations() << " upstream allocations in total" << std::endl;
+}
+
 void interactiveDemo() {
     std::cout << Colors::BOLD << Colors::MAGENTA << "\n🎮 Interactive Input Demo" << Colors::RESET << std::endl;
     std::cout << "Enter input in format: keyboard = \"...\", word = \"...\"" << std::endl;
@@ -424,7 +980,31 @@ void interactiveDemo() {
 // MAIN FUNCTION
 // =============================================================================
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        std::string input_path;
+        std::string output_path;
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--ingest" && i + 1 < argc) {
+                input_path = argv[++i];
+            } else if (arg == "--threads" && i + 1 < argc) {
+                threads = std::max(1, std::atoi(argv[++i]));
+            } else if (arg == "--output" && i + 1 < argc) {
+                output_path = argv[++i];
+            } else {
+                input_path.clear();
+                break;
+            }
+        }
+        if (input_path.empty()) {
+            std::cerr << "Usage: " << argv[0] << " [--ingest FILE [--threads N] [--output FILE]]" << std::endl;
+            return 1;
+        }
+        return ingestFile(input_path, threads, output_path);
+    }
+    
     std::cout << Colors::BOLD << Colors::CYAN << "📝 C++ Input Parsing and Cleaning Demo" << Colors::RESET << std::endl;
     std::cout << "Format: keyboard = \"string\", word = \"string\"" << std::endl;
     std::cout << std::string(60, '=') << std::endl;
@@ -435,12 +1015,19 @@ int main() {
     // Demonstrate validation and cleaning
     demonstrateValidation();
     
+    // Same parsers with an arena for their scratch strings and tokens
+    demonstrateArenaParsing();
+    
+    // Whole files: chunked, parsed and validated on a thread pool
+    benchmarkBatchIngestion();
+    
     // Best practices summary
     std::cout << Colors::BOLD << Colors::GREEN << "\n📋 Best Practices Summary:" << Colors::RESET << std::endl;
     std::cout << Colors::YELLOW << "1. Regex Parser" << Colors::RESET << " - Best for simple, well-defined formats" << std::endl;
     std::cout << Colors::YELLOW << "2. Token Parser" << Colors::RESET << " - Most flexible for complex parsing" << std::endl;
     std::cout << Colors::YELLOW << "3. Manual Parser" << Colors::RESET << " - Most control, good for performance" << std::endl;
     std::cout << Colors::YELLOW << "4. Stream Parser" << Colors::RESET << " - Traditional C++ approach" << std::endl;
+    std::cout << Colors::YELLOW << "5. View Parser" << Colors::RESET << " - Zero-copy single pass, best for bulk input" << std::endl;
     std::cout << Colors::GREEN << "\n✅ Always validate and clean input!" << Colors::RESET << std::endl;
     std::cout << Colors::GREEN << "✅ Handle edge cases and errors gracefully!" << Colors::RESET << std::endl;
     
@@ -32,11 +32,30 @@
 
 // This file will mainly focus on the implementation of iterators. In this
 // file, we demonstrate implementing C++ iterators by writing a basic doubly
-// linked list (DLL) iterator.
+// linked list (DLL) iterator, and then making it a full STL-compatible
+// bidirectional iterator that works with the standard algorithms.
 
 // Includes std::cout (printing) for demo purposes.
 #include <iostream>
 
+// Includes the iterator tags, the algorithms used with our iterators, and
+// the containers and timers used by the traversal benchmark.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+// Includes memory::PoolAllocator, a fixed-size pool allocator, and an
+// unrolled list that packs several values into each cache-line-sized node.
+#include "fixed_pool.h"
+#include "unrolled_list.h"
+
 // This is the definition of the Node struct, used in our DLL.
 struct Node {
   Node(int val) 
@@ -44,23 +63,65 @@ struct Node {
     , prev_(nullptr)
     , value_(val) {}
 
+  // Class-specific operator new and delete. Every `new Node(...)` and
+  // `delete node` below now takes its memory from a pool of Node-sized
+  // blocks instead of the general-purpose heap. The DLL code itself does
+  // not change at all.
+  static void* operator new(size_t size) {
+    if (size != sizeof(Node)) {
+      return ::operator new(size);  // A derived class; not our block size.
+    }
+    return memory::PoolAllocator<Node>().allocate(1);
+  }
+
+  static void operator delete(void* ptr, size_t size) {
+    if (size != sizeof(Node)) {
+      ::operator delete(ptr);
+      return;
+    }
+    memory::PoolAllocator<Node>().deallocate(static_cast<Node*>(ptr), 1);
+  }
+
   Node* next_;
   Node* prev_;
   int value_;
 };
 
-// This class implements a C++ style iterator for the doubly linked list class 
-// DLL. This class's constructor takes in a node that marks the start of the
-// iterating. It also implements several operators that increment the iterator
-// (i.e. accessing the next element in the DLL) and test for equality between
-// two different iterators by comparing their curr_ pointers.
-class DLLIterator {
+// To work with the algorithms in <algorithm> and <numeric>, an iterator has
+// to describe itself through five member types, which std::iterator_traits
+// looks up: its category (what it can do), the value type, the difference
+// type, and the pointer and reference types. A doubly linked list can be
+// walked in both directions, so its iterators are bidirectional: they
+// support ++ and --, but not jumps like iter + 5.
+//
+// This class template implements a C++ style iterator for the doubly linked
+// list class DLL. It is a template so that one implementation gives us both
+// the mutable DLLIterator (over Node, yields int&) and the read-only
+// ConstDLLIterator (over const Node, yields const int&). Besides the node it
+// currently points at, it remembers where the list keeps its tail pointer,
+// so that --End() can step back onto the last element.
+template <typename ValueType, typename NodeType>
+class BasicDLLIterator {
   public:
-    DLLIterator(Node* head) 
-      : curr_(head) {}
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::remove_const_t<ValueType>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = ValueType*;
+    using reference = ValueType&;
+
+    BasicDLLIterator(NodeType* curr, Node* const* tail) 
+      : curr_(curr)
+      , tail_(tail) {}
+
+    // A mutable iterator converts to a const one (but not the other way).
+    template <typename OtherValue, typename OtherNode,
+              typename = std::enable_if_t<std::is_convertible_v<OtherNode*, NodeType*>>>
+    BasicDLLIterator(const BasicDLLIterator<OtherValue, OtherNode>& other)
+      : curr_(other.curr_)
+      , tail_(other.tail_) {}
 
     // Implementing a prefix increment operator (++iter).
-    DLLIterator& operator++() {
+    BasicDLLIterator& operator++() {
       curr_ = curr_->next_;
       return *this;
     }
@@ -70,39 +131,70 @@ class DLLIterator {
     // of the operator. The prefix operator returns the result of the
     // increment, while the postfix operator returns the iterator before
     // the increment.
-    DLLIterator operator++(int) {
-      DLLIterator temp = *this;
+    BasicDLLIterator operator++(int) {
+      BasicDLLIterator temp = *this;
       ++*this;
       return temp;
     }
 
+    // Prefix and postfix decrement (--iter, iter--). Decrementing the End()
+    // iterator (curr_ is nullptr) moves it onto the last element.
+    BasicDLLIterator& operator--() {
+      curr_ = (curr_ == nullptr) ? *tail_ : curr_->prev_;
+      return *this;
+    }
+
+    BasicDLLIterator operator--(int) {
+      BasicDLLIterator temp = *this;
+      --*this;
+      return temp;
+    }
+
     // This is the equality operator for the DLLIterator class. It
     // tests that the current pointers are the same.
-    bool operator==(const DLLIterator &itr) const {
+    bool operator==(const BasicDLLIterator &itr) const {
       return itr.curr_ == this->curr_;
     }
 
     // This is the inequality operator for the DLLIterator class. It
     // tests that the current pointers are not the same.
-    bool operator!=(const DLLIterator &itr) const {
+    bool operator!=(const BasicDLLIterator &itr) const {
       return itr.curr_ != this->curr_;
     }
 
     // This is the dereference operator for the DLLIterator class. It
-    // returns the value of the element at the current position of the
-    // iterator. The current position of the iterator is marked by curr_,
-    // and we can access the value of curr_ by accessing its value field.
-    int operator*() {
+    // returns the element at the current position of the iterator. The
+    // current position of the iterator is marked by curr_, and we can access
+    // the value of curr_ by accessing its value field. Returning a reference
+    // (rather than a copy) lets callers and algorithms modify the element.
+    reference operator*() const {
       return curr_->value_;
     }
 
+    // The arrow operator returns a pointer to the element, so that
+    // iter->member works when the element is a struct.
+    pointer operator->() const {
+      return &curr_->value_;
+    }
+
   private:
-    Node* curr_;
+    // The other instantiation (mutable <-> const) and the DLL itself may
+    // look at the node pointer.
+    template <typename, typename>
+    friend class BasicDLLIterator;
+    friend class DLL;
+
+    NodeType* curr_;
+    Node* const* tail_;
 };
 
+using DLLIterator = BasicDLLIterator<int, Node>;
+using ConstDLLIterator = BasicDLLIterator<const int, const Node>;
+
 // This is a basic implementation of a doubly linked list. It also includes
 // iterator functions Begin and End, which return DLLIterators that can be
-// used to iterate through this DLL instance.
+// used to iterate through this DLL instance. The lowercase begin() and end()
+// are the names that range-based for loops and the STL expect.
 class DLL {
   public:
     // DLL class constructor.
@@ -110,6 +202,10 @@ class DLL {
     : head_(nullptr)
     , size_(0) {}
 
+    // The DLL owns its nodes, so copying it would free them twice.
+    DLL(const DLL&) = delete;
+    DLL& operator=(const DLL&) = delete;
+
     // Destructor should delete all the nodes by iterating through them.
     ~DLL() {
       Node *current = head_;
@@ -123,36 +219,175 @@ class DLL {
 
     // Function for inserting val at the head of the DLL.
     void InsertAtHead(int val) {
+      Insert(Begin(), val);
+    }
+
+    // Function for inserting val at the tail of the DLL.
+    void InsertAtTail(int val) {
+      Insert(End(), val);
+    }
+
+    // Inserts val before pos (pos may be End()) and returns an iterator to
+    // the new element. Like std::list, this is O(1) and no other iterator is
+    // invalidated.
+    DLLIterator Insert(ConstDLLIterator pos, int val) {
       Node *new_node = new Node(val);
-      new_node->next_ = head_;
+      Link(new_node, const_cast<Node*>(pos.curr_));
+      size_ += 1;
+      return DLLIterator(new_node, &tail_);
+    }
+
+    // Removes the element at pos and returns an iterator to the element
+    // after it. Only iterators to the erased element are invalidated.
+    DLLIterator Erase(ConstDLLIterator pos) {
+      Node *node = const_cast<Node*>(pos.curr_);
+      Node *next = node->next_;
+      Unlink(node);
+      delete node;
+      size_ -= 1;
+      return DLLIterator(next, &tail_);
+    }
 
-      if (head_ != nullptr) {
-        head_->prev_ = new_node;
+    // Moves every node of other in front of pos. No element is copied or
+    // reallocated: the two chains are relinked in O(1).
+    void Splice(ConstDLLIterator pos, DLL& other) {
+      if (&other == this || other.head_ == nullptr) {
+        return;
       }
+      Node *after = const_cast<Node*>(pos.curr_);
+      Node *before = (after != nullptr) ? after->prev_ : tail_;
 
-      head_ = new_node;
+      other.head_->prev_ = before;
+      other.tail_->next_ = after;
+      if (before != nullptr) { before->next_ = other.head_; } else { head_ = other.head_; }
+      if (after != nullptr) { after->prev_ = other.tail_; } else { tail_ = other.tail_; }
+
+      size_ += other.size_;
+      other.head_ = other.tail_ = nullptr;
+      other.size_ = 0;
+    }
+
+    // Moves the single node at it (which belongs to other) in front of pos.
+    void Splice(ConstDLLIterator pos, DLL& other, ConstDLLIterator it) {
+      Node *node = const_cast<Node*>(it.curr_);
+      if (node == pos.curr_) {
+        return;
+      }
+      other.Unlink(node);
+      other.size_ -= 1;
+      Link(node, const_cast<Node*>(pos.curr_));
       size_ += 1;
     }
 
     // The Begin() function returns an iterator to the head of the DLL,
     // which is the first element to access when iterating through.
     DLLIterator Begin() {
-      return DLLIterator(head_);
+      return DLLIterator(head_, &tail_);
     }
 
     // The End() function returns an iterator that marks the one-past-the-last
     // element of the iterator. In this case, this would be an iterator with
     // its current pointer set to nullptr.
     DLLIterator End() {
-      return DLLIterator(nullptr);
+      return DLLIterator(nullptr, &tail_);
     }
 
+    DLLIterator begin() { return Begin(); }
+    DLLIterator end() { return End(); }
+    ConstDLLIterator begin() const { return ConstDLLIterator(head_, &tail_); }
+    ConstDLLIterator end() const { return ConstDLLIterator(nullptr, &tail_); }
+    ConstDLLIterator cbegin() const { return begin(); }
+    ConstDLLIterator cend() const { return end(); }
+
+    size_t Size() const { return size_; }
+    size_t size() const { return size_; }
+
     Node* head_{nullptr};
+    Node* tail_{nullptr};
     size_t size_;
+
+  private:
+    // Links node in front of after (nullptr = at the tail).
+    void Link(Node *node, Node *after) {
+      Node *before = (after != nullptr) ? after->prev_ : tail_;
+      node->prev_ = before;
+      node->next_ = after;
+      if (before != nullptr) { before->next_ = node; } else { head_ = node; }
+      if (after != nullptr) { after->prev_ = node; } else { tail_ = node; }
+    }
+
+    void Unlink(Node *node) {
+      if (node->prev_ != nullptr) { node->prev_->next_ = node->next_; } else { head_ = node->next_; }
+      if (node->next_ != nullptr) { node->next_->prev_ = node->prev_; } else { tail_ = node->prev_; }
+      node->prev_ = node->next_ = nullptr;
+    }
 };
 
+// Prints any range we can iterate over.
+template <typename Range>
+void PrintRange(const char *label, const Range &range) {
+  std::cout << label;
+  for (const auto &value : range) {
+    std::cout << value << " ";
+  }
+  std::cout << std::endl;
+}
+
+// Sums a range `passes` times and returns nanoseconds per element visited.
+template <typename Range>
+double TraversalNanos(const Range &range, int passes, long long &sink) {
+  auto start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; ++pass) {
+    sink += std::accumulate(range.begin(), range.end(), 0LL);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return ns / (static_cast<double>(range.size()) * passes);
+}
+
+// Compares traversal of the same n integers stored five different ways.
+// A std::list whose nodes were relinked in random order is the "heap
+// scattered" case: every step is a cache miss once n outgrows the caches.
+void TraversalBenchmark(size_t n, int passes) {
+  std::vector<int> vec(n);
+  std::iota(vec.begin(), vec.end(), 0);
+
+  std::list<int> list(vec.begin(), vec.end());
+  DLL dll;
+  containers::UnrolledList<int> unrolled;
+  for (int value : vec) {
+    dll.InsertAtTail(value);
+    unrolled.push_back(value);
+  }
+
+  // Same values and order, but nodes relinked in a random memory order.
+  std::list<int> scattered;
+  {
+    std::list<int> source(vec.begin(), vec.end());
+    std::vector<std::list<int>::iterator> nodes;
+    for (auto it = source.begin(); it != source.end(); ++it) {
+      nodes.push_back(it);
+    }
+    std::shuffle(nodes.begin(), nodes.end(), std::mt19937(42));
+    for (auto it : nodes) {
+      scattered.splice(scattered.end(), source, it);
+    }
+    scattered.sort();
+  }
+
+  long long sink = 0;
+  std::cout << "\nTraversal of " << n << " ints (" << passes << " passes), ns per element:" << std::endl;
+  std::printf("  %-34s %6.2f\n", "std::vector", TraversalNanos(vec, passes, sink));
+  std::printf("  %-34s %6.2f  (%zu per node, %zu nodes)\n", "UnrolledList (pooled nodes)",
+              TraversalNanos(unrolled, passes, sink), containers::UnrolledList<int>::NODE_CAPACITY,
+              unrolled.node_count());
+  std::printf("  %-34s %6.2f\n", "DLL (pooled nodes)", TraversalNanos(dll, passes, sink));
+  std::printf("  %-34s %6.2f\n", "std::list (allocation order)", TraversalNanos(list, passes, sink));
+  std::printf("  %-34s %6.2f\n", "std::list (scattered nodes)", TraversalNanos(scattered, passes, sink));
+  std::cout << "  (checksum " << sink << ")" << std::endl;
+}
+
 // The main function shows the usage of the DLL iterator.
-int main() {
+int main(int argc, char *argv[]) {
   // Creating a DLL and inserting elements into it.
   DLL dll;
   dll.InsertAtHead(6);
@@ -175,5 +410,55 @@ int main() {
   }
   std::cout << std::endl;
 
+  // Because DLLIterator now publishes its iterator traits, the standard
+  // algorithms accept it like any other bidirectional iterator.
+  std::cout << "\nUsing DLL iterators with <algorithm> and <numeric>\n";
+  std::cout << "Sum via std::accumulate: " << std::accumulate(dll.begin(), dll.end(), 0) << std::endl;
+  DLLIterator four = std::find(dll.begin(), dll.end(), 4);
+  std::cout << "std::find(4) found: " << *four << ", distance from begin: "
+            << std::distance(dll.begin(), four) << std::endl;
+  std::reverse(dll.begin(), dll.end());  // Needs operator--
+  PrintRange("After std::reverse: ", dll);
+
+  // Walking backwards from End() with operator--.
+  std::cout << "Backwards: ";
+  for (DLLIterator iter = dll.End(); iter != dll.Begin();) {
+    --iter;
+    std::cout << *iter << " ";
+  }
+  std::cout << std::endl;
+
+  // Through a const reference we get ConstDLLIterators: read-only access.
+  const DLL &const_dll = dll;
+  ConstDLLIterator largest = std::max_element(const_dll.begin(), const_dll.end());
+  std::cout << "Largest element (via const iterator): " << *largest << std::endl;
+
+  // Insert, erase and splice, all O(1) relinking.
+  dll.Insert(std::find(dll.begin(), dll.end(), 3), 100);
+  dll.Erase(std::find(dll.begin(), dll.end(), 5));
+  PrintRange("Insert 100 before 3, erase 5: ", dll);
+
+  DLL other;
+  other.InsertAtTail(7);
+  other.InsertAtTail(8);
+  dll.Splice(dll.begin(), other);
+  PrintRange("Splice {7, 8} at the front: ", dll);
+  std::cout << "Sizes after splice: dll=" << dll.Size() << " other=" << other.Size() << std::endl;
+
+  // The unrolled list offers the same interface as std::list.
+  containers::UnrolledList<int> unrolled;
+  for (int i = 1; i <= 25; ++i) {
+    unrolled.push_back(i);
+  }
+  unrolled.erase(std::find(unrolled.begin(), unrolled.end(), 13));
+  unrolled.insert(unrolled.begin(), 0);
+  std::cout << "\nUnrolledList<int>: " << unrolled.size() << " elements in " << unrolled.node_count()
+            << " nodes of " << containers::UnrolledList<int>::NODE_CAPACITY << std::endl;
+  PrintRange("  contents: ", unrolled);
+
+  // Traversal benchmark; pass a different element count as argv[1].
+  size_t n = (argc > 1) ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+  TraversalBenchmark(n, 10);
+
   return 0;
-}
\ No newline at end of file
+}
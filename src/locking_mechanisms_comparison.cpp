@@ -59,6 +59,16 @@
 #include <thread>
 #include <atomic>
 #include <memory>
+#include <shared_mutex>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+
+#include "benchmark.h"
+#include "cache_line.h"
+#include "latency_histogram.h"
+#include "spin_locks.h"
 
 // ANSI Color codes
 namespace Colors {
@@ -615,7 +625,7 @@ namespace Demo3 {
 
 namespace PerformanceDemo {
     std::mutex test_mutex;
-    volatile int counter = 0;
+    int counter = 0;  // Shared global behind a lock: the increments are kept
     
     void print_header() {
         std::cout << Colors::BOLD << Colors::BLUE << "\n⚡ PERFORMANCE COMPARISON" << Colors::RESET << std::endl;
@@ -649,35 +659,287 @@ namespace PerformanceDemo {
         
         const int iterations = 100000;
         
-        // Test manual lock/unlock
-        counter = 0;
-        auto start = std::chrono::high_resolution_clock::now();
-        test_manual_lock(iterations);
-        auto manual_time = std::chrono::high_resolution_clock::now() - start;
-        
-        // Test lock_guard
-        counter = 0;
-        start = std::chrono::high_resolution_clock::now();
-        test_lock_guard(iterations);
-        auto lock_guard_time = std::chrono::high_resolution_clock::now() - start;
-        
-        // Test unique_lock
-        counter = 0;
-        start = std::chrono::high_resolution_clock::now();
-        test_unique_lock(iterations);
-        auto unique_lock_time = std::chrono::high_resolution_clock::now() - start;
-        
-        auto manual_ms = std::chrono::duration_cast<std::chrono::microseconds>(manual_time);
-        auto lock_guard_ms = std::chrono::duration_cast<std::chrono::microseconds>(lock_guard_time);
-        auto unique_lock_ms = std::chrono::duration_cast<std::chrono::microseconds>(unique_lock_time);
+        bench::Suite suite("locking_raii");
+        auto reset = [] { counter = 0; };
         
         std::cout << Colors::GREEN << "Performance Results (" << iterations << " iterations):" << Colors::RESET << std::endl;
-        std::cout << "Manual lock/unlock: " << manual_ms.count() << " μs" << std::endl;
-        std::cout << "std::lock_guard:    " << lock_guard_ms.count() << " μs" << std::endl;
-        std::cout << "std::unique_lock:   " << unique_lock_ms.count() << " μs" << std::endl;
+        suite.run_with_setup("Manual lock/unlock", reset, [&] { test_manual_lock(iterations); }, iterations);
+        suite.run_with_setup("std::lock_guard", reset, [&] { test_lock_guard(iterations); }, iterations);
+        suite.run_with_setup("std::unique_lock", reset, [&] { test_unique_lock(iterations); }, iterations);
         
         std::cout << Colors::YELLOW << "\nKey Insight: Performance is nearly identical!" << Colors::RESET << std::endl;
         std::cout << Colors::GREEN << "RAII has no performance penalty - always use it!" << Colors::RESET << std::endl;
+        std::cout << "(One thread, so this is the uncontended cost; see the contention benchmark next)" << std::endl;
+    }
+}
+
+// =============================================================================
+// CONTENTION BENCHMARK
+// =============================================================================
+
+// Contended Lock Handoff:
+// ┌─ WHAT EACH WAITER SPINS ON ────────────────────────────┐
+// │                                                        │
+// │ std::mutex      futex word; waiters sleep in kernel    │
+// │ TTAS spinlock   one shared flag ──► all waiters race   │
+// │ ticket lock     one now_serving ──► FIFO, all poll it  │
+// │ MCS lock        own queue node  ──► FIFO, one line     │
+// │                 [T1] → [T2] → [T3]   moves per handoff │
+// │ shared_mutex    readers share, writers exclusive       │
+// │ atomic          no lock: the cache line is the lock    │
+// └────────────────────────────────────────────────────────┘
+
+namespace ContentionDemo {
+    struct Config {
+        int max_threads = 0;       // 0: max(4, hardware_concurrency)
+        int duration_ms = 20;      // Per trial
+        int trials = 3;            // Throughput is the median trial
+    };
+
+    struct Workload {
+        int threads;
+        int critical_section;      // Dependent multiply-adds while holding the lock
+        int read_percent;          // Reads take shared_mutex in shared mode
+    };
+
+    // Everything the locks protect, on its own line
+    struct alignas(CACHE_LINE_SIZE) SharedData {
+        uint64_t value = 0;
+    };
+
+    struct ThreadResult {
+        uint64_t ops = 0;
+        LatencyHistogram acquire;  // ns from lock() call to lock held, sampled
+    };
+
+    struct Outcome {
+        double ops_per_second = 0;
+        double spread = 0;         // (max - min) / mean of per-thread op counts
+        LatencyHistogram acquire;
+    };
+
+    const int LATENCY_SAMPLE_EVERY = 8;  // Two clock reads cost about as much as an uncontended lock
+
+    inline uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    inline void critical_work(SharedData& data, int length) {
+        uint64_t value = data.value;
+        for (int i = 0; i < length; ++i) {
+            value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        data.value = value + 1;
+    }
+
+    inline uint64_t read_work(const SharedData& data, int length) {
+        uint64_t value = data.value;
+        for (int i = 0; i < length; ++i) {
+            value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        return value;
+    }
+
+    // One adapter per lock: op(write, data, length) acquires, runs the
+    // critical section and releases; returns when the lock was held
+    struct MutexOp {
+        std::mutex mutex;
+        template <typename Acquired>
+        void operator()(bool write, SharedData& data, int length, Acquired acquired) {
+            std::lock_guard<std::mutex> lock(mutex);
+            acquired();
+            if (write) {
+                critical_work(data, length);
+            } else {
+                bench::do_not_optimize(read_work(data, length));
+            }
+        }
+    };
+
+    struct SharedMutexOp {
+        std::shared_mutex mutex;
+        template <typename Acquired>
+        void operator()(bool write, SharedData& data, int length, Acquired acquired) {
+            if (write) {
+                std::unique_lock<std::shared_mutex> lock(mutex);
+                acquired();
+                critical_work(data, length);
+            } else {
+                std::shared_lock<std::shared_mutex> lock(mutex);
+                acquired();
+                bench::do_not_optimize(read_work(data, length));
+            }
+        }
+    };
+
+    template <typename Lock>
+    struct SpinOp {
+        Lock lock;
+        template <typename Acquired>
+        void operator()(bool write, SharedData& data, int length, Acquired acquired) {
+            std::lock_guard<Lock> guard(lock);
+            acquired();
+            if (write) {
+                critical_work(data, length);
+            } else {
+                bench::do_not_optimize(read_work(data, length));
+            }
+        }
+    };
+
+    struct McsOp {
+        concurrency::McsLock lock;
+        template <typename Acquired>
+        void operator()(bool write, SharedData& data, int length, Acquired acquired) {
+            concurrency::McsLock::Guard guard(lock);
+            acquired();
+            if (write) {
+                critical_work(data, length);
+            } else {
+                bench::do_not_optimize(read_work(data, length));
+            }
+        }
+    };
+
+    // No lock to hold: a write is one fetch_add, a read one load, and the
+    // critical-section length does not apply
+    struct AtomicOp {
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> counter{0};
+        template <typename Acquired>
+        void operator()(bool write, SharedData&, int, Acquired acquired) {
+            if (write) {
+                counter.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                bench::do_not_optimize(counter.load(std::memory_order_relaxed));
+            }
+            acquired();
+        }
+    };
+
+    // All threads hammer op() for duration_ms; each samples acquire latency
+    template <typename Op>
+    Outcome run_trial(Op& op, const Workload& workload, int duration_ms) {
+        SharedData data;
+        std::vector<CachePadded<ThreadResult>> results(workload.threads);
+        std::atomic<int> ready{0};
+        std::atomic<bool> go{false};
+        std::atomic<bool> stop{false};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < workload.threads; ++t) {
+            threads.emplace_back([&, t] {
+                ThreadResult& result = *results[t];
+                uint64_t rng = 0x9E3779B97F4A7C15ULL * (t + 1);
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                while (!stop.load(std::memory_order_relaxed)) {
+                    rng ^= rng << 13;
+                    rng ^= rng >> 7;
+                    rng ^= rng << 17;
+                    bool write = static_cast<int>(rng % 100) >= workload.read_percent;
+                    if (result.ops % LATENCY_SAMPLE_EVERY == 0) {
+                        uint64_t start = now_ns();
+                        op(write, data, workload.critical_section, [&] { result.acquire.record(now_ns() - start); });
+                    } else {
+                        op(write, data, workload.critical_section, [] {});
+                    }
+                    ++result.ops;
+                }
+            });
+        }
+        while (ready.load() < workload.threads) std::this_thread::yield();
+
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+        stop.store(true, std::memory_order_relaxed);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        Outcome outcome;
+        uint64_t total = 0, least = UINT64_MAX, most = 0;
+        for (auto& result : results) {
+            total += result->ops;
+            least = std::min(least, result->ops);
+            most = std::max(most, result->ops);
+            outcome.acquire.merge(result->acquire);
+        }
+        double mean = static_cast<double>(total) / workload.threads;
+        outcome.ops_per_second = total / seconds;
+        outcome.spread = mean > 0 ? (most - least) / mean : 0;
+        return outcome;
+    }
+
+    // Median-throughput trial of `trials`, printed as one table row; the
+    // per-trial ns/op go to the suite for export
+    template <typename Op>
+    void measure(bench::Suite& suite, const char* name, const Workload& workload, const Config& config) {
+        std::vector<Outcome> outcomes;
+        std::vector<double> ns_per_op;
+        for (int trial = 0; trial < config.trials; ++trial) {
+            Op op;
+            outcomes.push_back(run_trial(op, workload, config.duration_ms));
+            ns_per_op.push_back(1e9 / outcomes.back().ops_per_second);
+        }
+        std::sort(outcomes.begin(), outcomes.end(),
+                  [](const Outcome& a, const Outcome& b) { return a.ops_per_second < b.ops_per_second; });
+        const Outcome& median = outcomes[outcomes.size() / 2];
+        printf("  %-14s %3d %4d %4d%% %9.2f %7.0f%% %9.2f %9.2f %10.2f\n", name, workload.threads,
+               workload.critical_section, workload.read_percent, median.ops_per_second / 1e6, median.spread * 100,
+               median.acquire.percentile(50) / 1e3, median.acquire.percentile(99) / 1e3,
+               median.acquire.percentile(99.9) / 1e3);
+        suite.add(std::string(name) + " t=" + std::to_string(workload.threads) +
+                  " cs=" + std::to_string(workload.critical_section) +
+                  " read=" + std::to_string(workload.read_percent) + "%", ns_per_op);
+    }
+
+    void demonstrate(const Config& config) {
+        std::cout << Colors::BOLD << Colors::BLUE << "\n🏁 CONTENTION BENCHMARK" << Colors::RESET << std::endl;
+        std::cout << std::string(60, '=') << std::endl;
+
+        int max_threads = config.max_threads > 0
+                              ? config.max_threads
+                              : std::max(4, static_cast<int>(std::thread::hardware_concurrency()));
+        std::vector<int> thread_counts;
+        for (int n = 1; n < max_threads; n *= 2) thread_counts.push_back(n);
+        thread_counts.push_back(max_threads);
+
+        bench::Options options = bench::Options::from_environment();
+        options.print = false;
+        bench::Suite suite("locking_contention", options);
+
+        std::cout << config.duration_ms << "ms per trial, median of " << config.trials
+                  << " trials; spread = (max - min) / mean ops per thread; latency = time to acquire" << std::endl;
+        for (int critical_section : {0, 64}) {
+            for (int read_percent : {0, 90}) {
+                std::cout << Colors::CYAN << "\nCritical section " << critical_section << " multiply-adds, "
+                          << read_percent << "% reads" << Colors::RESET << std::endl;
+                printf("  %-14s %3s %4s %5s %9s %8s %9s %9s %10s\n", "lock", "thr", "cs", "read", "Mops/s",
+                       "spread", "p50 us", "p99 us", "p99.9 us");
+                for (int threads : thread_counts) {
+                    Workload workload{threads, critical_section, read_percent};
+                    measure<MutexOp>(suite, "std::mutex", workload, config);
+                    measure<SharedMutexOp>(suite, "shared_mutex", workload, config);
+                    measure<SpinOp<concurrency::TtasSpinLock>>(suite, "TTAS spin", workload, config);
+                    measure<SpinOp<concurrency::TicketLock>>(suite, "ticket", workload, config);
+                    measure<McsOp>(suite, "MCS", workload, config);
+                    if (critical_section == 0) {
+                        measure<AtomicOp>(suite, "atomic", workload, config);
+                    }
+                }
+            }
+        }
+
+        std::cout << Colors::YELLOW << "\nKey Insights:" << Colors::RESET << std::endl;
+        std::cout << "• Uncontended, every lock costs about the same (PerformanceDemo above)" << std::endl;
+        std::cout << "• TTAS is fast but unfair: the thread that just released often wins again" << std::endl;
+        std::cout << "• Ticket and MCS are FIFO (low spread); MCS keeps scaling because each waiter spins locally" << std::endl;
+        std::cout << "• More threads than cores: spinners burn the holder's time slice, std::mutex sleeps" << std::endl;
+        std::cout << "• shared_mutex pays off only with read-mostly load and a real critical section" << std::endl;
+        std::cout << "• A single atomic beats any lock, until the work no longer fits in one instruction" << std::endl;
     }
 }
 
@@ -685,7 +947,22 @@ namespace PerformanceDemo {
 // MAIN FUNCTION
 // =============================================================================
 
-int main() {
+int main(int argc, char* argv[]) {
+    ContentionDemo::Config contention;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            contention.max_threads = std::atoi(argv[++i]);
+        } else if (arg == "--duration-ms" && i + 1 < argc) {
+            contention.duration_ms = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--trials" && i + 1 < argc) {
+            contention.trials = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--threads N] [--duration-ms MS] [--trials N]" << std::endl;
+            return 1;
+        }
+    }
+    
     std::cout << Colors::BOLD << Colors::CYAN << "🔒 C++ Locking Mechanisms Comparison" << Colors::RESET << std::endl;
     std::cout << std::string(60, '=') << std::endl;
     
@@ -693,6 +970,7 @@ int main() {
     Demo2::demonstrate();
     Demo3::demonstrate();
     PerformanceDemo::demonstrate();
+    ContentionDemo::demonstrate(contention);
     
     std::cout << Colors::BOLD << Colors::GREEN << "\n📋 Summary: When to Use What?" << Colors::RESET << std::endl;
     std::cout << std::string(60, '=') << std::endl;
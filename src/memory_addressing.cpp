@@ -20,9 +20,20 @@
 #include <cstdint>
 #include <iomanip>
 #include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <future>
+#include <memory_resource>
+#include <random>
 #include <unistd.h>
 #include <sys/mman.h>
 
+#include "benchmark.h"
+#include "huge_pages.h"
+#include "memory_probe.h"
+#include "monotonic_arena.h"
+#include "numa.h"
+
 // Simulated structures for demonstration
 struct PhysicalPageFrame {
     uint64_t physical_address;
@@ -289,6 +300,56 @@ void demonstrate_virtual_to_physical_translation() {
     std::cout << "• Separate TLBs for instructions and data" << std::endl;
     std::cout << "• Must be flushed on context switches" << std::endl;
     
+    std::cout << "\n--- Huge Pages vs TLB Misses (measured) ---" << std::endl;
+    // Random access over 512MB: with 4KB pages nearly every load also
+    // misses the TLB and walks the page table; a 2MB page covers 512 times
+    // as much, and a 1GB page covers the whole buffer. (Hardware dTLB
+    // counters are often not available to unprivileged or virtualized
+    // processes, so the effect is shown as time per access.)
+    const size_t buffer_bytes = size_t{512} << 20;
+    const size_t slots = buffer_bytes / sizeof(uint64_t);
+    const size_t accesses = size_t{1} << 22;
+    std::vector<uint32_t> indices(accesses);
+    std::mt19937 rng(42);
+    for (uint32_t& index : indices) index = static_cast<uint32_t>(rng() % slots);
+    
+    std::printf("%-14s %-13s %10s %14s %14s\n", "requested", "obtained", "huge MB", "gather ns/op", "chase ns/op");
+    const memory::PageSize kinds[] = {memory::PageSize::HUGETLB_1GB, memory::PageSize::HUGETLB_2MB,
+                                      memory::PageSize::TRANSPARENT_2MB, memory::PageSize::SMALL_4KB};
+    for (memory::PageSize kind : kinds) {
+        memory::HugePageRegion region(buffer_bytes, kind);
+        if (region.page_size() != kind) {
+            std::printf("%-14s (not available: no pages of this size reserved)\n", memory::page_size_name(kind));
+            continue;
+        }
+        uint64_t* values = reinterpret_cast<uint64_t*>(region.data());
+        for (size_t i = 0; i < slots; ++i) values[i] = i;  // Fault every page in
+        
+        // Independent loads (the prefetcher cannot help, but many misses
+        // overlap), then dependent ones (every miss is paid in full)
+        double best_ns = 0;
+        for (int run = 0; run < 3; ++run) {
+            double ns = bench::time_ns([&] {
+                uint64_t sum = 0;
+                for (uint32_t index : indices) sum += values[index];
+                bench::do_not_optimize(sum);
+            });
+            if (run == 0 || ns < best_ns) best_ns = ns;
+        }
+        double chase_ns = memory::chase_latency_ns(region.data(), buffer_bytes, accesses / 2);
+        std::printf("%-14s %-13s %10zu %14.1f %14.1f\n", memory::page_size_name(kind),
+                    memory::page_size_name(region.page_size()), region.huge_bytes() >> 20,
+                    best_ns / accesses, chase_ns);
+    }
+    
+    // The same fallback behind an allocator: a pmr::vector on huge pages
+    memory::HugePageArena arena(size_t{64} << 20);
+    std::pmr::vector<uint64_t> table(size_t{4} << 20, 0, &arena);
+    std::cout << "pmr::vector<uint64_t>(4M) on HugePageArena: "
+              << memory::page_size_name(arena.page_size()) << " pages, "
+              << (arena.regions().front().huge_bytes() >> 20) << " MB of "
+              << (arena.regions().front().size() >> 20) << " MB huge" << std::endl;
+    
     std::cout << std::endl;
 }
 
@@ -563,41 +624,70 @@ void demonstrate_numa_architecture() {
     std::cout << "• Remote memory: ~150ns latency, reduced bandwidth" << std::endl;
     std::cout << "• Cache coherency overhead for shared data" << std::endl;
     
-    // Simulate NUMA memory access
-    std::cout << "\n--- NUMA Memory Access Simulation ---" << std::endl;
-    
-    // Get NUMA info (simplified simulation)
-    std::cout << "NUMA Node Information:" << std::endl;
-    std::cout << "Node 0: CPU cores 0-7, Memory 0x00000000-0x3FFFFFFFF" << std::endl;
-    std::cout << "Node 1: CPU cores 8-15, Memory 0x400000000-0x7FFFFFFFF" << std::endl;
-    
-    // Demonstrate memory access latency differences
-    const size_t array_size = 1024 * 1024;  // 1MB
-    std::vector<int> local_data(array_size);
-    
-    // Initialize data
-    for (size_t i = 0; i < array_size; ++i) {
-        local_data[i] = static_cast<int>(i);
+    // The real topology of this host, and what placement buys on it
+    std::cout << "\n--- This Host's NUMA Topology (/sys/devices/system/node) ---" << std::endl;
+    const memory::NumaTopology& topology = memory::NumaTopology::system();
+    if (!topology.from_sysfs()) {
+        std::cout << "(No NUMA information exposed: treating the machine as one node)" << std::endl;
     }
-    
-    // Sequential access (likely local)
-    auto start_time = std::chrono::high_resolution_clock::now();
-    long long sum = 0;
-    for (size_t i = 0; i < array_size; ++i) {
-        sum += local_data[i];
+    for (const memory::NumaNode& node : topology.nodes()) {
+        std::cout << "Node " << node.id << ": " << node.cpus.size() << " CPUs (";
+        for (size_t i = 0; i < node.cpus.size() && i < 8; ++i) std::cout << (i > 0 ? "," : "") << node.cpus[i];
+        std::cout << (node.cpus.size() > 8 ? ",..." : "") << "), " << (node.total_bytes >> 20) << " MB, "
+                  << (node.free_bytes >> 20) << " MB free" << std::endl;
+    }
+    std::cout << "Distances (10 = local):" << std::endl;
+    for (const memory::NumaNode& from : topology.nodes()) {
+        printf("  node %d:", from.id);
+        for (const memory::NumaNode& to : topology.nodes()) printf("%5d", topology.distance(from.id, to.id));
+        printf("\n");
+    }
+    int here = memory::current_node();
+    std::cout << "This thread is running on node " << here << std::endl;
+    
+    // Small objects from an arena whose blocks are bound to our node
+    std::cout << "\n--- Node-Local Allocation ---" << std::endl;
+    memory::NodeLocalResource local_pages(here);
+    memory::MonotonicArena arena(1 << 20, &local_pages);
+    std::pmr::vector<int> local_values(1 << 16, 1, &arena);
+    std::cout << "pmr::vector on MonotonicArena over NodeLocalResource(" << here << "): pages on node "
+              << memory::node_of_address(local_values.data()) << std::endl;
+    
+    // Workers spread over the nodes; each pins itself to its node's CPUs
+    size_t worker_count = std::max<size_t>(2, topology.node_count());
+    {
+        concurrency::WorkStealingPool pool(memory::numa_placement(topology, worker_count));
+        std::vector<std::future<int>> nodes_seen;
+        for (size_t i = 0; i < 4 * worker_count; ++i) {
+            nodes_seen.push_back(pool.submit([] { return memory::current_node(); }));
+        }
+        std::map<int, int> tasks_per_node;
+        for (auto& node : nodes_seen) ++tasks_per_node[node.get()];
+        std::cout << "WorkStealingPool(numa_placement(" << worker_count << " workers)): tasks ran on";
+        for (const auto& entry : tasks_per_node) std::cout << " node " << entry.first << " x" << entry.second;
+        std::cout << std::endl;
     }
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto access_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
     
-    std::cout << "\nMemory Access Performance:" << std::endl;
-    std::cout << "Sequential access time: " << access_time.count() << " μs" << std::endl;
-    std::cout << "Effective bandwidth: " << 
-                 (array_size * sizeof(int) / 1024.0 / 1024.0) / (access_time.count() / 1000000.0)
-                 << " MB/s" << std::endl;
+    // Measured: every CPU node against every memory node
+    std::cout << "\n--- Measured Local vs Remote Access (256MB per buffer) ---" << std::endl;
+    std::vector<memory::NumaPoint> points = memory::probe_numa(topology);
+    printf("  CPU node  memory node    latency   read bandwidth   vs local\n");
+    for (const memory::NumaPoint& point : points) {
+        double local_ns = point.ns_per_load;
+        for (const memory::NumaPoint& other : points) {
+            if (other.cpu_node == point.cpu_node && other.memory_node == point.cpu_node) local_ns = other.ns_per_load;
+        }
+        printf("  %8d  %11d  %7.1f ns  %10.2f GB/s  %8.2fx\n", point.cpu_node, point.memory_node, point.ns_per_load,
+               point.bytes_per_second / 1e9, point.ns_per_load / local_ns);
+    }
+    if (topology.node_count() < 2) {
+        std::cout << "One node only: every access here is local. On a two-socket host the" << std::endl;
+        std::cout << "remote rows typically show 1.5-2x the latency and well under the bandwidth." << std::endl;
+    }
     
     std::cout << "\nNUMA Optimization Strategies:" << std::endl;
-    std::cout << "• Memory Affinity: Allocate memory on same node as CPU" << std::endl;
-    std::cout << "• Thread Affinity: Keep threads on same NUMA node" << std::endl;
+    std::cout << "• Memory Affinity: Allocate memory on same node as CPU (NodeLocalResource)" << std::endl;
+    std::cout << "• Thread Affinity: Keep threads on same NUMA node (numa_placement)" << std::endl;
     std::cout << "• Data Locality: Minimize cross-node data sharing" << std::endl;
     std::cout << "• NUMA-aware Algorithms: Partition data by node" << std::endl;
     
@@ -157,7 +157,14 @@
 #include <vector>     // For containers
 #include <new>        // For placement new and bad_alloc
 #include <cstdlib>    // For malloc/free
-#include <chrono>     // For timing
+#include <algorithm>
+#include <list>
+#include <map>
+#include <thread>
+#include <cstdio>
+
+#include "benchmark.h"
+#include "fixed_pool.h"   // FixedPool / PoolAllocator
 
 // Forward declarations for demonstration
 class Resource;
@@ -866,30 +873,46 @@ void demonstrate_memory_pools() {
   std::cout << "- Better cache locality" << std::endl;
   std::cout << "- Predictable memory usage" << std::endl;
   
-  // Simple memory pool simulation
-  std::cout << "\n--- Simple Memory Pool Simulation ---" << std::endl;
-  constexpr size_t pool_size = 4096; // 4KB pool
+  // A real pool: FixedPool<Chunk> carves 64-byte blocks out of slabs
+  std::cout << "\n--- Fixed-Size Memory Pool ---" << std::endl;
   constexpr size_t chunk_size = 64;  // 64-byte chunks
-  constexpr size_t num_chunks = pool_size / chunk_size;
+  struct Chunk {
+    char bytes[chunk_size];
+  };
   
-  std::cout << "Pool size: " << pool_size << " bytes" << std::endl;
+  memory::FixedPool<Chunk> pool(64);  // First slab: 64 chunks = 4KB
   std::cout << "Chunk size: " << chunk_size << " bytes" << std::endl;
-  std::cout << "Number of chunks: " << num_chunks << std::endl;
-  
-  // Allocate pool
-  char* memory_pool = new char[pool_size];
-  bool chunk_used[num_chunks] = {false};
-  
-  std::cout << "Memory pool allocated at: " << static_cast<void*>(memory_pool) << std::endl;
   
-  // Simulate allocations
-  std::vector<void*> allocated_chunks;
-  for (size_t i = 0; i < 10 && i < num_chunks; ++i) {
-    chunk_used[i] = true;
-    void* chunk_ptr = memory_pool + (i * chunk_size);
+  // Consecutive allocations from a fresh slab are adjacent in memory
+  std::vector<Chunk*> allocated_chunks;
+  for (size_t i = 0; i < 10; ++i) {
+    Chunk* chunk_ptr = pool.create();
     allocated_chunks.push_back(chunk_ptr);
-    std::cout << "Allocated chunk " << i << " at: " << chunk_ptr << std::endl;
+    std::cout << "Allocated chunk " << i << " at: " << static_cast<void*>(chunk_ptr) << std::endl;
   }
+  std::cout << "Slabs: " << pool.slab_count() << ", reserved: " << pool.reserved_bytes() << " bytes" << std::endl;
+  
+  // Freed chunks go on the intrusive free list and are handed out again
+  // (LIFO) before any new memory is carved
+  void* freed = allocated_chunks[3];
+  pool.destroy(allocated_chunks[3]);
+  allocated_chunks[3] = pool.create();
+  std::cout << "Freed chunk 3 and allocated again: "
+            << (static_cast<void*>(allocated_chunks[3]) == freed ? "same address (reused)" : "new address")
+            << std::endl;
+  for (Chunk* chunk_ptr : allocated_chunks) {
+    pool.destroy(chunk_ptr);
+  }
+  
+  // PoolAllocator plugs the same idea into node-based STL containers
+  std::cout << "\n--- PoolAllocator with STL Containers ---" << std::endl;
+  std::list<int, memory::PoolAllocator<int>> pooled_list = {1, 2, 3, 4, 5};
+  std::map<int, std::string, std::less<int>, memory::PoolAllocator<std::pair<const int, std::string>>> pooled_map;
+  pooled_map[1] = "one";
+  pooled_map[2] = "two";
+  std::cout << "std::list with PoolAllocator, size " << pooled_list.size()
+            << ", first node at " << static_cast<const void*>(&pooled_list.front()) << std::endl;
+  std::cout << "std::map with PoolAllocator: {1: " << pooled_map[1] << ", 2: " << pooled_map[2] << "}" << std::endl;
   
   // Pool State After Allocations:
   // ┌─ Memory Pool Layout ────────────────────────────┐
@@ -913,9 +936,6 @@ void demonstrate_memory_pools() {
   // │ ✓ 54 chunks remain free                       │
   // └───────────────────────────────────────────────┘
   
-  // Cleanup
-  delete[] memory_pool;
-  
   std::cout << std::endl;
 }
 
@@ -1021,33 +1041,103 @@ void demonstrate_performance_comparison() {
   
   const size_t num_operations = 1000000;
   
+  bench::Suite suite("memory_stack_vs_heap");
+  
   // Stack allocation performance
-  auto start = std::chrono::high_resolution_clock::now();
-  for (size_t i = 0; i < num_operations; ++i) {
-    int stack_var = static_cast<int>(i);
-    volatile int dummy = stack_var; // Prevent optimization
-    (void)dummy;
-  }
-  auto end = std::chrono::high_resolution_clock::now();
-  auto stack_duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  const bench::Result& stack = suite.run("stack allocation", [&] {
+    for (size_t i = 0; i < num_operations; ++i) {
+      int stack_var = static_cast<int>(i);
+      bench::do_not_optimize(stack_var); // Prevent optimization
+    }
+  }, num_operations);
   
   // Heap allocation performance
-  start = std::chrono::high_resolution_clock::now();
-  for (size_t i = 0; i < num_operations; ++i) {
-    int* heap_var = new int(static_cast<int>(i));
-    volatile int dummy = *heap_var; // Prevent optimization
-    (void)dummy;
-    delete heap_var;
-  }
-  end = std::chrono::high_resolution_clock::now();
-  auto heap_duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  const bench::Result& heap = suite.run("heap allocation (new/delete)", [&] {
+    for (size_t i = 0; i < num_operations; ++i) {
+      int* heap_var = new int(static_cast<int>(i));
+      bench::do_not_optimize(heap_var); // Prevent optimization
+      delete heap_var;
+    }
+  }, num_operations);
   
-  std::cout << "Stack allocation (" << num_operations << " ops): " 
-            << stack_duration.count() << " microseconds" << std::endl;
-  std::cout << "Heap allocation (" << num_operations << " ops): " 
-            << heap_duration.count() << " microseconds" << std::endl;
-  std::cout << "Heap is ~" << (heap_duration.count() / static_cast<double>(stack_duration.count())) 
-            << "x slower than stack" << std::endl;
+  std::cout << "Heap is ~" << (heap.median_ns / stack.median_ns) << "x slower than stack" << std::endl;
+  
+  std::cout << std::endl;
+}
+
+// 32-byte object standing in for a typical small node
+struct PooledObject {
+  long values[4];
+};
+
+// `rounds` rounds of: allocate `batch` objects, then free them all
+template <typename Alloc, typename Free>
+void alloc_free(size_t rounds, size_t batch, Alloc alloc, Free release) {
+  std::vector<PooledObject*> live(batch);
+  for (size_t r = 0; r < rounds; ++r) {
+    for (size_t i = 0; i < batch; ++i) {
+      live[i] = alloc();
+      live[i]->values[0] = static_cast<long>(i);
+    }
+    bench::clobber_memory();
+    for (size_t i = 0; i < batch; ++i) {
+      release(live[i]);
+    }
+  }
+}
+
+void new_delete_rounds(size_t rounds, size_t batch) {
+  alloc_free(rounds, batch, [] { return new PooledObject(); }, [](PooledObject* p) { delete p; });
+}
+
+void pool_allocator_rounds(size_t rounds, size_t batch) {
+  memory::PoolAllocator<PooledObject> alloc;
+  alloc_free(rounds, batch, [&alloc] { return new (alloc.allocate(1)) PooledObject(); },
+             [&alloc](PooledObject* p) { alloc.deallocate(p, 1); });
+}
+
+// Runs `work` on `threads` threads at once and waits for all of them
+template <typename Work>
+void run_threaded(size_t threads, Work work) {
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back(work);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void demonstrate_pool_allocator_performance() {
+  std::cout << "=== POOL ALLOCATOR VS NEW/DELETE ===" << std::endl;
+  
+  const size_t batch = 1000;
+  const size_t rounds = 1000;  // rounds * batch = 1M alloc/free pairs
+  const size_t threads = std::max(4u, std::thread::hardware_concurrency());
+  const size_t pairs = rounds * batch;
+  bench::Suite suite("memory_pool");
+  
+  // Single-threaded: FixedPool needs no locks at all
+  std::cout << "Single thread, " << pairs << " alloc/free pairs of " << sizeof(PooledObject) << " bytes:" << std::endl;
+  const bench::Result& new_delete = suite.run("new/delete", [&] { new_delete_rounds(rounds, batch); }, pairs);
+  memory::FixedPool<PooledObject> pool;
+  const bench::Result& fixed = suite.run("FixedPool", [&] {
+    alloc_free(rounds, batch, [&pool] { return pool.create(); }, [&pool](PooledObject* p) { pool.destroy(p); });
+  }, pairs);
+  const bench::Result& allocator = suite.run("PoolAllocator", [&] { pool_allocator_rounds(rounds, batch); }, pairs);
+  std::printf("  FixedPool %.1fx, PoolAllocator %.1fx faster than new/delete\n", new_delete.median_ns / fixed.median_ns,
+              new_delete.median_ns / allocator.median_ns);
+  
+  // Multi-threaded: every thread does the full 1M pairs concurrently
+  std::cout << threads << " threads, " << pairs << " pairs each:" << std::endl;
+  std::string prefix = std::to_string(threads) + " threads, ";
+  const bench::Result& new_delete_mt = suite.run(prefix + "new/delete", [&] {
+    run_threaded(threads, [=] { new_delete_rounds(rounds, batch); });
+  }, pairs * threads);
+  const bench::Result& allocator_mt = suite.run(prefix + "PoolAllocator", [&] {
+    run_threaded(threads, [=] { pool_allocator_rounds(rounds, batch); });
+  }, pairs * threads);
+  std::printf("  PoolAllocator %.1fx faster than new/delete\n", new_delete_mt.median_ns / allocator_mt.median_ns);
   
   std::cout << std::endl;
 }
@@ -1065,6 +1155,7 @@ int main() {
   demonstrate_memory_pools();
   demonstrate_memory_best_practices();
   demonstrate_performance_comparison();
+  demonstrate_pool_allocator_performance();
   
   std::cout << "Memory management tutorial completed successfully!" << std::endl;
   std::cout << "Remember: Prefer RAII and smart pointers for safe, efficient code!" << std::endl;
@@ -43,6 +43,11 @@ THEORETICAL FOUNDATION: MEMORY MODEL AND INDIRECTION
 #include <string>
 #include <utility>
 #include <type_traits>
+#include <cstdio>
+
+#include "alloc_counter.h"
+#include "benchmark.h"
+#include "vector_expression.h"
 
 // Forward declarations for function pointer examples
 int add(int a, int b);
@@ -644,6 +649,151 @@ void demonstrate_move_semantics() {
   std::cout << std::endl;
 }
 
+// Eager vector arithmetic, the way it is usually first written: every
+// operator computes its result into a new std::vector
+namespace eager {
+
+using Vector = std::vector<double>;
+
+Vector operator+(const Vector& a, const Vector& b) {
+  Vector result(a.size());
+  for (size_t i = 0; i < a.size(); ++i) result[i] = a[i] + b[i];
+  return result;
+}
+
+Vector operator-(const Vector& a, const Vector& b) {
+  Vector result(a.size());
+  for (size_t i = 0; i < a.size(); ++i) result[i] = a[i] - b[i];
+  return result;
+}
+
+Vector operator*(const Vector& a, const Vector& b) {
+  Vector result(a.size());
+  for (size_t i = 0; i < a.size(); ++i) result[i] = a[i] * b[i];
+  return result;
+}
+
+Vector operator*(const Vector& a, double scale) {
+  Vector result(a.size());
+  for (size_t i = 0; i < a.size(); ++i) result[i] = a[i] * scale;
+  return result;
+}
+
+}  // namespace eager
+
+// The same, plus rvalue overloads: a temporary operand is about to die, so
+// its buffer is reused for the result (moved out, not copied)
+namespace move_aware {
+
+using eager::Vector;
+using eager::operator+;
+using eager::operator-;
+using eager::operator*;
+
+Vector operator+(Vector&& a, const Vector& b) {
+  for (size_t i = 0; i < a.size(); ++i) a[i] += b[i];
+  return std::move(a);
+}
+
+Vector operator+(const Vector& a, Vector&& b) { return std::move(b) + a; }
+
+Vector operator+(Vector&& a, Vector&& b) { return std::move(a) + b; }
+
+Vector operator-(Vector&& a, const Vector& b) {
+  for (size_t i = 0; i < a.size(); ++i) a[i] -= b[i];
+  return std::move(a);
+}
+
+Vector operator*(Vector&& a, double scale) {
+  for (double& x : a) x *= scale;
+  return std::move(a);
+}
+
+}  // namespace move_aware
+
+void demonstrate_expression_templates() {
+  std::cout << "=== MOVES vs EXPRESSION TEMPLATES ===" << std::endl;
+  
+  /*
+  Moves remove the copies of temporaries, but not the temporaries: in
+  r = a + b * c, b * c still has to exist as a whole vector before a can be
+  added to it. math::NumericVector (vector_expression.h) makes b * c a tiny
+  object that only remembers its operands; the assignment to r then runs one
+  loop computing a[i] + b[i] * c[i], straight into r's existing buffer.
+  
+  Per element of doubles, each eager binary operation reads 16 bytes and
+  writes 8; the fused loop reads each operand once and writes once.
+  */
+  
+  const size_t N = 1 << 20;
+  eager::Vector a(N, 1.5), b(N, 2.0), c(N, 3.0), d(N, 0.5), r(N);
+  math::NumericVector<double> va(N, 1.5), vb(N, 2.0), vc(N, 3.0), vd(N, 0.5), vr(N);
+  
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;  // The table below instead
+  bench::Suite suite("pointers_references", options);
+  // Allocations of one evaluation, then the time per element
+  auto row = [&](const char* expression, const char* variant, int bytes_per_element, auto&& evaluate) {
+    memory::AllocationScope scope;
+    evaluate();
+    uint64_t allocations = scope.allocations();
+    uint64_t bytes = scope.bytes();
+    double ns = suite.run(std::string(expression) + " / " + variant, evaluate, N).ns_per_item();
+    printf("  %-22s %-11s %8.2f %7llu %10.1f %9d\n", expression, variant, ns,
+           static_cast<unsigned long long>(allocations), bytes / 1048576.0, bytes_per_element);
+  };
+  
+  printf("  %-22s %-11s %8s %7s %10s %9s\n", "expression", "variant", "ns/elem", "allocs", "MB alloc",
+         "B/elem");
+  // a + b * c: eager is two passes of 24 B, fused reads 3 x 8 and writes 8
+  row("r = a + b * c", "copying", 48, [&] {
+    using namespace eager;
+    r = a + b * c;
+    bench::clobber_memory();
+  });
+  row("", "move-aware", 48, [&] {
+    using namespace move_aware;
+    r = a + b * c;
+    bench::clobber_memory();
+  });
+  row("", "fused", 32, [&] {
+    vr = va + vb * vc;
+    bench::clobber_memory();
+  });
+  // a * 2 + b * c - d: 16 + 24 + 24 + 24 eagerly, 4 reads and 1 write fused
+  row("r = a * 2 + b * c - d", "copying", 88, [&] {
+    using namespace eager;
+    r = a * 2.0 + b * c - d;
+    bench::clobber_memory();
+  });
+  row("", "move-aware", 88, [&] {
+    using namespace move_aware;
+    r = a * 2.0 + b * c - d;
+    bench::clobber_memory();
+  });
+  row("", "fused", 40, [&] {
+    vr = va * 2.0 + vb * vc - vd;
+    bench::clobber_memory();
+  });
+  // dot(a + b, c): eager materializes a + b; fused never stores anything
+  row("dot(a + b, c)", "copying", 40, [&] {
+    using namespace eager;
+    Vector sum = a + b;
+    double total = 0;
+    for (size_t i = 0; i < N; ++i) total += sum[i] * c[i];
+    bench::do_not_optimize(total);
+  });
+  row("", "fused", 24, [&] {
+    bench::do_not_optimize(math::dot(va + vb, vc));
+  });
+  
+  std::cout << "\n  copying: every operator allocates its result. move-aware: rvalue overloads reuse a" << std::endl;
+  std::cout << "  dying operand's buffer, so only operations on named vectors allocate, but every" << std::endl;
+  std::cout << "  operation is still its own pass. fused: one loop, straight into r's buffer." << std::endl;
+  
+  std::cout << std::endl;
+}
+
 // Function pointer examples
 int add(int a, int b) {
   return a + b;
@@ -1447,6 +1597,7 @@ int main() {
   demonstrate_lvalue_rvalue();
   demonstrate_rvalue_references();
   demonstrate_move_semantics();
+  demonstrate_expression_templates();
   demonstrate_function_pointers();
   demonstrate_member_function_pointers();
   demonstrate_std_function();
@@ -22,7 +22,19 @@
 #include <sys/wait.h>
 #include <sys/mman.h>
 #include <fcntl.h>
+#include <spawn.h>
+#include <cerrno>
 #include <cstring>
+#include <algorithm>
+#include <string>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "benchmark.h"
+#include "shm_ring.h"
+#include "work_stealing_pool.h"
+
+extern char** environ;
 
 // Global variables for demonstration
 std::atomic<int> shared_counter{0};
@@ -335,25 +347,22 @@ void demonstrate_thread_creation() {
   const int num_threads = 4;
   std::vector<std::thread> threads;
   
-  auto start_time = std::chrono::high_resolution_clock::now();
-  
-  // Create and start threads
-  for (int i = 0; i < num_threads; ++i) {
-    threads.emplace_back(worker_function, i);
-  }
-  
-  // Wait for all threads to complete
-  for (auto& thread : threads) {
-    thread.join();
-  }
-  
-  auto end_time = std::chrono::high_resolution_clock::now();
-  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+  double ns = bench::time_ns([&] {
+    // Create and start threads
+    for (int i = 0; i < num_threads; ++i) {
+      threads.emplace_back(worker_function, i);
+    }
+    
+    // Wait for all threads to complete
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  });
   
   std::cout << "All threads completed!" << std::endl;
   std::cout << "Final counter value: " << shared_counter.load() << std::endl;
   std::cout << "Expected: " << (num_threads * 1000) << std::endl;
-  std::cout << "Time taken: " << duration.count() << " ms" << std::endl;
+  std::cout << "Time taken: " << bench::format_ns(ns) << std::endl;
   
   std::cout << std::endl;
 }
@@ -522,72 +531,73 @@ void demonstrate_thread_creation_deep_dive() {
   // Performance Analysis
   std::cout << "\n--- Thread Creation Performance Analysis ---" << std::endl;
   
+  bench::Suite suite("processes_threads_creation");
   const int num_test_threads = 10;
-  auto start_time = std::chrono::high_resolution_clock::now();
-  
-  std::vector<std::thread> perf_threads;
-  perf_threads.reserve(num_test_threads);
-  
-  // Measure thread creation time
-  for (int i = 0; i < num_test_threads; ++i) {
-    perf_threads.emplace_back([i]() {
-      // Minimal work to avoid compiler optimizations
-      volatile int x = i * 42;
-      (void)x;
+  std::vector<double> creation_ns, lifecycle_ns;
+  
+  // Creation and the whole lifecycle are two samples of the same run
+  for (int run = -suite.options().warmup; run < suite.options().repetitions; ++run) {
+    std::vector<std::thread> perf_threads;
+    perf_threads.reserve(num_test_threads);
+    double created = 0;
+    double total = bench::time_ns([&] {
+      // Measure thread creation time
+      created = bench::time_ns([&] {
+        for (int i = 0; i < num_test_threads; ++i) {
+          perf_threads.emplace_back([i]() {
+            // Minimal work the compiler must keep
+            int x = i * 42;
+            bench::do_not_optimize(x);
+          });
+        }
+      });
+      
+      // Join all threads
+      for (auto& t : perf_threads) {
+        t.join();
+      }
     });
+    if (run >= 0) {
+      creation_ns.push_back(created);
+      lifecycle_ns.push_back(total);
+    }
   }
   
-  auto creation_time = std::chrono::high_resolution_clock::now();
-  
-  // Join all threads
-  for (auto& t : perf_threads) {
-    t.join();
-  }
-  
-  auto end_time = std::chrono::high_resolution_clock::now();
-  
-  auto creation_us = std::chrono::duration_cast<std::chrono::microseconds>(creation_time - start_time);
-  auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-  
-  std::cout << "Created " << num_test_threads << " threads in " << creation_us.count() << " μs" << std::endl;
-  std::cout << "Average creation time: " << (creation_us.count() / num_test_threads) << " μs per thread" << std::endl;
-  std::cout << "Total lifecycle time: " << total_us.count() << " μs" << std::endl;
+  std::cout << "Per thread, " << num_test_threads << " threads per run:" << std::endl;
+  suite.add("create", creation_ns, num_test_threads);
+  suite.add("create + join (lifecycle)", lifecycle_ns, num_test_threads);
   
   // Thread vs Direct Function Call Overhead
   std::cout << "\n--- Thread Overhead vs Direct Function Calls ---" << std::endl;
   
   auto test_function = []() {
-    volatile int result = 0;
+    int result = 0;
     for (int i = 0; i < 1000; ++i) {
       result += i;
+      bench::do_not_optimize(result);  // Keep all 1000 additions
     }
     return result;
   };
   
   // Time direct function calls
-  start_time = std::chrono::high_resolution_clock::now();
-  for (int i = 0; i < 50; ++i) {
-    test_function();
-  }
-  auto function_time = std::chrono::high_resolution_clock::now() - start_time;
+  const bench::Result& direct = suite.run("50 direct function calls", [&] {
+    for (int i = 0; i < 50; ++i) {
+      test_function();
+    }
+  }, 50);
   
   // Time threaded function calls
-  start_time = std::chrono::high_resolution_clock::now();
-  std::vector<std::thread> overhead_threads;
-  for (int i = 0; i < 50; ++i) {
-    overhead_threads.emplace_back(test_function);
-  }
-  for (auto& t : overhead_threads) {
-    t.join();
-  }
-  auto thread_time = std::chrono::high_resolution_clock::now() - start_time;
-  
-  auto function_us = std::chrono::duration_cast<std::chrono::microseconds>(function_time);
-  auto thread_us = std::chrono::duration_cast<std::chrono::microseconds>(thread_time);
+  const bench::Result& threaded = suite.run("50 threaded calls", [&] {
+    std::vector<std::thread> overhead_threads;
+    for (int i = 0; i < 50; ++i) {
+      overhead_threads.emplace_back(test_function);
+    }
+    for (auto& t : overhead_threads) {
+      t.join();
+    }
+  }, 50);
   
-  std::cout << "50 direct function calls: " << function_us.count() << " μs" << std::endl;
-  std::cout << "50 threaded calls: " << thread_us.count() << " μs" << std::endl;
-  std::cout << "Thread overhead: " << (static_cast<double>(thread_us.count()) / function_us.count()) << "x slower" << std::endl;
+  std::cout << "Thread overhead: " << (threaded.median_ns / direct.median_ns) << "x slower" << std::endl;
   
   std::cout << "\n--- Key Thread Creation Insights ---" << std::endl;
   std::cout << "🧵 Thread creation involves expensive OS kernel calls" << std::endl;
@@ -742,19 +752,19 @@ void demonstrate_atomic_operations() {
     }
   };
   
-  auto start_time = std::chrono::high_resolution_clock::now();
+  bench::Suite suite("processes_threads_counters");
+  const uint64_t increments = static_cast<uint64_t>(num_threads) * num_iterations;
   
-  std::vector<std::thread> atomic_threads;
-  for (int i = 0; i < num_threads; ++i) {
-    atomic_threads.emplace_back(atomic_worker);
-  }
-  
-  for (auto& thread : atomic_threads) {
-    thread.join();
-  }
-  
-  auto end_time = std::chrono::high_resolution_clock::now();
-  auto atomic_duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+  const bench::Result& atomic_result = suite.run_with_setup("atomic fetch_add", [&] { atomic_counter = 0; }, [&] {
+    std::vector<std::thread> atomic_threads;
+    for (int i = 0; i < num_threads; ++i) {
+      atomic_threads.emplace_back(atomic_worker);
+    }
+    
+    for (auto& thread : atomic_threads) {
+      thread.join();
+    }
+  }, increments);
   
   // Mutex counter test
   int mutex_counter = 0;
@@ -767,27 +777,21 @@ void demonstrate_atomic_operations() {
     }
   };
   
-  start_time = std::chrono::high_resolution_clock::now();
-  
-  std::vector<std::thread> mutex_threads;
-  for (int i = 0; i < num_threads; ++i) {
-    mutex_threads.emplace_back(mutex_worker);
-  }
-  
-  for (auto& thread : mutex_threads) {
-    thread.join();
-  }
-  
-  end_time = std::chrono::high_resolution_clock::now();
-  auto mutex_duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+  const bench::Result& mutex_result = suite.run_with_setup("std::mutex + increment", [&] { mutex_counter = 0; }, [&] {
+    std::vector<std::thread> mutex_threads;
+    for (int i = 0; i < num_threads; ++i) {
+      mutex_threads.emplace_back(mutex_worker);
+    }
+    
+    for (auto& thread : mutex_threads) {
+      thread.join();
+    }
+  }, increments);
   
-  std::cout << "Atomic operations time: " << atomic_duration.count() << " ms" << std::endl;
-  std::cout << "Mutex operations time: " << mutex_duration.count() << " ms" << std::endl;
   std::cout << "Atomic counter final value: " << atomic_counter.load() << std::endl;
   std::cout << "Mutex counter final value: " << mutex_counter << std::endl;
-  std::cout << "Performance improvement: " << 
-               (static_cast<double>(mutex_duration.count()) / atomic_duration.count()) 
-               << "x faster" << std::endl;
+  std::cout << "Performance improvement: " << (mutex_result.median_ns / atomic_result.median_ns) << "x faster"
+            << std::endl;
   
   std::cout << std::endl;
 }
@@ -931,6 +935,692 @@ void demonstrate_memory_sharing() {
   std::cout << std::endl;
 }
 
+// IPC channel benchmark: one process streams messages to another, then the
+// two bounce a message back and forth, over a pipe, a UNIX domain socket,
+// loopback UDP and an ipc::ShmRing. The kernel transports copy each
+// message twice (into the kernel and out again) and cost a system call per
+// send and per receive; the ring copies once and hands the receiver a
+// pointer into shared memory.
+namespace IpcBenchmark {
+
+const size_t MESSAGE_SIZES[] = {64, 512, 4096, 65536};
+const size_t STREAM_BYTES = 32 << 20;  // Per throughput run, before clamping
+const size_t MIN_MESSAGES = 2000;
+const size_t MAX_MESSAGES = 200000;
+const int ROUND_TRIPS = 2000;
+const size_t WINDOW = 64;  // Receiver acknowledges every WINDOW messages
+const size_t ACK_SIZE = sizeof(uint64_t);
+const size_t MAX_DATAGRAM = 65507;
+const size_t RING_CAPACITY = 1 << 20;
+
+using Clock = std::chrono::steady_clock;
+
+bool write_full(int fd, const char* data, size_t length) {
+  while (length > 0) {
+    ssize_t n = write(fd, data, length);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    length -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool read_full(int fd, char* buffer, size_t length) {
+  while (length > 0) {
+    ssize_t n = read(fd, buffer, length);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    buffer += n;
+    length -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// A two-way channel between a parent and the child it forks. Every
+// message starts with its 8-byte sequence number.
+class Transport {
+public:
+  virtual ~Transport() = default;
+  virtual const char* name() const = 0;
+  virtual size_t max_message() const { return SIZE_MAX; }
+  virtual bool lossy() const { return false; }
+
+  virtual bool open() = 0;                  // Before fork()
+  virtual void use_end(bool child) = 0;     // After fork(), in both processes
+  virtual void close_all() = 0;
+
+  virtual bool send(const char* data, size_t length) = 0;
+  // The next message, which must be `length` bytes; false on error or timeout
+  virtual bool receive(size_t length, uint64_t& sequence) = 0;
+};
+
+// Byte streams: read exactly one message's worth
+class StreamTransport : public Transport {
+public:
+  bool send(const char* data, size_t length) override { return write_full(send_fd_, data, length); }
+
+  bool receive(size_t length, uint64_t& sequence) override {
+    buffer_.resize(length);
+    if (!read_full(receive_fd_, buffer_.data(), length)) return false;
+    std::memcpy(&sequence, buffer_.data(), sizeof(sequence));
+    return true;
+  }
+
+protected:
+  void close_fds(std::vector<int>& fds) {
+    for (int& fd : fds) {
+      if (fd >= 0) ::close(fd);
+      fd = -1;
+    }
+  }
+
+  int send_fd_ = -1;
+  int receive_fd_ = -1;
+  std::vector<char> buffer_;
+};
+
+class PipeTransport : public StreamTransport {
+public:
+  const char* name() const override { return "pipe"; }
+
+  bool open() override {
+    int down[2], up[2];
+    if (pipe(down) != 0) return false;
+    if (pipe(up) != 0) {
+      ::close(down[0]);
+      ::close(down[1]);
+      return false;
+    }
+    fds_ = {down[0], down[1], up[0], up[1]};
+    return true;
+  }
+
+  void use_end(bool child) override {
+    send_fd_ = child ? fds_[3] : fds_[1];
+    receive_fd_ = child ? fds_[0] : fds_[2];
+  }
+
+  void close_all() override { close_fds(fds_); }
+
+private:
+  std::vector<int> fds_;
+};
+
+class UnixSocketTransport : public StreamTransport {
+public:
+  const char* name() const override { return "unix socket"; }
+
+  bool open() override {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) return false;
+    fds_ = {pair[0], pair[1]};
+    return true;
+  }
+
+  void use_end(bool child) override { send_fd_ = receive_fd_ = fds_[child ? 1 : 0]; }
+  void close_all() override { close_fds(fds_); }
+
+private:
+  std::vector<int> fds_;
+};
+
+// Two connected UDP sockets on 127.0.0.1 (the same setup as udp_server /
+// udp_client). Datagrams keep message boundaries but nothing stops a fast
+// sender from overrunning the receive buffer; a lost datagram shows up as
+// a receive timeout.
+class UdpTransport : public Transport {
+public:
+  const char* name() const override { return "loopback udp"; }
+  size_t max_message() const override { return MAX_DATAGRAM; }
+  bool lossy() const override { return true; }
+
+  bool open() override {
+    sockaddr_in addresses[2];
+    for (int i = 0; i < 2; ++i) {
+      fds_[i] = socket(AF_INET, SOCK_DGRAM, 0);
+      if (fds_[i] < 0) return false;
+      int buffer_size = 4 << 20;
+      setsockopt(fds_[i], SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+      setsockopt(fds_[i], SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+      timeval timeout{0, 500000};
+      setsockopt(fds_[i], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+      sockaddr_in& address = addresses[i];
+      std::memset(&address, 0, sizeof(address));
+      address.sin_family = AF_INET;
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      socklen_t length = sizeof(address);
+      if (bind(fds_[i], reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+          getsockname(fds_[i], reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return false;
+      }
+    }
+    return connect(fds_[0], reinterpret_cast<sockaddr*>(&addresses[1]), sizeof(addresses[1])) == 0 &&
+           connect(fds_[1], reinterpret_cast<sockaddr*>(&addresses[0]), sizeof(addresses[0])) == 0;
+  }
+
+  void use_end(bool child) override { fd_ = fds_[child ? 1 : 0]; }
+
+  void close_all() override {
+    for (int& fd : fds_) {
+      if (fd >= 0) ::close(fd);
+      fd = -1;
+    }
+  }
+
+  bool send(const char* data, size_t length) override {
+    ssize_t n;
+    while ((n = ::send(fd_, data, length, 0)) < 0 && errno == EINTR) {
+    }
+    return n == static_cast<ssize_t>(length);
+  }
+
+  // Datagrams of another size are stragglers from an earlier phase
+  bool receive(size_t length, uint64_t& sequence) override {
+    buffer_.resize(MAX_DATAGRAM);
+    while (true) {
+      ssize_t n = recv(fd_, buffer_.data(), buffer_.size(), 0);
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0) return false;
+      if (static_cast<size_t>(n) != length) continue;
+      std::memcpy(&sequence, buffer_.data(), sizeof(sequence));
+      return true;
+    }
+  }
+
+private:
+  int fds_[2] = {-1, -1};
+  int fd_ = -1;
+  std::vector<char> buffer_;
+};
+
+// One ring per direction. The child inherits both mappings through fork();
+// an unrelated process would open() the rings by name instead.
+class ShmRingTransport : public Transport {
+public:
+  const char* name() const override { return "ipc::ShmRing"; }
+  size_t max_message() const override { return down_.is_open() ? down_.max_message() : RING_CAPACITY / 2 - 8; }
+
+  bool open() override {
+    std::string prefix = "/bootcamp_ipc_" + std::to_string(getpid());
+    return down_.create(prefix + "_down", RING_CAPACITY) && up_.create(prefix + "_up", RING_CAPACITY);
+  }
+
+  void use_end(bool child) override {
+    sender_ = child ? &up_ : &down_;
+    receiver_ = child ? &down_ : &up_;
+  }
+
+  void close_all() override {
+    down_.close();
+    up_.close();
+  }
+
+  bool send(const char* data, size_t length) override { return sender_->send(data, length); }
+
+  // In place: only the sequence number is read out of the ring
+  bool receive(size_t length, uint64_t& sequence) override {
+    bool sized = false;
+    bool received = receiver_->receive([&](const char* data, size_t n) {
+      sized = n == length;
+      std::memcpy(&sequence, data, sizeof(sequence));
+    });
+    return received && sized;
+  }
+
+private:
+  ipc::ShmRing down_;  // Parent -> child
+  ipc::ShmRing up_;    // Child -> parent
+  ipc::ShmRing* sender_ = nullptr;
+  ipc::ShmRing* receiver_ = nullptr;
+};
+
+size_t stream_messages(size_t size) {
+  return std::min(MAX_MESSAGES, std::max(MIN_MESSAGES, STREAM_BYTES / size));
+}
+
+// Child: stream `count` messages (at most two windows ahead of the
+// parent's acknowledgements), then echo ROUND_TRIPS messages
+void run_child(Transport& transport, size_t size) {
+  std::vector<char> message(size, 'x');
+  const size_t count = stream_messages(size);
+  size_t acknowledged = 0;
+  uint64_t ack;
+  for (size_t sequence = 0; sequence < count; ++sequence) {
+    while (sequence >= (acknowledged + 2) * WINDOW) {
+      if (!transport.receive(ACK_SIZE, ack)) break;  // A lost ack must not stall
+      ++acknowledged;
+    }
+    if (sequence >= (acknowledged + 2) * WINDOW) acknowledged = sequence / WINDOW;
+    std::memcpy(message.data(), &sequence, sizeof(sequence));
+    if (!transport.send(message.data(), size)) return;
+  }
+  while (acknowledged < count / WINDOW && transport.receive(ACK_SIZE, ack)) ++acknowledged;
+
+  uint64_t sequence;
+  for (int i = 0; i < ROUND_TRIPS; ++i) {
+    if (!transport.receive(size, sequence)) return;
+    std::memcpy(message.data(), &sequence, sizeof(sequence));
+    if (!transport.send(message.data(), size)) return;
+  }
+}
+
+struct Measurement {
+  bool ok = false;
+  size_t received = 0;
+  size_t expected = 0;
+  double seconds = 0;
+  std::vector<double> round_trips_ns;
+};
+
+// Parent: receive the stream, acknowledging every WINDOW messages, then
+// time the round trips
+Measurement run_parent(Transport& transport, size_t size) {
+  Measurement m;
+  m.expected = stream_messages(size);
+  uint64_t next = 0, sequence, ack = 0;
+  Clock::time_point start;
+  while (m.received < m.expected) {
+    if (!transport.receive(size, sequence)) {
+      if (!transport.lossy()) return m;
+      break;  // The rest was dropped
+    }
+    if (m.received == 0) start = Clock::now();
+    if (sequence < next || (!transport.lossy() && sequence != next)) return m;  // Out of order
+    next = sequence + 1;
+    if (++m.received % WINDOW == 0) {
+      transport.send(reinterpret_cast<const char*>(&ack), ACK_SIZE);
+      ++ack;
+    }
+  }
+  m.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<char> message(size, 'y');
+  for (int i = 0; i < ROUND_TRIPS; ++i) {
+    uint64_t sent = static_cast<uint64_t>(i);
+    std::memcpy(message.data(), &sent, sizeof(sent));
+    auto round_trip_start = Clock::now();
+    if (!transport.send(message.data(), size)) return m;
+    do {
+      if (!transport.receive(size, sequence)) return m;
+    } while (sequence != sent);  // A late duplicate after a timeout
+    m.round_trips_ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - round_trip_start).count());
+  }
+  m.ok = true;
+  return m;
+}
+
+Measurement measure(Transport& transport, size_t size) {
+  Measurement m;
+  if (!transport.open()) {
+    perror(transport.name());
+    transport.close_all();
+    return m;
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    transport.use_end(true);
+    run_child(transport, size);
+    _exit(0);
+  }
+  if (pid > 0) {
+    transport.use_end(false);
+    m = run_parent(transport, size);
+  }
+  transport.close_all();  // Unblocks a child still waiting on us
+  if (pid > 0) {
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+  }
+  return m;
+}
+
+void run() {
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;  // The table below has throughput and latency side by side
+  bench::Suite suite("processes_threads_ipc", options);
+
+  PipeTransport pipe_transport;
+  UnixSocketTransport unix_transport;
+  UdpTransport udp_transport;
+  ShmRingTransport ring_transport;
+  Transport* transports[] = {&pipe_transport, &unix_transport, &udp_transport, &ring_transport};
+
+  printf("  %-14s %7s %12s %11s %11s %11s %7s\n", "transport", "size", "msgs/s", "MB/s", "rtt p50",
+         "rtt p99", "loss");
+  for (size_t size : MESSAGE_SIZES) {
+    for (Transport* transport : transports) {
+      std::string label = std::string(transport->name()) + " " + std::to_string(size) + "B";
+      if (size > transport->max_message()) {
+        printf("  %-14s %7zu %12s\n", transport->name(), size, "n/a (message too large)");
+        continue;
+      }
+      Measurement m = measure(*transport, size);
+      if (!m.ok || m.received < 2) {
+        printf("  %-14s %7zu %12s\n", transport->name(), size, "failed");
+        continue;
+      }
+      double messages_per_second = (m.received - 1) / m.seconds;
+      suite.add(label + " stream", {m.seconds * 1e9}, m.received);
+      const bench::Result& latency = suite.add(label + " round trip", m.round_trips_ns);
+      std::sort(m.round_trips_ns.begin(), m.round_trips_ns.end());
+      printf("  %-14s %7zu %12.0f %11.1f %11s %11s %6.2f%%\n", transport->name(), size, messages_per_second,
+             messages_per_second * size / 1e6, bench::format_ns(latency.median_ns).c_str(),
+             bench::format_ns(bench::percentile(m.round_trips_ns, 99)).c_str(),
+             100.0 * (m.expected - m.received) / m.expected);
+    }
+  }
+}
+
+}  // namespace IpcBenchmark
+
+void demonstrate_ipc_channels() {
+  std::cout << "=== INTER-PROCESS CHANNELS: KERNEL COPIES vs SHARED MEMORY ===" << std::endl;
+
+  // ┌─ Where a message goes ──────────────────────────────────┐
+  // │ pipe / socket:  sender buf ─write()─▶ kernel buffer     │
+  // │                 kernel buffer ─read()─▶ receiver buf    │
+  // │                 2 copies, 2 system calls per message    │
+  // │                                                         │
+  // │ ShmRing:        sender buf ─memcpy─▶ shared ring        │
+  // │                 receiver reads it where it lies         │
+  // │                 1 copy, system calls only to sleep/wake │
+  // └─────────────────────────────────────────────────────────┘
+
+  std::cout << "Child streams messages to the parent, then echoes round trips:" << std::endl;
+  IpcBenchmark::run();
+
+  std::cout << "\n💡 Small messages are dominated by the per-message system calls, which" << std::endl;
+  std::cout << "   the ring avoids while both sides keep up; large ones by the copies" << std::endl;
+  std::cout << "💡 UDP has no flow control: without the acknowledgement window a fast" << std::endl;
+  std::cout << "   sender overruns the receive buffer and datagrams are dropped" << std::endl;
+  std::cout << std::endl;
+}
+
+// Spawn-cost benchmark: what it costs to get code running on another
+// thread or process, one sample per operation so the tail is visible.
+// Creating a thread or process per job is compared with handing the job
+// to something that already exists (a thread pool, a pre-forked worker),
+// and the raw context-switch cost with a token bounced over two pipes.
+namespace SpawnBenchmark {
+
+const int SPAWNS = 200;        // Samples per spawn strategy
+const int DISPATCHES = 2000;   // Samples for pool and pre-forked dispatch
+const int PING_PONGS = 5000;   // Round trips per ping-pong run
+const int PREFORKED_WORKERS = 4;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ns(Clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// One line per strategy: the tail percentiles matter as much as the median
+void report(bench::Suite& suite, const std::string& name, std::vector<double> samples, int operations_per_sample = 1) {
+  for (double& sample : samples) sample /= operations_per_sample;
+  const bench::Result& result = suite.add(name, samples);
+  std::sort(samples.begin(), samples.end());
+  printf("  %-34s %10s %10s %10s %10s\n", name.c_str(), bench::format_ns(result.median_ns).c_str(),
+         bench::format_ns(result.p90_ns).c_str(), bench::format_ns(bench::percentile(samples, 99)).c_str(),
+         bench::format_ns(result.max_ns).c_str());
+}
+
+void wait_child(pid_t pid) {
+  int status;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+  }
+}
+
+void write_byte(int fd, char byte) {
+  while (write(fd, &byte, 1) < 0 && errno == EINTR) {
+  }
+}
+
+// false at end of file
+bool read_byte(int fd, char& byte) {
+  ssize_t n;
+  while ((n = read(fd, &byte, 1)) < 0 && errno == EINTR) {
+  }
+  return n == 1;
+}
+
+std::vector<double> thread_create_join() {
+  std::vector<double> samples;
+  for (int i = 0; i < SPAWNS; ++i) {
+    auto start = Clock::now();
+    std::thread t([] {
+      int x = 42;
+      bench::do_not_optimize(x);
+    });
+    t.join();
+    samples.push_back(elapsed_ns(start));
+  }
+  return samples;
+}
+
+// From post() until the task starts running on a worker. The workers are
+// idle between samples, as in a lightly loaded server, so this includes
+// waking a parked worker.
+std::vector<double> pool_dispatch() {
+  concurrency::WorkStealingPool pool(2);
+  std::vector<double> samples;
+  for (int i = 0; i < DISPATCHES; ++i) {
+    std::atomic<bool> started{false};
+    auto start = Clock::now();
+    double latency = 0;
+    pool.post([&] {
+      latency = elapsed_ns(start);
+      started.store(true, std::memory_order_release);
+    });
+    while (!started.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    samples.push_back(latency);
+  }
+  return samples;
+}
+
+std::vector<double> fork_wait() {
+  std::vector<double> samples;
+  for (int i = 0; i < SPAWNS; ++i) {
+    auto start = Clock::now();
+    pid_t pid = fork();
+    if (pid == 0) _exit(0);
+    if (pid > 0) wait_child(pid);
+    samples.push_back(elapsed_ns(start));
+  }
+  return samples;
+}
+
+// The child borrows the parent's address space (no page tables to copy)
+// and the parent is suspended until it exits or execs. Kept out of line:
+// the child runs on this frame, so the caller's locals stay untouched.
+__attribute__((noinline)) pid_t vfork_and_exit() {
+  pid_t pid = vfork();
+  if (pid == 0) _exit(0);
+  return pid;
+}
+
+std::vector<double> vfork_wait() {
+  std::vector<double> samples;
+  for (int i = 0; i < SPAWNS; ++i) {
+    auto start = Clock::now();
+    pid_t pid = vfork_and_exit();
+    if (pid > 0) wait_child(pid);
+    samples.push_back(elapsed_ns(start));
+  }
+  return samples;
+}
+
+// Starting a real program: fork + exec, against posix_spawn (which glibc
+// implements with a vfork-style clone, so nothing is copied before exec)
+std::vector<double> fork_exec(const char* program) {
+  std::vector<double> samples;
+  for (int i = 0; i < SPAWNS; ++i) {
+    auto start = Clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+      execl(program, program, static_cast<char*>(nullptr));
+      _exit(127);
+    }
+    if (pid > 0) wait_child(pid);
+    samples.push_back(elapsed_ns(start));
+  }
+  return samples;
+}
+
+std::vector<double> posix_spawn_wait(const char* program) {
+  std::vector<double> samples;
+  char* argv[] = {const_cast<char*>(program), nullptr};
+  for (int i = 0; i < SPAWNS; ++i) {
+    auto start = Clock::now();
+    pid_t pid;
+    if (posix_spawn(&pid, program, nullptr, nullptr, argv, environ) == 0) wait_child(pid);
+    samples.push_back(elapsed_ns(start));
+  }
+  return samples;
+}
+
+// Workers forked once up front (the Apache prefork / PostgreSQL model).
+// A job is one byte on a shared pipe, whichever idle worker reads it first
+// answers on the reply pipe; a sample is one request/reply round trip.
+std::vector<double> preforked_round_trip() {
+  int jobs[2], replies[2];
+  if (pipe(jobs) != 0 || pipe(replies) != 0) return {};
+  
+  std::vector<pid_t> workers;
+  for (int w = 0; w < PREFORKED_WORKERS; ++w) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(jobs[1]);
+      close(replies[0]);
+      char job;
+      while (read_byte(jobs[0], job)) {
+        write_byte(replies[1], job);
+      }
+      _exit(0);
+    }
+    if (pid > 0) workers.push_back(pid);
+  }
+  close(jobs[0]);
+  close(replies[1]);
+  
+  std::vector<double> samples;
+  for (int i = 0; i < DISPATCHES; ++i) {
+    char reply;
+    auto start = Clock::now();
+    write_byte(jobs[1], 'j');
+    if (!read_byte(replies[0], reply)) break;
+    samples.push_back(elapsed_ns(start));
+  }
+  
+  close(jobs[1]);  // EOF tells the workers to exit
+  for (pid_t pid : workers) wait_child(pid);
+  close(replies[0]);
+  return samples;
+}
+
+// Bounce one byte between two parties over two pipes. Each round trip is
+// two blocking reads, so on one core it is (at least) two context
+// switches plus the pipe; reported per switch.
+struct PingPong {
+  int to_peer[2];
+  int to_me[2];
+  
+  bool open() { return pipe(to_peer) == 0 && pipe(to_me) == 0; }
+  
+  // The peer's loop: echo every byte until end of file
+  void echo() {
+    char byte;
+    while (read_byte(to_peer[0], byte)) {
+      write_byte(to_me[1], byte);
+    }
+  }
+  
+  std::vector<double> measure() {
+    std::vector<double> samples;
+    char byte = 'p';
+    for (int i = 0; i < PING_PONGS; ++i) {
+      auto start = Clock::now();
+      write_byte(to_peer[1], byte);
+      if (!read_byte(to_me[0], byte)) break;
+      samples.push_back(elapsed_ns(start));
+    }
+    return samples;
+  }
+  
+  void close_all() {
+    for (int fd : {to_peer[0], to_peer[1], to_me[0], to_me[1]}) {
+      if (fd >= 0) close(fd);
+    }
+  }
+};
+
+std::vector<double> thread_ping_pong() {
+  PingPong channel;
+  if (!channel.open()) return {};
+  std::thread peer([&] { channel.echo(); });
+  std::vector<double> samples = channel.measure();
+  close(channel.to_peer[1]);
+  channel.to_peer[1] = -1;
+  peer.join();
+  channel.close_all();
+  return samples;
+}
+
+std::vector<double> process_ping_pong() {
+  PingPong channel;
+  if (!channel.open()) return {};
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(channel.to_peer[1]);
+    channel.echo();
+    _exit(0);
+  }
+  close(channel.to_peer[0]);
+  channel.to_peer[0] = -1;
+  std::vector<double> samples = channel.measure();
+  close(channel.to_peer[1]);
+  channel.to_peer[1] = -1;
+  if (pid > 0) wait_child(pid);
+  channel.close_all();
+  return samples;
+}
+
+void run() {
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;  // The table below has the percentiles
+  bench::Suite suite("processes_threads_spawn", options);
+  
+  printf("  %-34s %10s %10s %10s %10s\n", "", "p50", "p90", "p99", "max");
+  std::cout << "Start something new per job:" << std::endl;
+  report(suite, "std::thread create + join", thread_create_join());
+  report(suite, "fork + _exit + waitpid", fork_wait());
+  report(suite, "vfork + _exit + waitpid", vfork_wait());
+  const char* program = "/bin/true";
+  if (access(program, X_OK) == 0) {
+    report(suite, "fork + exec /bin/true + waitpid", fork_exec(program));
+    report(suite, "posix_spawn /bin/true + waitpid", posix_spawn_wait(program));
+  }
+  
+  std::cout << "Hand the job to something that already runs:" << std::endl;
+  report(suite, "thread pool post -> task start", pool_dispatch());
+  report(suite, "pre-forked worker round trip", preforked_round_trip());
+  
+  std::cout << "Context switch (pipe ping-pong, per switch):" << std::endl;
+  report(suite, "thread <-> thread", thread_ping_pong(), 2);
+  report(suite, "process <-> process", process_ping_pong(), 2);
+  
+  std::cout << "\n💡 Reuse beats creation: a pool dispatch or a pre-forked worker costs about" << std::endl;
+  std::cout << "   one wake-up (a context switch), creating a thread or process costs far more" << std::endl;
+  std::cout << "💡 posix_spawn/vfork avoid copying the parent's page tables, so their cost" << std::endl;
+  std::cout << "   does not grow with the parent's memory size the way fork()'s does" << std::endl;
+}
+
+}  // namespace SpawnBenchmark
+
 void demonstrate_performance_comparison() {
   std::cout << "=== PERFORMANCE COMPARISON: PROCESSES vs THREADS ===" << std::endl;
   
@@ -988,58 +1678,8 @@ void demonstrate_performance_comparison() {
   // │ PERFORMANCE RATIO: Thread switching ~10x faster       │
   // └─────────────────────────────────────────────────────────┘
   
-  std::cout << "\n--- Creation Time Comparison ---" << std::endl;
-  
-  const int num_iterations = 100;
-  
-  // Measure thread creation time
-  auto start_time = std::chrono::high_resolution_clock::now();
-  
-  for (int i = 0; i < num_iterations; ++i) {
-    std::thread t([]() {
-      // Minimal work
-      volatile int x = 42;
-      (void)x;
-    });
-    t.join();
-  }
-  
-  auto end_time = std::chrono::high_resolution_clock::now();
-  auto thread_duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-  
-  std::cout << "Thread creation+join (" << num_iterations << " iterations): " 
-            << thread_duration.count() << " microseconds" << std::endl;
-  std::cout << "Average per thread: " << (thread_duration.count() / num_iterations) 
-            << " microseconds" << std::endl;
-  
-  // Measure process creation time (smaller sample due to overhead)
-  start_time = std::chrono::high_resolution_clock::now();
-  
-  const int process_iterations = 10; // Fewer iterations due to higher cost
-  for (int i = 0; i < process_iterations; ++i) {
-    pid_t pid = fork();
-    if (pid == 0) {
-      // Child process - minimal work
-      exit(0);
-    } else if (pid > 0) {
-      // Parent process - wait for child
-      int status;
-      wait(&status);
-    }
-  }
-  
-  end_time = std::chrono::high_resolution_clock::now();
-  auto process_duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-  
-  std::cout << "Process creation+wait (" << process_iterations << " iterations): " 
-            << process_duration.count() << " microseconds" << std::endl;
-  std::cout << "Average per process: " << (process_duration.count() / process_iterations) 
-            << " microseconds" << std::endl;
-  
-  double speedup = static_cast<double>(process_duration.count()) / process_iterations /
-                   (static_cast<double>(thread_duration.count()) / num_iterations);
-  
-  std::cout << "Threads are approximately " << speedup << "x faster to create" << std::endl;
+  std::cout << "\n--- Spawn and Context-Switch Cost (per operation) ---" << std::endl;
+  SpawnBenchmark::run();
   
   std::cout << std::endl;
 }
@@ -1055,6 +1695,7 @@ int main() {
   demonstrate_thread_synchronization();
   demonstrate_atomic_operations();
   demonstrate_memory_sharing();
+  demonstrate_ipc_channels();
   demonstrate_performance_comparison();
   
   std::cout << "Processes vs Threads tutorial completed successfully!" << std::endl;
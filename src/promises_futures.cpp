@@ -13,9 +13,21 @@
 #include <future>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <stdexcept>
+#include <string>
+#include <system_error>
 #include <vector>
 
+#include "async_future.h"
+#include "benchmark.h"
+#include "work_stealing_pool.h"
+
 // Example 1: Basic promise/future usage
 void basic_example() {
     std::cout << "\n=== Basic Promise/Future Example ===" << std::endl;
@@ -198,7 +210,194 @@ void multiple_futures_example() {
     }
 }
 
-int main() {
+// Example 8: Continuations instead of blocking get() calls
+// async_example() and multiple_futures_example() park the main thread on
+// each get() in turn. concurrency::Future says what to do with a result
+// once it exists; the pool runs it, and only the final get() blocks.
+void continuation_example() {
+    std::cout << "\n=== Continuations (then / when_all) Example ===" << std::endl;
+
+    concurrency::WorkStealingPool pool(4);
+    std::vector<concurrency::Future<int>> futures;
+    for (int i = 1; i <= 3; ++i) {
+        futures.push_back(concurrency::async(pool, [i]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * i));
+            return i * 10;
+        }).then([i](int value) {
+            std::cout << "Task " << i << " completed, continuation got " << value << std::endl;
+            return value;
+        }));
+    }
+
+    // Fan-in: one continuation for all three, no thread waits for it
+    concurrency::Future<int> sum = concurrency::when_all(std::move(futures)).then([](std::vector<int> values) {
+        int total = 0;
+        for (int value : values) total += value;
+        return total;
+    });
+
+    // Exceptions travel down the chain and skip the steps after them
+    concurrency::Future<int> failed = concurrency::async(pool, []() -> int {
+        throw std::runtime_error("Parse error in stage 1");
+    }).then([](int value) {
+        std::cout << "Never printed" << std::endl;
+        return value * 2;
+    });
+
+    std::cout << "Main thread: Graph built, waiting only for the end..." << std::endl;
+    int total = std::move(sum).get();
+    std::cout << "Sum: " << total << std::endl;
+    try {
+        std::move(failed).get();
+    } catch (const std::exception& e) {
+        std::cout << "Caught exception from the chain: " << e.what() << std::endl;
+    }
+}
+
+// Example 9: when_any instead of polling
+// non_blocking_example() wakes up every 500ms to ask "done yet?". when_any
+// completes as soon as the first input does: no polling interval, no wasted
+// wake-ups, and the latency is the task's, not the interval's.
+void when_any_example() {
+    std::cout << "\n=== when_any (first result wins) Example ===" << std::endl;
+
+    concurrency::WorkStealingPool pool(4);
+    const char* mirrors[] = {"mirror-eu", "mirror-us", "mirror-asia"};
+    const int delays_ms[] = {300, 120, 200};
+
+    std::vector<concurrency::Future<std::string>> replies;
+    for (int i = 0; i < 3; ++i) {
+        std::string name = mirrors[i];
+        int delay = delays_ms[i];
+        replies.push_back(concurrency::async(pool, [name, delay]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+            return name;
+        }));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    concurrency::WhenAnyResult<std::string> first = concurrency::when_any(std::move(replies)).get();
+    auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "First reply from " << first.value << " (input " << first.index << ") after " << waited.count()
+              << "ms" << std::endl;
+}
+
+// Example 10: Fan-out / fan-in benchmark against std::async
+// A graph of `tasks` leaves, each followed by a continuation, all joined by
+// one final sum. std::async has no continuations, so each dependent step
+// is a thread blocked in get() on the step before it: 2 * tasks threads
+// in all, bounded by a window of chains in flight (see run_std_async).
+// The Future version runs on a fixed set of pool threads.
+namespace FanOutBenchmark {
+
+// A few hundred nanoseconds of arithmetic per leaf
+uint64_t leaf_work(uint64_t seed) {
+    uint64_t x = seed + 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 64; ++i) {
+        x ^= x >> 31;
+        x *= 0xBF58476D1CE4E5B9ull;
+    }
+    return x;
+}
+
+uint64_t continuation_work(uint64_t value) { return value >> 7; }
+
+uint64_t expected_sum(size_t tasks) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < tasks; ++i) sum += continuation_work(leaf_work(i));
+    return sum;
+}
+
+// All `tasks` chains at once needs 2 * tasks threads, more than most
+// systems allow, so at most `in_flight` chains exist at a time: when the
+// window is full, the oldest is collected before the next is started
+uint64_t run_std_async(size_t tasks, size_t in_flight) {
+    std::deque<std::future<uint64_t>> chains;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < tasks; ++i) {
+        if (chains.size() == in_flight) {
+            sum += chains.front().get();
+            chains.pop_front();
+        }
+        std::future<uint64_t> leaf = std::async(std::launch::async, [i] { return leaf_work(i); });
+        chains.push_back(std::async(std::launch::async, [leaf = std::move(leaf)]() mutable {
+            return continuation_work(leaf.get());
+        }));
+    }
+    for (auto& chain : chains) sum += chain.get();
+    return sum;
+}
+
+uint64_t run_continuations(concurrency::WorkStealingPool& pool, size_t tasks) {
+    std::vector<concurrency::Future<uint64_t>> chains;
+    chains.reserve(tasks);
+    for (size_t i = 0; i < tasks; ++i) {
+        chains.push_back(concurrency::async(pool, [i] { return leaf_work(i); }).then(continuation_work));
+    }
+    return concurrency::when_all(std::move(chains))
+        .then([](std::vector<uint64_t> values) {
+            uint64_t sum = 0;
+            for (uint64_t value : values) sum += value;
+            return sum;
+        })
+        .get();
+}
+
+void run(size_t tasks) {
+    std::cout << "\n=== Fan-out/fan-in of " << tasks << " tasks: Future vs std::async ===" << std::endl;
+    const uint64_t expected = expected_sum(tasks);
+    bool correct = true;
+
+    // A std::async run takes seconds, so fewer repetitions than usual
+    bench::Options options;
+    options.warmup = 0;
+    options.repetitions = 3;
+    bench::Suite suite("futures_fan_out", bench::Options::from_environment(options));
+    concurrency::WorkStealingPool pool;
+    const bench::Result& pooled = suite.run(
+        "Future::then + when_all (pool)",
+        [&] { correct &= run_continuations(pool, tasks) == expected; }, tasks);
+
+    // Unbounded first, for the record; it usually runs out of threads
+    try {
+        correct &= run_std_async(tasks, tasks) == expected;
+        std::printf("  std::async with all %zu chains in flight: ok\n", tasks);
+    } catch (const std::system_error& e) {
+        std::printf("  std::async with all %zu chains in flight: %s\n", tasks, e.what());
+    }
+
+    const size_t in_flight = std::min<size_t>(tasks, 1024);
+    const bench::Result& threads = suite.run(
+        "std::async, " + std::to_string(in_flight) + " chains in flight",
+        [&] { correct &= run_std_async(tasks, in_flight) == expected; }, tasks);
+
+    std::printf("  Pool: %zu threads; std::async: %zu threads per run\n", pool.size(), 2 * tasks);
+    std::printf("  Speedup: %.1fx\n", threads.median_ns / pooled.median_ns);
+    std::printf("  Results %s\n", correct ? "match" : "DO NOT MATCH");
+}
+
+}  // namespace FanOutBenchmark
+
+// Usage: promises_futures [--bench] [--tasks N]
+// --bench runs only the fan-out benchmark (default 100000 tasks)
+int main(int argc, char* argv[]) {
+    bool bench_only = false;
+    size_t tasks = 100000;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bench") == 0) {
+            bench_only = true;
+        } else if (std::strcmp(argv[i], "--tasks") == 0 && i + 1 < argc) {
+            tasks = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--bench] [--tasks N]" << std::endl;
+            return 1;
+        }
+    }
+    if (bench_only) {
+        FanOutBenchmark::run(tasks);
+        return 0;
+    }
+
     std::cout << "C++ Promises and Futures Tutorial" << std::endl;
     std::cout << "==================================" << std::endl;
     
@@ -209,6 +408,9 @@ int main() {
     custom_type_example();
     packaged_task_example();
     multiple_futures_example();
+    continuation_example();
+    when_any_example();
+    FanOutBenchmark::run(tasks);
     
     std::cout << "\nAll examples completed!" << std::endl;
     return 0;
@@ -27,6 +27,22 @@
 #include <shared_mutex>
 // Includes the thread library header.
 #include <thread>
+// Includes headers used by the scaling benchmark at the bottom.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "cache_line.h"
+#include "distributed_rw_lock.h"
+#include "rcu.h"
+#include "seqlock.h"
 
 // Defining a global count variable and a shared mutex to be used by all threads.
 // The std::shared_mutex is a mutex that allows for shared locking, as well as
@@ -49,18 +65,60 @@ void write_value() {
   count += 3;
 }
 
-// The main method constructs six thread objects and has two of them run the
-// write_value function, and four of them run the read_value function, all
-// in parallel. This means that the output is not deterministic, depending
-// on which threads grab the lock first. Run the program a few times, and
-// see if you can get different outputs.
-int main() {
-  std::thread t1(read_value);
-  std::thread t2(write_value);
-  std::thread t3(read_value);
-  std::thread t4(read_value);
-  std::thread t5(write_value);
-  std::thread t6(read_value);
+// std::shared_mutex still keeps a single reader count, so every
+// shared_lock above writes the same cache line. With many cores reading at
+// once that line bounces between them, and adding readers makes reads
+// slower. The two locks below avoid that for read-mostly data.
+
+// concurrency::DistributedRwLock is a drop-in replacement for the
+// std::shared_mutex: each reader thread counts itself in a slot on its own
+// cache line, and only writers look at all the slots.
+concurrency::DistributedRwLock dm;
+
+void read_value_distributed() {
+  std::shared_lock lk(dm);
+  std::cout << "Reading value " + std::to_string(count) + "\n" << std::flush;
+}
+
+void write_value_distributed() {
+  std::unique_lock lk(dm);
+  count += 3;
+}
+
+// concurrency::SeqLock holds the value itself. Readers take no lock at all:
+// they copy the value and retry if a write happened during the copy, so it
+// suits small values that are copied cheaply.
+concurrency::SeqLock<int> seq_count;
+
+void read_value_seqlock() {
+  std::cout << "Reading value " + std::to_string(seq_count.load()) + "\n" << std::flush;
+}
+
+void write_value_seqlock() {
+  seq_count.update([](int& value) { value += 3; });
+}
+
+// concurrency::RcuCell publishes immutable copies: a reader loads a pointer
+// inside an epoch-marked section and never waits or retries, and a writer
+// swaps in a new copy and frees the old one once no reader can hold it.
+concurrency::RcuCell<int> rcu_count;
+
+void read_value_rcu() {
+  std::cout << "Reading value " + std::to_string(*rcu_count.read()) + "\n" << std::flush;
+}
+
+void write_value_rcu() {
+  rcu_count.update([](int& value) { value += 3; });
+}
+
+// Runs two writers and four readers of one flavour, like main() does below.
+void run_readers_and_writers(void (*read)(), void (*write)()) {
+  std::thread t1(read);
+  std::thread t2(write);
+  std::thread t3(read);
+  std::thread t4(read);
+  std::thread t5(write);
+  std::thread t6(read);
 
   t1.join();
   t2.join();
@@ -68,6 +126,223 @@ int main() {
   t4.join();
   t5.join();
   t6.join();
+}
+
+// Scaling benchmark: every thread reads a 32-byte snapshot and, with
+// probability write_percent, updates it instead. Writers keep the four
+// fields equal, so a reader that sees them differ has read a torn value.
+struct Snapshot {
+  uint64_t a, b, c, d;
+};
 
+struct ScalingConfig {
+  int max_threads = 64;
+  int duration_ms = 20;
+  int trials = 3;
+};
+
+template <typename Read, typename Write>
+double run_mix(int threads, int write_percent, int duration_ms, Read read, Write write, uint64_t& torn) {
+  std::vector<CachePadded<uint64_t>> ops(threads);
+  std::atomic<uint64_t> torn_reads{0};
+  std::atomic<bool> go{false};
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      uint64_t rng = 0x9E3779B97F4A7C15ULL * (t + 1);
+      uint64_t done = 0;
+      uint64_t bad = 0;
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      while (!stop.load(std::memory_order_relaxed)) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        if (static_cast<int>(rng % 100) < write_percent) {
+          write();
+        } else {
+          Snapshot snapshot = read();
+          if (snapshot.a != snapshot.b || snapshot.b != snapshot.c || snapshot.c != snapshot.d) ++bad;
+        }
+        ++done;
+      }
+      *ops[t] = done;
+      torn_reads.fetch_add(bad);
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+  stop.store(true, std::memory_order_relaxed);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  uint64_t total = 0;
+  for (auto& n : ops) total += *n;
+  torn += torn_reads.load();
+  return total / seconds;
+}
+
+// Median ops/s over the trials; per-trial ns/op go to the suite
+template <typename Make>
+double measure_mix(bench::Suite& suite, const std::string& name, int threads, int write_percent,
+                   const ScalingConfig& config, Make make, uint64_t& torn) {
+  std::vector<double> rates;
+  std::vector<double> ns_per_op;
+  for (int trial = 0; trial < config.trials; ++trial) {
+    auto state = make();
+    double rate = run_mix(threads, write_percent, config.duration_ms, [&] { return state->read(); },
+                          [&] { state->write(); }, torn);
+    rates.push_back(rate);
+    ns_per_op.push_back(1e9 / rate);
+  }
+  std::sort(rates.begin(), rates.end());
+  suite.add(name + " t=" + std::to_string(threads) + " writes=" + std::to_string(write_percent) + "%", ns_per_op);
+  return rates[rates.size() / 2];
+}
+
+template <typename Mutex>
+struct LockedSnapshot {
+  Mutex mutex;
+  Snapshot snapshot{};
+  Snapshot read() {
+    std::shared_lock lk(mutex);
+    return snapshot;
+  }
+  void write() {
+    std::unique_lock lk(mutex);
+    ++snapshot.a;
+    ++snapshot.b;
+    ++snapshot.c;
+    ++snapshot.d;
+  }
+};
+
+// Readers copy out of the published snapshot; a write copies it, edits the
+// copy and waits one grace period before freeing the old one
+struct RcuSnapshot {
+  concurrency::RcuCell<Snapshot> snapshot;
+  Snapshot read() { return *snapshot.read(); }
+  void write() {
+    snapshot.update([](Snapshot& s) {
+      ++s.a;
+      ++s.b;
+      ++s.c;
+      ++s.d;
+    });
+  }
+};
+
+// The standard library's lock-free-looking alternative: every read copies
+// a shared_ptr, i.e. increments and decrements the same reference count.
+// C++20 has std::atomic<std::shared_ptr>; C++17 has the atomic_load /
+// atomic_store overloads it replaced (in libstdc++ both take a lock).
+struct AtomicSharedPtrSnapshot {
+#if defined(__cpp_lib_atomic_shared_ptr)
+  std::atomic<std::shared_ptr<const Snapshot>> current{std::make_shared<const Snapshot>()};
+  std::shared_ptr<const Snapshot> load() const { return current.load(std::memory_order_acquire); }
+  void store(std::shared_ptr<const Snapshot> next) { current.store(std::move(next), std::memory_order_release); }
+#else
+  std::shared_ptr<const Snapshot> current = std::make_shared<const Snapshot>();
+  std::shared_ptr<const Snapshot> load() const { return std::atomic_load(&current); }
+  void store(std::shared_ptr<const Snapshot> next) { std::atomic_store(&current, std::move(next)); }
+#endif
+  std::mutex writer;
+
+  Snapshot read() { return *load(); }
+  void write() {
+    std::lock_guard<std::mutex> lk(writer);
+    auto next = std::make_shared<Snapshot>(*load());
+    ++next->a;
+    ++next->b;
+    ++next->c;
+    ++next->d;
+    store(std::move(next));
+  }
+};
+
+struct SeqLockSnapshot {
+  concurrency::SeqLock<Snapshot> snapshot;
+  Snapshot read() { return snapshot.load(); }
+  void write() {
+    snapshot.update([](Snapshot& s) {
+      ++s.a;
+      ++s.b;
+      ++s.c;
+      ++s.d;
+    });
+  }
+};
+
+void benchmark_read_scaling(const ScalingConfig& config) {
+  std::cout << "\nRead scaling, " << config.duration_ms << "ms per trial, median of " << config.trials
+            << " trials (Mops/s, all threads):\n";
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;
+  bench::Suite suite("rwlock_scaling", options);
+  uint64_t torn = 0;
+
+  std::vector<int> thread_counts;
+  for (int n = 1; n < config.max_threads; n *= 2) thread_counts.push_back(n);
+  thread_counts.push_back(config.max_threads);
+
+  for (int write_percent : {0, 1, 10}) {
+    std::printf("\n%d%% writes\n  %7s %14s %14s %14s %14s %14s\n", write_percent, "threads", "shared_mutex",
+                "distributed", "seqlock", "rcu", "atomic_sp");
+    for (int threads : thread_counts) {
+      double shared = measure_mix(suite, "shared_mutex", threads, write_percent, config,
+                                  [] { return std::make_unique<LockedSnapshot<std::shared_mutex>>(); }, torn);
+      double distributed = measure_mix(suite, "DistributedRwLock", threads, write_percent, config,
+                                       [] { return std::make_unique<LockedSnapshot<concurrency::DistributedRwLock>>(); },
+                                       torn);
+      double seqlock = measure_mix(suite, "SeqLock", threads, write_percent, config,
+                                   [] { return std::make_unique<SeqLockSnapshot>(); }, torn);
+      double rcu = measure_mix(suite, "RcuCell", threads, write_percent, config,
+                               [] { return std::make_unique<RcuSnapshot>(); }, torn);
+      double shared_ptr = measure_mix(suite, "atomic<shared_ptr>", threads, write_percent, config,
+                                      [] { return std::make_unique<AtomicSharedPtrSnapshot>(); }, torn);
+      std::printf("  %7d %14.2f %14.2f %14.2f %14.2f %14.2f\n", threads, shared / 1e6, distributed / 1e6,
+                  seqlock / 1e6, rcu / 1e6, shared_ptr / 1e6);
+    }
+  }
+  std::cout << "Torn reads: " << torn << " (must be 0)\n";
+}
+
+// The main method constructs six thread objects and has two of them run the
+// write_value function, and four of them run the read_value function, all
+// in parallel. This means that the output is not deterministic, depending
+// on which threads grab the lock first. Run the program a few times, and
+// see if you can get different outputs. It then repeats the same with the
+// distributed lock, the seqlock and RCU, and measures how they scale next
+// to std::atomic<std::shared_ptr>.
+int main(int argc, char* argv[]) {
+  ScalingConfig config;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--threads" && i + 1 < argc) {
+      config.max_threads = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--duration-ms" && i + 1 < argc) {
+      config.duration_ms = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--trials" && i + 1 < argc) {
+      config.trials = std::max(1, std::atoi(argv[++i]));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--threads N] [--duration-ms MS] [--trials N]\n";
+      return 1;
+    }
+  }
+
+  run_readers_and_writers(read_value, write_value);
+
+  std::cout << "With DistributedRwLock:\n";
+  run_readers_and_writers(read_value_distributed, write_value_distributed);
+
+  std::cout << "With SeqLock:\n";
+  run_readers_and_writers(read_value_seqlock, write_value_seqlock);
+
+  std::cout << "With RcuCell:\n";
+  run_readers_and_writers(read_value_rcu, write_value_rcu);
+
+  benchmark_read_scaling(config);
   return 0;
-}
\ No newline at end of file
+}
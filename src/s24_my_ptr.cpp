@@ -39,7 +39,7 @@ class Pointer {
   Pointer<T> &operator=(const Pointer<T> &) = delete;
 
   // Add move constructor: useful when we need to EXTEND the lifetime of an object!
-  Pointer<T>(Pointer<T> &&another) : ptr_(another.ptr_) { another.ptr_ = nullptr; }
+  Pointer(Pointer<T> &&another) : ptr_(another.ptr_) { another.ptr_ = nullptr; }
   // Add move assign operator: useful when we need to EXTEND the lifetime of an object!
   Pointer<T> &operator=(Pointer<T> &&another) {
     if (ptr_ == another.ptr_) {  // In case `p = std::move(p);`
@@ -23,8 +23,126 @@
 #include <iostream>
 // Includes the set container library header.
 #include <set>
+// Includes the timers, random numbers and helpers used by the benchmark at
+// the end of this file.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
 
-int main() {
+// Includes containers::FlatSet / FlatMap (sorted vectors) and
+// containers::BTreeSet (a B-tree with cache-line-sized nodes).
+#include "btree_set.h"
+#include "flat_set.h"
+
+// Counts the bytes std::set requests for its nodes, so that the benchmark
+// can report memory per element.
+inline size_t g_set_bytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &) {}
+
+  T *allocate(size_t n) {
+    g_set_bytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T *ptr, size_t n) {
+    g_set_bytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(ptr, n);
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U> &) const { return true; }
+  template <typename U>
+  bool operator!=(const CountingAllocator<U> &) const { return false; }
+};
+
+template <typename Fn>
+double NanosPerOp(size_t ops, Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return ns / static_cast<double>(ops);
+}
+
+// Builds a set from `keys`, then times random lookups (half of them
+// misses), a full in-order iteration and, for mutable sets, erasing half
+// of the keys. Negative times mean "not measured".
+template <typename Set, typename Build, typename Bytes>
+void BenchmarkSet(const char *name, const std::vector<int> &keys, const std::vector<int> &probes,
+                  bool measure_erase, Build build, Bytes bytes) {
+  Set set;
+  double build_ns = NanosPerOp(keys.size(), [&] { build(set, keys); });
+  double bytes_per_elem = static_cast<double>(bytes(set)) / set.size();
+
+  size_t hits = 0;
+  double find_ns = NanosPerOp(probes.size(), [&] {
+    for (int key : probes) hits += (set.find(key) != set.end());
+  });
+
+  long long sum = 0;
+  double iterate_ns = NanosPerOp(set.size(), [&] {
+    for (int value : set) sum += value;
+  });
+
+  double erase_ns = -1;
+  if (measure_erase) {
+    erase_ns = NanosPerOp(keys.size() / 2, [&] {
+      for (size_t i = 0; i < keys.size(); i += 2) set.erase(keys[i]);
+    });
+  }
+
+  std::printf("  %-22s %9.1f %9.1f %9.2f ", name, build_ns, find_ns, iterate_ns);
+  if (erase_ns >= 0) {
+    std::printf("%9.1f", erase_ns);
+  } else {
+    std::printf("%9s", "O(n)");
+  }
+  std::printf(" %10.1f   (hits %zu, sum %lld)\n", bytes_per_elem, hits, sum);
+}
+
+void BenchmarkSets(size_t n) {
+  std::mt19937 rng(7);
+  // Distinct keys in random order: the even numbers below 2n, shuffled.
+  // Probes mix those with odd numbers, which are always misses.
+  std::vector<int> keys(n);
+  for (size_t i = 0; i < n; ++i) keys[i] = static_cast<int>(2 * i);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  std::vector<int> probes(n);
+  for (size_t i = 0; i < n; ++i) probes[i] = static_cast<int>(rng() % (2 * n));
+
+  using StdSet = std::set<int, std::less<int>, CountingAllocator<int>>;
+  using BTree1 = containers::BTreeSet<int, std::less<int>, CACHE_LINE_SIZE>;
+  using BTree4 = containers::BTreeSet<int>;
+
+  auto insert_each = [](auto &set, const std::vector<int> &values) {
+    for (int value : values) set.insert(value);
+  };
+  auto node_bytes = [](const auto &set) { return set.memory_bytes(); };
+
+  std::printf("\nSet of %zu ints (times in ns per element / lookup):\n", n);
+  std::printf("  %-22s %9s %9s %9s %9s %10s\n", "container", "build", "find", "iterate", "erase", "bytes/elem");
+  g_set_bytes = 0;
+  BenchmarkSet<StdSet>("std::set", keys, probes, true, insert_each, [](const StdSet &) { return g_set_bytes; });
+  BenchmarkSet<containers::FlatSet<int>>(
+      "FlatSet (bulk insert)", keys, probes, false,
+      [](containers::FlatSet<int> &set, const std::vector<int> &values) { set.insert(values.begin(), values.end()); },
+      node_bytes);
+  BenchmarkSet<BTree1>("BTreeSet (64B nodes)", keys, probes, true, insert_each, node_bytes);
+  BenchmarkSet<BTree4>("BTreeSet (256B nodes)", keys, probes, true, insert_each, node_bytes);
+  std::printf("  (std::set bytes are what it requests; malloc adds its own header per node)\n");
+}
+
+int main(int argc, char *argv[]) {
   // We can declare a int set with the following syntax.
   std::set<int> int_set;
 
@@ -113,5 +231,57 @@ int main() {
   // We discuss more stylistic and readable ways of iterating through C++ STL
   // containers in auto.cpp! Check it out if you are interested.
 
+  // std::set is a red-black tree: every element lives in its own heap node
+  // with three pointers and a colour beside it. Two alternatives keep
+  // elements packed together instead.
+  //
+  // containers::FlatSet keeps its elements in one sorted std::vector.
+  // Lookups are binary searches and iteration is a plain array scan, but
+  // inserting a single element shifts everything after it, so it suits
+  // data that is built once and then read. Bulk insert sorts and merges
+  // all new elements in one pass.
+  std::cout << "\n=== FLAT SET (SORTED VECTOR) ===\n";
+  containers::FlatSet<int> flat_set;
+  std::vector<int> batch = {42, 7, 19, 7, 3, 88, 19};
+  flat_set.insert(batch.begin(), batch.end());
+  flat_set.insert(11);
+  flat_set.erase(88);
+  std::cout << "flat_set contents: ";
+  for (const int &elem : flat_set) {
+    std::cout << elem << " ";
+  }
+  std::cout << "\nElement 19 is " << (flat_set.count(19) == 1 ? "in" : "not in") << " flat_set.\n";
+
+  // containers::FlatMap is the same idea for key-value pairs.
+  containers::FlatMap<std::string, int> flat_map = {{"spam", 1}, {"eggs", 2}};
+  flat_map["bacon"] = 5;
+  std::cout << "flat_map contents: ";
+  for (const auto &pair : flat_map) {
+    std::cout << "(" << pair.first << ", " << pair.second << ") ";
+  }
+  std::cout << "\n";
+
+  // containers::BTreeSet stores dozens of sorted keys per node, and each
+  // node spans a few cache lines. A lookup among a million keys touches
+  // about four nodes instead of about twenty, while inserts and erases stay
+  // O(log n). The code below is the same as the std::set code above.
+  std::cout << "\n=== B-TREE SET ===\n";
+  containers::BTreeSet<int> btree_set;
+  for (int i = 1; i <= 1000; ++i) {
+    btree_set.insert(i);
+  }
+  btree_set.erase(4);
+  btree_set.erase(btree_set.begin());
+  btree_set.erase(btree_set.find(11), btree_set.end());
+  std::cout << "btree_set contents: ";
+  for (const int &elem : btree_set) {
+    std::cout << elem << " ";
+  }
+  std::cout << "\n" << containers::BTreeSet<int>::NODE_CAPACITY << " ints per node\n";
+
+  // Benchmark; pass a different element count as argv[1].
+  size_t n = (argc > 1) ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+  BenchmarkSets(n);
+
   return 0;
 }
\ No newline at end of file
@@ -16,6 +16,15 @@
 #include <memory>
 // Includes the utility header for std::move.
 #include <utility>
+// Includes printf and std::vector for the measurements at the end.
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "benchmark.h"
+#include "fixed_pool.h"
+#include "intrusive_ptr.h"
 
 // Basic point class. (Will use later)
 class Point {
@@ -47,6 +56,81 @@ void copy_shared_ptr_in_function(std::shared_ptr<Point> point) {
             << std::endl;
 }
 
+// std::shared_ptr is not the only way to share ownership. An intrusive
+// pointer (intrusive_ptr.h) keeps the reference count inside the object
+// itself, and the count can be a plain integer when the object never leaves
+// one thread. This Point counts itself; the policies choose an atomic or
+// plain count and a heap or pool allocation.
+template <typename Count, typename Allocation>
+class CountedPoint : public memory::RefCounted<CountedPoint<Count, Allocation>, Count, Allocation>,
+                     public Point {
+public:
+  using Point::Point;
+};
+
+// Creation cost, heap use per object and copy cost of one pointer type
+template <typename Make>
+void measure_pointer(bench::Suite &suite, const char *name, Make make) {
+  const size_t OBJECTS = 100000;
+  using Ptr = decltype(make());
+  std::vector<Ptr> owners;
+  owners.reserve(OBJECTS);
+
+  double create_ns = suite.run(std::string(name) + " / create+destroy", [&] {
+    for (size_t i = 0; i < OBJECTS; ++i) owners.push_back(make());
+    owners.clear();
+  }, OBJECTS).ns_per_item();
+
+  memory::AllocationScope scope;
+  for (size_t i = 0; i < OBJECTS; ++i) owners.push_back(make());
+  double allocations = static_cast<double>(scope.allocations()) / OBJECTS;
+  double bytes = static_cast<double>(scope.bytes()) / OBJECTS;
+  owners.clear();
+
+  // Copying one pointer many times: each copy is an increment, each
+  // destruction a decrement (and, for the atomic counts, a locked instruction)
+  Ptr shared = make();
+  double copy_ns = suite.run(std::string(name) + " / copy+destroy", [&] {
+    for (size_t i = 0; i < OBJECTS; ++i) owners.push_back(shared);
+    owners.clear();
+  }, OBJECTS).ns_per_item();
+
+  printf("  %-38s %9.1f %9.1f %8.2f %9.1f %6zu\n", name, create_ns, copy_ns, allocations, bytes, sizeof(Ptr));
+}
+
+void measure_reference_counting() {
+  using AtomicHeapPoint = CountedPoint<memory::AtomicCount, memory::HeapAllocation>;
+  using LocalHeapPoint = CountedPoint<memory::LocalCount, memory::HeapAllocation>;
+  using LocalPoolPoint = CountedPoint<memory::LocalCount, memory::PoolAllocation>;
+
+  // libstdc++ skips shared_ptr's atomic instructions while the process has
+  // only ever had one thread. Any server has more, so start one first.
+  std::thread([] {}).join();
+
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;  // The table below instead
+  bench::Suite suite("shared_ptr", options);
+  printf("  %-38s %9s %9s %8s %9s %6s\n", "ns per object / pointer", "create", "copy", "allocs",
+         "heap B", "size");
+  measure_pointer(suite, "shared_ptr(new Point)", [] { return std::shared_ptr<Point>(new Point(1, 2)); });
+  measure_pointer(suite, "make_shared<Point>", [] { return std::make_shared<Point>(1, 2); });
+  measure_pointer(suite, "allocate_shared<Point>(PoolAllocator)", [] {
+    return std::allocate_shared<Point>(memory::PoolAllocator<Point>(), 1, 2);
+  });
+  measure_pointer(suite, "IntrusivePtr, atomic count, heap", [] {
+    return memory::make_intrusive<AtomicHeapPoint>(1, 2);
+  });
+  measure_pointer(suite, "IntrusivePtr, plain count, heap", [] {
+    return memory::make_intrusive<LocalHeapPoint>(1, 2);
+  });
+  measure_pointer(suite, "IntrusivePtr, plain count, pool", [] {
+    return memory::make_intrusive<LocalPoolPoint>(1, 2);
+  });
+  std::cout << "  heap B: bytes requested from operator new per object (pool blocks come from slabs" << std::endl;
+  std::cout << "  shared by many objects); size: bytes per pointer. The object itself is "
+            << sizeof(Point) << " bytes." << std::endl;
+}
+
 int main() {
   // This is how to initialize an empty shared pointer of type
   // std::shared_ptr<Point>.
@@ -145,5 +229,11 @@ int main() {
                "after calling copy_shared_ptr_in_function: "
             << s2.use_count() << std::endl;
 
+  // Finally, what shared ownership costs, with shared_ptr and with an
+  // intrusive count. The plain count is for objects that one thread owns
+  // (such as a per-core shard's); shared_ptr's count is always atomic.
+  std::cout << "\nReference counting costs:" << std::endl;
+  measure_reference_counting();
+
   return 0;
 }
@@ -18,6 +18,12 @@
 #include <cctype>    // For character classification functions
 #include <stack>     // For stack-based reversal
 #include <functional> // For std::function
+#include <climits>    // For CHAR_MIN / CHAR_MAX
+
+#include "benchmark.h"          // Suite, do_not_optimize
+#include "inline_string.h"      // containers::InlineString
+#include "simd_kernels.h"       // Vectorized case conversion and reversal
+#include "string_algorithms.h"  // strings::split, find_first_of, ...
 
 void demonstrate_character_types() {
   std::cout << "=== CHARACTER TYPES AND PROPERTIES ===" << std::endl;
@@ -304,6 +310,13 @@ void demonstrate_string_methods() {
   std::transform(lower_text.begin(), lower_text.end(), lower_text.begin(), ::tolower);
   std::cout << "Lowercase: '" << lower_text << "'" << std::endl;
   
+  // The same conversion 16-64 bytes at a time (ASCII only, locale-independent)
+  std::string simd_text = text;
+  simd::to_upper(&simd_text[0], simd_text.size());
+  std::cout << "simd::to_upper (" << simd::isa_name(simd::kernels().isa) << "): '" << simd_text << "'" << std::endl;
+  simd::to_lower(&simd_text[0], simd_text.size());
+  std::cout << "simd::to_lower: '" << simd_text << "'" << std::endl;
+  
   std::cout << std::endl;
 }
 
@@ -612,6 +625,12 @@ void demonstrate_string_reversal() {
   }
   std::cout << "Result: '" << method8 << "'" << std::endl;
   
+  // Method 8b: Vector shuffles reverse a whole register of bytes at once
+  std::cout << "\nMethod 8b - Using simd::reverse (" << simd::isa_name(simd::kernels().isa) << "):" << std::endl;
+  std::string method8b = original;
+  simd::reverse(&method8b[0], method8b.size());
+  std::cout << "Result: '" << method8b << "'" << std::endl;
+  
   // Demonstrating reversal of C-style strings
   std::cout << "\n--- C-Style String Reversal ---" << std::endl;
   char cstr[] = "C++ Programming";
@@ -660,12 +679,7 @@ void demonstrate_string_reversal() {
   std::cout << "Each word reversed: '" << each_word_reversed << "'" << std::endl;
   
   // Performance comparison
-  std::cout << "\n--- Performance Notes ---" << std::endl;
-  std::cout << "1. std::reverse() - Fastest, optimized by compiler" << std::endl;
-  std::cout << "2. Manual swap with iterators - Very fast, good for learning" << std::endl;
-  std::cout << "3. Reverse iterator constructor - Fast, creates new string" << std::endl;
-  std::cout << "4. Character-by-character building - Slower due to string reallocations" << std::endl;
-  std::cout << "5. Recursive approach - Slowest, high memory usage (not recommended for large strings)" << std::endl;
+  std::cout << "\n(These methods are timed against each other in PERFORMANCE COMPARISON below)" << std::endl;
   
   std::cout << std::endl;
 }
@@ -804,6 +818,28 @@ void demonstrate_string_copying() {
   std::cout << "copy_small size: " << copy_small.size() << std::endl;
   std::cout << "copy_small capacity: " << copy_small.capacity() << std::endl;
   
+  // Small-buffer optimization with a capacity we choose
+  std::cout << "\n=== INLINE (SMALL-BUFFER) STRINGS ===" << std::endl;
+  const char* key = "user:1024:session:expires-at";  // 28 characters
+  std::string std_key = key;
+  containers::InlineString<32> inline_key = key;
+  std::cout << "std::string capacity without allocating: " << std::string().capacity() << " characters" << std::endl;
+  std::cout << "std::string '" << std_key << "': "
+            << (std_key.capacity() > std::string().capacity() ? "on the heap" : "inline") << std::endl;
+  std::cout << "InlineString<32> '" << inline_key << "': " << (inline_key.is_inline() ? "inline" : "on the heap")
+            << " (sizeof " << sizeof(inline_key) << " vs " << sizeof(std_key) << ")" << std::endl;
+  containers::InlineString<32> inline_copy = inline_key;  // Copies bytes, no malloc
+  inline_copy += ":and-now-some-more";
+  std::cout << "After growing the copy past 32: " << (inline_copy.is_inline() ? "inline" : "on the heap")
+            << ", capacity " << inline_copy.capacity() << std::endl;
+  
+  // Views into one string instead of copies of its pieces
+  std::string csv = "id,name,,email";
+  std::vector<std::string_view> fields = strings::split(csv, ',');
+  std::cout << "strings::split(\"" << csv << "\", ',') -> " << fields.size() << " views:";
+  for (std::string_view field : fields) std::cout << " '" << field << "'";
+  std::cout << " (none copied)" << std::endl;
+  
   // Partial copying
   std::cout << "\n=== PARTIAL STRING COPYING ===" << std::endl;
   
@@ -858,23 +894,163 @@ void demonstrate_string_copying() {
 }
 
 void demonstrate_performance_comparison() {
-  std::cout << "=== PERFORMANCE NOTES ===" << std::endl;
-  
-  std::cout << "C-style strings (char arrays):" << std::endl;
-  std::cout << "  + Fast and memory-efficient" << std::endl;
-  std::cout << "  + Compatible with C libraries" << std::endl;
-  std::cout << "  - Manual memory management" << std::endl;
-  std::cout << "  - Buffer overflow risks" << std::endl;
-  std::cout << "  - Limited functionality" << std::endl;
-  
-  std::cout << "\nC++ std::string:" << std::endl;
-  std::cout << "  + Automatic memory management" << std::endl;
-  std::cout << "  + Rich set of methods" << std::endl;
-  std::cout << "  + Safe (bounds checking with at())" << std::endl;
-  std::cout << "  + Easy to use and maintain" << std::endl;
-  std::cout << "  - Slight overhead compared to char arrays" << std::endl;
-  
-  std::cout << "\nRecommendation: Use std::string for most applications!" << std::endl;
+  std::cout << "=== PERFORMANCE COMPARISON (measured) ===" << std::endl;
+  
+  /*
+  The same operation three ways: std::string and its algorithms, the C
+  library on char arrays, and the inline string / vectorized algorithms
+  of inline_string.h and string_algorithms.h. Short copies are about
+  allocation (std::string's inline buffer holds 15 characters, so the
+  40-character copy goes to malloc); the 64KB rows are about how many
+  bytes one instruction handles.
+  */
+  const int REPEATS = 256;  // Operations per timed run
+  
+  const char* short_text = "hello, world";                              // 12 characters
+  const char* medium_text = "the quick brown fox jumps over a lazy dog";  // 41 characters
+  std::string short_std = short_text, medium_std = medium_text;
+  containers::InlineString<48> short_inline = short_text, medium_inline = medium_text;
+  
+  // 64KB of lowercase words; the searched-for punctuation only at the end
+  std::string large(64 * 1024, ' ');
+  unsigned seed = 12345;
+  for (char& c : large) {
+    seed = seed * 1103515245 + 12345;
+    c = (seed >> 16) % 7 == 0 ? ' ' : static_cast<char>('a' + (seed >> 16) % 26);
+  }
+  large.back() = '!';
+  std::vector<char> large_c(large.begin(), large.end());
+  large_c.push_back('\0');
+  
+  // A 4KB CSV line of short fields
+  std::string csv;
+  while (csv.size() < 4096) csv += "field" + std::to_string(csv.size() % 1000) + ",";
+  csv.pop_back();
+  std::vector<char> csv_c(csv.size() + 1);
+  
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;  // The table below instead
+  bench::Suite suite("strings", options);
+  auto ns_per_op = [&](const std::string& name, auto&& op) {
+    return suite.run(name, [&] { for (int i = 0; i < REPEATS; ++i) op(); }, REPEATS).ns_per_item();
+  };
+  auto print_row = [](const char* operation, double std_ns, double c_ns, double inline_ns) {
+    printf("  %-22s %12.1f %12.1f %12.1f   %5.1fx\n", operation, std_ns, c_ns, inline_ns, std_ns / inline_ns);
+  };
+  
+  printf("  %-22s %12s %12s %12s   %s\n", "ns per operation", "std::string", "C string", "inline/simd", "vs std");
+  
+  print_row("copy 12 chars",
+            ns_per_op("copy 12 / std::string", [&] { std::string copy(short_std); bench::do_not_optimize(copy); }),
+            ns_per_op("copy 12 / strdup", [&] { char* copy = strdup(short_text); bench::do_not_optimize(copy); free(copy); }),
+            ns_per_op("copy 12 / InlineString", [&] {
+              containers::InlineString<48> copy(short_inline);
+              bench::do_not_optimize(copy);
+            }));
+  
+  print_row("copy 41 chars",
+            ns_per_op("copy 41 / std::string", [&] { std::string copy(medium_std); bench::do_not_optimize(copy); }),
+            ns_per_op("copy 41 / strdup", [&] { char* copy = strdup(medium_text); bench::do_not_optimize(copy); free(copy); }),
+            ns_per_op("copy 41 / InlineString", [&] {
+              containers::InlineString<48> copy(medium_inline);
+              bench::do_not_optimize(copy);
+            }));
+  
+  char medium_c[64];
+  strcpy(medium_c, medium_text);
+  auto reverse_c = [](char* text, size_t len) {
+    for (size_t i = 0; i < len / 2; ++i) {
+      char temp = text[i];
+      text[i] = text[len - 1 - i];
+      text[len - 1 - i] = temp;
+    }
+  };
+  print_row("reverse 41 chars",
+            ns_per_op("reverse 41 / std::reverse", [&] {
+              std::reverse(medium_std.begin(), medium_std.end());
+              bench::clobber_memory();
+            }),
+            ns_per_op("reverse 41 / swap loop", [&] {
+              reverse_c(medium_c, strlen(medium_c));
+              bench::clobber_memory();
+            }),
+            ns_per_op("reverse 41 / strings::reverse", [&] {
+              strings::reverse(medium_inline);
+              bench::clobber_memory();
+            }));
+  
+  print_row("reverse 64KB",
+            ns_per_op("reverse 64KB / std::reverse", [&] {
+              std::reverse(large.begin(), large.end());
+              bench::clobber_memory();
+            }),
+            ns_per_op("reverse 64KB / swap loop", [&] {
+              reverse_c(large_c.data(), large_c.size() - 1);
+              bench::clobber_memory();
+            }),
+            ns_per_op("reverse 64KB / strings::reverse", [&] {
+              strings::reverse(large);
+              bench::clobber_memory();
+            }));
+  
+  print_row("to_upper 64KB",
+            ns_per_op("to_upper 64KB / std::transform", [&] {
+              std::transform(large.begin(), large.end(), large.begin(), ::toupper);
+              bench::clobber_memory();
+            }),
+            ns_per_op("to_upper 64KB / toupper loop", [&] {
+              for (char* p = large_c.data(); *p != '\0'; ++p) *p = static_cast<char>(toupper(*p));
+              bench::clobber_memory();
+            }),
+            ns_per_op("to_upper 64KB / strings::to_upper", [&] {
+              strings::to_upper(large);
+              bench::clobber_memory();
+            }));
+  
+  // Each buffer was reversed an even number of times, so the '!' is back at the end
+  const char* punctuation = ".;:!?";
+  print_row("find_first_of 64KB",
+            ns_per_op("find_first_of 64KB / std::string", [&] {
+              bench::do_not_optimize(large.find_first_of(punctuation));
+            }),
+            ns_per_op("find_first_of 64KB / strpbrk", [&] {
+              bench::do_not_optimize(strpbrk(large_c.data(), punctuation));
+            }),
+            ns_per_op("find_first_of 64KB / strings::find_first_of", [&] {
+              bench::do_not_optimize(strings::find_first_of(large, punctuation));
+            }));
+  
+  std::vector<std::string> field_copies;
+  std::vector<char*> field_pointers;
+  std::vector<std::string_view> field_views;
+  print_row("split 4KB CSV line",
+            ns_per_op("split 4KB / getline", [&] {
+              field_copies.clear();
+              std::istringstream stream(csv);
+              for (std::string field; std::getline(stream, field, ',');) field_copies.push_back(field);
+              bench::do_not_optimize(field_copies.data());
+            }),
+            ns_per_op("split 4KB / strtok", [&] {
+              field_pointers.clear();
+              memcpy(csv_c.data(), csv.c_str(), csv.size() + 1);  // strtok() writes into its input
+              for (char* field = strtok(csv_c.data(), ","); field != nullptr; field = strtok(nullptr, ",")) {
+                field_pointers.push_back(field);
+              }
+              bench::do_not_optimize(field_pointers.data());
+            }),
+            ns_per_op("split 4KB / strings::split", [&] {
+              field_views.clear();
+              strings::split(csv, ',', field_views);
+              bench::do_not_optimize(field_views.data());
+            }));
+  
+  std::cout << "\n  inline/simd: containers::InlineString<48> and strings:: (" << simd::isa_name(simd::kernels().isa)
+            << " kernels)" << std::endl;
+  std::cout << "  12 characters still fit std::string's own buffer; 41 do not, so it calls malloc" << std::endl;
+  std::cout << "  (strdup() always does). split() hands out views, getline() a std::string per field." << std::endl;
+  
+  std::cout << "\nRecommendation: std::string by default; an inline string for hot short keys," << std::endl;
+  std::cout << "string_view and view-returning algorithms for parsing." << std::endl;
   
   std::cout << std::endl;
 }
@@ -7,13 +7,19 @@
  * - Handles basic Telnet protocol negotiation
  * - Provides interactive terminal interface
  * - Supports keyboard input and server responses
+ *
+ * With --bench it runs headless instead: thousands of concurrent sessions
+ * driven by the same net::EventLoop the server's reactor uses, each
+ * replaying a scripted command mix and timing every round trip.
  */
 
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <vector>
 #include <thread>
 #include <atomic>
+#include <algorithm>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -21,24 +27,23 @@
 #include <termios.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <sys/ioctl.h>
+#include <cstdlib>
+#include <cerrno>
+#include <chrono>
+#include <memory>
+#include <sstream>
 
-// Telnet protocol constants
-const unsigned char TELNET_IAC = 255;   // Interpret As Command
-const unsigned char TELNET_WILL = 251;  // Will option
-const unsigned char TELNET_WONT = 252;  // Won't option
-const unsigned char TELNET_DO = 253;    // Do option
-const unsigned char TELNET_DONT = 254;  // Don't option
-
-// Telnet options
-const unsigned char TELNET_ECHO = 1;          // Echo option
-const unsigned char TELNET_SUPPRESS_GA = 3;  // Suppress Go Ahead
-const unsigned char TELNET_TERMINAL_TYPE = 24; // Terminal Type
+#include "event_loop.h"
+#include "latency_histogram.h"
+#include "telnet_protocol.h"
 
 // Global variables
 int client_socket = -1;
 std::atomic<bool> connected{false};
 struct termios original_termios;
 bool terminal_modified = false;
+telnet::OptionTable client_options;  // Negotiated option state
 
 // Restore terminal settings on exit
 void cleanup_terminal() {
@@ -85,17 +90,37 @@ void set_terminal_raw_mode() {
 
 // Send Telnet command
 void send_telnet_command(int socket, unsigned char command, unsigned char option) {
-    unsigned char cmd[3] = {TELNET_IAC, command, option};
-    send(socket, cmd, 3, 0);
+    unsigned char cmd[3];
+    telnet::encode_negotiation(cmd, command, option);
+    send(socket, cmd, sizeof(cmd), 0);
 }
 
-// Process Telnet protocol commands
-void process_telnet_command(const std::vector<unsigned char>& command) {
-    if (command.size() < 3) return;
-    
-    unsigned char cmd = command[1];
-    unsigned char option = command[2];
-    
+// Send IAC SB <option> <payload> IAC SE
+void send_subnegotiation(int socket, unsigned char option, const unsigned char* payload, size_t length) {
+    unsigned char sb[5 + 2 * telnet::MAX_SUBNEGOTIATION];
+    if (length > telnet::MAX_SUBNEGOTIATION) length = telnet::MAX_SUBNEGOTIATION;
+    size_t n = telnet::encode_subnegotiation(sb, option, payload, length);
+    send(socket, sb, n, 0);
+}
+
+// Report our terminal size (NAWS, RFC 1073)
+void send_window_size(int socket) {
+    unsigned short width = 80, height = 24;
+    struct winsize ws;
+    if (ioctl(STDIN_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) {
+        width = ws.ws_col;
+        height = ws.ws_row;
+    }
+    unsigned char payload[4] = {
+        static_cast<unsigned char>(width >> 8), static_cast<unsigned char>(width & 0xff),
+        static_cast<unsigned char>(height >> 8), static_cast<unsigned char>(height & 0xff)
+    };
+    send_subnegotiation(socket, TELNET_WINDOW_SIZE, payload, sizeof(payload));
+}
+
+// Process Telnet protocol commands. Requests for a state we are already in
+// are not answered (RFC 854), which keeps negotiation from looping.
+void process_telnet_command(unsigned char cmd, unsigned char option) {
     std::cout << "\r📡 Telnet command: ";
     
     switch (cmd) {
@@ -103,7 +128,9 @@ void process_telnet_command(const std::vector<unsigned char>& command) {
             std::cout << "Server WILL " << (int)option << std::endl;
             // Server will do something - respond with DO or DONT
             if (option == TELNET_ECHO || option == TELNET_SUPPRESS_GA) {
-                send_telnet_command(client_socket, TELNET_DO, option);
+                if (client_options.set_remote(option, true)) {
+                    send_telnet_command(client_socket, TELNET_DO, option);
+                }
             } else {
                 send_telnet_command(client_socket, TELNET_DONT, option);
             }
@@ -112,14 +139,21 @@ void process_telnet_command(const std::vector<unsigned char>& command) {
         case TELNET_WONT:
             std::cout << "Server WONT " << (int)option << std::endl;
             // Server won't do something - acknowledge
-            send_telnet_command(client_socket, TELNET_DONT, option);
+            if (client_options.set_remote(option, false)) {
+                send_telnet_command(client_socket, TELNET_DONT, option);
+            }
             break;
             
         case TELNET_DO:
             std::cout << "Server wants us to DO " << (int)option << std::endl;
             // Server wants us to do something
-            if (option == TELNET_TERMINAL_TYPE) {
-                send_telnet_command(client_socket, TELNET_WILL, option);
+            if (option == TELNET_TERMINAL_TYPE || option == TELNET_WINDOW_SIZE) {
+                if (client_options.set_local(option, true)) {
+                    send_telnet_command(client_socket, TELNET_WILL, option);
+                    if (option == TELNET_WINDOW_SIZE) {
+                        send_window_size(client_socket);
+                    }
+                }
             } else {
                 send_telnet_command(client_socket, TELNET_WONT, option);
             }
@@ -128,7 +162,9 @@ void process_telnet_command(const std::vector<unsigned char>& command) {
         case TELNET_DONT:
             std::cout << "Server wants us to NOT DO " << (int)option << std::endl;
             // Server doesn't want us to do something
-            send_telnet_command(client_socket, TELNET_WONT, option);
+            if (client_options.set_local(option, false)) {
+                send_telnet_command(client_socket, TELNET_WONT, option);
+            }
             break;
             
         default:
@@ -137,12 +173,46 @@ void process_telnet_command(const std::vector<unsigned char>& command) {
     }
 }
 
+// Answer IAC SB TERMINAL-TYPE SEND IAC SE with our $TERM
+void process_subnegotiation(unsigned char option, const unsigned char* data, size_t length) {
+    if (option == TELNET_TERMINAL_TYPE && length >= 1 && data[0] == TELNET_SB_SEND) {
+        const char* term = std::getenv("TERM");
+        if (term == nullptr) term = "UNKNOWN";
+        
+        unsigned char payload[telnet::MAX_SUBNEGOTIATION];
+        size_t term_length = std::min(strlen(term), sizeof(payload) - 1);
+        payload[0] = TELNET_SB_IS;
+        memcpy(payload + 1, term, term_length);
+        send_subnegotiation(client_socket, TELNET_TERMINAL_TYPE, payload, term_length + 1);
+    }
+}
+
+// Receives the decoded server stream from telnet::Parser
+struct ServerOutputHandler {
+    void on_data(const unsigned char* data, size_t length) {
+        // Regular characters - display the whole run
+        std::cout.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(length));
+    }
+    
+    void on_command(unsigned char) {}
+    
+    void on_negotiation(unsigned char command, unsigned char option) {
+        process_telnet_command(command, option);
+    }
+    
+    void on_subnegotiation(unsigned char option, const unsigned char* data, size_t length) {
+        process_subnegotiation(option, data, length);
+    }
+};
+
 // Thread function to handle server responses
 void handle_server_responses() {
     char buffer[1024];
+    telnet::Parser parser;
+    ServerOutputHandler handler;
     
     while (connected) {
-        ssize_t bytes_received = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
+        ssize_t bytes_received = recv(client_socket, buffer, sizeof(buffer), 0);
         
         if (bytes_received <= 0) {
             if (connected) {
@@ -152,25 +222,9 @@ void handle_server_responses() {
             break;
         }
         
-        // Process received data
-        for (int i = 0; i < bytes_received; i++) {
-            unsigned char byte = static_cast<unsigned char>(buffer[i]);
-            
-            if (byte == TELNET_IAC && i + 2 < bytes_received) {
-                // Telnet command sequence
-                std::vector<unsigned char> command = {
-                    static_cast<unsigned char>(buffer[i]), 
-                    static_cast<unsigned char>(buffer[i+1]), 
-                    static_cast<unsigned char>(buffer[i+2])
-                };
-                process_telnet_command(command);
-                i += 2;  // Skip the next two bytes
-                
-            } else {
-                // Regular character - display it
-                std::cout << static_cast<char>(byte) << std::flush;
-            }
-        }
+        // Process received data; sequences split across reads are kept by the parser
+        parser.feed(buffer, static_cast<size_t>(bytes_received), handler);
+        std::cout << std::flush;
     }
 }
 
@@ -198,7 +252,331 @@ void handle_user_input() {
     }
 }
 
+// =============================================================================
+// SESSION LOAD TESTER (--bench)
+// =============================================================================
+
+struct SessionBenchConfig {
+    std::string server_ip = "127.0.0.1";
+    int server_port = 2323;
+    int total_sessions = 1000;        // Sessions to run in total
+    int concurrency = 100;            // Sessions open at the same time
+    int commands_per_session = 10;    // Commands replayed per session (then "quit")
+    int loop_threads = 1;             // Event loops driving the sessions
+    double timeout_seconds = 60.0;    // Give up on whatever is still running
+    std::vector<std::string> command_mix = {"echo hello", "date", "clients", "whoami", "pwd"};
+};
+
+uint64_t bench_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Results collected by one event loop thread; merged after the run
+struct LoopResults {
+    LatencyHistogram connect_latency;
+    LatencyHistogram command_latency;
+    LatencyHistogram session_duration;
+    uint64_t completed = 0;
+    uint64_t failed = 0;
+    uint64_t commands = 0;
+};
+
+struct BenchLoop {
+    net::EventLoop loop;
+    LoopResults results;
+};
+
+// Shared progress counters for all loops
+struct BenchProgress {
+    const SessionBenchConfig* config = nullptr;
+    std::atomic<int> started{0};
+    std::atomic<int> finished{0};
+};
+
+void start_bench_session(BenchLoop& owner, BenchProgress& progress);
+
+// One scripted session: connect, wait for the prompt, run the command mix,
+// quit. The server's "/$ " prompt marks the end of every response.
+class BenchSession : public net::EventHandler {
+public:
+    BenchSession(BenchLoop& owner, BenchProgress& progress, int sequence)
+        : owner_(owner), progress_(progress), next_command_(sequence) {}
+    
+    void start() {
+        started_ns_ = bench_now_ns();
+        socket_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (socket_ < 0) {
+            finish(false);
+            return;
+        }
+        net::set_nonblocking(socket_);
+        
+        struct sockaddr_in server_addr;
+        memset(&server_addr, 0, sizeof(server_addr));
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(progress_.config->server_port);
+        inet_pton(AF_INET, progress_.config->server_ip.c_str(), &server_addr.sin_addr);
+        
+        int rc = connect(socket_, (struct sockaddr*)&server_addr, sizeof(server_addr));
+        if (rc < 0 && errno != EINPROGRESS) {
+            finish(false);
+            return;
+        }
+        state_ = State::CONNECTING;
+        if (!owner_.loop.add(socket_, net::EVENT_WRITE, this)) {
+            finish(false);
+        }
+    }
+    
+    void handle_event(uint32_t events) override {
+        if (state_ == State::DONE) return;
+        
+        if (state_ == State::CONNECTING) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            getsockopt(socket_, SOL_SOCKET, SO_ERROR, &error, &length);
+            if (error != 0 || !owner_.loop.modify(socket_, net::EVENT_READ, this)) {
+                finish(false);
+                return;
+            }
+            owner_.results.connect_latency.record(bench_now_ns() - started_ns_);
+            state_ = State::WAIT_BANNER;
+            return;
+        }
+        
+        if (events & (net::EVENT_READ | net::EVENT_ERROR)) {
+            read_available();
+        }
+    }
+    
+    // telnet::Parser callbacks: only plain data matters, negotiation is ignored
+    void on_data(const unsigned char* data, size_t length) {
+        for (size_t i = 0; i < length && state_ != State::DONE; ++i) {
+            if (data[i] == PROMPT[prompt_matched_]) {
+                if (++prompt_matched_ == PROMPT_LENGTH) {
+                    prompt_matched_ = 0;
+                    on_prompt();
+                }
+            } else {
+                prompt_matched_ = (data[i] == PROMPT[0]) ? 1 : 0;
+            }
+        }
+    }
+    void on_command(unsigned char) {}
+    void on_negotiation(unsigned char, unsigned char) {}
+    void on_subnegotiation(unsigned char, const unsigned char*, size_t) {}
+    
+private:
+    enum class State { CONNECTING, WAIT_BANNER, WAIT_RESPONSE, QUITTING, DONE };
+    static constexpr const char* PROMPT = "/$ ";
+    static const size_t PROMPT_LENGTH = 3;
+    
+    void read_available() {
+        char buffer[4096];
+        while (state_ != State::DONE) {
+            ssize_t n = recv(socket_, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                parser_.feed(buffer, static_cast<size_t>(n), *this);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            // Orderly close is the expected answer to "quit"
+            finish(state_ == State::QUITTING);
+            return;
+        }
+    }
+    
+    void on_prompt() {
+        if (state_ == State::WAIT_RESPONSE) {
+            owner_.results.command_latency.record(bench_now_ns() - command_sent_ns_);
+            owner_.results.commands++;
+        }
+        
+        const auto& config = *progress_.config;
+        if (commands_sent_ < config.commands_per_session) {
+            const std::string& command = config.command_mix[next_command_++ % config.command_mix.size()];
+            commands_sent_++;
+            state_ = State::WAIT_RESPONSE;
+            command_sent_ns_ = bench_now_ns();
+            send_line(command);
+        } else {
+            state_ = State::QUITTING;
+            send_line("quit");
+        }
+    }
+    
+    void send_line(const std::string& text) {
+        std::string line = text + "\r\n";
+        if (send(socket_, line.data(), line.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(line.size())) {
+            finish(false);
+        }
+    }
+    
+    void finish(bool success) {
+        if (state_ == State::DONE) return;
+        state_ = State::DONE;
+        
+        if (socket_ >= 0) {
+            owner_.loop.remove(socket_);
+            close(socket_);
+        }
+        if (success) {
+            owner_.results.completed++;
+            owner_.results.session_duration.record(bench_now_ns() - started_ns_);
+        } else {
+            owner_.results.failed++;
+        }
+        progress_.finished.fetch_add(1, std::memory_order_acq_rel);
+        
+        // Keep the concurrency level up, then delete once this batch is done
+        BenchLoop& owner = owner_;
+        BenchProgress& progress = progress_;
+        owner.loop.post([this, &owner, &progress] {
+            delete this;
+            start_bench_session(owner, progress);
+        });
+    }
+    
+    BenchLoop& owner_;
+    BenchProgress& progress_;
+    telnet::Parser parser_;
+    State state_ = State::CONNECTING;
+    int socket_ = -1;
+    size_t next_command_;
+    int commands_sent_ = 0;
+    size_t prompt_matched_ = 0;
+    uint64_t started_ns_ = 0;
+    uint64_t command_sent_ns_ = 0;
+};
+
+// Start another session on this loop if the total has not been reached
+void start_bench_session(BenchLoop& owner, BenchProgress& progress) {
+    int sequence = progress.started.fetch_add(1, std::memory_order_acq_rel);
+    if (sequence >= progress.config->total_sessions) {
+        return;
+    }
+    auto* session = new BenchSession(owner, progress, static_cast<size_t>(sequence));
+    session->start();
+}
+
+int run_session_bench(const SessionBenchConfig& config) {
+    std::cout << "Load-testing Telnet server at " << config.server_ip << ":" << config.server_port << std::endl;
+    std::cout << config.total_sessions << " sessions, " << config.concurrency << " concurrent, "
+              << config.commands_per_session << " commands each, " << config.loop_threads
+              << " event loop(s)" << std::endl;
+    std::cout << "File descriptor limit: " << net::raise_fd_limit() << std::endl;
+    
+    BenchProgress progress;
+    progress.config = &config;
+    
+    std::vector<std::unique_ptr<BenchLoop>> loops;
+    for (int i = 0; i < config.loop_threads; ++i) {
+        loops.push_back(std::make_unique<BenchLoop>());
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < config.concurrency; ++i) {
+        BenchLoop& owner = *loops[i % loops.size()];
+        owner.loop.post([&owner, &progress] { start_bench_session(owner, progress); });
+    }
+    
+    std::vector<std::thread> threads;
+    for (auto& owner : loops) {
+        threads.emplace_back([&owner] { owner->loop.run(); });
+    }
+    
+    auto deadline = start + std::chrono::duration<double>(config.timeout_seconds);
+    while (progress.finished.load(std::memory_order_acquire) < config.total_sessions &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    for (auto& owner : loops) {
+        owner->loop.stop();
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    LoopResults total;
+    for (auto& owner : loops) {
+        total.connect_latency.merge(owner->results.connect_latency);
+        total.command_latency.merge(owner->results.command_latency);
+        total.session_duration.merge(owner->results.session_duration);
+        total.completed += owner->results.completed;
+        total.failed += owner->results.failed;
+        total.commands += owner->results.commands;
+    }
+    
+    std::cout << "\n📊 Session benchmark results (" << elapsed << "s)" << std::endl;
+    std::cout << "  Completed sessions: " << total.completed << " (" << total.completed / elapsed
+              << " sessions/s)" << std::endl;
+    std::cout << "  Failed sessions:    " << total.failed << std::endl;
+    if (progress.finished.load() < config.total_sessions) {
+        std::cout << "  Unfinished:         " << config.total_sessions - progress.finished.load()
+                  << " (timed out)" << std::endl;
+    }
+    std::cout << "  Commands:           " << total.commands << " (" << total.commands / elapsed
+              << " commands/s)" << std::endl;
+    std::cout << "  Connect latency:    " << total.connect_latency.summary() << std::endl;
+    std::cout << "  Command RTT:        " << total.command_latency.summary() << std::endl;
+    std::cout << "  Session duration:   " << total.session_duration.summary(1e6, "ms") << std::endl;
+    return total.failed == 0 ? 0 : 1;
+}
+
+// Parse "--bench [options]"; returns false on bad usage
+bool parse_bench_arguments(int argc, char* argv[], SessionBenchConfig& config) {
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--server" && has_value) {
+            config.server_ip = argv[++i];
+        } else if (arg == "--port" && has_value) {
+            config.server_port = std::stoi(argv[++i]);
+        } else if (arg == "--sessions" && has_value) {
+            config.total_sessions = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--concurrency" && has_value) {
+            config.concurrency = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--commands" && has_value) {
+            config.commands_per_session = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--loops" && has_value) {
+            config.loop_threads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--timeout" && has_value) {
+            config.timeout_seconds = std::stod(argv[++i]);
+        } else if (arg == "--mix" && has_value) {
+            // Comma-separated commands, e.g. "echo hi,date,clients"
+            config.command_mix.clear();
+            std::stringstream mix(argv[++i]);
+            std::string command;
+            while (std::getline(mix, command, ',')) {
+                if (!command.empty()) config.command_mix.push_back(command);
+            }
+            if (config.command_mix.empty()) return false;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " --bench [--server IP] [--port P] [--sessions N]"
+                      << " [--concurrency C] [--commands K] [--mix \"cmd1,cmd2,...\"] [--loops L]"
+                      << " [--timeout S]" << std::endl;
+            return false;
+        }
+    }
+    config.concurrency = std::min(config.concurrency, config.total_sessions);
+    return true;
+}
+
 int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--bench") {
+        std::cout << "=== TELNET SESSION LOAD TESTER ===" << std::endl;
+        SessionBenchConfig config;
+        if (!parse_bench_arguments(argc, argv, config)) {
+            return 1;
+        }
+        signal(SIGPIPE, SIG_IGN);
+        return run_session_bench(config);
+    }
+    
     std::cout << "=== BASIC TELNET CLIENT ===" << std::endl;
     
     std::string server_ip = "127.0.0.1";
@@ -257,7 +635,9 @@ int main(int argc, char* argv[]) {
     // Set terminal to raw mode for character-by-character input
     set_terminal_raw_mode();
     
-    // Initial Telnet negotiation
+    // Initial Telnet negotiation (recorded so the server's acks are not re-answered)
+    client_options.set_remote(TELNET_ECHO, true);
+    client_options.set_remote(TELNET_SUPPRESS_GA, true);
     send_telnet_command(client_socket, TELNET_DO, TELNET_ECHO);
     send_telnet_command(client_socket, TELNET_DO, TELNET_SUPPRESS_GA);
     
@@ -288,4 +668,6 @@ Usage Examples:
   ./telnet_client 192.168.1.100          # Connect to specific IP
   ./telnet_client 127.0.0.1 23           # Connect to standard Telnet port
   ./telnet_client example.com 2323       # Connect to remote server
+  ./telnet_client --bench --sessions 10000 --concurrency 2000 --loops 2
+  ./telnet_client --bench --mix "echo hi,date,clients" --commands 50
 */
\ No newline at end of file
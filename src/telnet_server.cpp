@@ -7,6 +7,29 @@
  * - Provides a basic shell-like interface
  * - Handles Telnet protocol basics
  * - Supports simple commands
+ *
+ * Two serving modes are available:
+ * - Threaded (default): one blocking std::thread per accepted client
+ * - Reactor (--reactor): non-blocking sockets multiplexed by a small, fixed
+ *   number of event-loop threads (epoll on Linux, kqueue on macOS). Each
+ *   connection only costs a TelnetSession instead of a whole thread stack.
+ *   Idle timeouts (--idle-timeout) and keepalives (--keepalive) run on each
+ *   loop's timer wheel: re-arming them on every read is O(1).
+ * - Coroutines (--coroutines, C++20 builds): the same event loops, but each
+ *   session is handle_client()'s straight-line loop written as a coroutine
+ *   that suspends in co_await instead of blocking its thread.
+ *
+ * Every mode records the same metrics (metrics.h): counters, latency
+ * histograms for session setup, input processing, command execution and
+ * flushes, and a per-thread trace ring. The "stats" and "trace" commands
+ * show them, --metrics-port serves them to Prometheus (on loopback unless
+ * --metrics-address is given), and per-command / per-negotiation log lines
+ * appear with --log-level debug (log.h; they are compiled out of release
+ * builds).
+ *
+ * "config" shows the server-wide session defaults. Changing them (TCP
+ * options, timeouts, the message of the day) is an admin action for every
+ * client, so it needs --allow-config and a connection from localhost.
  */
 
 #include <iostream>
@@ -14,7 +37,6 @@
 #include <cstring>
 #include <vector>
 #include <thread>
-#include <mutex>
 #include <algorithm>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -22,31 +44,132 @@
 #include <unistd.h>
 #include <signal.h>
 #include <fcntl.h>
+#include <cerrno>
+#include <charconv>
+#include <memory>
+#include <atomic>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <memory_resource>
+#include <string_view>
+
+#include "alloc_counter.h"
+#include "event_loop.h"
+#include "log.h"
+#include "metrics.h"
+#include "monotonic_arena.h"
+#include "output_buffer.h"
+#include "rcu.h"
+#include "session_table.h"
+#include "telnet_protocol.h"
+
+#if defined(__cpp_impl_coroutine)
+#include "async_socket.h"
+#include "task.h"
+#define TELNET_HAS_COROUTINES 1
+#else
+#define TELNET_HAS_COROUTINES 0
+#endif
 
 const int TELNET_PORT = 2323;  // Using non-standard port (standard is 23)
 const int BUFFER_SIZE = 1024;
 const int MAX_CLIENTS = 10;
+const uint32_t MAX_SESSIONS = 65536;     // Slots in the client registry
+const int REACTOR_READ_SIZE = 16 * 1024;  // Per-loop scratch buffer for recv()
+const int MAX_FLUSH_IOV = 32;             // Segments gathered per sendmsg()
+const size_t OUTPUT_HIGH_WATER = 256 * 1024;  // Reactor stops reading above this much queued output
 
-// Telnet protocol constants
-const unsigned char TELNET_IAC = 255;   // Interpret As Command
-const unsigned char TELNET_WILL = 251;  // Will option
-const unsigned char TELNET_WONT = 252;  // Won't option
-const unsigned char TELNET_DO = 253;    // Do option
-const unsigned char TELNET_DONT = 254;  // Don't option
-const unsigned char TELNET_SE = 240;    // Subnegotiation End
-const unsigned char TELNET_SB = 250;    // Subnegotiation Begin
-
-// Telnet options
-const unsigned char TELNET_ECHO = 1;          // Echo option
-const unsigned char TELNET_SUPPRESS_GA = 3;  // Suppress Go Ahead
-const unsigned char TELNET_TERMINAL_TYPE = 24; // Terminal Type
-const unsigned char TELNET_WINDOW_SIZE = 31;  // Window Size
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0  // macOS: SIGPIPE is ignored process-wide instead
+#endif
 
 // Global variables for server management
 int server_socket = -1;
-std::vector<int> client_sockets;
-std::mutex clients_mutex;
-bool server_running = true;
+net::SessionTable client_registry(MAX_SESSIONS);  // Lock-free; see session_table.h
+std::atomic<bool> server_running{true};  // Cleared by the signal handler, polled by every loop
+
+// Server configuration (parsed from the command line)
+struct ServerConfig {
+    int port = TELNET_PORT;
+    bool reactor = false;   // Event-driven mode instead of thread-per-client
+    bool coroutines = false;  // Reactor threads running one coroutine per session
+    int loop_threads = 0;   // 0 = one event loop per hardware thread
+    bool nodelay = false;   // Default TCP_NODELAY for new sessions
+    bool cork = false;      // Default TCP_CORK around each flush
+    int idle_timeout = 0;   // Reactor: close after this many idle seconds (0 = never)
+    int keepalive = 0;      // Reactor: send IAC NOP after this many quiet seconds (0 = never)
+    int metrics_port = 0;   // Serve Prometheus text on this port (0 = off)
+    std::string metrics_address = "127.0.0.1";  // ... on this interface
+    bool allow_config = false;  // Let local clients change the session defaults
+};
+ServerConfig server_config;
+
+// Server-wide session settings that can change while the server runs (the
+// "config" command). They are read on every connect and on every batch of
+// input, from every serving thread, and written almost never, so they are
+// published through RCU: readers load a snapshot without any lock, and a
+// change builds a new snapshot and swaps it in (see rcu.h).
+struct SessionDefaults {
+    bool nodelay = false;   // TCP_NODELAY for new sessions
+    bool cork = false;      // TCP_CORK around each flush, for new sessions
+    int idle_timeout = 0;   // Reactor: close after this many idle seconds (0 = never)
+    int keepalive = 0;      // Reactor: send IAC NOP after this many quiet seconds (0 = never)
+    std::string motd;       // Appended to the welcome banner when not empty
+};
+concurrency::RcuCell<SessionDefaults> session_defaults;
+
+// Syscall and byte counters: per session and summed over the whole server.
+// The interesting number is send() calls per input byte, which coalescing
+// keeps far below 1 even when clients paste large blocks of text.
+struct IoCounters {
+    uint64_t recv_calls = 0;
+    uint64_t send_calls = 0;
+    uint64_t setsockopt_calls = 0;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    
+    // Heap allocations on the command path (execute + reply + prompt);
+    // zero per command once the scratch arena and output blocks are warm
+    uint64_t commands = 0;
+    uint64_t command_allocations = 0;
+    uint64_t last_command_allocations = 0;
+};
+
+// Server-wide totals. Each serving thread counts into its own block and
+// the blocks are only summed when somebody asks (see metrics.h), so the
+// counters cost no shared cache line on the hot path.
+const metrics::Counter connections_total("telnet_connections_total", "Sessions opened");
+const metrics::Counter rejected_total("telnet_rejected_total", "Connections turned away by a full registry");
+const metrics::Counter disconnects_total("telnet_disconnects_total", "Sessions closed");
+const metrics::Counter recv_calls_total("telnet_recv_calls_total", "recv() calls");
+const metrics::Counter bytes_in_total("telnet_received_bytes_total", "Bytes received");
+const metrics::Counter send_calls_total("telnet_send_calls_total", "sendmsg() calls");
+const metrics::Counter bytes_out_total("telnet_sent_bytes_total", "Bytes sent");
+const metrics::Counter setsockopt_calls_total("telnet_setsockopt_calls_total", "setsockopt() calls");
+const metrics::Counter commands_total("telnet_commands_total", "Commands executed");
+const metrics::Counter command_allocations_total("telnet_command_allocations_total",
+                                                 "Heap allocations on the command path");
+
+const metrics::Histogram accept_latency("telnet_accept_seconds", "Session setup: registry, socket options, welcome");
+const metrics::Histogram recv_latency("telnet_recv_seconds", "Processing of one recv() worth of input");
+const metrics::Histogram command_latency("telnet_command_seconds", "execute_command() time");
+const metrics::Histogram send_latency("telnet_send_seconds", "flush() time, all sendmsg() calls");
+
+// Trace events; the argument is the socket for accept/close, else a byte count
+const metrics::TraceEvent trace_accept("accept");
+const metrics::TraceEvent trace_close("close");
+const metrics::TraceEvent trace_recv("recv");
+const metrics::TraceEvent trace_command("command");
+const metrics::TraceEvent trace_flush("flush");
+
+void count_recv(IoCounters& counters, ssize_t bytes) {
+    counters.recv_calls++;
+    recv_calls_total.add();
+    if (bytes > 0) {
+        counters.bytes_in += static_cast<uint64_t>(bytes);
+        bytes_in_total.add(static_cast<uint64_t>(bytes));
+    }
+}
 
 // Client session structure
 struct TelnetSession {
@@ -56,8 +179,102 @@ struct TelnetSession {
     bool echo_enabled;
     std::string current_directory;
     
+    // Per-connection parse state; the parser reassembles IAC sequences that
+    // span recv() calls, the option table tracks what has been negotiated
+    telnet::Parser parser;
+    telnet::OptionTable options;
+    std::string input_buffer;
+    
+    // Slot in client_registry
+    net::SessionTable::Handle registry_handle;
+    
+    // Learned through subnegotiation (TERMINAL-TYPE, NAWS)
+    std::string terminal_type;
+    int window_width = 0;
+    int window_height = 0;
+    
+    // All output is queued here and flushed once per batch of input
+    net::OutputBuffer output;
+    IoCounters io;
+    
+    // Per-session TCP tuning (see the "set" command)
+    bool nodelay = false;
+    bool cork = false;
+    
     TelnetSession(int sock, const std::string& ip, int port) 
         : socket(sock), client_ip(ip), client_port(port), echo_enabled(true), current_directory("/") {}
+    
+    // Queue data for the client; nothing is sent until flush()
+    void write(const char* data, size_t length) { output.append(data, length); }
+    void write(const std::string& data) { output.append(data.data(), data.size()); }
+    void write(std::string&& data) { output.append(std::move(data)); }
+    
+    void set_socket_option(int level, int name, bool enabled) {
+        int value = enabled ? 1 : 0;
+        setsockopt(socket, level, name, &value, sizeof(value));
+        io.setsockopt_calls++;
+        setsockopt_calls_total.add();
+    }
+    
+    // Disable Nagle's algorithm so small writes leave immediately
+    void set_nodelay(bool enabled) {
+        nodelay = enabled;
+        set_socket_option(IPPROTO_TCP, TCP_NODELAY, enabled);
+    }
+    
+    // Hold back partial segments while a flush is in progress
+    void set_cork(bool enabled) {
+        cork = enabled;
+    }
+    
+    // Send everything queued with as few gather writes as possible. A
+    // blocking socket is drained completely; a non-blocking one stops at
+    // EAGAIN and keeps the rest queued. Returns false if the connection failed.
+    bool flush() {
+        if (output.empty()) return true;
+        metrics::ScopedTimer timer(send_latency);
+        uint64_t bytes_before = io.bytes_out;
+        
+#if defined(TCP_CORK)
+        if (cork) set_socket_option(IPPROTO_TCP, TCP_CORK, true);
+#elif defined(TCP_NOPUSH)
+        if (cork) set_socket_option(IPPROTO_TCP, TCP_NOPUSH, true);
+#endif
+        
+        bool ok = true;
+        while (!output.empty()) {
+            struct iovec iov[MAX_FLUSH_IOV];
+            struct msghdr message;
+            memset(&message, 0, sizeof(message));
+            message.msg_iov = iov;
+            message.msg_iovlen = output.gather(iov, MAX_FLUSH_IOV);
+            
+            ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+            io.send_calls++;
+            send_calls_total.add();
+            
+            if (sent > 0) {
+                output.consume(static_cast<size_t>(sent));
+                io.bytes_out += static_cast<uint64_t>(sent);
+                bytes_out_total.add(static_cast<uint64_t>(sent));
+            } else if (sent < 0 && errno == EINTR) {
+                continue;
+            } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                ok = false;
+                break;
+            }
+        }
+        
+#if defined(TCP_CORK)
+        if (cork) set_socket_option(IPPROTO_TCP, TCP_CORK, false);
+#elif defined(TCP_NOPUSH)
+        if (cork) set_socket_option(IPPROTO_TCP, TCP_NOPUSH, false);
+#endif
+        trace_flush(io.bytes_out - bytes_before);
+        return ok;
+    }
 };
 
 // Signal handler for graceful shutdown
@@ -65,14 +282,12 @@ void signal_handler(int signum) {
     std::cout << "\n\nShutting down Telnet server..." << std::endl;
     server_running = false;
     
-    // Close all client connections
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex);
-        for (int client_sock : client_sockets) {
-            close(client_sock);
-        }
-        client_sockets.clear();
-    }
+    // Close all client connections. The registry is walked without a lock,
+    // so this cannot deadlock against a thread interrupted mid-accept.
+    client_registry.for_each([](int client_sock) {
+        shutdown(client_sock, SHUT_RDWR);
+        close(client_sock);
+    });
     
     if (server_socket != -1) {
         close(server_socket);
@@ -80,85 +295,229 @@ void signal_handler(int signum) {
     exit(0);
 }
 
-// Send data to client with error checking
-bool send_to_client(int socket, const std::string& data) {
-    ssize_t bytes_sent = send(socket, data.c_str(), data.length(), 0);
-    return bytes_sent > 0;
+// Send Telnet command
+void send_telnet_command(TelnetSession& session, unsigned char command, unsigned char option) {
+    unsigned char cmd[3];
+    telnet::encode_negotiation(cmd, command, option);
+    session.write(reinterpret_cast<const char*>(cmd), sizeof(cmd));
 }
 
-// Send Telnet command
-void send_telnet_command(int socket, unsigned char command, unsigned char option) {
-    unsigned char cmd[3] = {TELNET_IAC, command, option};
-    send(socket, cmd, 3, 0);
+// Ask the client to report its terminal type (IAC SB TERMINAL-TYPE SEND IAC SE)
+void request_terminal_type(TelnetSession& session) {
+    unsigned char payload = TELNET_SB_SEND;
+    unsigned char sb[8];
+    size_t length = telnet::encode_subnegotiation(sb, TELNET_TERMINAL_TYPE, &payload, 1);
+    session.write(reinterpret_cast<const char*>(sb), length);
 }
 
-// Process Telnet protocol commands
-void process_telnet_command(TelnetSession& session, const std::vector<unsigned char>& command) {
-    if (command.size() < 3) return;
-    
-    unsigned char cmd = command[1];
-    unsigned char option = command[2];
-    
-    std::cout << "📡 Telnet command from " << session.client_ip << ": ";
-    
+// Process Telnet protocol commands. Requests for a state we are already in
+// are not answered (RFC 854), which keeps negotiation from looping.
+void process_telnet_command(TelnetSession& session, unsigned char cmd, unsigned char option) {
     switch (cmd) {
         case TELNET_WILL:
-            std::cout << "WILL " << (int)option << std::endl;
+            LOG_DEBUG << "Telnet command from " << session.client_ip << ": WILL " << (int)option;
             // Client will do something - respond with DO or DONT
-            if (option == TELNET_ECHO || option == TELNET_SUPPRESS_GA) {
-                send_telnet_command(session.socket, TELNET_DO, option);
+            if (option == TELNET_ECHO || option == TELNET_SUPPRESS_GA ||
+                option == TELNET_TERMINAL_TYPE || option == TELNET_WINDOW_SIZE) {
+                if (session.options.set_remote(option, true)) {
+                    send_telnet_command(session, TELNET_DO, option);
+                }
+                if (option == TELNET_TERMINAL_TYPE && session.terminal_type.empty()) {
+                    request_terminal_type(session);
+                }
             } else {
-                send_telnet_command(session.socket, TELNET_DONT, option);
+                send_telnet_command(session, TELNET_DONT, option);
             }
             break;
             
         case TELNET_WONT:
-            std::cout << "WONT " << (int)option << std::endl;
+            LOG_DEBUG << "Telnet command from " << session.client_ip << ": WONT " << (int)option;
             // Client won't do something - acknowledge
-            send_telnet_command(session.socket, TELNET_DONT, option);
+            if (session.options.set_remote(option, false)) {
+                send_telnet_command(session, TELNET_DONT, option);
+            }
             break;
             
         case TELNET_DO:
-            std::cout << "DO " << (int)option << std::endl;
+            LOG_DEBUG << "Telnet command from " << session.client_ip << ": DO " << (int)option;
             // Client wants us to do something
-            if (option == TELNET_ECHO) {
-                send_telnet_command(session.socket, TELNET_WILL, option);
-                session.echo_enabled = true;
+            if (option == TELNET_ECHO || option == TELNET_SUPPRESS_GA) {
+                if (session.options.set_local(option, true)) {
+                    send_telnet_command(session, TELNET_WILL, option);
+                }
+                if (option == TELNET_ECHO) {
+                    session.echo_enabled = true;
+                }
             } else {
-                send_telnet_command(session.socket, TELNET_WONT, option);
+                send_telnet_command(session, TELNET_WONT, option);
             }
             break;
             
         case TELNET_DONT:
-            std::cout << "DONT " << (int)option << std::endl;
+            LOG_DEBUG << "Telnet command from " << session.client_ip << ": DONT " << (int)option;
             // Client doesn't want us to do something
-            send_telnet_command(session.socket, TELNET_WONT, option);
+            if (session.options.set_local(option, false)) {
+                send_telnet_command(session, TELNET_WONT, option);
+            }
             if (option == TELNET_ECHO) {
                 session.echo_enabled = false;
             }
             break;
             
         default:
-            std::cout << "Unknown command " << (int)cmd << std::endl;
+            LOG_DEBUG << "Telnet command from " << session.client_ip << ": unknown " << (int)cmd;
             break;
     }
 }
 
-// Execute a simple command
-std::string execute_command(TelnetSession& session, const std::string& command) {
-    std::string cmd = command;
-    std::string response;
+// Process IAC SB <option> ... IAC SE
+void process_subnegotiation(TelnetSession& session, unsigned char option, const unsigned char* data,
+                            size_t length) {
+    if (option == TELNET_TERMINAL_TYPE && length >= 1 && data[0] == TELNET_SB_IS) {
+        session.terminal_type.assign(reinterpret_cast<const char*>(data + 1), length - 1);
+        LOG_DEBUG << "Terminal type from " << session.client_ip << ": " << session.terminal_type;
+        
+    } else if (option == TELNET_WINDOW_SIZE && length >= 4) {
+        session.window_width = (data[0] << 8) | data[1];
+        session.window_height = (data[2] << 8) | data[3];
+        LOG_DEBUG << "Window size from " << session.client_ip << ": " << session.window_width << "x"
+                  << session.window_height;
+    }
+}
+
+// One line of the iostat report
+void append_io_counters(std::pmr::string& out, const char* scope, uint64_t recv_calls, uint64_t send_calls,
+                        uint64_t setsockopt_calls, uint64_t bytes_in, uint64_t bytes_out) {
+    char line[256];
+    double ratio = bytes_in > 0 ? static_cast<double>(send_calls) / static_cast<double>(bytes_in) : 0.0;
+    snprintf(line, sizeof(line),
+             "%s: recv=%llu send=%llu setsockopt=%llu in=%lluB out=%lluB send/byte-in=%.4f\r\n", scope,
+             (unsigned long long)recv_calls, (unsigned long long)send_calls,
+             (unsigned long long)setsockopt_calls, (unsigned long long)bytes_in,
+             (unsigned long long)bytes_out, ratio);
+    out += line;
+}
+
+void append_number(std::pmr::string& out, long long value) {
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%lld", value);
+    out.append(digits, static_cast<size_t>(length));
+}
+
+// The "trace" command: `arguments` empty or a count shows the newest events,
+// "dump" writes the binary ring (see metrics.h) next to the server. The file
+// name is fixed on purpose; a client must not choose paths on the server.
+std::pmr::string show_trace(std::string_view arguments, std::pmr::memory_resource* scratch) {
+    std::pmr::string response(scratch);
+    if (arguments == "dump") {
+        char path[64];
+        snprintf(path, sizeof(path), "telnet_server.%d.trace", static_cast<int>(getpid()));
+        response = metrics::dump_trace(path) ? "Trace written to " : "Could not write ";
+        response += path;
+        response += "\r\n";
+        return response;
+    }
+    
+    size_t count = 20;
+    if (!arguments.empty()) {
+        auto parsed = std::from_chars(arguments.data(), arguments.data() + arguments.size(), count);
+        if (parsed.ec != std::errc() || parsed.ptr != arguments.data() + arguments.size() || count == 0) {
+            response = "Usage: trace [count | dump]\r\n";
+            return response;
+        }
+    }
+    response = metrics::format_trace(std::min(count, metrics::TRACE_CAPACITY), "\r\n").c_str();
+    return response;
+}
+
+// Scratch memory for the command path, one arena per serving thread. It is
+// rewound before every command (see SessionInputHandler::end_of_line).
+memory::MonotonicArena& command_arena() {
+    static thread_local memory::MonotonicArena arena(8192);
+    return arena;
+}
+
+// The "config" command: `arguments` empty shows the current defaults,
+// otherwise one of them is changed by publishing a new snapshot. Sessions
+// already connected pick up the timeouts at their next read; the TCP
+// options apply to sessions connected afterwards. Clients are not
+// authenticated, so changes are only taken with --allow-config, and then
+// only from loopback connections; everyone else gets a read-only view.
+std::pmr::string update_session_defaults(const TelnetSession& session, std::string_view arguments,
+                                         std::pmr::memory_resource* scratch) {
+    std::pmr::string response(scratch);
+    size_t space = arguments.find(' ');
+    std::string_view name = arguments.substr(0, space);
+    std::string_view value = space == std::string_view::npos ? std::string_view() : arguments.substr(space + 1);
+    bool loopback = session.client_ip.compare(0, 4, "127.") == 0;
+    
+    if (!name.empty() && !(server_config.allow_config && loopback)) {
+        response = "Session defaults are read-only";
+        response += server_config.allow_config ? " from remote hosts\r\n" : " (server started without --allow-config)\r\n";
+        return response;
+    }
+    
+    if (name == "nodelay" || name == "cork") {
+        if (value != "on" && value != "off") {
+            response = "Usage: config nodelay|cork on|off\r\n";
+            return response;
+        }
+        bool enabled = value == "on";
+        session_defaults.update([&](SessionDefaults& defaults) {
+            (name == "nodelay" ? defaults.nodelay : defaults.cork) = enabled;
+        });
+    } else if (name == "idle-timeout" || name == "keepalive") {
+        int seconds = -1;
+        auto parsed = std::from_chars(value.data(), value.data() + value.size(), seconds);
+        if (parsed.ec != std::errc() || parsed.ptr != value.data() + value.size() || seconds < 0 || seconds > 86400) {
+            response = "Usage: config idle-timeout|keepalive <seconds, 0 = off>\r\n";
+            return response;
+        }
+        session_defaults.update([&](SessionDefaults& defaults) {
+            (name == "idle-timeout" ? defaults.idle_timeout : defaults.keepalive) = seconds;
+        });
+    } else if (name == "motd") {
+        session_defaults.update([&](SessionDefaults& defaults) { defaults.motd.assign(value); });
+    } else if (!name.empty()) {
+        response = "Usage: config [nodelay|cork on|off | idle-timeout|keepalive <sec> | motd <text>]\r\n";
+        return response;
+    }
+    
+    auto defaults = session_defaults.read();
+    response += "Session defaults: nodelay=";
+    response += defaults->nodelay ? "on" : "off";
+    response += " cork=";
+    response += defaults->cork ? "on" : "off";
+    response += " idle-timeout=";
+    append_number(response, defaults->idle_timeout);
+    response += "s keepalive=";
+    append_number(response, defaults->keepalive);
+    response += "s\r\n";
+    if (!defaults->motd.empty()) {
+        response += "Message of the day: ";
+        response += defaults->motd;
+        response += "\r\n";
+    }
+    return response;
+}
+
+// Execute a simple command. The response is built in `scratch`, which the
+// caller resets once per command, so the steady state never hits malloc.
+std::pmr::string execute_command(TelnetSession& session, std::string_view command,
+                                 std::pmr::memory_resource* scratch) {
+    std::string_view cmd = command;
+    std::pmr::string response(scratch);
     
     // Remove trailing whitespace
     while (!cmd.empty() && (cmd.back() == '\r' || cmd.back() == '\n' || cmd.back() == ' ')) {
-        cmd.pop_back();
+        cmd.remove_suffix(1);
     }
     
     if (cmd.empty()) {
-        return "";
+        return response;
     }
     
-    std::cout << "🔧 Command from " << session.client_ip << ": " << cmd << std::endl;
+    LOG_DEBUG << "Command from " << session.client_ip << ": " << cmd;
     
     if (cmd == "help" || cmd == "?") {
         response = "Available commands:\r\n";
@@ -169,6 +528,15 @@ std::string execute_command(TelnetSession& session, const std::string& command)
         response += "  echo <text> - Echo text back\r\n";
         response += "  uptime      - Show server uptime\r\n";
         response += "  clients     - Show connected clients\r\n";
+        response += "  iostat      - Show syscall and allocation counters\r\n";
+        response += "  stats       - Show server metrics and latency percentiles\r\n";
+        response += "  trace [N|dump] - Show the last N trace events, or dump them to a file\r\n";
+        response += "  set nodelay|cork on|off - Tune this session's TCP socket\r\n";
+        response += "  config      - Show server-wide session defaults\r\n";
+        if (server_config.allow_config) {
+            response += "  config nodelay|cork on|off, config idle-timeout|keepalive <sec>,\r\n";
+            response += "  config motd <text> - Change them for every session (from localhost)\r\n";
+        }
         response += "  quit, exit  - Disconnect\r\n";
         
     } else if (cmd == "date") {
@@ -178,143 +546,740 @@ std::string execute_command(TelnetSession& session, const std::string& command)
         response += time_str;  // ctime includes \n
         
     } else if (cmd == "whoami") {
-        response = "You are: telnet_user@" + session.client_ip + "\r\n";
-        response += "Session: " + std::to_string(session.socket) + "\r\n";
+        response = "You are: telnet_user@";
+        response += session.client_ip;
+        response += "\r\nSession: ";
+        append_number(response, session.socket);
+        response += "\r\n";
+        if (!session.terminal_type.empty()) {
+            response += "Terminal: ";
+            response += session.terminal_type;
+            if (session.window_width > 0) {
+                response += " (";
+                append_number(response, session.window_width);
+                response += "x";
+                append_number(response, session.window_height);
+                response += ")";
+            }
+            response += "\r\n";
+        }
         
     } else if (cmd == "pwd") {
-        response = "Current directory: " + session.current_directory + "\r\n";
+        response = "Current directory: ";
+        response += session.current_directory;
+        response += "\r\n";
         
     } else if (cmd.substr(0, 5) == "echo ") {
-        response = cmd.substr(5) + "\r\n";
+        response = cmd.substr(5);
+        response += "\r\n";
         
     } else if (cmd == "uptime") {
         response = "Server is running (simplified uptime)\r\n";
         
     } else if (cmd == "clients") {
-        std::lock_guard<std::mutex> lock(clients_mutex);
-        response = "Connected clients: " + std::to_string(client_sockets.size()) + "\r\n";
+        response = "Connected clients: ";
+        append_number(response, static_cast<long long>(client_registry.size()));
+        response += "\r\n";
+        
+    } else if (cmd == "iostat") {
+        append_io_counters(response, "Session", session.io.recv_calls, session.io.send_calls,
+                           session.io.setsockopt_calls, session.io.bytes_in, session.io.bytes_out);
+        append_io_counters(response, "Server", recv_calls_total.value(), send_calls_total.value(),
+                           setsockopt_calls_total.value(), bytes_in_total.value(), bytes_out_total.value());
+        char line[160];
+        snprintf(line, sizeof(line), "Command path: commands=%llu heap-allocs=%llu (last command: %llu)\r\n",
+                 (unsigned long long)session.io.commands, (unsigned long long)session.io.command_allocations,
+                 (unsigned long long)session.io.last_command_allocations);
+        response += line;
+        snprintf(line, sizeof(line), "Server command path: commands=%llu heap-allocs=%llu\r\n",
+                 (unsigned long long)commands_total.value(), (unsigned long long)command_allocations_total.value());
+        response += line;
+        
+    } else if (cmd == "stats") {
+        response = metrics::render_text("\r\n").c_str();
+        
+    } else if (cmd == "trace" || cmd.substr(0, 6) == "trace ") {
+        response = show_trace(cmd.size() > 6 ? cmd.substr(6) : std::string_view(), scratch);
+        
+    } else if (cmd.substr(0, 4) == "set ") {
+        std::string_view option = cmd.substr(4);
+        bool enable = option.size() > 3 && option.substr(option.size() - 3) == " on";
+        bool disable = option.size() > 4 && option.substr(option.size() - 4) == " off";
+        std::string_view name = option.substr(0, option.find(' '));
+        
+        if ((enable || disable) && name == "nodelay") {
+            session.set_nodelay(enable);
+            response = enable ? "TCP_NODELAY on\r\n" : "TCP_NODELAY off\r\n";
+        } else if ((enable || disable) && name == "cork") {
+            session.set_cork(enable);
+            response = enable ? "TCP_CORK on\r\n" : "TCP_CORK off\r\n";
+        } else {
+            response = "Usage: set nodelay|cork on|off\r\n";
+        }
+        
+    } else if (cmd == "config" || cmd.substr(0, 7) == "config ") {
+        response = update_session_defaults(session, cmd.size() > 7 ? cmd.substr(7) : std::string_view(), scratch);
         
     } else if (cmd == "quit" || cmd == "exit") {
-        response = "Goodbye!\r\n";
-        return "QUIT:" + response;  // Special marker for quit
+        response = "QUIT:Goodbye!\r\n";  // Special marker for quit
         
     } else {
-        response = "Unknown command: " + cmd + "\r\n";
+        response = "Unknown command: ";
+        response += cmd;
+        response += "\r\n";
         response += "Type 'help' for available commands.\r\n";
     }
     
     return response;
 }
 
-// Handle individual client connection
-void handle_client(int client_socket, const std::string& client_ip, int client_port) {
-    TelnetSession session(client_socket, client_ip, client_port);
-    
-    std::cout << "🔗 New Telnet client connected: " << client_ip << ":" << client_port << std::endl;
-    
-    // Send welcome message
+// Build the greeting, initial negotiation and first prompt for a new session
+void send_welcome(TelnetSession& session) {
     std::string welcome = "\r\n";
     welcome += "=========================================\r\n";
     welcome += "  Welcome to Basic Telnet Server\r\n";
     welcome += "=========================================\r\n";
-    welcome += "Connected from: " + client_ip + ":" + std::to_string(client_port) + "\r\n";
+    welcome += "Connected from: " + session.client_ip + ":" + std::to_string(session.client_port) + "\r\n";
     welcome += "Type 'help' for available commands.\r\n";
+    {
+        auto defaults = session_defaults.read();
+        if (!defaults->motd.empty()) {
+            welcome += defaults->motd + "\r\n";
+        }
+    }
     welcome += "\r\n";
     
-    send_to_client(client_socket, welcome);
+    session.write(welcome);
     
-    // Initial Telnet negotiation
-    send_telnet_command(client_socket, TELNET_WILL, TELNET_ECHO);
-    send_telnet_command(client_socket, TELNET_WILL, TELNET_SUPPRESS_GA);
+    // Initial Telnet negotiation (recorded so the client's acks are not re-answered)
+    session.options.set_local(TELNET_ECHO, true);
+    session.options.set_local(TELNET_SUPPRESS_GA, true);
+    session.options.set_remote(TELNET_TERMINAL_TYPE, true);
+    session.options.set_remote(TELNET_WINDOW_SIZE, true);
+    send_telnet_command(session, TELNET_WILL, TELNET_ECHO);
+    send_telnet_command(session, TELNET_WILL, TELNET_SUPPRESS_GA);
+    send_telnet_command(session, TELNET_DO, TELNET_TERMINAL_TYPE);
+    send_telnet_command(session, TELNET_DO, TELNET_WINDOW_SIZE);
     
-    char buffer[BUFFER_SIZE];
-    std::string input_buffer;
+    session.write(session.current_directory + "$ ");
+}
+
+// Receives the decoded stream from the session's telnet::Parser and applies
+// it to the line editor (input buffer, echo, backspace, command execution)
+struct SessionInputHandler {
+    TelnetSession& session;
+    bool quit = false;
     
-    while (server_running) {
-        // Send prompt
-        std::string prompt = session.current_directory + "$ ";
-        send_to_client(client_socket, prompt);
-        
-        // Read data from client
-        ssize_t bytes_received = recv(client_socket, buffer, BUFFER_SIZE - 1, 0);
-        
-        if (bytes_received <= 0) {
-            break;  // Client disconnected or error
-        }
-        
-        // Process received data
-        for (int i = 0; i < bytes_received; i++) {
-            unsigned char byte = buffer[i];
-            
-            if (byte == TELNET_IAC && i + 2 < bytes_received) {
-                // Telnet command sequence
-                std::vector<unsigned char> command = {
-                    static_cast<unsigned char>(buffer[i]), 
-                    static_cast<unsigned char>(buffer[i+1]), 
-                    static_cast<unsigned char>(buffer[i+2])
-                };
-                process_telnet_command(session, command);
-                i += 2;  // Skip the next two bytes
-                
-            } else if (byte == '\r' || byte == '\n') {
-                // End of command
-                if (!input_buffer.empty()) {
-                    std::string response = execute_command(session, input_buffer);
-                    
-                    if (response.substr(0, 5) == "QUIT:") {
-                        send_to_client(client_socket, response.substr(5));
-                        goto cleanup;  // Break out of nested loops
-                    }
-                    
-                    if (!response.empty()) {
-                        send_to_client(client_socket, response);
-                    }
-                    
-                    input_buffer.clear();
-                }
-                
-            } else if (byte >= 32 && byte <= 126) {
-                // Printable character
-                input_buffer += byte;
+    void on_data(const unsigned char* data, size_t length) {
+        size_t i = 0;
+        while (i < length && !quit) {
+            // Printable characters are appended and echoed a whole run at a time
+            size_t run = telnet::scan_printable(data + i, length - i);
+            if (run > 0) {
+                const char* text = reinterpret_cast<const char*>(data + i);
+                session.input_buffer.append(text, run);
                 
                 // Echo back if echo is enabled
                 if (session.echo_enabled) {
-                    char echo_char = byte;
-                    send(client_socket, &echo_char, 1, 0);
+                    session.write(text, run);
+                }
+                i += run;
+                continue;
+            }
+            
+            unsigned char byte = data[i++];
+            if (byte == '\r' || byte == '\n') {
+                // End of command
+                if (!session.input_buffer.empty()) {
+                    end_of_line();
                 }
                 
             } else if (byte == 8 || byte == 127) {
                 // Backspace or delete
-                if (!input_buffer.empty()) {
-                    input_buffer.pop_back();
+                if (!session.input_buffer.empty()) {
+                    session.input_buffer.pop_back();
                     if (session.echo_enabled) {
-                        send_to_client(client_socket, "\b \b");  // Backspace, space, backspace
+                        session.write("\b \b");  // Backspace, space, backspace
                     }
                 }
             }
         }
     }
     
-cleanup:
-    // Remove client from list
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex);
-        client_sockets.erase(
-            std::remove(client_sockets.begin(), client_sockets.end(), client_socket),
-            client_sockets.end()
-        );
+    void end_of_line() {
+        memory::MonotonicArena& arena = command_arena();
+        arena.reset();
+        memory::AllocationScope allocations;
+        
+        std::pmr::string response(&arena);
+        {
+            metrics::ScopedTimer timer(command_latency);
+            response = execute_command(session, session.input_buffer, &arena);
+        }
+        trace_command(session.input_buffer.size());
+        session.input_buffer.clear();
+        
+        if (response.compare(0, 5, "QUIT:") == 0) {
+            session.write(response.data() + 5, response.size() - 5);
+            quit = true;
+        } else {
+            if (!response.empty()) {
+                session.write(response.data(), response.size());
+            }
+            
+            // Send prompt
+            session.write(session.current_directory);
+            session.write("$ ", 2);
+        }
+        
+        session.io.commands++;
+        session.io.last_command_allocations = allocations.allocations();
+        session.io.command_allocations += session.io.last_command_allocations;
+        commands_total.add();
+        command_allocations_total.add(session.io.last_command_allocations);
+    }
+    
+    void on_command(unsigned char) {
+        // NOP, GA, AYT, ... carry no state for this server
+    }
+    
+    void on_negotiation(unsigned char command, unsigned char option) {
+        if (!quit) process_telnet_command(session, command, option);
     }
     
+    void on_subnegotiation(unsigned char option, const unsigned char* data, size_t length) {
+        if (!quit) process_subnegotiation(session, option, data, length);
+    }
+};
+
+// Feed received bytes through the session's parser. Returns false once the
+// client asked to quit. Used by both the threaded and the reactor mode.
+bool process_input(TelnetSession& session, const char* data, size_t length) {
+    metrics::ScopedTimer timer(recv_latency);
+    trace_recv(length);
+    SessionInputHandler handler{session};
+    session.parser.feed(data, length, handler);
+    return !handler.quit;
+}
+
+// Add a client to the registry; a full registry turns the client away
+bool register_client(TelnetSession& session) {
+    session.registry_handle = client_registry.insert(session.socket);
+    if (session.registry_handle.valid()) {
+        return true;
+    }
+    const char* message = "Server full, try again later.\r\n";
+    send(session.socket, message, strlen(message), MSG_NOSIGNAL);
+    return false;
+}
+
+// Remove client from the registry (O(1), by handle); the end of a session
+// in every mode
+void unregister_client(TelnetSession& session) {
+    client_registry.remove(session.registry_handle);
+    disconnects_total.add();
+    trace_close(static_cast<uint64_t>(session.socket));
+    LOG_INFO << "Client disconnected: " << session.client_ip << ":" << session.client_port;
+}
+
+// Apply the server-wide TCP defaults to a new session
+void apply_default_socket_options(TelnetSession& session) {
+    auto defaults = session_defaults.read();
+    if (defaults->nodelay) {
+        session.set_nodelay(true);
+    }
+    session.set_cork(defaults->cork);
+}
+
+// Register a new session, apply the defaults and queue the welcome. False
+// if the registry is full; the caller then closes the socket.
+bool open_session(TelnetSession& session) {
+    metrics::ScopedTimer timer(accept_latency);
+    if (!register_client(session)) {
+        rejected_total.add();
+        LOG_WARNING << "Server full, rejected " << session.client_ip << ":" << session.client_port;
+        return false;
+    }
+    connections_total.add();
+    trace_accept(static_cast<uint64_t>(session.socket));
+    LOG_INFO << "Client connected: " << session.client_ip << ":" << session.client_port;
+    
+    apply_default_socket_options(session);
+    send_welcome(session);
+    return true;
+}
+
+// Handle individual client connection (threaded mode)
+void handle_client(int client_socket, const std::string& client_ip, int client_port) {
+    TelnetSession session(client_socket, client_ip, client_port);
+    if (!open_session(session)) {
+        close(client_socket);
+        return;
+    }
+    
+    char buffer[BUFFER_SIZE];
+    
+    while (server_running && session.flush()) {
+        // Read data from client
+        ssize_t bytes_received = recv(client_socket, buffer, BUFFER_SIZE - 1, 0);
+        count_recv(session.io, bytes_received);
+        
+        if (bytes_received <= 0) {
+            break;  // Client disconnected or error
+        }
+        
+        // Everything this batch produced goes out in the next flush()
+        if (!process_input(session, buffer, static_cast<size_t>(bytes_received))) {
+            session.flush();  // "Goodbye!"
+            break;  // Client asked to quit
+        }
+    }
+    
+    unregister_client(session);
+    close(client_socket);
+}
+
+// =============================================================================
+// REACTOR MODE
+// =============================================================================
+
+// One accepted connection served by an event loop. All callbacks run on the
+// owning loop's thread, so the session needs no locking of its own.
+class ReactorConnection : public net::EventHandler {
+public:
+    ReactorConnection(net::EventLoop& loop, int sock, const std::string& ip, int port)
+        : loop_(loop), session_(sock, ip, port) {}
+    
+    void start() {
+        if (!open_session(session_)) {
+            close(session_.socket);
+            delete this;
+            return;
+        }
+        registered_ = true;
+        if (!loop_.add(session_.socket, net::EVENT_READ, this)) {
+            close_connection();
+            return;
+        }
+        update_interest();
+        rearm_timers();
+    }
+    
+    void handle_event(uint32_t events) override {
+        if (closed_) return;
+        
+        if (events & net::EVENT_READ) {
+            if (!read_available()) {
+                close_connection();
+                return;
+            }
+        } else if (events & net::EVENT_ERROR) {
+            close_connection();
+            return;
+        }
+        
+        if (!update_interest()) {
+            close_connection();
+        }
+    }
+    
+private:
+    // Drain the socket (edge cases: EOF and quit both end the session).
+    // Stops early once more than OUTPUT_HIGH_WATER is queued for a client
+    // that is not reading its replies; update_interest() then pauses reads.
+    bool read_available() {
+        static thread_local char buffer[REACTOR_READ_SIZE];
+        
+        while (true) {
+            if (session_.output.size() > OUTPUT_HIGH_WATER) {
+                if (!session_.flush()) return false;
+                if (session_.output.size() > OUTPUT_HIGH_WATER) return true;  // The rest waits in the kernel
+            }
+            ssize_t bytes_received = recv(session_.socket, buffer, sizeof(buffer), 0);
+            count_recv(session_.io, bytes_received);
+            if (bytes_received > 0) {
+                if (!process_input(session_, buffer, static_cast<size_t>(bytes_received))) {
+                    session_.flush();  // Best effort "Goodbye!"
+                    return false;
+                }
+                rearm_timers();
+                continue;
+            }
+            if (bytes_received == 0) return false;  // Peer closed
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+    }
+    
+    // Flush queued output (once per readiness event, however many recv()
+    // calls it took) and only ask for writability while output is pending.
+    // Reads are paused while the backlog is above OUTPUT_HIGH_WATER, so the
+    // client's unread replies push back on its input (and TCP on the
+    // client), as the blocking flush() does in threaded mode.
+    bool update_interest() {
+        if (!session_.flush()) return false;
+        bool want_write = !session_.output.empty();
+        bool want_read = session_.output.size() <= OUTPUT_HIGH_WATER;
+        if (want_write != write_armed_ || want_read != read_armed_) {
+            uint32_t interest = (want_read ? net::EVENT_READ : 0u) | (want_write ? net::EVENT_WRITE : 0u);
+            if (!loop_.modify(session_.socket, interest, this)) return false;
+            write_armed_ = want_write;
+            read_armed_ = want_read;
+        }
+        return true;
+    }
+    
+    // Push both deadlines out: called on connect and on every read
+    void rearm_timers() {
+        auto defaults = session_defaults.read();
+        if (defaults->idle_timeout > 0) {
+            loop_.schedule_after(idle_timer_, static_cast<uint64_t>(defaults->idle_timeout) * 1000);
+        } else {
+            idle_timer_.cancel();  // Turned off since the last read
+        }
+        if (defaults->keepalive > 0) {
+            loop_.schedule_after(keepalive_timer_, static_cast<uint64_t>(defaults->keepalive) * 1000);
+        } else {
+            keepalive_timer_.cancel();
+        }
+    }
+    
+    void on_idle_timeout() {
+        if (closed_) return;
+        session_.write("\r\nIdle timeout, closing connection. Goodbye!\r\n");
+        session_.flush();
+        close_connection();
+    }
+    
+    // Probe a quiet client so dead peers (and NAT entries) get noticed
+    void on_keepalive() {
+        if (closed_) return;
+        const char nop[] = {static_cast<char>(TELNET_IAC), static_cast<char>(TELNET_NOP)};
+        session_.write(nop, sizeof(nop));
+        if (!update_interest()) {
+            close_connection();
+            return;
+        }
+        int keepalive = session_defaults.read()->keepalive;
+        if (keepalive > 0) {
+            loop_.schedule_after(keepalive_timer_, static_cast<uint64_t>(keepalive) * 1000);
+        }
+    }
+    
+    void close_connection() {
+        if (closed_) return;
+        closed_ = true;
+        idle_timer_.cancel();
+        keepalive_timer_.cancel();
+        
+        loop_.remove(session_.socket);
+        if (registered_) unregister_client(session_);
+        close(session_.socket);
+        
+        // Defer the delete: the current event batch may still reference us
+        loop_.post([this] { delete this; });
+    }
+    
+    net::EventLoop& loop_;
+    TelnetSession session_;
+    net::Timer idle_timer_{[this] { on_idle_timeout(); }};
+    net::Timer keepalive_timer_{[this] { on_keepalive(); }};
+    bool write_armed_ = false;
+    bool read_armed_ = true;
+    bool registered_ = false;
+    bool closed_ = false;
+};
+
+// accept() errors in the event-driven modes. Out of descriptors (EMFILE,
+// ENFILE) or memory, the pending connection stays queued and the listener
+// stays readable, so retrying at once would spin at 100% CPU. Accepting is
+// paused instead, for 10ms doubling up to 1s, and logged at most once a
+// second. Errors that only affect one connection are retried at once.
+class AcceptBackoff {
+public:
+    static const uint64_t MIN_DELAY_MS = 10;
+    static const uint64_t MAX_DELAY_MS = 1000;
+    
+    // Milliseconds to pause accepting for, 0 to retry right away
+    uint64_t on_error(int error, uint64_t now_ms) {
+        if (error == EINTR || error == ECONNABORTED) return 0;
+        failures_++;
+        delay_ms_ = delay_ms_ == 0 ? MIN_DELAY_MS : std::min(2 * delay_ms_, MAX_DELAY_MS);
+        if (now_ms >= next_log_ms_) {
+            LOG_ERROR << "Error accepting client connection: " << strerror(error) << " (" << failures_
+                      << " in a row, pausing accept for " << delay_ms_ << " ms)";
+            next_log_ms_ = now_ms + 1000;
+        }
+        return delay_ms_;
+    }
+    
+    void on_success() {
+        failures_ = 0;
+        delay_ms_ = 0;
+    }
+    
+private:
+    uint64_t failures_ = 0;
+    uint64_t delay_ms_ = 0;
+    uint64_t next_log_ms_ = 0;
+};
+
+// Accepts new connections on the listening socket and deals them out to the
+// event loops round-robin. Runs on loops[0], which owns the listener.
+class Acceptor : public net::EventHandler {
+public:
+    Acceptor(int listen_socket, std::vector<std::unique_ptr<net::EventLoop>>& loops)
+        : listen_socket_(listen_socket), loops_(loops) {}
+    
+    void handle_event(uint32_t) override {
+        while (true) {
+            struct sockaddr_in client_addr;
+            socklen_t client_len = sizeof(client_addr);
+            int client_socket = accept(listen_socket_, (struct sockaddr*)&client_addr, &client_len);
+            if (client_socket < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || !server_running) return;
+                uint64_t delay_ms = backoff_.on_error(errno, loops_[0]->now_ms());
+                if (delay_ms == 0) continue;
+                // Stop watching the listener until the timer re-arms it
+                loops_[0]->modify(listen_socket_, 0, this);
+                loops_[0]->schedule_after(resume_timer_, delay_ms);
+                return;
+            }
+            backoff_.on_success();
+            
+            net::set_nonblocking(client_socket);
+            
+            char client_ip[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
+            int client_port = ntohs(client_addr.sin_port);
+            
+            net::EventLoop& loop = *loops_[next_loop_];
+            next_loop_ = (next_loop_ + 1) % loops_.size();
+            
+            std::string ip(client_ip);
+            loop.post([&loop, client_socket, ip, client_port] {
+                auto* connection = new ReactorConnection(loop, client_socket, ip, client_port);
+                connection->start();
+            });
+        }
+    }
+    
+private:
+    int listen_socket_;
+    std::vector<std::unique_ptr<net::EventLoop>>& loops_;
+    size_t next_loop_ = 0;
+    AcceptBackoff backoff_;
+    net::Timer resume_timer_{[this] { loops_[0]->modify(listen_socket_, net::EVENT_READ, this); }};
+};
+
+// =============================================================================
+// COROUTINE MODE
+// =============================================================================
+
+#if TELNET_HAS_COROUTINES
+
+// handle_client() as a coroutine on an event loop. The code is the same
+// loop, but a recv() with nothing to read suspends the session instead of
+// blocking a thread: an idle client costs its coroutine frame (the
+// TelnetSession plus a few locals) rather than a thread stack.
+concurrency::Task<void> handle_client_coroutine(net::EventLoop& loop, int client_socket, std::string client_ip,
+                                                int client_port) {
+    TelnetSession session(client_socket, client_ip, client_port);
+    if (!open_session(session)) {
+        close(client_socket);
+        co_return;
+    }
+    
+    net::AsyncSocket socket(loop, client_socket);
+    // One buffer per loop thread, not per session: input is parsed before
+    // the next suspension point
+    static thread_local char buffer[REACTOR_READ_SIZE];
+    
+    while (server_running) {
+        // Send what the socket takes, wait for room for the rest
+        bool connected = session.flush();
+        while (connected && !session.output.empty()) {
+            connected = co_await net::async_writable(socket) == 0 && session.flush();
+        }
+        if (!connected) {
+            break;
+        }
+        
+        ssize_t bytes_received = co_await net::async_recv(socket, buffer, sizeof(buffer));
+        count_recv(session.io, bytes_received);
+        
+        if (bytes_received <= 0) {
+            break;  // Client disconnected or error
+        }
+        
+        if (!process_input(session, buffer, static_cast<size_t>(bytes_received))) {
+            session.flush();  // Best effort "Goodbye!"
+            break;  // Client asked to quit
+        }
+    }
+    
+    socket.remove();
+    unregister_client(session);
     close(client_socket);
-    std::cout << "🔌 Client disconnected: " << client_ip << ":" << client_port << std::endl;
 }
 
-int main() {
+// Accept on `loop` and start each session on the next loop round-robin
+concurrency::Task<void> accept_clients(net::EventLoop& loop, std::vector<std::unique_ptr<net::EventLoop>>& loops) {
+    net::AsyncSocket listener(loop, server_socket);
+    size_t next_loop = 0;
+    AcceptBackoff backoff;
+    
+    while (server_running) {
+        struct sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+        int client_socket = co_await net::async_accept(listener, (struct sockaddr*)&client_addr, &client_len);
+        if (client_socket < 0) {
+            if (!server_running) break;
+            uint64_t delay_ms = backoff.on_error(errno, loop.now_ms());
+            if (delay_ms > 0) {
+                // Nobody waits on the listener meanwhile, so the loop drops
+                // its read interest after one report instead of spinning
+                co_await net::async_sleep(loop, delay_ms);
+            }
+            continue;
+        }
+        backoff.on_success();
+        
+        net::set_nonblocking(client_socket);
+        
+        char client_ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
+        int client_port = ntohs(client_addr.sin_port);
+        
+        net::EventLoop& target = *loops[next_loop];
+        next_loop = (next_loop + 1) % loops.size();
+        
+        std::string ip(client_ip);
+        target.post([&target, client_socket, ip, client_port] {
+            handle_client_coroutine(target, client_socket, ip, client_port).detach();
+        });
+    }
+}
+
+#endif  // TELNET_HAS_COROUTINES
+
+// Serve all clients from config.loop_threads event loops. Loop 0 runs on
+// the calling thread and also owns the listening socket.
+int run_reactor(const ServerConfig& config) {
+    std::cout << "✓ File descriptor limit: " << net::raise_fd_limit() << std::endl;
+    net::set_nonblocking(server_socket);
+    
+    int loop_count = config.loop_threads;
+    if (loop_count <= 0) {
+        loop_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    std::vector<std::unique_ptr<net::EventLoop>> loops;
+    for (int i = 0; i < loop_count; ++i) {
+        loops.push_back(std::make_unique<net::EventLoop>());
+    }
+    
+    Acceptor acceptor(server_socket, loops);
+    if (config.coroutines) {
+#if TELNET_HAS_COROUTINES
+        accept_clients(*loops[0], loops).detach();
+#endif
+    } else if (!loops[0]->add(server_socket, net::EVENT_READ, &acceptor)) {
+        std::cerr << "❌ Error: Failed to register listening socket" << std::endl;
+        return 1;
+    }
+    
+    std::cout << "✓ " << (config.coroutines ? "Coroutine" : "Reactor") << " mode: " << loop_count
+              << " event loop thread(s)" << std::endl;
+    if (config.coroutines && (config.idle_timeout > 0 || config.keepalive > 0)) {
+        std::cout << "⚠️  --idle-timeout / --keepalive are reactor-only, ignored" << std::endl;
+    }
+    if (config.idle_timeout > 0 && !config.coroutines) {
+        std::cout << "✓ Idle timeout: " << config.idle_timeout << "s" << std::endl;
+    }
+    if (config.keepalive > 0 && !config.coroutines) {
+        std::cout << "✓ Keepalive: IAC NOP after " << config.keepalive << "s of silence" << std::endl;
+    }
+    
+    std::vector<std::thread> loop_threads;
+    for (int i = 1; i < loop_count; ++i) {
+        loop_threads.emplace_back([&loops, i] { loops[i]->run(); });
+    }
+    loops[0]->run();
+    
+    for (int i = 1; i < loop_count; ++i) {
+        loops[i]->stop();
+    }
+    for (auto& t : loop_threads) {
+        t.join();
+    }
+    return 0;
+}
+
+// Parse command line flags; returns false on bad usage
+bool parse_arguments(int argc, char* argv[], ServerConfig& config) {
+    logging::Level level;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--reactor") {
+            config.reactor = true;
+        } else if (arg == "--coroutines") {
+            if (!TELNET_HAS_COROUTINES) {
+                std::cerr << "--coroutines needs a C++20 build (cmake -DBOOTCAMP_CXX20=ON)" << std::endl;
+                return false;
+            }
+            config.reactor = true;
+            config.coroutines = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            config.loop_threads = std::stoi(argv[++i]);
+        } else if (arg == "--port" && i + 1 < argc) {
+            config.port = std::stoi(argv[++i]);
+        } else if (arg == "--nodelay") {
+            config.nodelay = true;
+        } else if (arg == "--cork") {
+            config.cork = true;
+        } else if (arg == "--idle-timeout" && i + 1 < argc) {
+            config.idle_timeout = std::stoi(argv[++i]);
+        } else if (arg == "--keepalive" && i + 1 < argc) {
+            config.keepalive = std::stoi(argv[++i]);
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            config.metrics_port = std::stoi(argv[++i]);
+        } else if (arg == "--metrics-address" && i + 1 < argc) {
+            config.metrics_address = argv[++i];
+        } else if (arg == "--allow-config") {
+            config.allow_config = true;
+        } else if (arg == "--log-level" && i + 1 < argc && logging::parse_level(argv[i + 1], level)) {
+            logging::set_level(level);
+            ++i;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--reactor | --coroutines] [--threads N] [--port P] [--nodelay] [--cork]"
+                      << " [--idle-timeout SEC] [--keepalive SEC] [--metrics-port P] [--metrics-address A]"
+                      << " [--allow-config]"
+                      << " [--log-level error|warning|info|debug]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    ServerConfig& config = server_config;
+    if (!parse_arguments(argc, argv, config)) {
+        return 1;
+    }
+    SessionDefaults defaults;
+    defaults.nodelay = config.nodelay;
+    defaults.cork = config.cork;
+    defaults.idle_timeout = config.idle_timeout;
+    defaults.keepalive = config.keepalive;
+    session_defaults.store(std::move(defaults));
+    
     std::cout << "=== BASIC TELNET SERVER ===" << std::endl;
-    std::cout << "Starting Telnet server on port " << TELNET_PORT << std::endl;
+    std::cout << "Starting Telnet server on port " << config.port << std::endl;
     
     // Set up signal handler
     signal(SIGINT, signal_handler);
+    signal(SIGPIPE, SIG_IGN);  // A vanished client must not kill the server
     
     // Create TCP socket
     server_socket = socket(AF_INET, SOCK_STREAM, 0);
@@ -334,27 +1299,44 @@ int main() {
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(TELNET_PORT);
+    server_addr.sin_port = htons(config.port);
     
     // Bind socket to address
     if (bind(server_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        std::cerr << "❌ Error: Failed to bind socket to port " << TELNET_PORT << std::endl;
+        std::cerr << "❌ Error: Failed to bind socket to port " << config.port << std::endl;
         close(server_socket);
         return 1;
     }
     
-    // Listen for connections
-    if (listen(server_socket, MAX_CLIENTS) < 0) {
+    // Listen for connections (the reactor expects bursts of thousands of connects)
+    if (listen(server_socket, config.reactor ? SOMAXCONN : MAX_CLIENTS) < 0) {
         std::cerr << "❌ Error: Failed to listen on socket" << std::endl;
         close(server_socket);
         return 1;
     }
     
-    std::cout << "✓ Server listening on port " << TELNET_PORT << std::endl;
-    std::cout << "✓ Maximum clients: " << MAX_CLIENTS << std::endl;
+    std::cout << "✓ Server listening on port " << config.port << std::endl;
+    if (!config.reactor) {
+        std::cout << "✓ Maximum clients: " << MAX_CLIENTS << std::endl;
+    }
+    if (config.metrics_port > 0) {
+        if (metrics::serve_prometheus(config.metrics_port, config.metrics_address.c_str())) {
+            std::cout << "✓ Metrics: http://" << config.metrics_address << ":" << config.metrics_port << "/metrics"
+                      << std::endl;
+        } else {
+            std::cerr << "⚠️  Warning: Failed to serve metrics on port " << config.metrics_port << std::endl;
+        }
+    }
+    if (config.allow_config) {
+        std::cout << "✓ Session defaults can be changed with \"config\" from localhost" << std::endl;
+    }
     std::cout << "✓ Ready to accept connections..." << std::endl;
     std::cout << "  (Press Ctrl+C to stop)" << std::endl;
-    std::cout << "\n📋 To connect: telnet localhost " << TELNET_PORT << std::endl << std::endl;
+    std::cout << "\n📋 To connect: telnet localhost " << config.port << std::endl << std::endl;
+    
+    if (config.reactor) {
+        return run_reactor(config);
+    }
     
     // Main server loop
     while (server_running) {
@@ -366,7 +1348,7 @@ int main() {
         
         if (client_socket < 0) {
             if (server_running) {
-                std::cerr << "❌ Error accepting client connection" << std::endl;
+                LOG_ERROR << "Error accepting client connection: " << strerror(errno);
             }
             continue;
         }
@@ -376,12 +1358,6 @@ int main() {
         inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
         int client_port = ntohs(client_addr.sin_port);
         
-        // Add client to list
-        {
-            std::lock_guard<std::mutex> lock(clients_mutex);
-            client_sockets.push_back(client_socket);
-        }
-        
         // Handle client in separate thread
         std::thread client_thread(handle_client, client_socket, std::string(client_ip), client_port);
         client_thread.detach();
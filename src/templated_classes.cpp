@@ -6,6 +6,11 @@
 
 // Includes std::cout (printing).
 #include <iostream>
+#include <cstdio>
+#include <vector>
+
+#include "benchmark.h"
+#include "fixed_math.h"
 
 // Templates can be also used to implement classes. For instance, here is a
 // basic templated class that stores one element of a templated type and
@@ -78,6 +83,150 @@ class Bar {
     }
 };
 
+// Non-type template parameters are also how a size becomes part of a type.
+// math::Vec<T, N> and math::Mat<T, R, C> (fixed_math.h) know their sizes at
+// compile time, so every loop over them is unrolled and float/double
+// operations pick SIMD instructions with if constexpr. This compares them
+// with the same math on a matrix whose size is only known at run time.
+class DynamicMatrix {
+  public:
+    DynamicMatrix(size_t rows, size_t cols) : rows_(rows), cols_(cols), values_(rows * cols) {}
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    double& operator()(size_t r, size_t c) { return values_[r * cols_ + c]; }
+    double operator()(size_t r, size_t c) const { return values_[r * cols_ + c]; }
+  private:
+    size_t rows_;
+    size_t cols_;
+    std::vector<double> values_;
+};
+
+// out = a * b, with out already sized
+void multiply(const DynamicMatrix& a, const DynamicMatrix& b, DynamicMatrix& out) {
+  for (size_t r = 0; r < a.rows(); ++r) {
+    for (size_t c = 0; c < b.cols(); ++c) {
+      double sum = 0;
+      for (size_t k = 0; k < a.cols(); ++k) sum += a(r, k) * b(k, c);
+      out(r, c) = sum;
+    }
+  }
+}
+
+// out[0, rows) = m * v
+void multiply(const DynamicMatrix& m, const double* v, double* out) {
+  for (size_t r = 0; r < m.rows(); ++r) {
+    double sum = 0;
+    for (size_t c = 0; c < m.cols(); ++c) sum += m(r, c) * v[c];
+    out[r] = sum;
+  }
+}
+
+template <typename T>
+math::Mat<T, 4, 4> sample_transform() {
+  return math::translation<T>(1, 2, 3) * math::scaling<T>(T(0.5), 2, 1);
+}
+
+void measure_fixed_size_math() {
+  const size_t MATRICES = 1024;
+  const size_t POINTS = 1 << 20;
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;  // The table below instead
+  bench::Suite suite("templated_classes", options);
+  auto ns_per_op = [&](const std::string& name, size_t items, auto&& op) {
+    return suite.run(name, op, items).ns_per_item();
+  };
+
+  // Runtime-sized inputs (4x4 and 4-vectors, but the code cannot know)
+  DynamicMatrix transform(4, 4);
+  std::vector<DynamicMatrix> dynamic_matrices(MATRICES, DynamicMatrix(4, 4));
+  std::vector<DynamicMatrix> dynamic_products(MATRICES, DynamicMatrix(4, 4));
+  std::vector<double> dynamic_points(4 * POINTS), dynamic_moved(4 * POINTS);
+  math::Mat<double, 4, 4> fixed_transform = sample_transform<double>();
+  for (size_t r = 0; r < 4; ++r) {
+    for (size_t c = 0; c < 4; ++c) transform(r, c) = fixed_transform(r, c);
+  }
+  std::vector<math::Mat<double, 4, 4>> double_matrices(MATRICES), double_products(MATRICES);
+  std::vector<math::Mat<float, 4, 4>> float_matrices(MATRICES), float_products(MATRICES);
+  for (size_t i = 0; i < MATRICES; ++i) {
+    for (size_t r = 0; r < 4; ++r) {
+      for (size_t c = 0; c < 4; ++c) {
+        double value = static_cast<double>((i + r * 4 + c) % 10);
+        dynamic_matrices[i](r, c) = value;
+        double_matrices[i](r, c) = value;
+        float_matrices[i](r, c) = static_cast<float>(value);
+      }
+    }
+  }
+  std::vector<math::Vec<double, 4>> double_points(POINTS), double_moved(POINTS);
+  std::vector<math::Vec<float, 4>> float_points(POINTS), float_moved(POINTS);
+  for (size_t i = 0; i < POINTS; ++i) {
+    for (size_t c = 0; c < 4; ++c) {
+      double value = c == 3 ? 1.0 : static_cast<double>(i % 100) + c;
+      dynamic_points[4 * i + c] = value;
+      double_points[i][c] = value;
+      float_points[i][c] = static_cast<float>(value);
+    }
+  }
+  math::Mat<float, 4, 4> float_transform = sample_transform<float>();
+
+  auto print_row = [](const char* operation, double dynamic_ns, double double_ns, double float_ns) {
+    printf("  %-24s %12.2f %12.2f %12.2f   %5.1fx\n", operation, dynamic_ns, double_ns, float_ns,
+           dynamic_ns / float_ns);
+  };
+  printf("  %-24s %12s %12s %12s   %s\n", "ns per operation", "runtime size", "Mat<double>", "Mat<float>",
+         "gain");
+  print_row("4x4 * 4x4",
+            ns_per_op("4x4 multiply / runtime size", MATRICES, [&] {
+              for (size_t i = 0; i < MATRICES; ++i) multiply(transform, dynamic_matrices[i], dynamic_products[i]);
+              bench::clobber_memory();
+            }),
+            ns_per_op("4x4 multiply / Mat<double>", MATRICES, [&] {
+              for (size_t i = 0; i < MATRICES; ++i) double_products[i] = fixed_transform * double_matrices[i];
+              bench::clobber_memory();
+            }),
+            ns_per_op("4x4 multiply / Mat<float>", MATRICES, [&] {
+              for (size_t i = 0; i < MATRICES; ++i) float_products[i] = float_transform * float_matrices[i];
+              bench::clobber_memory();
+            }));
+  print_row("4x4 * point",
+            ns_per_op("transform point / runtime size", POINTS, [&] {
+              for (size_t i = 0; i < POINTS; ++i) multiply(transform, &dynamic_points[4 * i], &dynamic_moved[4 * i]);
+              bench::clobber_memory();
+            }),
+            ns_per_op("transform point / Mat<double>", POINTS, [&] {
+              for (size_t i = 0; i < POINTS; ++i) double_moved[i] = fixed_transform * double_points[i];
+              bench::clobber_memory();
+            }),
+            ns_per_op("transform point / Mat<float>", POINTS, [&] {
+              for (size_t i = 0; i < POINTS; ++i) float_moved[i] = float_transform * float_points[i];
+              bench::clobber_memory();
+            }));
+  print_row("dot of 4-vectors",
+            ns_per_op("dot / runtime size", POINTS, [&] {
+              double sum = 0;
+              for (size_t i = 0; i < POINTS; ++i) {
+                for (size_t c = 0; c < transform.cols(); ++c) sum += dynamic_points[4 * i + c] * dynamic_moved[4 * i + c];
+              }
+              bench::do_not_optimize(sum);
+            }),
+            ns_per_op("dot / Vec<double>", POINTS, [&] {
+              double sum = 0;
+              for (size_t i = 0; i < POINTS; ++i) sum += math::dot(double_points[i], double_moved[i]);
+              bench::do_not_optimize(sum);
+            }),
+            ns_per_op("dot / Vec<float>", POINTS, [&] {
+              float sum = 0;
+              for (size_t i = 0; i < POINTS; ++i) sum += math::dot(float_points[i], float_moved[i]);
+              bench::do_not_optimize(sum);
+            }));
+
+  // The same code runs at compile time, where no SIMD is involved
+  constexpr math::Vec<float, 4> moved = math::translation<float>(1, 2, 3) * math::Vec<float, 4>{0, 0, 0, 1};
+  static_assert(moved == math::Vec<float, 4>{1, 2, 3, 1}, "evaluated by the compiler");
+  std::cout << "  (compile time: translation(1, 2, 3) * origin = {" << moved[0] << ", " << moved[1] << ", "
+            << moved[2] << ", " << moved[3] << "})" << std::endl;
+}
+
 int main() {
   // First, let us construct an object from a templated class. The Foo
   // class template is instantiated with an int template argument. This
@@ -124,5 +273,10 @@ int main() {
   // to understand them you'll be seeing code similar to this in the Bustub
   // codebase, so it's good to understand templated classes in these contexts!
 
+  // Not all of them are contrived, though: here are size parameters used
+  // for performance.
+  std::cout << "\nFixed-size math vs runtime-sized math:" << std::endl;
+  measure_fixed_size_math();
+
   return 0;
 }
\ No newline at end of file
@@ -6,6 +6,12 @@
 
 // Includes std::cout (printing) for demo purposes.
 #include <iostream>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "benchmark.h"
+#include "lookup_tables.h"
 
 // Templates are a language feature in C++ that allow you to write code that
 // can work with multiple data types, without actually specifying those types.
@@ -49,6 +55,75 @@ template <bool T> int add3(int a) {
   return a;
 }
 
+// Templated and constexpr functions can also run inside the compiler. The
+// generators in lookup_tables.h build CRC-32 and popcount tables at compile
+// time; here they are measured against computing the same answers bit by
+// bit at run time.
+uint32_t crc32_bitwise(const char* data, size_t size) {
+  uint32_t crc = ~0u;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= static_cast<uint8_t>(data[i]);
+    for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320u : 0);
+  }
+  return ~crc;
+}
+
+// One table lookup per byte (the first of the eight tables)
+uint32_t crc32_bytewise(const char* data, size_t size) {
+  uint32_t crc = ~0u;
+  for (size_t i = 0; i < size; ++i) {
+    crc = (crc >> 8) ^ tables::CRC32_TABLES[0][(crc ^ static_cast<uint8_t>(data[i])) & 0xFF];
+  }
+  return ~crc;
+}
+
+int popcount_bitwise(uint64_t x) {
+  int count = 0;
+  for (; x != 0; x &= x - 1) ++count;  // Clears the lowest set bit
+  return count;
+}
+
+void measure_lookup_tables() {
+  // Evaluated by the compiler: a wrong table would not even build
+  static_assert(tables::crc32("123456789") == 0xCBF43926u, "CRC-32 check value");
+  static_assert(tables::popcount(0xF0F0F0F0F0F0F0F0ull) == 32, "popcount");
+
+  const size_t BYTES = 1 << 20;
+  std::vector<char> data(BYTES);
+  std::vector<uint64_t> words(BYTES / sizeof(uint64_t));
+  uint64_t state = 42;
+  for (size_t i = 0; i < words.size(); ++i) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    words[i] = state;
+  }
+  for (size_t i = 0; i < BYTES; ++i) data[i] = static_cast<char>(words[i / 8] >> (i % 8 * 8));
+
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;  // The lines below instead
+  bench::Suite suite("templated_functions", options);
+  auto ns_per_item = [&](const std::string& name, size_t items, auto&& op) {
+    return suite.run(name, op, items).ns_per_item();
+  };
+
+  printf("  crc32 of 1MB, ns per byte: bitwise %.2f, byte table %.2f, slicing-by-8 %.2f\n",
+         ns_per_item("crc32 / bitwise", BYTES, [&] { bench::do_not_optimize(crc32_bitwise(data.data(), BYTES)); }),
+         ns_per_item("crc32 / byte table", BYTES, [&] { bench::do_not_optimize(crc32_bytewise(data.data(), BYTES)); }),
+         ns_per_item("crc32 / slicing-by-8", BYTES, [&] { bench::do_not_optimize(tables::crc32(data.data(), BYTES)); }));
+  auto count_bits = [&](auto popcount) {
+    return [&words, popcount] {
+      long long bits = 0;
+      for (uint64_t word : words) bits += popcount(word);
+      bench::do_not_optimize(bits);
+    };
+  };
+  printf("  popcount of 128K words, ns per word: bit loop %.2f, byte table %.2f, builtin %.2f\n",
+         ns_per_item("popcount / bit loop", words.size(), count_bits(popcount_bitwise)),
+         ns_per_item("popcount / byte table", words.size(), count_bits([](uint64_t x) { return tables::popcount(x); })),
+         ns_per_item("popcount / builtin", words.size(), count_bits([](uint64_t x) { return __builtin_popcountll(x); })));
+  std::cout << "  (compiled for a CPU with POPCNT, e.g. -mpopcnt, the builtin is one instruction, and the" << std::endl;
+  std::cout << "  compiler recognizes the bit loop and emits the same instruction)" << std::endl;
+}
+
 int main() {
   // First, let's see the add function called on both ints and floats.
   std::cout << "Printing add<int>(3, 5): " << add<int>(3, 5) << std::endl;
@@ -86,5 +161,9 @@ int main() {
   // However, in the class, you'll be seeing code similar to this in the
   // codebase, so it's good to understand templated functions in these contexts!
 
+  // And some templates are there for speed: tables the compiler builds.
+  std::cout << "\nCompile-time lookup tables vs computing at run time:" << std::endl;
+  measure_lookup_tables();
+
   return 0;
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 /**
  * @file udp_client.cpp
  * @brief Standalone UDP client implementation
+ *
+ * Without --bench the client sends one message and waits for the echo.
+ * With --bench it becomes a load generator for udp_server: every datagram
+ * carries a flow id, sequence number and send timestamp, and the echoes are
+ * used to measure throughput, loss, reordering and round-trip percentiles.
  */
 
 #include <iostream>
@@ -10,14 +15,260 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "latency_histogram.h"
 
 const int SERVER_PORT = 9999;
 const int BUFFER_SIZE = 1024;
 const char* SERVER_IP = "127.0.0.1";  // localhost
 
+// =============================================================================
+// BENCHMARK MODE
+// =============================================================================
+
+struct BenchConfig {
+    std::string server_ip = SERVER_IP;
+    int port = SERVER_PORT;
+    int concurrency = 1;       // Flows, one socket + thread each
+    size_t message_size = 64;  // Payload bytes per datagram (>= header)
+    double rate = 0;           // Open loop: total datagrams/sec across flows
+    int window = 16;           // Closed loop: datagrams in flight per flow
+    double duration = 5.0;     // Seconds of sending
+};
+
+// Stamped at the front of every payload; the server echoes it back after
+// its "Echo: " prefix
+struct PacketHeader {
+    uint32_t magic;
+    uint32_t flow;
+    uint64_t sequence;
+    uint64_t send_ns;
+};
+const uint32_t PACKET_MAGIC = 0x55445042;  // "UDPB"
+const size_t ECHO_PREFIX_LENGTH = 6;       // strlen("Echo: ")
+const int DRAIN_MS = 500;                  // Wait this long for stragglers
+const int RETRANSMIT_TIMEOUT_MS = 100;     // Closed loop: assume the window was lost
+
+struct FlowStats {
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t reordered = 0;
+    uint64_t bytes_received = 0;
+    uint64_t highest_sequence = 0;
+    bool any_received = false;
+    LatencyHistogram rtt;
+};
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Read every echo that is already queued on the socket
+void drain_responses(int sock, uint32_t flow, FlowStats& stats, uint64_t& in_flight) {
+    char buffer[BUFFER_SIZE + ECHO_PREFIX_LENGTH];
+    while (true) {
+        ssize_t n = recv(sock, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n < static_cast<ssize_t>(ECHO_PREFIX_LENGTH + sizeof(PacketHeader))) {
+            if (n < 0) return;
+            continue;  // Not one of ours
+        }
+        uint64_t arrival = now_ns();
+        
+        PacketHeader header;
+        memcpy(&header, buffer + ECHO_PREFIX_LENGTH, sizeof(header));
+        if (header.magic != PACKET_MAGIC || header.flow != flow) continue;
+        
+        stats.received++;
+        stats.bytes_received += static_cast<uint64_t>(n);
+        stats.rtt.record(arrival - header.send_ns);
+        if (in_flight > 0) in_flight--;
+        
+        if (stats.any_received && header.sequence < stats.highest_sequence) {
+            stats.reordered++;
+        } else {
+            stats.highest_sequence = header.sequence;
+            stats.any_received = true;
+        }
+    }
+}
+
+// Wait for readability for at most timeout_ns. ppoll() rather than poll():
+// open-loop send gaps are often well under a millisecond, and rounding
+// them down to whole milliseconds turned every wait into a busy poll.
+bool wait_readable(int sock, uint64_t timeout_ns) {
+    struct pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    struct timespec timeout;
+    timeout.tv_sec = static_cast<time_t>(timeout_ns / 1000000000);
+    timeout.tv_nsec = static_cast<long>(timeout_ns % 1000000000);
+    return ppoll(&pfd, 1, &timeout, nullptr) > 0;
+}
+
+// One flow: open loop sends on a fixed schedule regardless of replies;
+// closed loop keeps `window` datagrams outstanding
+void run_flow(const BenchConfig& config, uint32_t flow, FlowStats& stats) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) return;
+    
+    int buffer_bytes = 4 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &buffer_bytes, sizeof(buffer_bytes));
+    
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(config.port);
+    inet_pton(AF_INET, config.server_ip.c_str(), &server_addr.sin_addr);
+    if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        close(sock);
+        return;
+    }
+    
+    std::vector<char> payload(config.message_size, 'x');
+    PacketHeader header;
+    header.magic = PACKET_MAGIC;
+    header.flow = flow;
+    
+    bool open_loop = config.rate > 0;
+    uint64_t interval_ns = open_loop ? static_cast<uint64_t>(1e9 * config.concurrency / config.rate) : 0;
+    uint64_t start = now_ns();
+    uint64_t end = start + static_cast<uint64_t>(config.duration * 1e9);
+    uint64_t next_send = start;
+    uint64_t in_flight = 0;
+    
+    while (true) {
+        uint64_t now = now_ns();
+        if (now >= end) break;
+        
+        bool may_send = open_loop ? now >= next_send : in_flight < static_cast<uint64_t>(config.window);
+        if (may_send) {
+            header.sequence = stats.sent;
+            header.send_ns = now_ns();
+            memcpy(payload.data(), &header, sizeof(header));
+            if (send(sock, payload.data(), payload.size(), 0) > 0) {
+                stats.sent++;
+                in_flight++;
+            }
+            next_send += interval_ns;
+            drain_responses(sock, flow, stats, in_flight);
+            continue;
+        }
+        
+        uint64_t timeout_ns = open_loop ? next_send - now : RETRANSMIT_TIMEOUT_MS * 1000000ull;
+        if (wait_readable(sock, timeout_ns)) {
+            drain_responses(sock, flow, stats, in_flight);
+        } else if (!open_loop) {
+            in_flight = 0;  // Whole window timed out: presume lost, keep going
+        }
+    }
+    
+    // Collect late echoes before counting the rest as lost
+    uint64_t drain_end = now_ns() + DRAIN_MS * 1000000ull;
+    while (stats.received < stats.sent && now_ns() < drain_end) {
+        if (wait_readable(sock, 10 * 1000000ull)) {
+            drain_responses(sock, flow, stats, in_flight);
+        }
+    }
+    close(sock);
+}
+
+void print_bench_report(const BenchConfig& config, const std::vector<FlowStats>& flows, double elapsed) {
+    FlowStats total;
+    for (const auto& flow : flows) {
+        total.sent += flow.sent;
+        total.received += flow.received;
+        total.reordered += flow.reordered;
+        total.bytes_received += flow.bytes_received;
+        total.rtt.merge(flow.rtt);
+    }
+    uint64_t lost = total.sent > total.received ? total.sent - total.received : 0;
+    
+    std::cout << "\n📊 Benchmark results (" << config.concurrency << " flow(s), " << config.message_size
+              << "-byte messages, " << (config.rate > 0 ? "open loop" : "closed loop") << ")" << std::endl;
+    std::cout << "  Sent:       " << total.sent << " (" << static_cast<uint64_t>(total.sent / elapsed)
+              << " pkt/s)" << std::endl;
+    std::cout << "  Received:   " << total.received << " (" << static_cast<uint64_t>(total.received / elapsed)
+              << " pkt/s, " << (total.bytes_received * 8 / elapsed / 1e6) << " Mbit/s)" << std::endl;
+    std::cout << "  Lost:       " << lost << " (" << (total.sent ? 100.0 * lost / total.sent : 0.0) << "%)"
+              << std::endl;
+    std::cout << "  Reordered:  " << total.reordered << std::endl;
+    std::cout << "  RTT:        " << total.rtt.summary() << std::endl;
+}
+
+int run_benchmark(const BenchConfig& config) {
+    std::cout << "Load-testing UDP server at " << config.server_ip << ":" << config.port << " for "
+              << config.duration << "s" << std::endl;
+    if (config.rate > 0) {
+        std::cout << "Open loop: " << config.rate << " pkt/s total" << std::endl;
+    } else {
+        std::cout << "Closed loop: window " << config.window << " per flow" << std::endl;
+    }
+    
+    std::vector<FlowStats> flows(config.concurrency);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < config.concurrency; ++i) {
+        threads.emplace_back(run_flow, std::cref(config), static_cast<uint32_t>(i), std::ref(flows[i]));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double elapsed = std::min(config.duration,
+                              std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    
+    print_bench_report(config, flows, elapsed);
+    return 0;
+}
+
+// Parse "--bench [--server IP] [--port P] [--concurrency C] [--size B] [--rate R | --window W] [--duration S]"
+bool parse_bench_arguments(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--server" && has_value) {
+            config.server_ip = argv[++i];
+        } else if (arg == "--port" && has_value) {
+            config.port = std::stoi(argv[++i]);
+        } else if (arg == "--concurrency" && has_value) {
+            config.concurrency = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--size" && has_value) {
+            config.message_size = std::stoul(argv[++i]);
+        } else if (arg == "--rate" && has_value) {
+            config.rate = std::stod(argv[++i]);
+        } else if (arg == "--window" && has_value) {
+            config.window = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--duration" && has_value) {
+            config.duration = std::stod(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " --bench [--server IP] [--port P] [--concurrency C]"
+                      << " [--size BYTES] [--rate PPS | --window W] [--duration SECONDS]" << std::endl;
+            return false;
+        }
+    }
+    config.message_size = std::max(config.message_size, sizeof(PacketHeader));
+    config.message_size = std::min(config.message_size, static_cast<size_t>(BUFFER_SIZE));
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "=== UDP CLIENT ===" << std::endl;
     
+    if (argc >= 2 && std::string(argv[1]) == "--bench") {
+        BenchConfig config;
+        if (!parse_bench_arguments(argc, argv, config)) {
+            return 1;
+        }
+        return run_benchmark(config);
+    }
+    
     std::string server_ip = SERVER_IP;
     std::string message;
     
@@ -123,4 +374,6 @@ Usage Examples:
   ./udp_client                           # Interactive mode
   ./udp_client "Hello Server"            # Send specific message to localhost
   ./udp_client "Hello" 192.168.1.100     # Send to specific IP
+  ./udp_client --bench --concurrency 4 --window 32 --duration 10
+  ./udp_client --bench --rate 200000 --size 256 --server 10.0.0.2
 */
\ No newline at end of file
@@ -1,37 +1,345 @@
 /**
  * @file udp_server.cpp
  * @brief Standalone UDP server implementation
+ *
+ * Default mode handles one datagram per recvfrom()/sendto() pair; with
+ * --log-level debug it logs every packet (those lines are compiled out of
+ * release builds, see log.h). The high-throughput mode (--batch) instead
+ * runs one worker per core, each with its own SO_REUSEPORT socket, and
+ * moves up to N datagrams per recvmmsg()/sendmmsg() call through
+ * preallocated buffers.
+ *
+ * Both modes count datagrams and time each echo into per-thread metrics
+ * (metrics.h); --metrics-port serves them to Prometheus (on loopback,
+ * unless --metrics-address says otherwise).
  */
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <signal.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "log.h"
+#include "metrics.h"
 
 const int PORT = 9999;
 const int BUFFER_SIZE = 1024;
+const int DEFAULT_BATCH_SIZE = 64;
 int server_socket = -1;
 
+// Every worker (and the single-socket loop) counts into its own per-thread
+// block; the totals are summed only when read (see metrics.h)
+const metrics::Counter datagrams_total("udp_datagrams_total", "Datagrams echoed");
+const metrics::Counter bytes_total("udp_received_bytes_total", "Payload bytes received");
+const metrics::Counter batches_total("udp_batches_total", "recvmmsg() batches (1 datagram each without --batch)");
+const metrics::Counter errors_total("udp_errors_total", "Failed receives and sends");
+const metrics::Histogram echo_latency("udp_echo_seconds", "From a datagram or batch received to its echo sent");
+const metrics::TraceEvent trace_batch("batch");  // Argument: datagrams in the batch
+
 // Signal handler for graceful shutdown
 void signal_handler(int signum) {
     std::cout << "\n\nShutting down UDP server..." << std::endl;
+    if (datagrams_total.value() > 0) {
+        std::cout << "Echoed " << datagrams_total.value() << " datagrams (" << bytes_total.value() << " bytes) in "
+                  << batches_total.value() << " batches" << std::endl;
+    }
     if (server_socket != -1) {
         close(server_socket);
     }
     exit(0);
 }
 
-int main() {
+// =============================================================================
+// BATCH MODE: recvmmsg/sendmmsg + SO_REUSEPORT, one worker per core
+// =============================================================================
+
+// Everything one worker needs per batch, allocated once up front. A reply is
+// gathered from two iovecs - the constant "Echo: " prefix and the received
+// payload - so no response string is built per packet.
+struct BatchBuffers {
+    explicit BatchBuffers(int batch_size)
+        : payloads(static_cast<size_t>(batch_size) * BUFFER_SIZE),
+          addrs(batch_size), recv_iov(batch_size), send_iov(2 * batch_size) {
+#if defined(__linux__)
+        recv_msgs.resize(batch_size);
+        send_msgs.resize(batch_size);
+        for (int i = 0; i < batch_size; ++i) {
+            recv_iov[i].iov_base = payload(i);
+            recv_iov[i].iov_len = BUFFER_SIZE;
+            memset(&recv_msgs[i], 0, sizeof(recv_msgs[i]));
+            recv_msgs[i].msg_hdr.msg_iov = &recv_iov[i];
+            recv_msgs[i].msg_hdr.msg_iovlen = 1;
+            recv_msgs[i].msg_hdr.msg_name = &addrs[i];
+            recv_msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            
+            send_iov[2 * i].iov_base = const_cast<char*>(ECHO_PREFIX);
+            send_iov[2 * i].iov_len = ECHO_PREFIX_LENGTH;
+            send_iov[2 * i + 1].iov_base = payload(i);
+            memset(&send_msgs[i], 0, sizeof(send_msgs[i]));
+            send_msgs[i].msg_hdr.msg_iov = &send_iov[2 * i];
+            send_msgs[i].msg_hdr.msg_iovlen = 2;
+            send_msgs[i].msg_hdr.msg_name = &addrs[i];
+        }
+#endif
+    }
+    
+    char* payload(int i) { return payloads.data() + static_cast<size_t>(i) * BUFFER_SIZE; }
+    
+    static constexpr const char* ECHO_PREFIX = "Echo: ";
+    static const size_t ECHO_PREFIX_LENGTH = 6;
+    
+    std::vector<char> payloads;
+    std::vector<struct sockaddr_in> addrs;
+    std::vector<struct iovec> recv_iov;
+    std::vector<struct iovec> send_iov;
+#if defined(__linux__)
+    std::vector<struct mmsghdr> recv_msgs;
+    std::vector<struct mmsghdr> send_msgs;
+#endif
+};
+
+// Create a UDP socket bound to port that shares the port with the other workers
+int open_reuseport_socket(int port) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) return -1;
+    
+    int opt = 1;
+#if defined(SO_REUSEPORT)
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        std::cerr << "⚠️  Warning: Failed to set SO_REUSEPORT" << std::endl;
+    }
+#endif
+    // Bigger kernel buffers absorb bursts between two batches
+    int buffer_bytes = 4 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &buffer_bytes, sizeof(buffer_bytes));
+    setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &buffer_bytes, sizeof(buffer_bytes));
+    
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// Failed receives in batch_worker. EINTR and EAGAIN are retried at once;
+// any other error would most likely come straight back, so retrying at once
+// would spin at 100% CPU. The worker sleeps instead, for 10ms doubling up
+// to 1s, and logs at most once a second. If the socket itself is unusable
+// the worker stops.
+class ReceiveBackoff {
+public:
+    static const uint64_t MIN_DELAY_MS = 10;
+    static const uint64_t MAX_DELAY_MS = 1000;
+    
+    // Returns false if the worker should stop receiving on this socket
+    bool on_error(int error) {
+        if (error == EINTR || error == EAGAIN || error == EWOULDBLOCK) return true;
+        errors_total.add();
+        if (error == EBADF || error == ENOTSOCK || error == EFAULT || error == EINVAL) {
+            LOG_ERROR << "Error receiving datagrams, stopping worker: " << strerror(error);
+            return false;
+        }
+        failures_++;
+        delay_ms_ = delay_ms_ == 0 ? MIN_DELAY_MS : std::min(2 * delay_ms_, MAX_DELAY_MS);
+        uint64_t now_ms = metrics::now_ns() / 1000000;
+        if (now_ms >= next_log_ms_) {
+            LOG_ERROR << "Error receiving datagrams: " << strerror(error) << " (" << failures_
+                      << " in a row, retrying in " << delay_ms_ << " ms)";
+            next_log_ms_ = now_ms + 1000;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms_));
+        return true;
+    }
+    
+    void on_success() {
+        failures_ = 0;
+        delay_ms_ = 0;
+    }
+    
+private:
+    uint64_t failures_ = 0;
+    uint64_t delay_ms_ = 0;
+    uint64_t next_log_ms_ = 0;
+};
+
+// Receive up to batch_size datagrams, echo them back, repeat
+void batch_worker(int sock, int batch_size) {
+    BatchBuffers buffers(batch_size);
+    ReceiveBackoff backoff;
+    
+    while (true) {
+#if defined(__linux__)
+        for (int i = 0; i < batch_size; ++i) {
+            buffers.recv_msgs[i].msg_hdr.msg_namelen = sizeof(buffers.addrs[i]);
+        }
+        // Block for the first datagram, then take whatever else is queued
+        int received = recvmmsg(sock, buffers.recv_msgs.data(), batch_size, MSG_WAITFORONE, nullptr);
+        if (received < 0) {
+            if (!backoff.on_error(errno)) break;
+            continue;
+        }
+        if (received == 0) continue;
+        backoff.on_success();
+        uint64_t start = metrics::now_ns();
+        
+        uint64_t bytes = 0;
+        for (int i = 0; i < received; ++i) {
+            size_t length = buffers.recv_msgs[i].msg_len;
+            buffers.send_iov[2 * i + 1].iov_len = length;
+            buffers.send_msgs[i].msg_hdr.msg_namelen = buffers.recv_msgs[i].msg_hdr.msg_namelen;
+            bytes += length;
+        }
+        
+        int sent = 0;
+        while (sent < received) {
+            int n = sendmmsg(sock, buffers.send_msgs.data() + sent, received - sent, 0);
+            if (n <= 0) {
+                errors_total.add();
+                break;  // Drop the rest of the batch, as UDP would
+            }
+            sent += n;
+        }
+#else
+        // No recvmmsg/sendmmsg: same buffers, one datagram per syscall
+        int received = 0;
+        uint64_t bytes = 0;
+        int flags = 0;
+        while (received < batch_size) {
+            socklen_t addr_len = sizeof(buffers.addrs[received]);
+            ssize_t length = recvfrom(sock, buffers.payload(received), BUFFER_SIZE, flags,
+                                      (struct sockaddr*)&buffers.addrs[received], &addr_len);
+            if (length < 0) {
+                if (received == 0 && !backoff.on_error(errno)) return;
+                break;
+            }
+            buffers.send_iov[2 * received + 1].iov_len = static_cast<size_t>(length);
+            bytes += static_cast<uint64_t>(length);
+            ++received;
+            flags = MSG_DONTWAIT;
+        }
+        if (received > 0) backoff.on_success();
+        uint64_t start = metrics::now_ns();
+        for (int i = 0; i < received; ++i) {
+            struct msghdr message;
+            memset(&message, 0, sizeof(message));
+            message.msg_name = &buffers.addrs[i];
+            message.msg_namelen = sizeof(buffers.addrs[i]);
+            message.msg_iov = &buffers.send_iov[2 * i];
+            message.msg_iovlen = 2;
+            sendmsg(sock, &message, 0);
+        }
+        if (received == 0) continue;
+#endif
+        echo_latency.record(metrics::now_ns() - start);
+        trace_batch(static_cast<uint64_t>(received));
+        datagrams_total.add(static_cast<uint64_t>(received));
+        bytes_total.add(bytes);
+        batches_total.add();
+    }
+}
+
+// Start the workers and print one throughput line per second
+int run_batch_mode(int workers, int batch_size) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workers; ++i) {
+        int sock = open_reuseport_socket(PORT);
+        if (sock < 0) {
+            std::cerr << "Error: Failed to bind worker socket to port " << PORT << std::endl;
+            return 1;
+        }
+        threads.emplace_back(batch_worker, sock, batch_size);
+    }
+    
+    std::cout << "✓ Batch mode: " << workers << " worker(s), batch size " << batch_size << std::endl;
+    std::cout << "✓ Per-packet logging disabled; printing totals every second" << std::endl;
+    std::cout << "  (Press Ctrl+C to stop)" << std::endl << std::endl;
+    
+    uint64_t last_packets = 0, last_batches = 0;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        uint64_t packets = datagrams_total.value();
+        uint64_t batches = batches_total.value();
+        uint64_t pps = packets - last_packets;
+        uint64_t batch_count = batches - last_batches;
+        if (pps > 0) {
+            std::cout << "📊 " << pps << " pkt/s, avg batch " << (batch_count ? pps / batch_count : 0)
+                      << ", total " << packets << std::endl;
+        }
+        last_packets = packets;
+        last_batches = batches;
+    }
+    
+    for (auto& t : threads) {
+        t.join();
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    bool batch_mode = false;
+    int batch_size = DEFAULT_BATCH_SIZE;
+    int workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int metrics_port = 0;
+    std::string metrics_address = "127.0.0.1";
+    logging::Level level;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--batch") {
+            batch_mode = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                batch_size = std::max(1, std::stoi(argv[++i]));
+            }
+        } else if (arg == "--workers" && i + 1 < argc) {
+            workers = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            metrics_port = std::stoi(argv[++i]);
+        } else if (arg == "--metrics-address" && i + 1 < argc) {
+            metrics_address = argv[++i];
+        } else if (arg == "--log-level" && i + 1 < argc && logging::parse_level(argv[i + 1], level)) {
+            logging::set_level(level);
+            ++i;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--batch [N]] [--workers W] [--metrics-port P] [--metrics-address A]"
+                      << " [--log-level error|warning|info|debug]" << std::endl;
+            return 1;
+        }
+    }
+    
     std::cout << "=== UDP SERVER ===" << std::endl;
     std::cout << "Starting UDP server on port " << PORT << std::endl;
     
     // Set up signal handler for Ctrl+C
     signal(SIGINT, signal_handler);
     
+    if (metrics_port > 0) {
+        if (metrics::serve_prometheus(metrics_port, metrics_address.c_str())) {
+            std::cout << "✓ Metrics: http://" << metrics_address << ":" << metrics_port << "/metrics" << std::endl;
+        } else {
+            std::cerr << "⚠️  Warning: Failed to serve metrics on port " << metrics_port << std::endl;
+        }
+    }
+    
+    if (batch_mode) {
+        return run_batch_mode(workers, batch_size);
+    }
+    
     // Create UDP socket
     server_socket = socket(AF_INET, SOCK_DGRAM, 0);
     if (server_socket < 0) {
@@ -72,34 +380,53 @@ int main() {
         
         if (bytes_received > 0) {
             buffer[bytes_received] = '\0';
+            uint64_t start = metrics::now_ns();
             
             // Get client IP and port
             char client_ip[INET_ADDRSTRLEN];
             inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
             int client_port = ntohs(client_addr.sin_port);
             
-            std::cout << "📨 Received from " << client_ip << ":" << client_port 
-                      << " (" << bytes_received << " bytes): \"" << buffer << "\"" << std::endl;
+            LOG_DEBUG << "Received from " << client_ip << ":" << client_port << " (" << bytes_received
+                      << " bytes): \"" << std::string_view(buffer, static_cast<size_t>(bytes_received)) << "\"";
             
-            // Create echo response
-            std::string response = "Echo: " + std::string(buffer);
+            // Create echo response. By length, not as a C string: payloads
+            // may be binary (udp_client --bench headers are full of zeros)
+            std::string response = "Echo: ";
+            response.append(buffer, static_cast<size_t>(bytes_received));
             
             // Send response back to client
             ssize_t bytes_sent = sendto(server_socket, response.c_str(), response.length(),
                                        0, (struct sockaddr*)&client_addr, client_len);
             
             if (bytes_sent > 0) {
-                std::cout << "📤 Sent response to " << client_ip << ":" << client_port 
-                          << " (" << bytes_sent << " bytes): \"" << response << "\"" << std::endl;
+                LOG_DEBUG << "Sent response to " << client_ip << ":" << client_port << " (" << bytes_sent
+                          << " bytes): \"" << response << "\"";
             } else {
-                std::cerr << "❌ Failed to send response to client" << std::endl;
+                errors_total.add();
+                LOG_ERROR << "Failed to send response to " << client_ip << ":" << client_port << ": "
+                          << strerror(errno);
             }
             
-            std::cout << std::endl;
+            echo_latency.record(metrics::now_ns() - start);
+            datagrams_total.add();
+            bytes_total.add(static_cast<uint64_t>(bytes_received));
+            batches_total.add();
         } else if (bytes_received < 0) {
-            std::cerr << "❌ Error receiving data" << std::endl;
+            errors_total.add();
+            LOG_ERROR << "Error receiving data: " << strerror(errno);
         }
     }
     
     return 0;
-}
\ No newline at end of file
+}
+
+/*
+Usage Examples:
+  ./udp_server                           # One datagram at a time
+  ./udp_server --log-level debug         # ... and log every packet (debug builds)
+  ./udp_server --batch                   # recvmmsg/sendmmsg, 64 per call, one worker per core
+  ./udp_server --batch 256 --workers 4   # Bigger batches on 4 SO_REUSEPORT sockets
+  ./udp_server --batch --metrics-port 9100   # curl localhost:9100/metrics
+  ./udp_server --metrics-port 9100 --metrics-address 0.0.0.0   # Scrapeable from other hosts
+*/
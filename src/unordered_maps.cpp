@@ -24,8 +24,116 @@
 #include <utility>
 // Includes algorithms like std::count_if and std::max_element
 #include <algorithm>
+// Includes the timers, fixed-width integers and helpers used by the
+// benchmark at the end of this file.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
 
-int main() {
+// Includes containers::FlatHashMap, an open-addressing hash map.
+#include "flat_hash_map.h"
+
+// Counts the bytes a container allocates, so that the benchmark can report
+// memory per entry for both maps.
+inline size_t g_allocated_bytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &) {}
+
+  T *allocate(size_t n) {
+    g_allocated_bytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T *ptr, size_t n) {
+    g_allocated_bytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(ptr, n);
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U> &) const { return true; }
+  template <typename U>
+  bool operator!=(const CountingAllocator<U> &) const { return false; }
+};
+
+// Pseudo-random, distinct 64-bit keys (splitmix64 is a bijection). Hits
+// have the low bit cleared and misses have it set, so they never collide.
+uint64_t BenchKey(uint64_t i, bool hit) {
+  uint64_t z = (i + 1) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z ^= z >> 31;
+  return hit ? (z & ~1ULL) : (z | 1ULL);
+}
+
+template <typename Fn>
+double NanosPerOp(size_t ops, Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return ns / static_cast<double>(ops);
+}
+
+// Times insert, find-hit, find-miss and erase for one map type, and
+// reports the bytes it allocated per entry at full size.
+template <typename Map>
+void BenchmarkMap(const char *name, size_t n) {
+  std::vector<uint64_t> hits(n);
+  std::vector<uint64_t> misses(n);
+  for (size_t i = 0; i < n; ++i) {
+    hits[i] = BenchKey(i, true);
+    misses[i] = BenchKey(i, false);
+  }
+
+  g_allocated_bytes = 0;
+  uint64_t found = 0;
+  {
+    Map map;
+    double insert_ns = NanosPerOp(n, [&] {
+      for (uint64_t key : hits) map[key] = key;
+    });
+    double bytes_per_entry = static_cast<double>(g_allocated_bytes) / n;
+    double hit_ns = NanosPerOp(n, [&] {
+      for (uint64_t key : hits) found += map.count(key);
+    });
+    double miss_ns = NanosPerOp(n, [&] {
+      for (uint64_t key : misses) found += map.count(key);
+    });
+    double erase_ns = NanosPerOp(n, [&] {
+      for (uint64_t key : hits) found += map.erase(key);
+    });
+    std::printf("  %-20s %10zu %9.1f %9.1f %9.1f %9.1f %10.1f\n", name, n, insert_ns, hit_ns, miss_ns,
+                erase_ns, bytes_per_entry);
+  }
+  if (found != 2 * n) {
+    std::printf("  (unexpected result count %llu)\n", static_cast<unsigned long long>(found));
+  }
+}
+
+void BenchmarkHashMaps(size_t max_keys) {
+  using StdMap = std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                    CountingAllocator<std::pair<const uint64_t, uint64_t>>>;
+  using FlatMap = containers::FlatHashMap<uint64_t, uint64_t, containers::FlatHash<uint64_t>,
+                                          std::equal_to<uint64_t>,
+                                          CountingAllocator<std::pair<const uint64_t, uint64_t>>>;
+
+  std::printf("\n  %-20s %10s %9s %9s %9s %9s %10s\n", "map (uint64 -> uint64)", "keys", "insert",
+              "find-hit", "find-miss", "erase", "bytes/key");
+  std::printf("  %-20s %10s %9s %9s %9s %9s %10s\n", "", "", "ns/op", "ns/op", "ns/op", "ns/op", "");
+  for (size_t n = 1000; n <= max_keys; n *= 1000) {
+    BenchmarkMap<StdMap>("std::unordered_map", n);
+    BenchmarkMap<FlatMap>("FlatHashMap", n);
+  }
+}
+
+int main(int argc, char *argv[]) {
   // The std::unordered_map is a data structure that contains key-value pairs
   // with unique keys. Essentially, this means you can use it as a hash table
   // in your code.
@@ -386,5 +494,42 @@ int main() {
   std::cout << "- Iterating all elements: O(n) time complexity" << std::endl;
   std::cout << "- empty(): O(1) time complexity" << std::endl;
 
+  // === FLAT (OPEN-ADDRESSING) HASH MAP ===
+  // std::unordered_map allocates a separate node for every element, so each
+  // insert is a heap allocation and each lookup chases pointers.
+  // containers::FlatHashMap (src/include/flat_hash_map.h) stores elements
+  // inline in one array and probes 16 one-byte hash tags at a time.
+  std::cout << "\n=== FLAT HASH MAP (OPEN ADDRESSING) ===" << std::endl;
+  containers::FlatHashMap<std::string, int> flat_frequency;
+  for (const std::string &word : text_words) {
+    flat_frequency[word]++;
+  }
+  std::cout << "Word frequencies:" << std::endl;
+  for (const auto &pair : flat_frequency) {
+    std::cout << "'" << pair.first << "': " << pair.second << " times" << std::endl;
+  }
+
+  // Lookups with a std::string_view (or a string literal) do not build a
+  // temporary std::string: the map's hash and equality are transparent.
+  std::string_view sentence = "hello cpp";
+  std::string_view first_word = sentence.substr(0, sentence.find(' '));
+  auto flat_it = flat_frequency.find(first_word);
+  if (flat_it != flat_frequency.end()) {
+    std::cout << "Found '" << first_word << "' via string_view: " << flat_it->second << std::endl;
+  }
+  std::cout << "Contains \"world\": " << (flat_frequency.contains("world") ? "Yes" : "No") << std::endl;
+
+  // erase() moves later elements back into the hole instead of leaving a
+  // tombstone, so filtering while iterating goes through erase_if.
+  size_t removed = erase_if(flat_frequency, [](const auto &pair) { return pair.second < 2; });
+  std::cout << "erase_if removed " << removed << " words seen once; size is now " << flat_frequency.size()
+            << " (capacity " << flat_frequency.capacity() << ")" << std::endl;
+
+  // Pass a larger key count to extend the benchmark, e.g.
+  // `unordered_maps 100000000` also runs 100M keys (needs several GB).
+  size_t max_keys = (argc > 1) ? static_cast<size_t>(std::atoll(argv[1])) : 1000000;
+  std::cout << "\n=== BENCHMARK: std::unordered_map vs FlatHashMap ===" << std::endl;
+  BenchmarkHashMaps(max_keys);
+
   return 0;
 }
\ No newline at end of file
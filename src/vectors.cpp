@@ -25,6 +25,19 @@
 #include <iostream>
 // Includes the vector container library header.
 #include <vector>
+// Includes headers used by the growth benchmark at the bottom.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "benchmark.h"
+#include "remap_vector.h"
+#include "stable_vector.h"
 
 // Basic point class. (Will use later)
 class Point {
@@ -60,7 +73,173 @@ void print_int_vector(const std::vector<int> &vec) {
   std::cout << "\n";
 }
 
-int main() {
+// How a vector grows matters once it is big. std::vector doubles its
+// capacity by allocating a new buffer, copying (or moving) every element
+// over and freeing the old one. That makes push_back amortized O(1), but
+// the growth past 256MB copies 256MB, and until the copy is done both
+// buffers are resident: 512MB to hold 256MB. reserve() avoids it when the
+// final size is known in advance. The two containers below avoid it even
+// when it is not:
+// - containers::RemapVector grows its mmap()ed buffer with mremap(). The
+//   kernel moves page-table entries, not bytes, so nothing is copied and the
+//   old and new buffers are the same memory (trivially copyable types only).
+// - containers::StableVector adds fixed-size chunks and never moves an
+//   element, so references into it stay valid while it grows.
+
+// Peak RSS of the current process since reset_peak_rss(), in KB (Linux:
+// writing "5" to clear_refs resets the VmHWM high-water mark)
+long status_kb(const char *field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  size_t length = std::char_traits<char>::length(field);
+  while (std::getline(status, line)) {
+    if (line.compare(0, length, field) == 0 && line.size() > length && line[length] == ':') {
+      return std::atol(line.c_str() + length + 1);
+    }
+  }
+  return -1;
+}
+
+bool reset_peak_rss() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+  clear_refs.flush();
+  return clear_refs.good();
+}
+
+// Runs fill() in a child process, so the allocator state and RSS left
+// behind by earlier runs cannot hide or inflate its peak. Returns the
+// growth of resident memory during fill() in MB, or -1 if unknown.
+template <typename Fill> double peak_rss_mb(Fill fill) {
+  int channel[2];
+  if (pipe(channel) != 0) return -1;
+  pid_t child = fork();
+  if (child == 0) {
+    close(channel[0]);
+    double peak = -1;
+    if (reset_peak_rss()) {
+      long baseline = status_kb("VmRSS");
+      fill();
+      long high_water = status_kb("VmHWM");
+      if (baseline >= 0 && high_water >= 0) peak = (high_water - baseline) / 1024.0;
+    }
+    ssize_t written = write(channel[1], &peak, sizeof(peak));
+    _exit(written == sizeof(peak) ? 0 : 1);
+  }
+  close(channel[1]);
+  double peak = -1;
+  if (child < 0 || read(channel[0], &peak, sizeof(peak)) != sizeof(peak)) peak = -1;
+  close(channel[0]);
+  if (child > 0) waitpid(child, nullptr, 0);
+  return peak;
+}
+
+// Bytes a container copied while it grew: for every capacity change, the
+// elements that were there before
+template <typename Vector> uint64_t bytes_copied_growing(size_t elements) {
+  Vector vector;
+  uint64_t copied = 0;
+  size_t capacity = vector.capacity();
+  for (size_t i = 0; i < elements; ++i) {
+    vector.push_back(i);
+    if (vector.capacity() != capacity) {
+      copied += i * sizeof(uint64_t);
+      capacity = vector.capacity();
+    }
+  }
+  return copied;
+}
+
+void measure_growth(size_t elements) {
+  std::printf("\nPushing %zu uint64_t (%.0f MB), median of %d runs:\n", elements,
+              elements * sizeof(uint64_t) / 1048576.0, bench::Options::from_environment().repetitions);
+  bench::Options options = bench::Options::from_environment();
+  options.print = false;
+  bench::Suite suite("vectors", options);
+
+  auto fill_vector = [elements] {
+    std::vector<uint64_t> values;
+    for (size_t i = 0; i < elements; ++i) values.push_back(i);
+    bench::do_not_optimize(values.data());
+  };
+  auto fill_reserved = [elements] {
+    std::vector<uint64_t> values;
+    values.reserve(elements);
+    for (size_t i = 0; i < elements; ++i) values.push_back(i);
+    bench::do_not_optimize(values.data());
+  };
+  auto fill_remap = [elements] {
+    containers::RemapVector<uint64_t> values;
+    for (size_t i = 0; i < elements; ++i) values.push_back(i);
+    bench::do_not_optimize(values.data());
+  };
+  auto fill_stable = [elements] {
+    containers::StableVector<uint64_t> values;
+    for (size_t i = 0; i < elements; ++i) values.push_back(i);
+    bench::do_not_optimize(values.back());
+  };
+
+  // Peaks first, before the timed runs grow this process
+  double peak_vector = peak_rss_mb(fill_vector);
+  double peak_reserved = peak_rss_mb(fill_reserved);
+  double peak_remap = peak_rss_mb(fill_remap);
+  double peak_stable = peak_rss_mb(fill_stable);
+
+  double copied_vector = bytes_copied_growing<std::vector<uint64_t>>(elements) / 1048576.0;
+  double copied_remap = containers::remap_detail::remaps_in_kernel()
+                            ? 0.0
+                            : bytes_copied_growing<containers::RemapVector<uint64_t>>(elements) / 1048576.0;
+
+  auto print_row = [](const char *name, double ns, double peak, double copied, const char *stable) {
+    std::printf("  %-30s %8.2f %10.0f %10.0f   %s\n", name, ns, peak, copied, stable);
+  };
+  std::printf("  %-30s %8s %10s %10s   %s\n", "", "ns/push", "peak MB", "copied MB", "references stable");
+  print_row("std::vector", suite.run("std::vector", fill_vector, elements).ns_per_item(), peak_vector,
+            copied_vector, "no");
+  print_row("std::vector + reserve", suite.run("std::vector reserved", fill_reserved, elements).ns_per_item(),
+            peak_reserved, 0.0, "until size > reserve");
+  print_row("containers::RemapVector", suite.run("RemapVector", fill_remap, elements).ns_per_item(), peak_remap,
+            copied_remap, "no");
+  print_row("containers::StableVector", suite.run("StableVector", fill_stable, elements).ns_per_item(),
+            peak_stable, 0.0, "yes");
+  std::printf("  peak MB: resident memory added while filling (-1: not measurable here); the\n"
+              "  elements themselves take %.0f MB.\n",
+              elements * sizeof(uint64_t) / 1048576.0);
+
+  // What "references stable" means: the address of the first element
+  // before and after the vector grew a thousandfold
+  containers::StableVector<Point> stable_points;
+  const Point *first = &stable_points.emplace_back(1, 2);
+  for (int i = 0; i < 1000; ++i) stable_points.push_back(stable_points.back());
+  std::printf("  StableVector<Point>: first element %s after growing to %zu points\n",
+              first == &stable_points[0] ? "did not move" : "MOVED", stable_points.size());
+
+  // Appending one of its own elements across a growth, which may unmap the
+  // buffer that element lives in
+  containers::RemapVector<uint64_t> self_appended;
+  self_appended.push_back(42);
+  while (self_appended.size() < 100000) {
+    self_appended.push_back(self_appended[0]);
+    self_appended.emplace_back(self_appended.back());
+  }
+  bool intact = std::all_of(self_appended.begin(), self_appended.end(), [](uint64_t v) { return v == 42; });
+  std::printf("  RemapVector self-append: %s after growing to %zu elements\n", intact ? "intact" : "CORRUPTED",
+              self_appended.size());
+}
+
+int main(int argc, char *argv[]) {
+  // 305 MB of uint64_t: just past a doubling, like most real sizes
+  size_t growth_elements = 40'000'000;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--elements" && i + 1 < argc) {
+      growth_elements = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--elements N]\n";
+      return 1;
+    }
+  }
+
   // We can declare a Point vector with the following syntax.
   std::vector<Point> point_vector;
 
@@ -170,5 +349,8 @@ int main() {
   // We discuss more stylistic and readable ways of iterating through C++ STL
   // containers in auto.cpp! Check it out if you are interested.
 
+  // Finally, what growing a big vector costs, with and without reserve.
+  measure_growth(growth_elements);
+
   return 0;
 }